@@ -2,6 +2,12 @@
 
 #include "Rendering/BasicLightingPass.h"
 #include "Rendering/Camera.h"
+#include "Rendering/ObjectPicker.h"
+#include "Utils/BVHSelfCheck.h"
+#include "Utils/FrustumCullingBenchmark.h"
+#include "Utils/JobSystemBenchmark.h"
+#include "Utils/MemoryAllocatorSelfCheck.h"
+#include "Utils/TaskGraph.h"
 #include "extern/tiny-stable-diffusion/TinyStableDiffusion.h"
 
 static bool g_ShowFileBrowser = false;
@@ -29,7 +35,7 @@ std::string ShowOpenFileDialog() {
 }
 
 bool IsAllowedExtension(const std::filesystem::path& path) {
-  //  ׻ ǥ
+  // 폴더는 항상 표시
   if (std::filesystem::is_directory(path)) return true;
 
   std::string ext = path.extension().string();
@@ -77,7 +83,7 @@ void Editor::ShowFileBrowserUI(const std::string& filter) {
           s_currentDir = entry.path().string();
         }
       } else {
-        // Click File  Execute 'loadGltfModel()'  Exit Browser
+        // Click File → Execute 'loadGltfModel()' → Exit Browser
         if (ImGui::Selectable(name.c_str(), false)) {
           g_SelectedFilePath = entry.path().string();
 
@@ -86,27 +92,23 @@ void Editor::ShowFileBrowserUI(const std::string& filter) {
 
           std::string fileName = entry.path().filename().string();
 
-          std::vector<Mesh> meshes = {};
-          loadGltfModel(mainDevice.logicalDevice, directoryPath, fileName, meshes, 1.0f);
-          g_BatchManager.FlushMiniBatch(g_BatchManager.m_miniBatchList, g_ResourceManager);
+          m_sceneEdits.push_back([this, directoryPath, fileName]() {
+            std::vector<Mesh> meshes = {};
+            // Queued on the transfer queue without waiting, the next culling submit waits for it on the GPU
+            g_ResourceManager.BeginUploadBatch();
+            loadGltfModel(mainDevice.logicalDevice, directoryPath, fileName, meshes, 1.0f);
+            g_BatchManager.FlushMiniBatch(g_BatchManager.m_miniBatchList);
+            g_ResourceManager.EndUploadBatch();
 
-          for (Mesh& mesh : meshes) {
-            for (RayTracingVertex& vertex : mesh.ray_vertices) {
-              g_BatchManager.m_allMeshVertices.push_back(vertex);
+            for (Mesh& mesh : meshes) {
+              g_BatchManager.m_meshes.push_back(mesh);
             }
-            for (uint32_t& index : mesh.indices) {
-              g_BatchManager.m_allMeshIndices.push_back(index);
-            }
-            mesh.vertexOffset = g_BatchManager.m_accmulatedVertexOffset;
-            mesh.indexOffset = g_BatchManager.m_accmulatedIndexOffset;
-            g_BatchManager.m_accmulatedVertexOffset += mesh.ray_vertices.size() * sizeof(RayTracingVertex);
-            g_BatchManager.m_accmulatedIndexOffset += mesh.indices.size() * sizeof(uint32_t);
-            g_BatchManager.m_meshes.push_back(mesh);
-          }
 
-          g_BatchManager.RebuildBatchManager(mainDevice.logicalDevice, mainDevice.physicalDevice);
-          m_pCullingPass->SetupQueryPool();
-          m_pLightingPass->RebuildAS();
+            g_BatchManager.RebuildBatchManager(mainDevice.logicalDevice, mainDevice.physicalDevice);
+            m_pCullingPass->SetupQueryPool();
+            m_pCullingPass->SetupVisibilityBuffer();
+            m_pLightingPass->RebuildAS();
+          });
 
           g_ShowFileBrowser = false;
 
@@ -142,7 +144,8 @@ void Editor::ShowStableDiffusionUI() {
       s_statusMessage = "Generating...";
 
       std::string prompt = s_promptBuf;
-      s_genFuture = g_ThreadPool.Submit([prompt]() { GenerateImage2D(prompt); });
+      // Long running, keep it off the job workers so frame jobs are never queued behind it
+      s_genFuture = std::async(std::launch::async, [prompt]() { GenerateImage2D(prompt); });
     }
   }
   ImGui::SameLine();
@@ -167,17 +170,30 @@ void Editor::DrawTextureListUI() {
   static bool showFilePicker = false;
 
   if (ImGui::BeginTable("TextureTable", 5)) {
-    for (int i = 0; i < (int)g_BatchManager.m_diffuseImages.size(); i++) {
+    for (int i = 0; i < (int)g_BatchManager.m_materialTextures.size(); i++) {
       ImGui::PushID(i);
       ImGui::TableNextColumn();
 
       ImGui::Text(std::string("Texture #" + std::to_string(i)).c_str());
-      if (ImGui::ImageButton("", (ImTextureID)g_BatchManager.m_textureIdList[i], ImVec2(64, 64))) {
+      // Uploaded this frame, the graphics queue owns it from the next frame's culling submit on
+      const MaterialTexture& materialTexture = g_BatchManager.m_materialTextures[i];
+      if (g_ResourceManager.IsAcquirePending(g_BatchManager.m_diffuseImages[materialTexture.textureIndex].image)) {
+        ImGui::Text("Uploading...");
+        ImGui::PopID();
+        continue;
+      }
+      // The tile of the material when it shares an atlas page
+      const ImVec2 uv0(materialTexture.uvTransform.z, materialTexture.uvTransform.w);
+      const ImVec2 uv1(uv0.x + materialTexture.uvTransform.x, uv0.y + materialTexture.uvTransform.y);
+      if (ImGui::ImageButton("", (ImTextureID)g_BatchManager.m_textureIdList[materialTexture.textureIndex], ImVec2(64, 64), uv0,
+                             uv1)) {
         selectedIndex = i;
 
         std::string selectedFile = ShowOpenFileDialog();
         if (!selectedFile.empty()) {
-          g_BatchManager.ChangeTexture(mainDevice.logicalDevice, mainDevice.physicalDevice, i, selectedFile);
+          m_sceneEdits.push_back([this, i, selectedFile]() mutable {
+            g_BatchManager.ChangeTexture(mainDevice.logicalDevice, mainDevice.physicalDevice, i, selectedFile);
+          });
           std::cout << selectedFile << std::endl;
         }
 
@@ -239,10 +255,10 @@ void Editor::Initialize(GLFWwindow* window, VkInstance instance, VkDevice device
   depthStencilAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
   // REFERENCES
-  // FrameBuffer   Ͽ, attachment 迭 Ѵٰ  ȴ.
+  // FrameBuffer를 만들 때 사용하였던, attachment 배열을 참조한다고 보면 된다.
   // Attachment reference uses an attachment index that refers to index in the attachment list passed to renderPassCreateInfo
   VkAttachmentReference swapChainColourAttachmentRef = {};
-  swapChainColourAttachmentRef.attachment = 0;  // 󸶳  attachment ִ X, ° attachment ϳ .
+  swapChainColourAttachmentRef.attachment = 0;  // 얼마나 많은 attachment가 있는지 정의X, 몇번째 attachment를 참조하냐의 느낌.
   swapChainColourAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
   VkAttachmentReference depthStencilAttachmentRef = {};
@@ -265,7 +281,7 @@ void Editor::Initialize(GLFWwindow* window, VkInstance instance, VkDevice device
   // Conversion from VK_IMAGE_LAYER-UNDEFINED to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
   // Transition must happen after ..
   subpassDependencies[0].srcSubpass =
-      VK_SUBPASS_EXTERNAL;  // ܺο Ƿ, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
+      VK_SUBPASS_EXTERNAL;  // 외부에서 들어오므로, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
   subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;  // Pipeline stage
   subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;            // Stage access mask (memory access)
   // But most happen before ..
@@ -302,15 +318,15 @@ void Editor::Initialize(GLFWwindow* window, VkInstance instance, VkDevice device
 
   VK_CHECK(vkCreateRenderPass(mainDevice.logicalDevice, &renderPassCreateInfo, nullptr, &renderPass));
 
-  // 1. ImGui Context 
+  // 1. ImGui Context 생성
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGuiIO& io = ImGui::GetIO();
 
-  // 2. ImGui Ÿ 
+  // 2. ImGui 스타일 설정
   ImGui::StyleColorsDark();
 
-  // 3. ImGui Vulkan ʱȭ  
+  // 3. ImGui Vulkan 초기화 정보 설정
   ImGui_ImplGlfw_InitForVulkan(window, true);
   ImGui_ImplVulkan_InitInfo init_info = {};
   init_info.Instance = m_Instance;
@@ -319,7 +335,7 @@ void Editor::Initialize(GLFWwindow* window, VkInstance instance, VkDevice device
   init_info.QueueFamily = m_queueFamilyIndices.graphicsFamily;
   init_info.Queue = m_graphicsQueue;
   init_info.PipelineCache = VK_NULL_HANDLE;
-  init_info.DescriptorPool = m_ImguiDescriptorPool;  // ImGui  descriptor pool  ʿ
+  init_info.DescriptorPool = m_ImguiDescriptorPool;  // ImGui 전용 descriptor pool 생성 필요
   init_info.MinImageCount = MAX_FRAME_DRAWS;
   init_info.ImageCount = MAX_FRAME_DRAWS;
   init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
@@ -327,7 +343,7 @@ void Editor::Initialize(GLFWwindow* window, VkInstance instance, VkDevice device
 
   ImGui_ImplVulkan_Init(&init_info);
   ImGui_ImplVulkan_CreateFontsTexture();
-  // Font texture   cleanup
+  // Font texture 생성 후 cleanup
   ImGui_ImplVulkan_DestroyFontsTexture();
 }
 
@@ -345,6 +361,15 @@ void Editor::Update() {
   UpdateKeyboard();
 }
 
+void Editor::ApplySceneEdits() {
+  if (m_sceneEdits.empty()) return;
+
+  // Frames still in flight read the buffers and descriptors the edits free or rewrite
+  vkDeviceWaitIdle(mainDevice.logicalDevice);
+  for (std::function<void()>& edit : m_sceneEdits) edit();
+  m_sceneEdits.clear();
+}
+
 void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
   static float fps;
   static std::chrono::high_resolution_clock::time_point lastTime;
@@ -358,13 +383,13 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
   lastTime = currentTime;
   float deltaTime = elapsedTime.count();
 
-  // FPS 
+  // FPS 계산
   if (deltaTime > 0.0f) {
     fps = 1.0f / deltaTime;
     frameCount++;
     totalFps += fps;
 
-    // ְ FPS 
+    // 최고 FPS 갱신
     if (fps > maxFps) {
       maxFps = fps;
     }
@@ -372,7 +397,7 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
 
   float averageFps = (frameCount > 0) ? totalFps / frameCount : 0.0f;
 
-  // ο ImGui  
+  // 새로운 ImGui 프레임 시작
   ImGui_ImplVulkan_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
@@ -383,7 +408,7 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
   if (ImGui::BeginMainMenuBar()) {
     if (ImGui::BeginMenu("File")) {
       if (ImGui::MenuItem("Load Model")) {
-        g_ShowFileBrowser = true;  //   
+        g_ShowFileBrowser = true;  // 파일 브라우저 열기
       }
       ImGui::EndMenu();
     }
@@ -402,12 +427,88 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
   ImGui::Text("Max FPS: %.1f | Average FPS: %.1f", maxFps, averageFps);
   ImGui::Text("Number Of Rendering Object (Before Culling) : %d", g_RenderSetting.beforeCullingRenderingNum);
   ImGui::Text("Number Of Rendering Object (After View Culling) : %d", g_RenderSetting.afterViewCullingRenderingNum);
+  ImGui::Text("Number Of Rendering Object (After Occlusion Culling) : %d", g_RenderSetting.afterOcclusionCullingRenderingNum);
+  ImGui::Text("Draw Compaction Ratio : %.1f %%", g_RenderSetting.drawCompactionRatio * 100.0f);
+  ImGui::Text("Meshlets (After Meshlet Culling) : %d / %d", g_RenderSetting.afterMeshletCullingNum, g_RenderSetting.meshletNum);
+  ImGui::Text("Record CPU Time (Culling / Lighting) : %.3f ms / %.3f ms", g_RenderSetting.cullingRecordTimeMs,
+              g_RenderSetting.lightingRecordTimeMs);
+  VkUtils::MemoryStats memoryStats = g_MemoryAllocator.GetStats();
+  ImGui::Text("Device Memory : %u allocations in %u vkAllocateMemory (limit %u), %.1f / %.1f MB", memoryStats.allocationCount,
+              memoryStats.deviceMemoryCount, memoryStats.maxMemoryAllocationCount, memoryStats.usedBytes / (1024.0 * 1024.0),
+              memoryStats.reservedBytes / (1024.0 * 1024.0));
+  if (!g_RenderSetting.isGpuPicking && g_ObjectPicker.GetLastResult().entity >= 0) {
+    ImGui::Text("Pick : entity %d, triangle %u, distance %.3f (%.1f us)", g_ObjectPicker.GetLastResult().entity,
+                g_ObjectPicker.GetLastResult().triangle, g_ObjectPicker.GetLastResult().distance, g_RenderSetting.pickTimeUs);
+  }
+
+  // Benchmarks and self-checks run on the main thread when their button is pressed, they print a report to the console and
+  // the last result stays on screen below the button
+  static JobBenchmarkResult s_jobBenchmark;
+  if (ImGui::Button("Run Job System Benchmark")) {
+    s_jobBenchmark = RunJobSystemBenchmark();
+  }
+  if (s_jobBenchmark.taskCount > 0) {
+    ImGui::Text("Tasks/sec (%u tasks, %u workers)", s_jobBenchmark.taskCount, s_jobBenchmark.workerCount);
+    ImGui::Text("  Legacy Pool : %.0f", s_jobBenchmark.legacyTasksPerSec);
+    ImGui::Text("  Submit      : %.0f", s_jobBenchmark.submitTasksPerSec);
+    ImGui::Text("  Schedule    : %.0f", s_jobBenchmark.scheduleTasksPerSec);
+  }
+
+  static std::vector<FrustumCullingBenchmarkResult> s_cullingBenchmark;
+  if (ImGui::Button("Run Frustum Culling Benchmark")) {
+    s_cullingBenchmark = RunFrustumCullingBenchmark();
+  }
+  if (!s_cullingBenchmark.empty()) {
+    ImGui::Text("Culling ms (Legacy / Bounds / Scalar / %s / BVH)", GetSimdLevelName(GetSimdLevel()));
+    for (const FrustumCullingBenchmarkResult& result : s_cullingBenchmark) {
+      ImGui::Text("  %7u : %.3f / %.3f / %.3f / %.3f / %.3f (mismatch %u / %u)", result.boxCount, result.legacyMs, result.boundsMs,
+                  result.scalarMs, result.simdMs, result.bvhMs, result.simdMismatchCount, result.bvhMismatchCount);
+    }
+  }
+
+  static std::vector<BVHSelfCheckResult> s_bvhSelfCheck;
+  if (ImGui::Button("Run BVH Self-Check")) {
+    s_bvhSelfCheck = RunBVHSelfCheck();
+  }
+  for (const BVHSelfCheckResult& result : s_bvhSelfCheck) {
+    ImGui::Text("  %-10s : %s (depth %u, errors %u / %u / %u)", result.scene, result.IsPassed() ? "passed" : "FAILED", result.maxDepth,
+                result.structureErrors, result.cullMismatches, result.rayMismatches);
+  }
+
+  static AllocatorSelfCheckResult s_allocatorSelfCheck;
+  if (ImGui::Button("Run Allocator Self-Check")) {
+    s_allocatorSelfCheck = RunAllocatorSelfCheck();
+  }
+  if (s_allocatorSelfCheck.operationCount > 0) {
+    ImGui::Text("  Buddy / Linear / Allocator : %s (errors %u / %u / %u)", s_allocatorSelfCheck.IsPassed() ? "passed" : "FAILED",
+                s_allocatorSelfCheck.buddyErrors, s_allocatorSelfCheck.linearErrors, s_allocatorSelfCheck.allocatorErrors);
+  }
+
+  if (m_pFrameGraph) {
+    ImGui::Separator();
+    ImGui::Text("Frame Graph : %.3f ms (Critical Path : %.3f ms)", m_pFrameGraph->GetFrameTimeMs(), m_pFrameGraph->GetCriticalPathMs());
+    for (const CriticalPathEntry& entry : m_pFrameGraph->GetCriticalPath()) {
+      ImGui::Text("  %-20s %.3f ms", m_pFrameGraph->GetTaskName(entry.task).c_str(), entry.durationMs);
+    }
+  }
   ImGui::End();
 
   ImGui::Begin("Rendering");
   ImGui::Checkbox("Multi Threading Culling", &(g_RenderSetting.isMultiThreading));
+  ImGui::Checkbox("Multi Threading Recording", &(g_RenderSetting.isMultiThreadingRecord));
   ImGui::Checkbox("Wire Frame", &(g_RenderSetting.isWireRendering));
   ImGui::Checkbox("Occlusion Culling", &(g_RenderSetting.isOcclusionCulling));
+  ImGui::Checkbox("GPU Culling", &(g_RenderSetting.isGpuCulling));
+  ImGui::Checkbox("BVH Culling (CPU)", &(g_RenderSetting.isBvhCulling));
+  ImGui::Checkbox("Meshlet Culling (GPU)", &(g_RenderSetting.isMeshletCulling));
+  ImGui::Checkbox("Meshlet Cone Culling", &(g_RenderSetting.isMeshletConeCulling));
+  ImGui::Checkbox("LOD Selection", &(g_RenderSetting.isLodSelection));
+  ImGui::SliderFloat("LOD 1 Screen Size (px)", &(g_RenderSetting.lodScreenSize), 16.0f, 1024.0f);
+  ImGui::Checkbox("Texture Mipmaps", &(g_RenderSetting.isTextureMipmaps));
+  ImGui::SliderInt("Texture Budget (MB)", &(g_RenderSetting.textureBudgetMB), 16, 4096);
+  ImGui::SliderFloat("Texture Streaming Bias", &(g_RenderSetting.textureStreamingBias), 0.0f, 4.0f);
+  ImGui::Text("Resident Textures : %.1f MB (%d loading)", g_RenderSetting.residentTextureMB, g_RenderSetting.loadingTextureNum);
+  ImGui::Checkbox("GPU Picking (Debug)", &(g_RenderSetting.isGpuPicking));
   ImGui::Checkbox("View BoundingBox", &(g_RenderSetting.isRenderBoundingBox));
   ImGui::SliderFloat4("Light Pos", glm::value_ptr(g_ShaderSetting.lightPos), -5.0f, 5.0f);
   ImGui::Text("Selected File: %s", g_SelectedFilePath.c_str());
@@ -417,7 +518,7 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
 
   if (m_selectedIndex >= 0 && m_selectedIndex < (int)g_BatchManager.m_transforms[currentImage].size() && m_gizmoType != -1) {
     g_RenderSetting.changeFlag = true;
-    ImGuizmo::SetOrthographic(false);  // Persp / Ortho 
+    ImGuizmo::SetOrthographic(false);  // Persp / Ortho 설정
     ImGuizmo::Enable(true);
 
     float width = ImGui::GetIO().DisplaySize.x;
@@ -434,9 +535,9 @@ void Editor::RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage) {
       glm::mat4& tc = g_BatchManager.m_transforms[currentImage][m_selectedIndex].currentTransform;
       glm::mat4 transform = glm::translate(tc, aabbCenter);
       ImGuizmo::Manipulate(glm::value_ptr(view), glm::value_ptr(proj),
-                           (ImGuizmo::OPERATION)m_gizmoType,  // Ǵ ʿ   (ROTATE, SCALE )
-                           ImGuizmo::MODE::LOCAL,             //  ǥ Ǵ  ǥ 
-                           glm::value_ptr(transform));        // gizmo 
+                           (ImGuizmo::OPERATION)m_gizmoType,  // 또는 필요한 조작 종류 (ROTATE, SCALE 등)
+                           ImGuizmo::MODE::LOCAL,             // 월드 좌표계 또는 로컬 좌표계 선택
+                           glm::value_ptr(transform));        // gizmo 행렬
 
       if (ImGuizmo::IsUsing()) {
         tc = transform * glm::translate(glm::mat4(1.0f), -aabbCenter);
@@ -1,4 +1,6 @@
 #pragma once
+#include <functional>
+
 #include "Utils/ModelLoader.h"
 #include "VkUtils/ChooseFunc.h"
 #include "VkUtils/QueueFamilyIndices.h"
@@ -6,6 +8,7 @@
 
 class Camera;
 class BasicLightingPass;
+class TaskGraph;
 
 class Editor {
   bool check = false;
@@ -27,9 +30,14 @@ class Editor {
   VkDescriptorPool m_ImguiDescriptorPool;
   VkRenderPass renderPass;
 
+  // Model imports and texture changes picked in the UI. They submit, rebuild the scene buffers and rewrite the texture
+  // descriptors, so they wait for ApplySceneEdits instead of running inside SwapchainRecord next to the other passes.
+  std::vector<std::function<void()>> m_sceneEdits;
+
  public:
   CullingRenderPass* m_pCullingPass;
   BasicLightingPass* m_pLightingPass;
+  TaskGraph* m_pFrameGraph = nullptr;
 
  public:
   Editor() = default;
@@ -44,6 +52,9 @@ class Editor {
 
   void RenderImGui(VkCommandBuffer commandBuffer, uint32_t currentImage);
 
+  // After Present ("SceneEdits" task) : waits for the device, then runs the edits queued by RenderImGui
+  void ApplySceneEdits();
+
   void OnLeftMouseClick();
 
  private:
@@ -1,6 +1,7 @@
 #include "BasicLightingPass.h"
 
 #include "Camera.h"
+#include "ObjectPicker.h"
 #include "Editor/Editor.h"
 
 BasicLightingPass::BasicLightingPass(VkDevice device, VkPhysicalDevice physicalDevice) : IRenderPass(device, physicalDevice) {}
@@ -37,31 +38,32 @@ void BasicLightingPass::Initialize(VkDevice device, VkPhysicalDevice physicalDev
    */
   CreateSemaphores();
   CreateCommandBuffers();
+  m_commandRecorder.Initialize(m_pDevice, g_ResourceManager.GetQueueFamilyIndices().graphicsFamily, MAX_FRAME_DRAWS);
 }
 
 void BasicLightingPass::Cleanup() {
   vkDestroyImageView(m_pDevice, m_objectIdBufferImageView, nullptr);
+  g_MemoryAllocator.FreeImageMemory(m_objectIdColourBufferImage);
   vkDestroyImage(m_pDevice, m_objectIdColourBufferImage, nullptr);
-  vkFreeMemory(m_pDevice, m_objectIdBufferImageMemory, nullptr);
 
   vkDestroyImageView(m_pDevice, m_objectIdDepthStencilBufferImageView, nullptr);
+  g_MemoryAllocator.FreeImageMemory(m_objectIdDepthStencilBufferImage);
   vkDestroyImage(m_pDevice, m_objectIdDepthStencilBufferImage, nullptr);
-  vkFreeMemory(m_pDevice, m_objectIdDepthStencilBufferImageMemory, nullptr);
 
   for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
     vkDestroyFramebuffer(m_pDevice, m_framebuffers[i], nullptr);
 
     vkDestroyImageView(m_pDevice, m_colourBufferImages[i].imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(m_colourBufferImages[i].image);
     vkDestroyImage(m_pDevice, m_colourBufferImages[i].image, nullptr);
-    vkFreeMemory(m_pDevice, m_colourBufferImages[i].memory, nullptr);
 
     vkDestroyImageView(m_pDevice, m_depthStencilBufferImages[i].imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(m_depthStencilBufferImages[i].image);
     vkDestroyImage(m_pDevice, m_depthStencilBufferImages[i].image, nullptr);
-    vkFreeMemory(m_pDevice, m_depthStencilBufferImages[i].memory, nullptr);
 
     vkDestroyImageView(m_pDevice, m_raytracingImages[i].imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(m_raytracingImages[i].image);
     vkDestroyImage(m_pDevice, m_raytracingImages[i].image, nullptr);
-    vkFreeMemory(m_pDevice, m_raytracingImages[i].memory, nullptr);
   }
 
   vkDestroyFramebuffer(m_pDevice, m_objectIdFramebuffer, nullptr);
@@ -71,6 +73,7 @@ void BasicLightingPass::Cleanup() {
     vkDestroyFence(m_pDevice, m_fence[i], nullptr);
   }
   vkFreeCommandBuffers(m_pDevice, m_pGraphicsCommandPool, MAX_FRAME_DRAWS, m_commandBuffers.data());
+  m_commandRecorder.Cleanup();
 
   vkDestroyPipeline(m_pDevice, m_graphicsPipeline, nullptr);
   vkDestroyPipeline(m_pDevice, m_wireGraphicsPipeline, nullptr);
@@ -82,28 +85,28 @@ void BasicLightingPass::Cleanup() {
   vkDestroyRenderPass(m_pDevice, m_objectIdRenderPass, nullptr);
 
   for (auto& blas : m_bottomLevelASList) {
-    vkDestroyBuffer(m_pDevice, blas.buffer, nullptr);
     vkDestroyAccelerationStructureKHR(m_pDevice, blas.handle, nullptr);
-    vkFreeMemory(m_pDevice, blas.memory, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(blas.buffer);
+    vkDestroyBuffer(m_pDevice, blas.buffer, nullptr);
   }
   for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
-    vkDestroyBuffer(m_pDevice, m_topLevelASList[i].buffer, nullptr);
     vkDestroyAccelerationStructureKHR(m_pDevice, m_topLevelASList[i].handle, nullptr);
-    vkFreeMemory(m_pDevice, m_topLevelASList[i].memory, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_topLevelASList[i].buffer);
+    vkDestroyBuffer(m_pDevice, m_topLevelASList[i].buffer, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_instancesBuffers[i].buffer);
     vkDestroyBuffer(m_pDevice, m_instancesBuffers[i].buffer, nullptr);
-    vkFreeMemory(m_pDevice, m_instancesBuffers[i].memory, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_scratchBufferTLAS[i].handle);
     vkDestroyBuffer(m_pDevice, m_scratchBufferTLAS[i].handle, nullptr);
-    vkFreeMemory(m_pDevice, m_scratchBufferTLAS[i].memory, nullptr);
   }
 
+  g_MemoryAllocator.FreeBufferMemory(shaderBindingTables.raygen.buffer);
   vkDestroyBuffer(m_pDevice, shaderBindingTables.raygen.buffer, nullptr);
-  vkFreeMemory(m_pDevice, shaderBindingTables.raygen.memory, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(shaderBindingTables.hit.buffer);
   vkDestroyBuffer(m_pDevice, shaderBindingTables.hit.buffer, nullptr);
-  vkFreeMemory(m_pDevice, shaderBindingTables.hit.memory, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(shaderBindingTables.miss.buffer);
   vkDestroyBuffer(m_pDevice, shaderBindingTables.miss.buffer, nullptr);
-  vkFreeMemory(m_pDevice, shaderBindingTables.miss.memory, nullptr);
 
   vkDestroyPipeline(m_pDevice, m_raytracingPipeline, nullptr);
   vkDestroyPipelineLayout(m_pDevice, m_raytracingPipelineLayout, nullptr);
@@ -115,45 +118,54 @@ void BasicLightingPass::Cleanup() {
   vkDestroyDescriptorPool(m_pDevice, m_raytracingPool, nullptr);
 }
 
-void BasicLightingPass::Update(uint32_t imageIndex) {
-  if (m_pCamera->isMousePressed) {
+void BasicLightingPass::UpdateObjectPicking() {
+  if (!m_pCamera->isMousePressed) return;
+
+  if (g_RenderSetting.isGpuPicking) {
     m_pCamera->result = g_ResourceManager.ReadPixelFromImage(m_objectIdColourBufferImage, m_width, m_height, m_pCamera->MousePos().x,
                                                              m_pCamera->MousePos().y);
+    return;
   }
 
-  UpdateTLAS(imageIndex);
+  // r : entity (-1 on a miss, same as the cleared ObjectID image), g : hit distance, b : triangle
+  Ray ray = ObjectPicker::ScreenPointToRay(*m_pCamera, m_pCamera->MousePos(), glm::vec2(m_width, m_height));
+  PickResult pick = g_ObjectPicker.Pick(ray);
+  m_pCamera->result = glm::vec4(static_cast<float>(pick.entity), pick.distance, static_cast<float>(pick.triangle), 1.0f);
+  g_RenderSetting.pickTimeUs = pick.timeUs;
 }
 
-void BasicLightingPass::UpdateTLAS(uint32_t imageIndex) {
+void BasicLightingPass::UpdateTLASInstances(uint32_t imageIndex) {
   uint32_t numInstances = (uint32_t)g_BatchManager.m_meshes.size();
-  std::vector<VkAccelerationStructureInstanceKHR> instances[MAX_FRAME_DRAWS];
-  instances[imageIndex].resize(numInstances);
 
   {
-    for (uint32_t i = 0; i < numInstances; ++i) {
-      //  νϽ ȯ, customIndex, mask  
-      VkAccelerationStructureInstanceKHR& instance = instances[imageIndex][i];
+    // Fill the mapped instance buffer directly, chunked over the job system
+    void* mappedData = g_MemoryAllocator.GetMappedData(m_instancesBuffers[imageIndex].buffer);
+    VkAccelerationStructureInstanceKHR* instances = static_cast<VkAccelerationStructureInstanceKHR*>(mappedData);
 
-      glm::mat4 curr = (g_BatchManager.m_transforms[imageIndex][i].currentTransform);
-      VkTransformMatrixKHR transformMatrix = mat4ToVkTransform(curr);
-      instance.transform = transformMatrix;
+    ParallelFor(0, numInstances, 0, [&](size_t i) {
+      // 각 인스턴스별 변환행렬, customIndex, mask 등 세팅
+      VkAccelerationStructureInstanceKHR instance{};
 
-      // :  (= BLAS) ּ
+      const glm::mat4& curr = g_BatchManager.m_transforms[imageIndex][i].currentTransform;
+      instance.transform = mat4ToVkTransform(curr);
+
+      // 예: 하위 구조(= BLAS) 주소
       instance.accelerationStructureReference = m_bottomLevelASList[i].deviceAddress;
 
-      //   Ӽ
-      instance.instanceCustomIndex = i;  //  ĺ
+      // 그 외 속성
+      instance.instanceCustomIndex = (uint32_t)i;  // 임의의 식별자
       instance.mask = 0xFF;
       instance.instanceShaderBindingTableRecordOffset = 0;
       instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-    }
 
-    void* mappedData = nullptr;
-    vkMapMemory(m_pDevice, m_instancesBuffers[imageIndex].memory, 0, numInstances * sizeof(VkAccelerationStructureInstanceKHR), 0,
-                &mappedData);
-    memcpy(mappedData, instances[imageIndex].data(), numInstances * sizeof(VkAccelerationStructureInstanceKHR));
-    vkUnmapMemory(m_pDevice, m_instancesBuffers[imageIndex].memory);
+      instances[i] = instance;
+    });
+
   }
+}
+
+void BasicLightingPass::RefitTLAS() {
+  uint32_t numInstances = (uint32_t)g_BatchManager.m_meshes.size();
 
   VkCommandBuffer commandBuffer = g_ResourceManager.CreateAndBeginCommandBuffer();
 
@@ -222,9 +234,9 @@ void BasicLightingPass::UpdateTLAS(uint32_t imageIndex) {
 
 void BasicLightingPass::RebuildAS() {
   for (auto& blas : m_bottomLevelASList) {
-    vkDestroyBuffer(m_pDevice, blas.buffer, nullptr);
     vkDestroyAccelerationStructureKHR(m_pDevice, blas.handle, nullptr);
-    vkFreeMemory(m_pDevice, blas.memory, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(blas.buffer);
+    vkDestroyBuffer(m_pDevice, blas.buffer, nullptr);
   }
   m_bottomLevelASList.clear();
   m_bottomLevelASList = {};
@@ -232,15 +244,15 @@ void BasicLightingPass::RebuildAS() {
   scratchBuffers = {};
 
   for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
-    vkDestroyBuffer(m_pDevice, m_topLevelASList[i].buffer, nullptr);
     vkDestroyAccelerationStructureKHR(m_pDevice, m_topLevelASList[i].handle, nullptr);
-    vkFreeMemory(m_pDevice, m_topLevelASList[i].memory, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_topLevelASList[i].buffer);
+    vkDestroyBuffer(m_pDevice, m_topLevelASList[i].buffer, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_instancesBuffers[i].buffer);
     vkDestroyBuffer(m_pDevice, m_instancesBuffers[i].buffer, nullptr);
-    vkFreeMemory(m_pDevice, m_instancesBuffers[i].memory, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_scratchBufferTLAS[i].handle);
     vkDestroyBuffer(m_pDevice, m_scratchBufferTLAS[i].handle, nullptr);
-    vkFreeMemory(m_pDevice, m_scratchBufferTLAS[i].memory, nullptr);
   }
 
   CreateBLAS();
@@ -284,8 +296,18 @@ void BasicLightingPass::RebuildAS() {
 }
 
 void BasicLightingPass::Draw(uint32_t imageIndex, VkFence fence, VkSemaphore renderAvailable) {
+  Record(imageIndex);
+  Submit(imageIndex, renderAvailable);
+}
+
+void BasicLightingPass::Record(uint32_t imageIndex) {
+  auto begin = std::chrono::high_resolution_clock::now();
   RecordCommands(imageIndex);
+  g_RenderSetting.lightingRecordTimeMs =
+      std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+}
 
+void BasicLightingPass::Submit(uint32_t imageIndex, VkSemaphore renderAvailable) {
   // RenderPass 1.
   VkSubmitInfo basicSubmitInfo = {};
   basicSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -299,7 +321,7 @@ void BasicLightingPass::Draw(uint32_t imageIndex, VkFence fence, VkSemaphore ren
   basicSubmitInfo.pCommandBuffers = &m_commandBuffers[imageIndex];     // Command buffer to submit
   basicSubmitInfo.signalSemaphoreCount = 1;                            // Number of semaphores to signal
   basicSubmitInfo.pSignalSemaphores = &m_renderAvailable[imageIndex];  // Semaphores to signal when command buffer finishes
-  // Command buffer  Ϸϸ, Signaled °  semaphore 迭.
+  // Command buffer가 실행을 완료하면, Signaled 상태가 될 semaphore 배열.
 
   VK_CHECK(vkQueueSubmit(m_pGraphicsQueue, 1, &basicSubmitInfo, nullptr));
 }
@@ -359,7 +381,7 @@ void BasicLightingPass::CreateLightingRenderPass() {
   // Conversion from VK_IMAGE_LAYER-UNDEFINED to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
   // Transition must happen after ..
   subpassDependencies[0].srcSubpass =
-      VK_SUBPASS_EXTERNAL;  // ܺο Ƿ, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
+      VK_SUBPASS_EXTERNAL;  // 외부에서 들어오므로, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
   subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;  // Pipeline stage
   subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;            // Stage access mask (memory access)
   // But most happen before ..
@@ -442,7 +464,7 @@ void BasicLightingPass::CreateObjectIdRenderPass() {
   // Conversion from VK_IMAGE_LAYER-UNDEFINED to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
   // Transition must happen after ..
   subpassDependencies[0].srcSubpass =
-      VK_SUBPASS_EXTERNAL;  // ܺο Ƿ, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
+      VK_SUBPASS_EXTERNAL;  // 외부에서 들어오므로, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
   subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;  // Pipeline stage
   subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;            // Stage access mask (memory access)
   // But most happen before ..
@@ -577,7 +599,7 @@ void BasicLightingPass::CreateRaytracingFramebuffer() {
       imageCreateInfo.arrayLayers = 1;                            // Number of levels in image array
       imageCreateInfo.format = colourImageFormat;                 // Format type of image
       imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;           // How image data should be "tiled" (arranged for optimal reading)
-      imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // Layout of image data on creation (ӹۿ ° )
+      imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // Layout of image data on creation (프레임버퍼에 맞게 변형됨)
       imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
                               VK_IMAGE_USAGE_STORAGE_BIT;       // Bit flags defining what image will be used for
       imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;          // Number of samples for multi-sampling
@@ -586,20 +608,8 @@ void BasicLightingPass::CreateRaytracingFramebuffer() {
       VK_CHECK(vkCreateImage(m_pDevice, &imageCreateInfo, nullptr, &m_raytracingImages[i].image));
 
       // CRAETE MEMORY FOR IMAGE
-      // Get memory requirements for a type of image
-      VkMemoryRequirements memRequirements;
-      vkGetImageMemoryRequirements(m_pDevice, m_raytracingImages[i].image, &memRequirements);
-
-      VkMemoryAllocateInfo memAllocInfo = {};
-      memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-      memAllocInfo.allocationSize = memRequirements.size;
-      memAllocInfo.memoryTypeIndex =
-          VkUtils::FindMemoryTypeIndex(m_pPhyscialDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-      VK_CHECK(vkAllocateMemory(m_pDevice, &memAllocInfo, nullptr, &m_raytracingImages[i].memory));
-
-      // Connect memory to Image
-      VK_CHECK(vkBindImageMemory(m_pDevice, m_raytracingImages[i].image, m_raytracingImages[i].memory, 0));
+      VK_CHECK(g_MemoryAllocator.AllocateImageMemory(m_raytracingImages[i].image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                     &m_raytracingImages[i].memory));
     }
 
     VkUtils::CreateImageView(m_pDevice, m_raytracingImages[i].image, &m_raytracingImages[i].imageView, colourImageFormat,
@@ -625,7 +635,7 @@ void BasicLightingPass::CreateRaytracingPipelineLayout() {
       g_DescriptorManager.GetVkDescriptorSetLayout("ViewProjection_ALL0"),
       m_raytracingSetLayouts[0],
       g_DescriptorManager.GetVkDescriptorSetLayout("BATCH_ALL0"),
-      g_DescriptorManager.GetVkDescriptorSetLayout("DiffuseTextureList"),
+      g_DescriptorManager.GetVkDescriptorSetLayout("DiffuseTextureList0"),
   };
 
   VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
@@ -647,7 +657,7 @@ void BasicLightingPass::CreatePipelines() {
 }
 
 void BasicLightingPass::CreateGraphicsPipeline() {
-  auto vertexShaderCode = VkUtils::ReadFile("Resources/Shaders/LightingVS.spv");
+  auto vertexShaderCode = VkUtils::ReadFile(g_BatchManager.GetVertexShaderPath("LightingVS"));
   auto fragmentShaderCode = VkUtils::ReadFile("Resources/Shaders/LightingPS.spv");
 
   // Build Shaders
@@ -697,6 +707,7 @@ void BasicLightingPass::CreateGraphicsPipeline() {
   attributeDescriptions[2].location = 2;
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
   attributeDescriptions[2].offset = offsetof(BasicVertex, tex);
+  g_BatchManager.ApplyVertexFormat(bindingDescription, attributeDescriptions);
   // -- VERTEX INPUT --
   VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = {};
   vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -710,7 +721,7 @@ void BasicLightingPass::CreateGraphicsPipeline() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -786,7 +797,7 @@ void BasicLightingPass::CreateGraphicsPipeline() {
   std::vector<VkDescriptorSetLayout> setLayouts = {g_DescriptorManager.GetVkDescriptorSetLayout("ViewProjection_ALL0"),
                                                    g_DescriptorManager.GetVkDescriptorSetLayout("BATCH_ALL0"),
                                                    g_DescriptorManager.GetVkDescriptorSetLayout("SamplerList_ALL"),
-                                                   g_DescriptorManager.GetVkDescriptorSetLayout("DiffuseTextureList"),
+                                                   g_DescriptorManager.GetVkDescriptorSetLayout("DiffuseTextureList0"),
                                                    g_DescriptorManager.GetVkDescriptorSetLayout("ShadowTexture_ALL0")};
 
   VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
@@ -805,8 +816,8 @@ void BasicLightingPass::CreateGraphicsPipeline() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_TRUE;           // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -838,7 +849,7 @@ void BasicLightingPass::CreateGraphicsPipeline() {
 }
 
 void BasicLightingPass::CreateWireGraphicsPipeline() {
-  auto vertexShaderCode = VkUtils::ReadFile("Resources/Shaders/LightingVS.spv");
+  auto vertexShaderCode = VkUtils::ReadFile(g_BatchManager.GetVertexShaderPath("LightingVS"));
   auto fragmentShaderCode = VkUtils::ReadFile("Resources/Shaders/LightingPS.spv");
 
   // Build Shaders
@@ -888,6 +899,7 @@ void BasicLightingPass::CreateWireGraphicsPipeline() {
   attributeDescriptions[2].location = 2;
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
   attributeDescriptions[2].offset = offsetof(BasicVertex, tex);
+  g_BatchManager.ApplyVertexFormat(bindingDescription, attributeDescriptions);
   // -- VERTEX INPUT --
   VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = {};
   vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -901,7 +913,7 @@ void BasicLightingPass::CreateWireGraphicsPipeline() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -980,8 +992,8 @@ void BasicLightingPass::CreateWireGraphicsPipeline() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_TRUE;           // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -1067,7 +1079,7 @@ void BasicLightingPass::CreateBoundingBoxPipeline() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -1146,8 +1158,8 @@ void BasicLightingPass::CreateBoundingBoxPipeline() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_TRUE;           // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -1179,7 +1191,7 @@ void BasicLightingPass::CreateBoundingBoxPipeline() {
 }
 
 void BasicLightingPass::CreateObjectIDPipeline() {
-  auto vertexShaderCode = VkUtils::ReadFile("Resources/Shaders/ObjectIdVS.spv");
+  auto vertexShaderCode = VkUtils::ReadFile(g_BatchManager.GetVertexShaderPath("ObjectIdVS"));
   auto fragmentShaderCode = VkUtils::ReadFile("Resources/Shaders/ObjectIdPS.spv");
 
   // Build Shaders
@@ -1229,6 +1241,7 @@ void BasicLightingPass::CreateObjectIDPipeline() {
   attributeDescriptions[2].location = 2;
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
   attributeDescriptions[2].offset = offsetof(BasicVertex, tex);
+  g_BatchManager.ApplyVertexFormat(bindingDescription, attributeDescriptions);
   // -- VERTEX INPUT --
   VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = {};
   vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -1242,7 +1255,7 @@ void BasicLightingPass::CreateObjectIDPipeline() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -1321,8 +1334,8 @@ void BasicLightingPass::CreateObjectIDPipeline() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_TRUE;           // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -1412,7 +1425,9 @@ void BasicLightingPass::CreateRaytracingPipeline() {
 
   // Closest hit group
   {
-    auto shaderCode = VkUtils::ReadFile("Resources/Shaders/RaytracingShadow/ClosestHit.rchit.spv");
+    auto shaderCode = VkUtils::ReadFile(g_BatchManager.m_vertexFormat == VertexFormat::Packed
+                                             ? "Resources/Shaders/RaytracingShadow/ClosestHit_Packed.rchit.spv"
+                                             : "Resources/Shaders/RaytracingShadow/ClosestHit.rchit.spv");
     VkShaderModule shaderModule = VkUtils::CreateShaderModule(m_pDevice, shaderCode);
     VkPipelineShaderStageCreateInfo stageCreateInfo = {};
     stageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -1540,18 +1555,26 @@ void BasicLightingPass::CreateRaytracingDescriptorSets() {
 */
 void BasicLightingPass::CreateBLAS() {
   /*
-       BLAS 
+      여러 BLAS 생성
   */
   m_bottomLevelASList.reserve(g_BatchManager.m_meshes.size());
   scratchBuffers.reserve(g_BatchManager.m_meshes.size());
 
   VkDeviceOrHostAddressConstKHR vertexBufferDeviceAddress{};
   VkDeviceOrHostAddressConstKHR indexBufferDeviceAddress{};
+  VkDeviceOrHostAddressConstKHR vertexDecodeBufferDeviceAddress{};
 
   vertexBufferDeviceAddress.deviceAddress = GetVkDeviceAddress(m_pDevice, g_BatchManager.m_verticesBuffer.buffer);
   indexBufferDeviceAddress.deviceAddress = GetVkDeviceAddress(m_pDevice, g_BatchManager.m_indicesBuffer.buffer);
+  vertexDecodeBufferDeviceAddress.deviceAddress = GetVkDeviceAddress(m_pDevice, g_BatchManager.m_vertexDecodeBuffer.buffer);
+
+  // Scratch only lives until the build below finishes, every mesh gets its own range of one linear pool
+  // (256 : the largest minAccelerationStructureScratchOffsetAlignment the spec allows)
+  uint32_t scratchPool = g_MemoryAllocator.CreateLinearPool(32ull * 1024 * 1024, 256);
+
   VkCommandBuffer commandBuffer = g_ResourceManager.CreateAndBeginCommandBuffer();
-  for (const auto& mesh : g_BatchManager.m_meshes) {
+  for (size_t meshIndex = 0; meshIndex < g_BatchManager.m_meshes.size(); ++meshIndex) {
+    const Mesh& mesh = g_BatchManager.m_meshes[meshIndex];
     uint32_t numTriangles = static_cast<uint32_t>(mesh.indices.size() / 3);
 
     VkDeviceOrHostAddressConstKHR meshVertexBufferDeviceAddress{};
@@ -1567,12 +1590,19 @@ void BasicLightingPass::CreateBLAS() {
     accelerationStructureGeometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
     accelerationStructureGeometry.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
     accelerationStructureGeometry.geometry.triangles.vertexData = meshVertexBufferDeviceAddress;
-    accelerationStructureGeometry.geometry.triangles.maxVertex = mesh.ray_vertices.size() - 1;
-    accelerationStructureGeometry.geometry.triangles.vertexStride = sizeof(RayTracingVertex);
+    accelerationStructureGeometry.geometry.triangles.maxVertex = mesh.vertexCount - 1;
+    accelerationStructureGeometry.geometry.triangles.vertexStride = sizeof(BasicVertex);  // pos at offset 0
     accelerationStructureGeometry.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
     accelerationStructureGeometry.geometry.triangles.indexData = meshIndexBufferDeviceAddress;
     accelerationStructureGeometry.geometry.triangles.transformData.deviceAddress = 0;
     accelerationStructureGeometry.geometry.triangles.transformData.hostAddress = nullptr;
+    if (g_BatchManager.m_vertexFormat == VertexFormat::Packed) {
+      // snorm16 positions are built as is, the mesh VertexDecode is applied as the geometry transform
+      accelerationStructureGeometry.geometry.triangles.vertexFormat = VK_FORMAT_R16G16B16A16_SNORM;
+      accelerationStructureGeometry.geometry.triangles.vertexStride = sizeof(PackedVertex);
+      accelerationStructureGeometry.geometry.triangles.transformData.deviceAddress =
+          vertexDecodeBufferDeviceAddress.deviceAddress + meshIndex * sizeof(VkTransformMatrixKHR);
+    }
 
     // Get BLAS size info
     VkAccelerationStructureBuildGeometryInfoKHR accelerationStructureBuildGeometryInfo{};
@@ -1595,11 +1625,12 @@ void BasicLightingPass::CreateBLAS() {
     CreateAccelerationStructure(m_pDevice, m_pPhyscialDevice, blas, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
                                 accelerationStructureBuildSizesInfo);
 
-    std::cout << "Vertices Size: " << mesh.ray_vertices.size() << " | "
+    std::cout << "Vertices Size: " << mesh.vertexCount << " | "
               << "indices Size: " << mesh.indices.size() << " | "
               << "Build Size: " << accelerationStructureBuildSizesInfo.buildScratchSize << std::endl;
 
-    scratchBuffers.push_back(CreateScratchBuffer(m_pDevice, m_pPhyscialDevice, accelerationStructureBuildSizesInfo.buildScratchSize));
+    scratchBuffers.push_back(
+        CreateScratchBuffer(m_pDevice, m_pPhyscialDevice, accelerationStructureBuildSizesInfo.buildScratchSize, scratchPool));
 
     VkAccelerationStructureBuildGeometryInfoKHR accelerationBuildGeometryInfo{};
     accelerationBuildGeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
@@ -1629,13 +1660,12 @@ void BasicLightingPass::CreateBLAS() {
   g_ResourceManager.EndAndSummitCommandBuffer(commandBuffer);
 
   for (ScratchBuffer& scratchBuffer : scratchBuffers) {
-    if (scratchBuffer.memory != VK_NULL_HANDLE) {
-      vkFreeMemory(m_pDevice, scratchBuffer.memory, nullptr);
-    }
     if (scratchBuffer.handle != VK_NULL_HANDLE) {
+      g_MemoryAllocator.FreeBufferMemory(scratchBuffer.handle);
       vkDestroyBuffer(m_pDevice, scratchBuffer.handle, nullptr);
     }
   }
+  g_MemoryAllocator.DestroyLinearPool(scratchPool);
 }
 
 /*
@@ -1654,18 +1684,18 @@ void BasicLightingPass::CreateTLAS() {
   for (int cur = 0; cur < MAX_FRAME_DRAWS; ++cur) {
     instances[cur].resize(numInstances);
     for (uint32_t i = 0; i < numInstances; ++i) {
-      //  νϽ ȯ, customIndex, mask  
+      // 각 인스턴스별 변환행렬, customIndex, mask 등 세팅
       VkAccelerationStructureInstanceKHR& instance = instances[cur][i];
 
       glm::mat4 curr = (g_BatchManager.m_transforms[cur][i].currentTransform);
       VkTransformMatrixKHR transformMatrix = mat4ToVkTransform(curr);
       instance.transform = transformMatrix;
 
-      // :  (= BLAS) ּ
+      // 예: 하위 구조(= BLAS) 주소
       instance.accelerationStructureReference = m_bottomLevelASList[i].deviceAddress;
 
-      //   Ӽ
-      instance.instanceCustomIndex = i;  //  ĺ
+      // 그 외 속성
+      instance.instanceCustomIndex = i;  // 임의의 식별자
       instance.mask = 0xFF;
       instance.instanceShaderBindingTableRecordOffset = 0;
       instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
@@ -1677,11 +1707,8 @@ void BasicLightingPass::CreateTLAS() {
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_instancesBuffers[cur].buffer,
         &m_instancesBuffers[cur].memory, true);
 
-    void* mappedData = nullptr;
-    vkMapMemory(m_pDevice, m_instancesBuffers[cur].memory, 0, numInstances * sizeof(VkAccelerationStructureInstanceKHR), 0,
-                &mappedData);
+    void* mappedData = g_MemoryAllocator.GetMappedData(m_instancesBuffers[cur].buffer);
     memcpy(mappedData, instances[cur].data(), numInstances * sizeof(VkAccelerationStructureInstanceKHR));
-    vkUnmapMemory(m_pDevice, m_instancesBuffers[cur].memory);
   }
 
   VkCommandBuffer commandBuffer = g_ResourceManager.CreateAndBeginCommandBuffer();
@@ -1763,16 +1790,12 @@ void BasicLightingPass::CreateShaderBindingTables() {
   CreateShaderBindingTable(m_pDevice, m_pPhyscialDevice, shaderBindingTables.hit, 1);
 
   // Copy handles
-  void* pData = nullptr;
-  VK_CHECK(vkMapMemory(m_pDevice, shaderBindingTables.raygen.memory, 0, handleSize, 0, &pData));
+  void* pData = g_MemoryAllocator.GetMappedData(shaderBindingTables.raygen.buffer);
   memcpy(pData, shaderHandleStorage.data(), handleSize);
-  vkUnmapMemory(m_pDevice, shaderBindingTables.raygen.memory);
-  VK_CHECK(vkMapMemory(m_pDevice, shaderBindingTables.miss.memory, 0, handleSize * 2, 0, &pData));
+  pData = g_MemoryAllocator.GetMappedData(shaderBindingTables.miss.buffer);
   memcpy(pData, shaderHandleStorage.data() + handleSizeAligned, handleSize * 2);
-  vkUnmapMemory(m_pDevice, shaderBindingTables.miss.memory);
-  VK_CHECK(vkMapMemory(m_pDevice, shaderBindingTables.hit.memory, 0, handleSize, 0, &pData));
+  pData = g_MemoryAllocator.GetMappedData(shaderBindingTables.hit.buffer);
   memcpy(pData, shaderHandleStorage.data() + handleSizeAligned * 3, handleSize);
-  vkUnmapMemory(m_pDevice, shaderBindingTables.hit.memory);
 }
 
 void BasicLightingPass::CreatePushConstantRange() {
@@ -1804,7 +1827,7 @@ void BasicLightingPass::CreateCommandBuffers() {
   VkCommandBufferAllocateInfo cbAllocInfo = {};
   cbAllocInfo = {};
   cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  cbAllocInfo.commandPool = m_pGraphicsCommandPool;  // ش ť йи ť Ŀǵ ť  డϴ.
+  cbAllocInfo.commandPool = m_pGraphicsCommandPool;  // 해당 큐 패밀리의 큐에서만 커맨드 큐 동작이 실행가능하다.
   cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;  // VK_COMMAND_BUFFER_LEVEL_PRIMARY		: buffer you submit directly to
                                                         // queue. cant be called by other buffers
   // VK_COMMAND_BUFFER_LEVEL_SECONDARY	: buffer can't be called directly. Can be called from other buffers via
@@ -1816,6 +1839,20 @@ void BasicLightingPass::CreateCommandBuffers() {
 }
 
 void BasicLightingPass::RecordCommands(uint32_t currentImage) {
+  // batchIdx of each mini-batch, so batch ranges can be recorded independently
+  m_miniBatchFirstIndex.resize(g_BatchManager.m_miniBatchList.size());
+  uint32_t batchIdx = 0;
+  for (size_t i = 0; i < g_BatchManager.m_miniBatchList.size(); ++i) {
+    m_miniBatchFirstIndex[i] = batchIdx;
+    batchIdx += static_cast<uint32_t>(g_BatchManager.m_miniBatchList[i].m_drawIndexedCommands.size());
+  }
+
+  const bool isSecondary = g_RenderSetting.isMultiThreadingRecord;
+  const VkSubpassContents subpassContents = isSecondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+  if (isSecondary) {
+    m_commandRecorder.Reset(currentImage);
+  }
+
   VkCommandBufferBeginInfo bufferBeginInfo = {};
   bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;  // Buffer can be resubmitted when it has already been
@@ -1843,10 +1880,16 @@ void BasicLightingPass::RecordCommands(uint32_t currentImage) {
   renderPassBeginInfo.framebuffer = m_framebuffers[currentImage];
 
   // Begin Render Pass
-  vkCmdBeginRenderPass(m_commandBuffers[currentImage], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-  RecordLightingPassCommands(currentImage);
-  RecordBoundingBoxCommands(currentImage);
+  vkCmdBeginRenderPass(m_commandBuffers[currentImage], &renderPassBeginInfo, subpassContents);
+
+  if (isSecondary) {
+    RecordSecondaryCommands(m_commandBuffers[currentImage], currentImage, m_renderPass, m_framebuffers[currentImage], false);
+  } else {
+    RecordLightingPassCommands(m_commandBuffers[currentImage], currentImage, 0, g_BatchManager.m_miniBatchList.size());
+    if (g_RenderSetting.isRenderBoundingBox) {
+      RecordBoundingBoxCommands(m_commandBuffers[currentImage], currentImage, 0, g_BatchManager.m_boundingBoxList.size());
+    }
+  }
 
   // End Render Pass
   vkCmdEndRenderPass(m_commandBuffers[currentImage]);
@@ -1870,9 +1913,13 @@ void BasicLightingPass::RecordCommands(uint32_t currentImage) {
   renderPassBeginInfo.framebuffer = m_objectIdFramebuffer;
 
   // Begin Render Pass
-  vkCmdBeginRenderPass(m_commandBuffers[currentImage], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBeginRenderPass(m_commandBuffers[currentImage], &renderPassBeginInfo, subpassContents);
 
-  RecordObjectIDPassCommands(currentImage);
+  if (isSecondary) {
+    RecordSecondaryCommands(m_commandBuffers[currentImage], currentImage, m_objectIdRenderPass, m_objectIdFramebuffer, true);
+  } else {
+    RecordObjectIDPassCommands(m_commandBuffers[currentImage], currentImage, 0, g_BatchManager.m_miniBatchList.size());
+  }
 
   vkCmdEndRenderPass(m_commandBuffers[currentImage]);
 
@@ -1887,38 +1934,79 @@ void BasicLightingPass::RecordCommands(uint32_t currentImage) {
   VK_CHECK(vkEndCommandBuffer(m_commandBuffers[currentImage]));
 }
 
-void BasicLightingPass::RecordLightingPassCommands(uint32_t currentImage) {
+void BasicLightingPass::RecordSecondaryCommands(VkCommandBuffer primaryCommandBuffer, uint32_t currentImage, VkRenderPass renderPass,
+                                                VkFramebuffer framebuffer, bool isObjectIdPass) {
+  VkCommandBufferInheritanceInfo inheritanceInfo = {};
+  inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass = renderPass;
+  inheritanceInfo.subpass = 0;
+  inheritanceInfo.framebuffer = framebuffer;
+
+  // One secondary command buffer per mini-batch (and per range of bounding boxes), executed in recording order
+  std::vector<VkCommandBuffer> secondaryCommandBuffers = m_commandRecorder.RecordRanges(
+      currentImage, inheritanceInfo, g_BatchManager.m_miniBatchList.size(), 1,
+      [&](VkCommandBuffer commandBuffer, size_t batchBegin, size_t batchEnd) {
+        if (isObjectIdPass) {
+          RecordObjectIDPassCommands(commandBuffer, currentImage, batchBegin, batchEnd);
+        } else {
+          RecordLightingPassCommands(commandBuffer, currentImage, batchBegin, batchEnd);
+        }
+      });
+
+  if (!isObjectIdPass && g_RenderSetting.isRenderBoundingBox) {
+    std::vector<VkCommandBuffer> boundingBoxCommandBuffers = m_commandRecorder.RecordRanges(
+        currentImage, inheritanceInfo, g_BatchManager.m_boundingBoxList.size(), 256,
+        [&](VkCommandBuffer commandBuffer, size_t meshBegin, size_t meshEnd) {
+          RecordBoundingBoxCommands(commandBuffer, currentImage, meshBegin, meshEnd);
+        });
+    secondaryCommandBuffers.insert(secondaryCommandBuffers.end(), boundingBoxCommandBuffers.begin(), boundingBoxCommandBuffers.end());
+  }
+
+  if (!secondaryCommandBuffers.empty()) {
+    vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+  }
+}
+
+void BasicLightingPass::RecordLightingPassCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t batchBegin,
+                                                   size_t batchEnd) {
+  // Local copy, ranges are recorded concurrently
+  ShaderSetting shaderSetting = g_ShaderSetting;
+  shaderSetting.maxTextureLod = g_RenderSetting.isTextureMipmaps ? VK_LOD_CLAMP_NONE : 0.0f;
+
   // Bind Pipeline to be used in render pass
-  vkCmdBindPipeline(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS,
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
                     g_RenderSetting.isWireRendering ? m_wireGraphicsPipeline : m_graphicsPipeline);
 
-  g_ShaderSetting.batchIdx = 0;
-  for (auto& miniBatch : g_BatchManager.m_miniBatchList) {
-    // Bind the vertex buffer with the correct offset
-    VkDeviceSize vertexOffset = 0;  // Always bind at offset 0 since indirect commands handle offsets
-    vkCmdBindVertexBuffers(m_commandBuffers[currentImage], 0, 1, &miniBatch.m_vertexBuffer, &vertexOffset);
-    // Bind the index buffer with the correct offset
-    vkCmdBindIndexBuffer(m_commandBuffers[currentImage], miniBatch.m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+  // Every mini-batch draws from the scene geometry buffers, indirect commands carry the offsets.
+  // The index buffer is the meshlet culled copy when MeshletCullingCS ran, laid out like the scene one.
+  VkDeviceSize vertexOffset = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &g_BatchManager.m_verticesBuffer.buffer, &vertexOffset);
+  vkCmdBindIndexBuffer(commandBuffer, g_BatchManager.GetDrawIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+  for (size_t i = batchBegin; i < batchEnd; ++i) {
+    MiniBatch& miniBatch = g_BatchManager.m_miniBatchList[i];
+    shaderSetting.batchIdx = m_miniBatchFirstIndex[i];
 
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
                             &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0, nullptr);
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
                             &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 2, 1,
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 2, 1,
                             &g_DescriptorManager.GetVkDescriptorSet("SamplerList_ALL"), 0, nullptr);
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 3, 1,
-                            &g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList"), 0, nullptr);
-
-    vkCmdPushConstants(m_commandBuffers[currentImage], m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
-                       &g_ShaderSetting);
-
-    uint32_t drawCount = static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
-    vkCmdDrawIndexedIndirect(m_commandBuffers[currentImage], g_BatchManager.m_indirectDrawCommandBuffer.buffer,
-                             miniBatch.m_indirectCommandsOffset,   // offset
-                             drawCount,                            // drawCount
-                             sizeof(VkDrawIndexedIndirectCommand)  // stride
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 3, 1,
+                            &g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList" + std::to_string(currentImage)), 0, nullptr);
+
+    vkCmdPushConstants(commandBuffer, m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &shaderSetting);
+
+    // Only the commands that survived culling, packed from the front of the mini-batch range
+    uint32_t maxDrawCount = static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
+    vkCmdDrawIndexedIndirectCount(commandBuffer, g_BatchManager.m_compactedDrawCommandBuffers[currentImage].buffer,
+                                  miniBatch.m_indirectCommandsOffset,                      // offset
+                                  g_BatchManager.m_drawCountBuffers[currentImage].buffer,  // countBuffer
+                                  m_miniBatchFirstIndex[i] * sizeof(uint32_t),             // countBufferOffset
+                                  maxDrawCount,                                            // maxDrawCount
+                                  sizeof(VkDrawIndexedIndirectCommand)                     // stride
     );
-    g_ShaderSetting.batchIdx += miniBatch.m_drawIndexedCommands.size();
   }
 }
 
@@ -1950,71 +2038,84 @@ void BasicLightingPass::RecordRaytracingShadowCommands(uint32_t currentImage) {
                            VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 }
 
-void BasicLightingPass::RecordBoundingBoxCommands(uint32_t currentImage) {
+void BasicLightingPass::RecordBoundingBoxCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t meshBegin,
+                                                  size_t meshEnd) {
   /*
    * BoundingBox Renderer
    */
-  std::vector<VkDrawIndexedIndirectCommand> commands{};
-  for (auto& batch : g_BatchManager.m_miniBatchList) {
-    commands.insert(commands.end(), batch.m_drawIndexedCommands.begin(), batch.m_drawIndexedCommands.end());
-  }
+  // Host copy of the draw commands, instanceCount is the frustum culling result
+  auto instanceCount = [](size_t meshIndex) -> uint32_t {
+    for (auto& batch : g_BatchManager.m_miniBatchList) {
+      if (meshIndex < batch.m_drawIndexedCommands.size()) return batch.m_drawIndexedCommands[meshIndex].instanceCount;
+      meshIndex -= batch.m_drawIndexedCommands.size();
+    }
+    return 0;
+  };
 
-  g_ShaderSetting.batchIdx = 0;
-  if (g_RenderSetting.isRenderBoundingBox) {
-    vkCmdBindPipeline(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_boundingBoxPipeline);
-
-    for (int i = 0; i < g_BatchManager.m_boundingBoxBufferList.size(); ++i) {
-      VkDeviceSize vertexOffset = 0;  // Always bind at offset 0 since indirect commands handle offsets
-      vkCmdBindVertexBuffers(m_commandBuffers[currentImage], 0, 1, &g_BatchManager.m_boundingBoxBufferList[i].vertexBuffer,
-                             &vertexOffset);
-
-      // Bind the index buffer with the correct offset
-      vkCmdBindIndexBuffer(m_commandBuffers[currentImage], g_BatchManager.m_boundingBoxBufferList[i].indexBuffer, 0,
-                           VK_INDEX_TYPE_UINT32);
-
-      vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
-                              &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0,
-                              nullptr);
-      vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
-                              &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
-      vkCmdPushConstants(m_commandBuffers[currentImage], m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
-                         &g_ShaderSetting);
-
-      vkCmdDrawIndexed(m_commandBuffers[currentImage], 36, commands[i].instanceCount, 0, 0, 0);
-      g_ShaderSetting.batchIdx += 1;
+  // Local copy, ranges are recorded concurrently
+  ShaderSetting shaderSetting = g_ShaderSetting;
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_boundingBoxPipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0, nullptr);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
+
+  // Every box is the shared unit cube, gl_InstanceIndex picks the mesh's AABB and transform
+  VkDeviceSize vertexOffset = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &g_BatchManager.m_unitCubeVertexBuffer.buffer, &vertexOffset);
+  vkCmdBindIndexBuffer(commandBuffer, g_BatchManager.m_unitCubeIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+  vkCmdPushConstants(commandBuffer, m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &shaderSetting);
+
+  // One instanced draw per run of visible meshes
+  size_t runBegin = meshBegin;
+  for (size_t i = meshBegin; i <= meshEnd; ++i) {
+    if (i < meshEnd && instanceCount(i) > 0) continue;
+
+    if (i > runBegin) {
+      vkCmdDrawIndexed(commandBuffer, g_BatchManager.m_unitCubeIndexCount, static_cast<uint32_t>(i - runBegin), 0, 0,
+                       static_cast<uint32_t>(runBegin));
     }
+    runBegin = i + 1;
   }
 }
 
-void BasicLightingPass::RecordObjectIDPassCommands(uint32_t currentImage) {
+void BasicLightingPass::RecordObjectIDPassCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t batchBegin,
+                                                   size_t batchEnd) {
+  // Local copy, ranges are recorded concurrently
+  ShaderSetting shaderSetting = g_ShaderSetting;
+
   // Bind Pipeline to be used in render pass
-  vkCmdBindPipeline(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_objectIDPipeline);
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_objectIDPipeline);
   //
   // mini-batch system
   //
-  g_ShaderSetting.batchIdx = 0;
-  for (auto& miniBatch : g_BatchManager.m_miniBatchList) {
-    // Bind the vertex buffer with the correct offset
-    VkDeviceSize vertexOffset = 0;  // Always bind at offset 0 since indirect commands handle offsets
-    vkCmdBindVertexBuffers(m_commandBuffers[currentImage], 0, 1, &miniBatch.m_vertexBuffer, &vertexOffset);
+  // Every mini-batch draws from the scene geometry buffers, indirect commands carry the offsets.
+  // The index buffer is the meshlet culled copy when MeshletCullingCS ran, laid out like the scene one.
+  VkDeviceSize vertexOffset = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &g_BatchManager.m_verticesBuffer.buffer, &vertexOffset);
+  vkCmdBindIndexBuffer(commandBuffer, g_BatchManager.GetDrawIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
 
-    // Bind the index buffer with the correct offset
-    vkCmdBindIndexBuffer(m_commandBuffers[currentImage], miniBatch.m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+  for (size_t i = batchBegin; i < batchEnd; ++i) {
+    MiniBatch& miniBatch = g_BatchManager.m_miniBatchList[i];
+    shaderSetting.batchIdx = m_miniBatchFirstIndex[i];
 
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
                             &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0, nullptr);
-    vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
                             &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
 
-    vkCmdPushConstants(m_commandBuffers[currentImage], m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
-                       &g_ShaderSetting);
+    vkCmdPushConstants(commandBuffer, m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &shaderSetting);
 
-    uint32_t drawCount = static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
-    vkCmdDrawIndexedIndirect(m_commandBuffers[currentImage], g_BatchManager.m_indirectDrawCommandBuffer.buffer,
-                             miniBatch.m_indirectCommandsOffset,   // offset
-                             drawCount,                            // drawCount
-                             sizeof(VkDrawIndexedIndirectCommand)  // stride
+    // Only the commands that survived culling, packed from the front of the mini-batch range
+    uint32_t maxDrawCount = static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
+    vkCmdDrawIndexedIndirectCount(commandBuffer, g_BatchManager.m_compactedDrawCommandBuffers[currentImage].buffer,
+                                  miniBatch.m_indirectCommandsOffset,                      // offset
+                                  g_BatchManager.m_drawCountBuffers[currentImage].buffer,  // countBuffer
+                                  m_miniBatchFirstIndex[i] * sizeof(uint32_t),             // countBufferOffset
+                                  maxDrawCount,                                            // maxDrawCount
+                                  sizeof(VkDrawIndexedIndirectCommand)                     // stride
     );
-    g_ShaderSetting.batchIdx += miniBatch.m_drawIndexedCommands.size();
   }
 }
@@ -4,8 +4,10 @@
 #include "Components.h"
 #include "CullingRenderPass.h"
 #include "Image.h"
+#include "Utils/Parallel.h"
 #include "Utils/ThreadPool.h"
 #include "VkUtils/ChooseFunc.h"
+#include "VkUtils/CommandRecorder.h"
 #include "VkUtils/DescriptorManager.h"
 #include "VkUtils/ResourceManager.h"
 #include "VkUtils/ShaderModule.h"
@@ -24,13 +26,18 @@ class BasicLightingPass : public IRenderPass {
                           Editor* editor, const uint32_t width, const uint32_t height);
   virtual void Cleanup();
 
-  virtual void Update(uint32_t imageIndex);
-  void UpdateTLAS(uint32_t imageIndex);
+  void UpdateObjectPicking();
+  void UpdateTLASInstances(uint32_t imageIndex);
+  void RefitTLAS();
 
   void RebuildAS();
 
   virtual void Draw(uint32_t imageIndex, VkFence fence, VkSemaphore renderAvailable);
 
+  // Draw() split into steps for the frame task graph
+  void Record(uint32_t imageIndex);
+  void Submit(uint32_t imageIndex, VkSemaphore renderAvailable);
+
   VkImageView& GetFrameBufferImageView(uint32_t imageIndex) { return m_colourBufferImages[imageIndex].imageView; };
   VkImageView& GetDepthStencilImageView(uint32_t imageIndex) { return m_depthStencilBufferImages[imageIndex].imageView; };
   VkSemaphore& GetSemaphore(uint32_t imageIndex) { return m_renderAvailable[imageIndex]; };
@@ -69,10 +76,12 @@ class BasicLightingPass : public IRenderPass {
   virtual void CreateCommandBuffers();
 
   virtual void RecordCommands(uint32_t currentImage);
-  void RecordLightingPassCommands(uint32_t currentImage);
+  void RecordSecondaryCommands(VkCommandBuffer primaryCommandBuffer, uint32_t currentImage, VkRenderPass renderPass,
+                               VkFramebuffer framebuffer, bool isObjectIdPass);
+  void RecordLightingPassCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t batchBegin, size_t batchEnd);
   void RecordRaytracingShadowCommands(uint32_t currentImage);
-  void RecordBoundingBoxCommands(uint32_t currentImage);
-  void RecordObjectIDPassCommands(uint32_t currentImage);
+  void RecordBoundingBoxCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t meshBegin, size_t meshEnd);
+  void RecordObjectIDPassCommands(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t batchBegin, size_t batchEnd);
 
  private:
   Editor* m_pEditor;
@@ -89,6 +98,8 @@ class BasicLightingPass : public IRenderPass {
 
   VkCommandPool m_pGraphicsCommandPool;
   std::vector<VkCommandBuffer> m_commandBuffers;
+  VkUtils::ParallelCommandRecorder m_commandRecorder;  // Secondary command buffers (isMultiThreadingRecord)
+  std::vector<uint32_t> m_miniBatchFirstIndex;          // batchIdx of the first draw of each mini-batch
 
   std::vector<VkSemaphore> m_renderAvailable;
   std::vector<VkFence> m_fence;
@@ -1,22 +1,25 @@
 #include "BatchSystem.h"
 
+#include "ObjectPicker.h"
+#include "RenderSetting.h"
+#include "TextureStreamer.h"
+
 void BatchManager::Update(VkDevice device, uint32_t imageIndex) {
   void* pData = nullptr;
+  RefitSceneBVH(imageIndex);
+
   // 1. Update Transform List Buffer
   {
     m_trasformList = m_transforms[0];
 
-    vkMapMemory(device, g_BatchManager.m_transformListBuffer[imageIndex].memory, 0,
-                g_BatchManager.m_transformListBuffer[imageIndex].size, 0, &pData);
+    pData = g_MemoryAllocator.GetMappedData(g_BatchManager.m_transformListBuffer[imageIndex].buffer);
     memcpy(pData, g_BatchManager.m_transforms[imageIndex].data(), g_BatchManager.m_transformListBuffer[imageIndex].size);
-    vkUnmapMemory(device, g_BatchManager.m_transformListBuffer[imageIndex].memory);
   }
   // 2. Update BoundingBox
   {
     VkDeviceSize aabbBufferSize = sizeof(AABB) * g_BatchManager.m_boundingBoxList.size();
-    vkMapMemory(device, g_BatchManager.m_boundingBoxListBuffer.memory, 0, aabbBufferSize, 0, &pData);
+    pData = g_MemoryAllocator.GetMappedData(g_BatchManager.m_boundingBoxListBuffer.buffer);
     memcpy(pData, g_BatchManager.m_boundingBoxList.data(), aabbBufferSize);
-    vkUnmapMemory(device, g_BatchManager.m_boundingBoxListBuffer.memory);
   }
 }
 
@@ -42,11 +45,23 @@ void BatchManager::UpdateDescriptorSets(VkDevice device) {
     idUBOInfo.offset = 0;                                       // Position of start of data
     idUBOInfo.range = g_BatchManager.m_objectIDBuffer.size;     // size of data
 
+    VkDescriptorBufferInfo vertexDecodeInfo = {};
+    vertexDecodeInfo.buffer = g_BatchManager.m_vertexDecodeBuffer.buffer;  // Buffer to get data from
+    vertexDecodeInfo.offset = 0;                                           // Position of start of data
+    vertexDecodeInfo.range = g_BatchManager.m_vertexDecodeBuffer.size;     // size of data
+
+    VkDescriptorBufferInfo lodInfo = {};
+    lodInfo.buffer = g_BatchManager.m_lodBuffer.buffer;  // Buffer to get data from
+    lodInfo.offset = 0;                                  // Position of start of data
+    lodInfo.range = g_BatchManager.m_lodBuffer.size;     // size of data
+
     VkUtils::DescriptorBuilder batchBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
     batchBuilder.BindBuffer(0, &transformUBOInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(1, &indirectBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(2, &aabbIndirectInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(3, &idUBOInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
+    batchBuilder.BindBuffer(4, &vertexDecodeInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
+    batchBuilder.BindBuffer(5, &lodInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
 
     g_DescriptorManager.UpdateDescriptorSet(&batchBuilder, g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(i)));
   }
@@ -71,143 +86,130 @@ void BatchManager::UpdateDescriptorSets(VkDevice device) {
     m_textureIdList[i] = imguiTextureID;
   }
 
-  VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
-  materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
-  g_DescriptorManager.UpdateDescriptorSet(&materialBuilder, g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList"));
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+    materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
+    g_DescriptorManager.UpdateDescriptorSet(&materialBuilder,
+                                            g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList" + std::to_string(i)));
+  }
 }
 
 void BatchManager::Cleanup(VkDevice device) {
+  g_MemoryAllocator.FreeBufferMemory(m_indirectDrawCommandBuffer.buffer);
   vkDestroyBuffer(device, m_indirectDrawCommandBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_indirectDrawCommandBuffer.memory, nullptr);
+  for (int i = 0; i < static_cast<int>(m_compactedDrawCommandBuffers.size()); ++i) {
+    g_MemoryAllocator.FreeBufferMemory(m_compactedDrawCommandBuffers[i].buffer);
+    vkDestroyBuffer(device, m_compactedDrawCommandBuffers[i].buffer, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_drawCountBuffers[i].buffer);
+    vkDestroyBuffer(device, m_drawCountBuffers[i].buffer, nullptr);
+  }
 
+  g_MemoryAllocator.FreeBufferMemory(m_boundingBoxListBuffer.buffer);
   vkDestroyBuffer(device, m_boundingBoxListBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_boundingBoxListBuffer.memory, nullptr);
 
   for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    g_MemoryAllocator.FreeBufferMemory(m_transformListBuffer[i].buffer);
     vkDestroyBuffer(device, m_transformListBuffer[i].buffer, nullptr);
-    vkFreeMemory(device, m_transformListBuffer[i].memory, nullptr);
   }
+  g_MemoryAllocator.FreeBufferMemory(m_objectIDBuffer.buffer);
   vkDestroyBuffer(device, m_objectIDBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_objectIDBuffer.memory, nullptr);
 
   for (int i = 0; i < m_diffuseImages.size(); ++i) {
     vkDestroyImageView(device, m_diffuseImages[i].imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(m_diffuseImages[i].image);
     vkDestroyImage(device, m_diffuseImages[i].image, nullptr);
-    vkFreeMemory(device, m_diffuseImages[i].memory, nullptr);
   }
 
+  g_MemoryAllocator.FreeBufferMemory(m_instanceOffsetBuffer.buffer);
   vkDestroyBuffer(device, m_instanceOffsetBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_instanceOffsetBuffer.memory, nullptr);
 
+  g_MemoryAllocator.FreeBufferMemory(m_verticesBuffer.buffer);
   vkDestroyBuffer(device, m_verticesBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_verticesBuffer.memory, nullptr);
 
+  g_MemoryAllocator.FreeBufferMemory(m_indicesBuffer.buffer);
   vkDestroyBuffer(device, m_indicesBuffer.buffer, nullptr);
-  vkFreeMemory(device, m_indicesBuffer.memory, nullptr);
 
-  for (int i = 0; i < m_boundingBoxBufferList.size(); ++i) {
-    vkDestroyBuffer(device, m_boundingBoxBufferList[i].vertexBuffer, nullptr);
-    vkFreeMemory(device, m_boundingBoxBufferList[i].vertexBufferMemory, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(m_vertexDecodeBuffer.buffer);
+  vkDestroyBuffer(device, m_vertexDecodeBuffer.buffer, nullptr);
 
-    vkDestroyBuffer(device, m_boundingBoxBufferList[i].indexBuffer, nullptr);
-    vkFreeMemory(device, m_boundingBoxBufferList[i].indexBufferMemory, nullptr);
-  }
+  g_MemoryAllocator.FreeBufferMemory(m_meshletBuffer.buffer);
+  vkDestroyBuffer(device, m_meshletBuffer.buffer, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(m_culledIndicesBuffer.buffer);
+  vkDestroyBuffer(device, m_culledIndicesBuffer.buffer, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(m_meshletIndexCountBuffer.buffer);
+  vkDestroyBuffer(device, m_meshletIndexCountBuffer.buffer, nullptr);
 
-  for (int i = 0; i < m_meshes.size(); ++i) {
-    vkDestroyBuffer(device, m_bbVertexBuffers[i].buffer, nullptr);
-    vkFreeMemory(device, m_bbVertexBuffers[i].memory, nullptr);
-    vkDestroyBuffer(device, m_bbIndexBuffers[i].buffer, nullptr);
-    vkFreeMemory(device, m_bbIndexBuffers[i].memory, nullptr);
-  }
+  g_MemoryAllocator.FreeBufferMemory(m_lodBuffer.buffer);
+  vkDestroyBuffer(device, m_lodBuffer.buffer, nullptr);
+
+  g_MemoryAllocator.FreeBufferMemory(m_unitCubeVertexBuffer.buffer);
+  vkDestroyBuffer(device, m_unitCubeVertexBuffer.buffer, nullptr);
+  g_MemoryAllocator.FreeBufferMemory(m_unitCubeIndexBuffer.buffer);
+  vkDestroyBuffer(device, m_unitCubeIndexBuffer.buffer, nullptr);
 }
 
-void BatchManager::AddDataToMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager, const Mesh& mesh,
-                                      bool flag) {
-  //  ޽  ũ 
-  size_t vertexDataSize = mesh.vertexCount * sizeof(BasicVertex);
-  size_t indexDataSize = mesh.indexCount * sizeof(uint32_t);
-  size_t totalDataSize = vertexDataSize + indexDataSize;
+void BatchManager::AddDataToMiniBatch(std::vector<MiniBatch>& miniBatches, Mesh& mesh, bool flag) {
+  // 현재 메쉬 데이터 크기 계산
+  size_t vertexDataSize = mesh.vertexCount * GetVertexStride();
+  size_t indexDataSize = (mesh.indexCount + mesh.lod_indices.size()) * sizeof(uint32_t);
 
-  //  miniBatches   ϳ 
+  // 만약 miniBatches가 비어 있으면 하나 생성
   if (m_accumulatedVertexSize == 0 && m_accumulatedIndexSize == 0) {
     miniBatches.emplace_back();
+    miniBatches.back().m_vertexBufferOffset = m_allMeshVertices.size();
+    miniBatches.back().m_indexBufferOffset = m_allMeshIndices.size() * sizeof(uint32_t);
   }
 
   MiniBatch* currentBatch = &miniBatches.back();
 
-  // Draw Command   ߰
+  // Draw Command 생성 및 추가, offsets are into the whole scene geometry buffers
   VkDrawIndexedIndirectCommand drawCommand{};
   drawCommand.indexCount = mesh.indexCount;
   drawCommand.instanceCount = 1;
-  drawCommand.firstIndex = m_accumulatedIndexSize / sizeof(uint32_t);
-  drawCommand.vertexOffset = m_accumulatedVertexSize / sizeof(BasicVertex);  // It's not byte offset, Just Index Offset
+  drawCommand.firstIndex = static_cast<uint32_t>(m_allMeshIndices.size());
+  drawCommand.vertexOffset = static_cast<int32_t>(m_allMeshVertices.size() / GetVertexStride());  // It's not byte offset
   drawCommand.firstInstance = m_accumulatedMeshIndex++;
 
   currentBatch->m_drawIndexedCommands.push_back(drawCommand);
 
-  //  Ϳ  ޽ ߰
-  m_accumulatedVertices.insert(m_accumulatedVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
-  m_accumulatedIndices.insert(m_accumulatedIndices.end(), mesh.indices.begin(), mesh.indices.end());
-  std::cout << mesh.indices.size() << std::endl;
+  // The BLAS builds address the mesh in the same buffers
+  mesh.vertexOffset = m_allMeshVertices.size();
+  mesh.indexOffset = m_allMeshIndices.size() * sizeof(uint32_t);
+
+  // 누적된 데이터에 현재 메쉬 추가
+  const uint8_t* vertexData = GetVertexData(mesh);
+  m_allMeshVertices.insert(m_allMeshVertices.end(), vertexData, vertexData + vertexDataSize);
+  m_allMeshIndices.insert(m_allMeshIndices.end(), mesh.indices.begin(), mesh.indices.end());
+  m_allMeshIndices.insert(m_allMeshIndices.end(), mesh.lod_indices.begin(), mesh.lod_indices.end());  // Mesh::lods
 
   m_accumulatedVertexSize += vertexDataSize;
   m_accumulatedIndexSize += indexDataSize;
 
-  //  ũⰡ 3MB ʰϸ ο mini-batch  Ǵ  ƹ͵  ʾ ,  
+  // 누적된 크기가 3MB를 초과하면 새로운 mini-batch 생성 또는 현재까지 아무것도 생성하지 않았을 경우, 마지막에 생성
   if (m_accumulatedVertexSize + m_accumulatedIndexSize > MAX_BATCH_SIZE || flag) {
-    // ο mini-batch 
-    manager.CreateVertexBuffer(m_accumulatedVertexSize, &currentBatch->m_vertexBufferMemory, &currentBatch->m_vertexBuffer,
-                               m_accumulatedVertices.data());
-    manager.CreateIndexBuffer(m_accumulatedIndexSize, &currentBatch->m_indexBufferMemory, &currentBatch->m_indexBuffer,
-                              m_accumulatedIndices.data());
-
-    currentBatch->m_currentVertexOffset = m_accumulatedVertexSize;
-    currentBatch->m_currentIndexOffset = m_accumulatedIndexSize;
-    currentBatch->m_currentBatchSize = m_accumulatedVertexSize + m_accumulatedIndexSize;
-
-    currentBatch->m_indirectCommandsOffset = m_accumulatedIndirectOffset;
-    m_accumulatedIndirectOffset +=
-        static_cast<uint64_t>(currentBatch->m_drawIndexedCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
-
+    CloseMiniBatch(*currentBatch);
     std::cout << "New mini-batch created with size: " << currentBatch->m_currentBatchSize << " bytes." << std::endl;
-
-    //   ʱȭ
-    m_accumulatedVertices = {};
-    m_accumulatedIndices = {};
-    m_accumulatedVertexSize = 0;
-    m_accumulatedIndexSize = 0;
-    m_accumulatedMeshIndex = 0;
-
-  } else {
-    std::cout << "Accumulating mesh data. Current accumulated size: " << m_accumulatedVertexSize + m_accumulatedIndexSize << " bytes."
-              << std::endl;
   }
 }
 
-void BatchManager::FlushMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager) {
+void BatchManager::FlushMiniBatch(std::vector<MiniBatch>& miniBatches) {
   if (m_accumulatedVertexSize == 0 && m_accumulatedIndexSize == 0) return;
 
   MiniBatch* currentBatch = &miniBatches.back();
+  CloseMiniBatch(*currentBatch);
 
-  manager.CreateVertexBuffer(m_accumulatedVertexSize, &currentBatch->m_vertexBufferMemory, &currentBatch->m_vertexBuffer,
-                             m_accumulatedVertices.data());
-  manager.CreateIndexBuffer(m_accumulatedIndexSize, &currentBatch->m_indexBufferMemory, &currentBatch->m_indexBuffer,
-                            m_accumulatedIndices.data());
-
-  currentBatch->m_currentVertexOffset = m_accumulatedVertexSize;
-  currentBatch->m_currentIndexOffset = m_accumulatedIndexSize;
-  currentBatch->m_currentBatchSize = m_accumulatedVertexSize + m_accumulatedIndexSize;
+  std::cout << "Flushed mini-batch with size: " << currentBatch->m_currentBatchSize << " bytes." << std::endl;
+}
 
-  currentBatch->m_indirectCommandsOffset = m_accumulatedIndirectOffset;
-  m_accumulatedIndirectOffset +=
-      static_cast<uint64_t>(currentBatch->m_drawIndexedCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+void BatchManager::CloseMiniBatch(MiniBatch& batch) {
+  batch.m_currentVertexOffset = m_accumulatedVertexSize;
+  batch.m_currentIndexOffset = m_accumulatedIndexSize;
+  batch.m_currentBatchSize = m_accumulatedVertexSize + m_accumulatedIndexSize;
 
-  std::cout << "Flushed mini-batch with size: " << currentBatch->m_currentBatchSize << " bytes." << std::endl;
-  std::cout << "Flushed mini-batch with fefefe: " << currentBatch->m_indirectCommandsOffset << " bytes." << std::endl;
+  batch.m_indirectCommandsOffset = m_accumulatedIndirectOffset;
+  m_accumulatedIndirectOffset += static_cast<uint64_t>(batch.m_drawIndexedCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
 
-  //   ʱȭ
-  m_accumulatedVertices = {};
-  m_accumulatedIndices = {};
+  // 누적된 데이터 초기화
   m_accumulatedVertexSize = 0;
   m_accumulatedIndexSize = 0;
   m_accumulatedMeshIndex = 0;
@@ -218,7 +220,10 @@ void BatchManager::CreateBatchManagerBuffers(VkDevice device, VkPhysicalDevice p
   CreateIndirectDrawBuffers(device, physicalDevice);
   CreateBoundingBoxBuffers(device, physicalDevice);
   CreateObjectIDBuffers(device, physicalDevice);
-  CreateRaytracingBuffers(device, physicalDevice);
+  CreateGeometryBuffers(device, physicalDevice);
+  CreateVertexDecodeBuffers(device, physicalDevice);
+  CreateMeshletBuffers(device, physicalDevice);
+  CreateLodBuffers(device, physicalDevice);
 }
 
 void BatchManager::CreateDescriptorSets(VkDevice device, VkPhysicalDevice physicalDevice) {
@@ -243,11 +248,23 @@ void BatchManager::CreateDescriptorSets(VkDevice device, VkPhysicalDevice physic
     idUBOInfo.offset = 0;                                       // Position of start of data
     idUBOInfo.range = g_BatchManager.m_objectIDBuffer.size;     // size of data
 
+    VkDescriptorBufferInfo vertexDecodeInfo = {};
+    vertexDecodeInfo.buffer = g_BatchManager.m_vertexDecodeBuffer.buffer;  // Buffer to get data from
+    vertexDecodeInfo.offset = 0;                                           // Position of start of data
+    vertexDecodeInfo.range = g_BatchManager.m_vertexDecodeBuffer.size;     // size of data
+
+    VkDescriptorBufferInfo lodInfo = {};
+    lodInfo.buffer = g_BatchManager.m_lodBuffer.buffer;  // Buffer to get data from
+    lodInfo.offset = 0;                                  // Position of start of data
+    lodInfo.range = g_BatchManager.m_lodBuffer.size;     // size of data
+
     VkUtils::DescriptorBuilder batchBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
     batchBuilder.BindBuffer(0, &transformUBOInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(1, &indirectBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(2, &aabbIndirectInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
     batchBuilder.BindBuffer(3, &idUBOInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
+    batchBuilder.BindBuffer(4, &vertexDecodeInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
+    batchBuilder.BindBuffer(5, &lodInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL);
 
     g_DescriptorManager.AddDescriptorSet(&batchBuilder, "BATCH_ALL" + std::to_string(i));
   }
@@ -275,49 +292,118 @@ void BatchManager::CreateDescriptorSets(VkDevice device, VkPhysicalDevice physic
     m_textureIdList[i] = imguiTextureID;
   }
 
-  VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
-  materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
-  g_DescriptorManager.AddDescriptorSet(&materialBuilder, "DiffuseTextureList", true);
+  // One set per frame in flight, TextureStreamer writes a swapped mip into the set of the frame being recorded only
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+    materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
+    g_DescriptorManager.AddDescriptorSet(&materialBuilder, "DiffuseTextureList" + std::to_string(i), true);
+  }
 }
 
 void BatchManager::RebuildBatchManager(VkDevice device, VkPhysicalDevice physicalDevice) {
   {
+    g_MemoryAllocator.FreeBufferMemory(m_indirectDrawCommandBuffer.buffer);
     vkDestroyBuffer(device, m_indirectDrawCommandBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_indirectDrawCommandBuffer.memory, nullptr);
+    for (int i = 0; i < static_cast<int>(m_compactedDrawCommandBuffers.size()); ++i) {
+      g_MemoryAllocator.FreeBufferMemory(m_compactedDrawCommandBuffers[i].buffer);
+      vkDestroyBuffer(device, m_compactedDrawCommandBuffers[i].buffer, nullptr);
+      g_MemoryAllocator.FreeBufferMemory(m_drawCountBuffers[i].buffer);
+      vkDestroyBuffer(device, m_drawCountBuffers[i].buffer, nullptr);
+    }
 
+    g_MemoryAllocator.FreeBufferMemory(m_boundingBoxListBuffer.buffer);
     vkDestroyBuffer(device, m_boundingBoxListBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_boundingBoxListBuffer.memory, nullptr);
 
     for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+      g_MemoryAllocator.FreeBufferMemory(m_transformListBuffer[i].buffer);
       vkDestroyBuffer(device, m_transformListBuffer[i].buffer, nullptr);
-      vkFreeMemory(device, m_transformListBuffer[i].memory, nullptr);
     }
+    g_MemoryAllocator.FreeBufferMemory(m_objectIDBuffer.buffer);
     vkDestroyBuffer(device, m_objectIDBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_objectIDBuffer.memory, nullptr);
 
     m_instanceOffsets.clear();
+    g_MemoryAllocator.FreeBufferMemory(m_instanceOffsetBuffer.buffer);
     vkDestroyBuffer(device, m_instanceOffsetBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_instanceOffsetBuffer.memory, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_verticesBuffer.buffer);
     vkDestroyBuffer(device, m_verticesBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_verticesBuffer.memory, nullptr);
 
+    g_MemoryAllocator.FreeBufferMemory(m_indicesBuffer.buffer);
     vkDestroyBuffer(device, m_indicesBuffer.buffer, nullptr);
-    vkFreeMemory(device, m_indicesBuffer.memory, nullptr);
+
+    g_MemoryAllocator.FreeBufferMemory(m_vertexDecodeBuffer.buffer);
+    vkDestroyBuffer(device, m_vertexDecodeBuffer.buffer, nullptr);
+
+    g_MemoryAllocator.FreeBufferMemory(m_meshletBuffer.buffer);
+    vkDestroyBuffer(device, m_meshletBuffer.buffer, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_culledIndicesBuffer.buffer);
+    vkDestroyBuffer(device, m_culledIndicesBuffer.buffer, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_meshletIndexCountBuffer.buffer);
+    vkDestroyBuffer(device, m_meshletIndexCountBuffer.buffer, nullptr);
+
+    g_MemoryAllocator.FreeBufferMemory(m_lodBuffer.buffer);
+    vkDestroyBuffer(device, m_lodBuffer.buffer, nullptr);
   }
 
   CreateBatchManagerBuffers(device, physicalDevice);
   UpdateDescriptorSets(device);
+  BuildSceneBVH();
+  g_ObjectPicker.Reset();  // Triangle BVHs of the previous meshes
 }
 
-void BatchManager::ChangeTexture(VkDevice device, VkPhysicalDevice physicalDevice, int idx, std::string& path) {
-  GpuImage newImage;
-  oldImage = m_diffuseImages[idx];
+void BatchManager::BuildSceneBVH(uint32_t imageIndex) {
+  const std::vector<Transform>& transforms = m_transforms[imageIndex];
 
-  g_ResourceManager.CreateTexture(path, &newImage.memory, &newImage.image, &newImage.size);
-  VkUtils::CreateImageView(device, newImage.image, &newImage.imageView, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+  std::vector<AABB> worldBoxes(m_boundingBoxList.size());
+  m_sceneBVHTransforms.resize(m_boundingBoxList.size());
+  for (size_t i = 0; i < m_boundingBoxList.size(); ++i) {
+    m_sceneBVHTransforms[i] = transforms[i].currentTransform;
+    worldBoxes[i] = TransformAABB(m_boundingBoxList[i], m_sceneBVHTransforms[i]);
+  }
+  m_sceneBVH.Build(worldBoxes);
+}
+
+// Only the meshes whose transform changed since the last refit walk their leaf-to-root path
+void BatchManager::RefitSceneBVH(uint32_t imageIndex) {
+  const std::vector<Transform>& transforms = m_transforms[imageIndex];
+  if (m_sceneBVH.GetPrimitiveCount() != transforms.size()) {
+    BuildSceneBVH(imageIndex);
+    return;
+  }
+
+  for (size_t i = 0; i < transforms.size(); ++i) {
+    if (transforms[i].currentTransform == m_sceneBVHTransforms[i]) continue;
+    m_sceneBVHTransforms[i] = transforms[i].currentTransform;
+    m_sceneBVH.UpdatePrimitive(static_cast<uint32_t>(i), TransformAABB(m_boundingBoxList[i], m_sceneBVHTransforms[i]));
+  }
+}
 
-  m_diffuseImages[idx] = newImage;
+void BatchManager::ChangeTexture(VkDevice device, VkPhysicalDevice physicalDevice, int idx, std::string& path) {
+  GpuImage newImage;
+  MaterialTexture& materialTexture = m_materialTextures[idx];
+  const bool isPacked = materialTexture.uvTransform != MaterialTexture().uvTransform;
+
+  // Full residency, the streamer may drop it back to the tail later
+  VkUtils::ResourceManager::DecodedTexture texture =
+      VkUtils::ResourceManager::DecodeTexture(path, TextureCooker::TextureSlot::BaseColor);
+  VkFormat format;
+  g_ResourceManager.UploadTexture(texture, &newImage.memory, &newImage.image, &newImage.size, &format);
+  VkUtils::CreateImageView(device, newImage.image, &newImage.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0,
+                           VK_REMAINING_MIP_LEVELS);
+
+  if (isPacked) {
+    // The page keeps serving the other tiles, the material gets a new element at the end of u_DiffuseTextureList
+    materialTexture = {};
+    materialTexture.textureIndex = static_cast<int>(m_diffuseImages.size());
+    m_diffuseImages.push_back(newImage);
+    if (g_RenderSetting.isTextureStreaming) {
+      g_TextureStreamer.AddTexture(static_cast<uint32_t>(materialTexture.textureIndex), texture, format);
+    }
+  } else {
+    oldImage = m_diffuseImages[materialTexture.textureIndex];
+    g_TextureStreamer.ResetTexture(static_cast<uint32_t>(materialTexture.textureIndex), texture, format);
+    m_diffuseImages[materialTexture.textureIndex] = newImage;
+  }
 
   VkDeviceSize imageListSize = 0;
   for (GpuImage& image : m_diffuseImages) {
@@ -337,10 +423,33 @@ void BatchManager::ChangeTexture(VkDevice device, VkPhysicalDevice physicalDevic
     m_textureIdList[i] = imguiTextureID;
   }
 
-  VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
-  materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
-  g_DescriptorManager.UpdateDescriptorSet(&materialBuilder, g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList"));
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    VkUtils::DescriptorBuilder materialBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+    materialBuilder.BindImage(0, imageInfos.data(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_ALL, true, imageInfos.size());
+    g_DescriptorManager.UpdateDescriptorSet(&materialBuilder,
+                                            g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList" + std::to_string(i)));
+  }
+
+  // After the new element is written, the meshes of the material read it from the next frame on
+  if (isPacked) {
+    ResolveMaterialTextures();
+    memcpy(g_MemoryAllocator.GetMappedData(m_objectIDBuffer.buffer), m_objectIDList.data(), (size_t)m_objectIDBuffer.size);
+  }
+}
+
+void BatchManager::ResolveMaterialTextures() {
+  for (ObjectID& objectID : m_objectIDList) {
+    // Materials the loaders found no texture for index u_DiffuseTextureList directly, as they always did
+    MaterialTexture materialTexture;
+    materialTexture.textureIndex = objectID.materialID;
+    if (objectID.materialID >= 0 && objectID.materialID < static_cast<int>(m_materialTextures.size())) {
+      materialTexture = m_materialTextures[objectID.materialID];
+    }
 
+    objectID.textureIndex = materialTexture.textureIndex;
+    objectID.maxLod = materialTexture.maxLod;
+    objectID.uvTransform = materialTexture.uvTransform;
+  }
 }
 
 void BatchManager::CreateTransformListBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
@@ -356,9 +465,8 @@ void BatchManager::CreateTransformListBuffers(VkDevice device, VkPhysicalDevice
                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_transformListBuffer[i].buffer,
                           &m_transformListBuffer[i].memory);
 
-    vkMapMemory(device, m_transformListBuffer[i].memory, 0, transformBufferSize, 0, &pData);
+    pData = g_MemoryAllocator.GetMappedData(m_transformListBuffer[i].buffer);
     memcpy(pData, m_trasformList.data(), (size_t)transformBufferSize);
-    vkUnmapMemory(device, m_transformListBuffer[i].memory);
   }
 }
 
@@ -378,10 +486,42 @@ void BatchManager::CreateIndirectDrawBuffers(VkDevice device, VkPhysicalDevice p
                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                         &m_indirectDrawCommandBuffer.buffer, &m_indirectDrawCommandBuffer.memory);
 
-  vkMapMemory(device, m_indirectDrawCommandBuffer.memory, 0, indirectBufferSize, 0, &pData);
+  pData = g_MemoryAllocator.GetMappedData(m_indirectDrawCommandBuffer.buffer);
   memcpy(pData, flattenCommands.data(), (size_t)indirectBufferSize);
-  vkUnmapMemory(device, m_indirectDrawCommandBuffer.memory);
   m_indirectDrawCommandBuffer.size = indirectBufferSize;
+
+  std::vector<uint32_t> drawCounts(flattenCommands.size(), 0);
+  uint32_t firstDraw = 0;
+  for (MiniBatch& miniBatch : m_miniBatchList) {
+    drawCounts[firstDraw] = static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
+    firstDraw += static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size());
+  }
+  VkDeviceSize drawCountBufferSize = sizeof(uint32_t) * drawCounts.size();
+
+  // Compaction output, starts as "nothing culled" until the first culling pass rewrites it
+  m_compactedDrawCommandBuffers.resize(MAX_FRAME_DRAWS);
+  m_drawCountBuffers.resize(MAX_FRAME_DRAWS);
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    GpuBuffer& compactedDrawCommandBuffer = m_compactedDrawCommandBuffers[i];
+    VkUtils::CreateBuffer(device, physicalDevice, indirectBufferSize,
+                          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          &compactedDrawCommandBuffer.buffer, &compactedDrawCommandBuffer.memory);
+
+    pData = g_MemoryAllocator.GetMappedData(compactedDrawCommandBuffer.buffer);
+    memcpy(pData, flattenCommands.data(), (size_t)indirectBufferSize);
+    compactedDrawCommandBuffer.size = indirectBufferSize;
+
+    GpuBuffer& drawCountBuffer = m_drawCountBuffers[i];
+    VkUtils::CreateBuffer(device, physicalDevice, drawCountBufferSize,
+                          VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &drawCountBuffer.buffer,
+                          &drawCountBuffer.memory);
+
+    pData = g_MemoryAllocator.GetMappedData(drawCountBuffer.buffer);
+    memcpy(pData, drawCounts.data(), (size_t)drawCountBufferSize);
+    drawCountBuffer.size = drawCountBufferSize;
+  }
 }
 
 void BatchManager::CreateObjectIDBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
@@ -393,9 +533,9 @@ void BatchManager::CreateObjectIDBuffers(VkDevice device, VkPhysicalDevice physi
                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_objectIDBuffer.buffer,
                         &m_objectIDBuffer.memory);
 
-  vkMapMemory(device, m_objectIDBuffer.memory, 0, idBufferSize, 0, &pData);
+  ResolveMaterialTextures();
+  pData = g_MemoryAllocator.GetMappedData(m_objectIDBuffer.buffer);
   memcpy(pData, m_objectIDList.data(), (size_t)idBufferSize);
-  vkUnmapMemory(device, m_objectIDBuffer.memory);
 }
 
 void BatchManager::CreateTextureBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {}
@@ -409,50 +549,61 @@ void BatchManager::CreateBoundingBoxBuffers(VkDevice device, VkPhysicalDevice ph
                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_boundingBoxListBuffer.buffer,
                         &m_boundingBoxListBuffer.memory);
 
-  vkMapMemory(device, m_boundingBoxListBuffer.memory, 0, aabbBufferSize, 0, &pData);
+  pData = g_MemoryAllocator.GetMappedData(m_boundingBoxListBuffer.buffer);
   memcpy(pData, m_boundingBoxList.data(), (size_t)aabbBufferSize);
-  vkUnmapMemory(device, m_boundingBoxListBuffer.memory);
+
+  // Unit cube, created once and kept across rebuilds (it does not depend on the scene)
+  if (m_unitCubeVertexBuffer.buffer == VK_NULL_HANDLE) {
+    std::vector<glm::vec3> cubeVertices = CreateAABBVertexBuffer({glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(1.0f)});
+    std::vector<uint32_t> cubeIndices = CreateAABBIndexBuffer();
+    m_unitCubeIndexCount = static_cast<uint32_t>(cubeIndices.size());
+
+    m_unitCubeVertexBuffer.size = cubeVertices.size() * sizeof(glm::vec3);
+    VkUtils::CreateBuffer(device, physicalDevice, m_unitCubeVertexBuffer.size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_unitCubeVertexBuffer.buffer,
+                          &m_unitCubeVertexBuffer.memory);
+    memcpy(g_MemoryAllocator.GetMappedData(m_unitCubeVertexBuffer.buffer), cubeVertices.data(), (size_t)m_unitCubeVertexBuffer.size);
+
+    m_unitCubeIndexBuffer.size = cubeIndices.size() * sizeof(uint32_t);
+    VkUtils::CreateBuffer(device, physicalDevice, m_unitCubeIndexBuffer.size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_unitCubeIndexBuffer.buffer,
+                          &m_unitCubeIndexBuffer.memory);
+    memcpy(g_MemoryAllocator.GetMappedData(m_unitCubeIndexBuffer.buffer), cubeIndices.data(), (size_t)m_unitCubeIndexBuffer.size);
+  }
+
+  // What a box vertex/index pair plus a copy of the mesh geometry per mesh (the old occlusion depth input) would have taken
+  VkDeviceSize perMeshBytes = 0;
+  for (const Mesh& mesh : m_meshes) {
+    perMeshBytes += m_unitCubeVertexBuffer.size + m_unitCubeIndexBuffer.size;
+    perMeshBytes += mesh.vertexCount * sizeof(BasicVertex) + mesh.indexCount * sizeof(uint32_t);
+  }
+  std::cout << "Bounding box geometry : " << m_unitCubeVertexBuffer.size + m_unitCubeIndexBuffer.size << " bytes shared by "
+            << m_boundingBoxList.size() << " boxes, " << perMeshBytes << " bytes of per-mesh buffers saved" << std::endl;
 }
 
-void BatchManager::CreateRaytracingBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
+void BatchManager::CreateGeometryBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
   void* pData = nullptr;
 
   /*
-   * Vertices + Indices + Offset Buffer
+   * Vertices + Indices (device local, one copy for raster and ray tracing) + Offset Buffer
    */
-  m_verticesBuffer.size = static_cast<uint64_t>(m_allMeshVertices.size() * sizeof(RayTracingVertex));
-  VkUtils::CreateBuffer(device, physicalDevice, m_verticesBuffer.size,
-                        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_verticesBuffer.buffer,
-                        &m_verticesBuffer.memory, true);
-
-  vkMapMemory(device, m_verticesBuffer.memory, 0, m_verticesBuffer.size, 0, &pData);
-  memcpy(pData, m_allMeshVertices.data(), (size_t)m_verticesBuffer.size);
-  vkUnmapMemory(device, m_verticesBuffer.memory);
+  m_verticesBuffer.size = static_cast<uint64_t>(m_allMeshVertices.size());
+  g_ResourceManager.CreateGeometryBuffer(m_verticesBuffer.size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &m_verticesBuffer.memory,
+                                         &m_verticesBuffer.buffer, m_allMeshVertices.data());
 
   m_indicesBuffer.size = static_cast<uint64_t>(m_allMeshIndices.size() * sizeof(uint32_t));
-  VkUtils::CreateBuffer(device, physicalDevice, m_indicesBuffer.size,
-                        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_indicesBuffer.buffer,
-                        &m_indicesBuffer.memory, true);
+  g_ResourceManager.CreateGeometryBuffer(m_indicesBuffer.size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &m_indicesBuffer.memory,
+                                         &m_indicesBuffer.buffer, m_allMeshIndices.data());
 
-  vkMapMemory(device, m_indicesBuffer.memory, 0, m_indicesBuffer.size, 0, &pData);
-  memcpy(pData, m_allMeshIndices.data(), (size_t)m_indicesBuffer.size);
-  vkUnmapMemory(device, m_indicesBuffer.memory);
+  std::cout << "Scene geometry : " << (m_verticesBuffer.size + m_indicesBuffer.size) / 1024 << " KB for " << m_meshes.size()
+            << " meshes, shared by raster and ray tracing" << std::endl;
 
-  uint32_t vertexOffset = 0;
-  uint32_t indexOffset = 0;
   for (auto& mesh : m_meshes) {
     InstanceOffset offset;
-    offset.vertexOffset = vertexOffset;
-    offset.indicesOffset = indexOffset;
+    offset.vertexOffset = static_cast<uint32_t>(mesh.vertexOffset / GetVertexStride());
+    offset.indicesOffset = static_cast<uint32_t>(mesh.indexOffset / sizeof(uint32_t));
 
     m_instanceOffsets.push_back(offset);
-
-    vertexOffset += mesh.vertices.size();
-    indexOffset += mesh.indices.size();
   }
 
   m_instanceOffsetBuffer.size = static_cast<uint64_t>(m_instanceOffsets.size() * sizeof(InstanceOffset));
@@ -462,7 +613,130 @@ void BatchManager::CreateRaytracingBuffers(VkDevice device, VkPhysicalDevice phy
                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_instanceOffsetBuffer.buffer,
                         &m_instanceOffsetBuffer.memory, true);
 
-  vkMapMemory(device, m_instanceOffsetBuffer.memory, 0, m_instanceOffsetBuffer.size, 0, &pData);
+  pData = g_MemoryAllocator.GetMappedData(m_instanceOffsetBuffer.buffer);
   memcpy(pData, m_instanceOffsets.data(), (size_t)m_instanceOffsetBuffer.size);
-  vkUnmapMemory(device, m_instanceOffsetBuffer.memory);
+}
+
+void BatchManager::CreateVertexDecodeBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
+  m_vertexDecodeList.clear();
+  for (const Mesh& mesh : m_meshes) m_vertexDecodeList.push_back(mesh.vertexDecode);
+
+  // Also read by the BLAS builds (transformData), which want a device address
+  m_vertexDecodeBuffer.size = static_cast<uint64_t>(m_vertexDecodeList.size() * sizeof(VkTransformMatrixKHR));
+  VkUtils::CreateBuffer(device, physicalDevice, m_vertexDecodeBuffer.size,
+                        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_vertexDecodeBuffer.buffer,
+                        &m_vertexDecodeBuffer.memory, true);
+
+  void* pData = g_MemoryAllocator.GetMappedData(m_vertexDecodeBuffer.buffer);
+  memcpy(pData, m_vertexDecodeList.data(), (size_t)m_vertexDecodeBuffer.size);
+}
+
+void BatchManager::CreateMeshletBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
+  m_meshletList.clear();
+  for (uint32_t i = 0; i < m_meshes.size(); ++i) {
+    const Mesh& mesh = m_meshes[i];
+    uint32_t meshFirstIndex = static_cast<uint32_t>(mesh.indexOffset / sizeof(uint32_t));
+
+    if (mesh.meshlets.empty()) {
+      // Not clustered (e.g. too few indices) : one meshlet around the whole mesh that never fails the cone test
+      AABB aabb = m_boundingBoxList[i];
+      glm::vec3 center = (glm::vec3(aabb.min) + glm::vec3(aabb.max)) * 0.5f;
+      Meshlet meshlet = {};
+      meshlet.boundingSphere = glm::vec4(center, glm::length(glm::vec3(aabb.max) - center));
+      meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+      meshlet.firstIndex = meshFirstIndex;
+      meshlet.triangleCount = mesh.indexCount / 3;
+      meshlet.meshIndex = i;
+      m_meshletList.push_back(meshlet);
+      continue;
+    }
+
+    for (uint32_t m = 0; m < mesh.meshlets.size(); ++m) {
+      Meshlet meshlet = mesh.meshlets[m];
+      meshlet.firstIndex += meshFirstIndex;
+      meshlet.meshIndex = i;
+      meshlet.localIndex = m;
+      m_meshletList.push_back(meshlet);
+    }
+  }
+
+  // std::max : a storage buffer descriptor can not be empty
+  m_meshletBuffer.size = sizeof(Meshlet) * (std::max)(m_meshletList.size(), size_t(1));
+  VkUtils::CreateBuffer(device, physicalDevice, m_meshletBuffer.size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_meshletBuffer.buffer,
+                        &m_meshletBuffer.memory);
+
+  void* pData = g_MemoryAllocator.GetMappedData(m_meshletBuffer.buffer);
+  memcpy(pData, m_meshletList.data(), m_meshletList.size() * sizeof(Meshlet));
+
+  // Only written and read on the GPU, a mesh range is always rewritten before its draw reads it
+  m_culledIndicesBuffer.size = (std::max)(m_indicesBuffer.size, VkDeviceSize(sizeof(uint32_t)));
+  VkUtils::CreateBuffer(device, physicalDevice, m_culledIndicesBuffer.size,
+                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        &m_culledIndicesBuffer.buffer, &m_culledIndicesBuffer.memory);
+
+  m_meshletIndexCountBuffer.size = sizeof(uint32_t) * (std::max)(m_meshes.size(), size_t(1));
+  VkUtils::CreateBuffer(device, physicalDevice, m_meshletIndexCountBuffer.size,
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        &m_meshletIndexCountBuffer.buffer, &m_meshletIndexCountBuffer.memory);
+
+  std::cout << "Meshlets : " << m_meshletList.size() << " for " << m_meshes.size() << " meshes" << std::endl;
+}
+
+void BatchManager::CreateLodBuffers(VkDevice device, VkPhysicalDevice physicalDevice) {
+  m_lodTableList.assign(m_meshes.size(), MeshLodTable{});
+  std::array<uint64_t, MAX_LOD_COUNT> levelTriangles = {};
+  for (size_t i = 0; i < m_meshes.size(); ++i) {
+    const Mesh& mesh = m_meshes[i];
+    uint32_t meshFirstIndex = static_cast<uint32_t>(mesh.indexOffset / sizeof(uint32_t));
+
+    MeshLodTable& table = m_lodTableList[i];
+    table.lodCount = static_cast<uint32_t>(mesh.lods.size()) + 1;
+    table.levels[0] = {meshFirstIndex, mesh.indexCount, 0.0f, 0};
+    for (uint32_t level = 1; level < table.lodCount; ++level) {
+      table.levels[level] = mesh.lods[level - 1];
+      table.levels[level].firstIndex += meshFirstIndex;
+    }
+
+    // Meshes with a shorter chain keep drawing their last level
+    for (uint32_t level = 0; level < MAX_LOD_COUNT; ++level) {
+      levelTriangles[level] += table.levels[(std::min)(level, table.lodCount - 1)].indexCount / 3;
+    }
+  }
+
+  m_lodBuffer.size = sizeof(MeshLodTable) * (std::max)(m_lodTableList.size(), size_t(1));
+  VkUtils::CreateBuffer(device, physicalDevice, m_lodBuffer.size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_lodBuffer.buffer,
+                        &m_lodBuffer.memory);
+
+  void* pData = g_MemoryAllocator.GetMappedData(m_lodBuffer.buffer);
+  memcpy(pData, m_lodTableList.data(), m_lodTableList.size() * sizeof(MeshLodTable));
+
+  std::cout << "LOD triangles :";
+  for (uint32_t level = 0; level < MAX_LOD_COUNT; ++level) std::cout << " " << levelTriangles[level];
+  std::cout << std::endl;
+}
+
+bool BatchManager::IsMeshletCullingActive() const {
+  return g_RenderSetting.isGpuCulling && g_RenderSetting.isMeshletCulling && !m_meshletList.empty();
+}
+
+std::string BatchManager::GetVertexShaderPath(const std::string& name) const {
+  return "Resources/Shaders/" + name + (m_vertexFormat == VertexFormat::Packed ? "_Packed.spv" : ".spv");
+}
+
+void BatchManager::ApplyVertexFormat(VkVertexInputBindingDescription& binding,
+                                     std::array<VkVertexInputAttributeDescription, 3>& attributes) const {
+  if (m_vertexFormat != VertexFormat::Packed) return;
+
+  // Normalized formats, the vertex shader decodes position with the mesh VertexDecode (BATCH_ALL binding 4)
+  binding.stride = static_cast<uint32_t>(sizeof(PackedVertex));
+  attributes[0].format = VK_FORMAT_R16G16B16A16_SNORM;
+  attributes[0].offset = offsetof(PackedVertex, pos);
+  attributes[1].format = VK_FORMAT_R16G16_SNORM;
+  attributes[1].offset = offsetof(PackedVertex, normal);
+  attributes[2].format = VK_FORMAT_R16G16_SFLOAT;
+  attributes[2].offset = offsetof(PackedVertex, tex);
 }
@@ -4,6 +4,7 @@
 #include "Components.h"
 #include "Image.h"
 #include "Mesh.h"
+#include "Utils/BVH.h"
 #include "Utils/Boundingbox.h"
 #include "Utils/Singleton.h"
 #include "VkUtils/DescriptorBuilder.h"
@@ -11,18 +12,12 @@
 #include "VkUtils/ResourceManager.h"
 
 static const uint32_t MAX_BATCH_SIZE = 3 * 1024 * 1024;  // 3MB
-static std::vector<BasicVertex> s_accumulatedVertices;
-static std::vector<uint32_t> s_accumulatedIndices;
-static size_t s_accumulatedVertexSize;
-static size_t s_accumulatedIndexSize;
-static uint64_t s_accumulatedIndirectOffset;
-static uint32_t s_accumulatedMeshIndex;
 
+// A run of draws sharing one indirect draw / culling range. The geometry itself lives in BatchManager::m_verticesBuffer and
+// m_indicesBuffer, the draw commands carry whole-buffer firstIndex / vertexOffset.
 struct MiniBatch {
-  VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory m_vertexBufferMemory = VK_NULL_HANDLE;
-  VkBuffer m_indexBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory m_indexBufferMemory = VK_NULL_HANDLE;
+  uint64_t m_vertexBufferOffset = 0;  // byte offset of the batch in the scene geometry buffers
+  uint64_t m_indexBufferOffset = 0;
 
   uint32_t m_currentVertexOffset = 0;
   uint32_t m_currentIndexOffset = 0;
@@ -30,14 +25,6 @@ struct MiniBatch {
 
   uint64_t m_indirectCommandsOffset = 0;
   std::vector<VkDrawIndexedIndirectCommand> m_drawIndexedCommands;
-
-  void Cleanup(VkDevice device) {
-    vkDestroyBuffer(device, m_vertexBuffer, nullptr);
-    vkFreeMemory(device, m_vertexBufferMemory, nullptr);
-
-    vkDestroyBuffer(device, m_indexBuffer, nullptr);
-    vkFreeMemory(device, m_indexBufferMemory, nullptr);
-  }
 };
 
 class BatchManager : public Singleton<BatchManager> {
@@ -52,24 +39,46 @@ class BatchManager : public Singleton<BatchManager> {
 
   void Cleanup(VkDevice device);
 
-  void AddDataToMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager, const Mesh& mesh, bool flag = false);
-  void FlushMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager);
+  // Appends the mesh to the scene geometry (m_allMeshVertices / m_allMeshIndices) and sets its vertexOffset / indexOffset,
+  // uploaded once by CreateBatchManagerBuffers
+  void AddDataToMiniBatch(std::vector<MiniBatch>& miniBatches, Mesh& mesh, bool flag = false);
+  void FlushMiniBatch(std::vector<MiniBatch>& miniBatches);
 
   void CreateBatchManagerBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
   void CreateDescriptorSets(VkDevice device, VkPhysicalDevice physicalDevice);
   void RebuildBatchManager(VkDevice device, VkPhysicalDevice physicalDevice);
+  // idx : materialID, a material packed into an atlas page moves to an image of its own
   void ChangeTexture(VkDevice device, VkPhysicalDevice physicalDevice, int idx, std::string& path);
+  // Texture fields of m_objectIDList from m_materialTextures
+  void ResolveMaterialTextures();
+
+  void BuildSceneBVH(uint32_t imageIndex = 0);
+  void RefitSceneBVH(uint32_t imageIndex);
+
+  uint32_t GetVertexStride() const {
+    return static_cast<uint32_t>(m_vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(BasicVertex));
+  }
+  const uint8_t* GetVertexData(const Mesh& mesh) const {
+    if (m_vertexFormat == VertexFormat::Packed) return reinterpret_cast<const uint8_t*>(mesh.packed_vertices.data());
+    return reinterpret_cast<const uint8_t*>(mesh.vertices.data());
+  }
+  // Pipelines drawing the mini-batches : "<name>_Packed.spv" and the PackedVertex input layout when m_vertexFormat is Packed
+  std::string GetVertexShaderPath(const std::string& name) const;
+  void ApplyVertexFormat(VkVertexInputBindingDescription& binding,
+                         std::array<VkVertexInputAttributeDescription, 3>& attributes) const;
+  // GPU culling with isMeshletCulling : the draws read m_culledIndicesBuffer instead of m_indicesBuffer
+  bool IsMeshletCullingActive() const;
+  VkBuffer GetDrawIndexBuffer() const { return IsMeshletCullingActive() ? m_culledIndicesBuffer.buffer : m_indicesBuffer.buffer; }
 
  public:
+  // Set before a scene is loaded, every mesh of the scene and every pipeline use it (see VertexFormat)
+  VertexFormat m_vertexFormat = VertexFormat::Full;
+
   std::vector<MiniBatch> m_miniBatchList;
-  std::vector<BasicVertex> m_accumulatedVertices;
-  std::vector<uint32_t> m_accumulatedIndices;
-  size_t m_accumulatedVertexSize = 0;
+  size_t m_accumulatedVertexSize = 0;  // of the mini-batch being filled
   size_t m_accumulatedIndexSize = 0;
   uint64_t m_accumulatedIndirectOffset = 0;
   uint32_t m_accumulatedMeshIndex = 0;
-  uint64_t m_accmulatedVertexOffset = 0;
-  uint64_t m_accmulatedIndexOffset = 0;
 
   // Descriptor Set
   VkDescriptorSetLayout m_batchSetLayout;
@@ -85,134 +94,75 @@ class BatchManager : public Singleton<BatchManager> {
   std::vector<GpuBuffer> m_transformListBuffer;
 
   // Material
-  std::vector<GpuImage> m_diffuseImages;
+  std::vector<GpuImage> m_diffuseImages;  // u_DiffuseTextureList : textures of their own and TexturePacker pages
+  std::vector<MaterialTexture> m_materialTextures;  // per materialID, in the order the loaders found the textures
   std::vector<VkDescriptorSet> m_textureIdList;
   VkSampler m_sampler;
   GpuImage oldImage;
 
   // Indirect Draw Call
   GpuBuffer m_indirectDrawCommandBuffer;
+  // - Surviving commands of each mini-batch packed from its m_indirectCommandsOffset (vkCmdDrawIndexedIndirectCount).
+  //   One per frame in flight, the CPU fallback rewrites them while the previous frames still draw from theirs.
+  std::vector<GpuBuffer> m_compactedDrawCommandBuffers;
+  std::vector<GpuBuffer> m_drawCountBuffers;  // uint per draw, the count of a mini-batch sits at the index of its first draw
 
   // Bounding Box
   std::vector<AABB> m_boundingBoxList;
   GpuBuffer m_boundingBoxListBuffer;
-  // - Each bounding box array (for visible bounding box)
-  std::vector<AABBBufferList> m_boundingBoxBufferList;
-
-  // Test
-  std::vector<GpuBuffer> m_bbVertexBuffers;
-  std::vector<GpuBuffer> m_bbIndexBuffers;
+  // - One unit cube shared by every box, stretched to m_boundingBoxList[gl_InstanceIndex] in BoundingBoxVS
+  GpuBuffer m_unitCubeVertexBuffer;
+  GpuBuffer m_unitCubeIndexBuffer;
+  uint32_t m_unitCubeIndexCount = 0;
+  // - World space boxes of every mesh (hierarchical CPU culling, picking), refit when m_transforms change
+  BVH m_sceneBVH;
+  std::vector<glm::mat4> m_sceneBVHTransforms;  // transforms the BVH is currently fitted to
 
   /*
-    Ray Tracing
+    Scene Geometry : one vertex / index buffer drawn by every raster pass and read by the BLAS builds and hit shaders
   */
   std::vector<Mesh> m_meshes;
-  std::vector<RayTracingVertex> m_allMeshVertices;
+  std::vector<uint8_t> m_allMeshVertices;  // in m_vertexFormat
   GpuBuffer m_verticesBuffer;
-
   std::vector<uint32_t> m_allMeshIndices;
   GpuBuffer m_indicesBuffer;
 
+  // Mesh::vertexDecode of every mesh (identity for VertexFormat::Full), BATCH_ALL binding 4 and BLAS transformData
+  std::vector<VkTransformMatrixKHR> m_vertexDecodeList;
+  GpuBuffer m_vertexDecodeBuffer;
+
   std::vector<InstanceOffset> m_instanceOffsets;
   GpuBuffer m_instanceOffsetBuffer;
 
+  /*
+    Meshlets : Mesh::meshlets of every mesh with scene buffer firstIndex, culled by MeshletCullingCS (isMeshletCulling)
+  */
+  std::vector<Meshlet> m_meshletList;
+  GpuBuffer m_meshletBuffer;
+  // - Surviving meshlet indices, each mesh at the same offset as in m_indicesBuffer so the draw commands stay valid
+  GpuBuffer m_culledIndicesBuffer;
+  GpuBuffer m_meshletIndexCountBuffer;  // uint per mesh, the indexCount of its draw after meshlet culling
+
+  /*
+    LOD : MeshLodTable per mesh (level 0 = its draw command), the levels follow Mesh::indices in m_indicesBuffer.
+    BATCH_ALL binding 5, ViewFrustumCullingCS / CullingRenderPass::SelectLods rewrite firstIndex / indexCount of the draws.
+  */
+  std::vector<MeshLodTable> m_lodTableList;
+  GpuBuffer m_lodBuffer;
+
  public:
   void CreateTransformListBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
   void CreateIndirectDrawBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
   void CreateObjectIDBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
   void CreateTextureBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
   void CreateBoundingBoxBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
-  void CreateRaytracingBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
+  void CreateGeometryBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
+  void CreateVertexDecodeBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
+  void CreateMeshletBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
+  void CreateLodBuffers(VkDevice device, VkPhysicalDevice physicalDevice);
+
+ private:
+  void CloseMiniBatch(MiniBatch& batch);
 };
 
 #define g_BatchManager BatchManager::Get()
-
-static void AddDataToMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager, const Mesh& mesh,
-                               bool flag = false) {
-  //  ޽  ũ 
-  size_t vertexDataSize = mesh.vertexCount * sizeof(BasicVertex);
-  size_t indexDataSize = mesh.indexCount * sizeof(uint32_t);
-  size_t totalDataSize = vertexDataSize + indexDataSize;
-
-  //  miniBatches   ϳ 
-  if (s_accumulatedVertexSize == 0 && s_accumulatedIndexSize == 0) {
-    miniBatches.emplace_back();
-  }
-
-  MiniBatch* currentBatch = &miniBatches.back();
-
-  // Draw Command   ߰
-  VkDrawIndexedIndirectCommand drawCommand{};
-  drawCommand.indexCount = mesh.indexCount;
-  drawCommand.instanceCount = 1;
-  drawCommand.firstIndex = s_accumulatedIndexSize / sizeof(uint32_t);
-  drawCommand.vertexOffset = s_accumulatedVertexSize / sizeof(BasicVertex);  // It's not byte offset, Just Index Offset
-  drawCommand.firstInstance = s_accumulatedMeshIndex++;
-
-  currentBatch->m_drawIndexedCommands.push_back(drawCommand);
-
-  //  Ϳ  ޽ ߰
-  s_accumulatedVertices.insert(s_accumulatedVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
-  s_accumulatedIndices.insert(s_accumulatedIndices.end(), mesh.indices.begin(), mesh.indices.end());
-  std::cout << mesh.indices.size() << std::endl;
-
-  s_accumulatedVertexSize += vertexDataSize;
-  s_accumulatedIndexSize += indexDataSize;
-
-  //  ũⰡ 3MB ʰϸ ο mini-batch  Ǵ  ƹ͵  ʾ ,  
-  if (s_accumulatedVertexSize + s_accumulatedIndexSize > MAX_BATCH_SIZE || flag) {
-    // ο mini-batch 
-    manager.CreateVertexBuffer(s_accumulatedVertexSize, &currentBatch->m_vertexBufferMemory, &currentBatch->m_vertexBuffer,
-                               s_accumulatedVertices.data());
-    manager.CreateIndexBuffer(s_accumulatedIndexSize, &currentBatch->m_indexBufferMemory, &currentBatch->m_indexBuffer,
-                              s_accumulatedIndices.data());
-
-    currentBatch->m_currentVertexOffset = s_accumulatedVertexSize;
-    currentBatch->m_currentIndexOffset = s_accumulatedIndexSize;
-    currentBatch->m_currentBatchSize = s_accumulatedVertexSize + s_accumulatedIndexSize;
-
-    currentBatch->m_indirectCommandsOffset = s_accumulatedIndirectOffset;
-    s_accumulatedIndirectOffset +=
-        static_cast<uint64_t>(currentBatch->m_drawIndexedCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
-
-    std::cout << "New mini-batch created with size: " << currentBatch->m_currentBatchSize << " bytes." << std::endl;
-
-    //   ʱȭ
-    s_accumulatedVertices.clear();
-    s_accumulatedIndices.clear();
-    s_accumulatedVertexSize = 0;
-    s_accumulatedIndexSize = 0;
-    s_accumulatedMeshIndex = 0;
-
-  } else {
-    std::cout << "Accumulating mesh data. Current accumulated size: " << s_accumulatedVertexSize + s_accumulatedIndexSize << " bytes."
-              << std::endl;
-  }
-}
-
-static void FlushMiniBatch(std::vector<MiniBatch>& miniBatches, VkUtils::ResourceManager& manager) {
-  if (s_accumulatedVertexSize == 0 && s_accumulatedIndexSize == 0) return;
-
-  MiniBatch* currentBatch = &miniBatches.back();
-
-  manager.CreateVertexBuffer(s_accumulatedVertexSize, &currentBatch->m_vertexBufferMemory, &currentBatch->m_vertexBuffer,
-                             s_accumulatedVertices.data());
-  manager.CreateIndexBuffer(s_accumulatedIndexSize, &currentBatch->m_indexBufferMemory, &currentBatch->m_indexBuffer,
-                            s_accumulatedIndices.data());
-
-  currentBatch->m_currentVertexOffset = s_accumulatedVertexSize;
-  currentBatch->m_currentIndexOffset = s_accumulatedIndexSize;
-  currentBatch->m_currentBatchSize = s_accumulatedVertexSize + s_accumulatedIndexSize;
-
-  currentBatch->m_indirectCommandsOffset = s_accumulatedIndirectOffset;
-
-  std::cout << "Flushed mini-batch with size: " << currentBatch->m_currentBatchSize << " bytes." << std::endl;
-  std::cout << "Flushed mini-batch with fefefe: " << currentBatch->m_indirectCommandsOffset << " bytes." << std::endl;
-
-  //   ʱȭ
-  s_accumulatedVertices.clear();
-  s_accumulatedIndices.clear();
-  s_accumulatedVertexSize = 0;
-  s_accumulatedIndexSize = 0;
-  s_accumulatedMeshIndex = 0;
-}
\ No newline at end of file
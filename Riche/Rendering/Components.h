@@ -28,7 +28,8 @@ struct ShaderSetting : public Singleton<ShaderSetting> {
   uint32_t isDebugging = false;
 #endif  // _DEBUG
   uint32_t batchIdx = 0;
-  float pad[2];
+  uint32_t cullingFlags = 0;  // CullingFlag bits, only set for the culling dispatches of CullingRenderPass
+  float maxTextureLod = VK_LOD_CLAMP_NONE;  // LightingPS mip clamp, 0 samples mip 0 only (RenderSetting::isTextureMipmaps)
 
   glm::vec4 lightPos = glm::vec4(0.0f, 3.0f, 0.0f, 1.0f);
 };
@@ -43,18 +44,55 @@ struct BasicVertex {
   bool operator==(const BasicVertex& other) const { return pos == other.pos && normal == other.normal && tex == other.tex; }
 };
 
-struct RayTracingVertex {
-  glm::vec4 pos;     // Vertex pos (x, y, z)
-  glm::vec4 normal;  // Vertex colour (r, g, b)
-  glm::vec2 tex;     // Texture Coords (u, v)
-  float padd[2] = {999.0f, 999.0f};
+// Vertex layout of the scene geometry buffer (raster and ray tracing), chosen per scene (BatchManager::m_vertexFormat)
+enum class VertexFormat : uint32_t {
+  Full,    // BasicVertex (32 bytes)
+  Packed,  // PackedVertex (16 bytes)
+};
+
+struct PackedVertex {
+  int16_t pos[4];     // snorm, [-1, 1] over the mesh AABB, Mesh::vertexDecode maps it back (w unused)
+  int16_t normal[2];  // snorm, octahedral
+  uint16_t tex[2];    // half float
 };
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
 
+// First vertex / index of a mesh in the scene geometry buffers, in elements
 struct InstanceOffset {
   uint32_t vertexOffset;
   uint32_t indicesOffset;
 };
 
+// A cluster of at most 64 vertices / 124 triangles, its triangles are contiguous in the mesh index list (MeshletBuilder.h).
+// Same layout as the Meshlet of MeshletCullingCS.
+struct Meshlet {
+  glm::vec4 boundingSphere;  // object space center, radius
+  glm::vec4 cone;            // object space normal cone axis, cutoff (1 : never back-facing as a whole)
+  uint32_t firstIndex;       // into Mesh::indices, rebased to the scene index buffer by BatchManager
+  uint32_t triangleCount;
+  uint32_t meshIndex;   // set by BatchManager
+  uint32_t localIndex;  // of the meshlet inside its mesh, set by BatchManager
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet is read as a std430 array");
+
+// Level of detail chain of a mesh (MeshSimplifier.h), every level indexes the same vertices
+static constexpr uint32_t MAX_LOD_COUNT = 5;
+
+struct MeshLod {
+  uint32_t firstIndex;  // relative to the mesh in Mesh::lods, into the scene index buffer in MeshLodTable
+  uint32_t indexCount;
+  float error;  // object space distance the collapses moved the surface by (at most)
+  uint32_t pad;
+};
+
+// Per mesh, level 0 is the full mesh. BATCH_ALL binding 5, read by the culling shaders to pick the level of a draw.
+struct MeshLodTable {
+  uint32_t lodCount;
+  uint32_t pad[3];
+  MeshLod levels[MAX_LOD_COUNT];
+};
+static_assert(sizeof(MeshLodTable) == 96, "MeshLodTable is read as a std430 array");
+
 struct COMPONENTS MaterialCPU {
   glm::vec4 baseColor = glm::vec4(1.0f);
   float albedoFactor = 1.0f;
@@ -81,10 +119,22 @@ struct MaterialBufferManager {
   }
 };
 
+// Where the texture of a material sits in u_DiffuseTextureList, a texture of its own or a tile of a TexturePacker page
+struct COMPONENTS MaterialTexture {
+  int textureIndex = 0;  // BatchManager::m_diffuseImages
+  float maxLod = VK_LOD_CLAMP_NONE;
+  glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);  // xy scale, zw offset of the tile in the page
+};
+
 struct COMPONENTS ObjectID {
   int materialID = 0;
-  float dummy[3] = {0.0f};
+  // - MaterialTexture of materialID, filled in by BatchManager::CreateObjectIDBuffers
+  int textureIndex = 0;
+  float maxLod = VK_LOD_CLAMP_NONE;
+  float pad = 0.0f;
+  glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
 };
+static_assert(sizeof(ObjectID) == 32, "ObjectID is read as a std430 array");
 
 struct COMPONENTS Transform {
   glm::mat4 startTransform = glm::mat4(1.0f);
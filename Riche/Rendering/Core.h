@@ -8,7 +8,8 @@ const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NA
                                                    VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
                                                    VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
                                                    VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME,
-                                                   VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME};
+                                                   VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME,
+                                                   VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
 
 
 inline bool VK_CHECK(VkResult result) {
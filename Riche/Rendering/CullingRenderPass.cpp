@@ -37,6 +37,7 @@ void CullingRenderPass::Initialize(VkDevice device, VkPhysicalDevice physicalDev
    */
   CreateSemaphores();
   CreateCommandBuffers();
+  m_commandRecorder.Initialize(m_pDevice, g_ResourceManager.GetQueueFamilyIndices().graphicsFamily, MAX_FRAME_DRAWS);
 }
 
 void CullingRenderPass::Cleanup() {
@@ -45,14 +46,41 @@ void CullingRenderPass::Cleanup() {
     vkDestroyFence(m_pDevice, m_fence[i], nullptr);
   }
   vkFreeCommandBuffers(m_pDevice, m_pGraphicsCommandPool, MAX_FRAME_DRAWS, m_commandBuffers.data());
+  m_commandRecorder.Cleanup();
 
   vkDestroyPipelineLayout(m_pDevice, m_graphicsPipelineLayout, nullptr);
 
+  // GPU Culling
+  vkDestroyPipeline(m_pDevice, m_frustumCullingPipeline, nullptr);
+  vkDestroyPipelineLayout(m_pDevice, m_frustumCullingPipelineLayout, nullptr);
+  vkDestroyPipeline(m_pDevice, m_hizDownsamplePipeline, nullptr);
+  vkDestroyPipelineLayout(m_pDevice, m_hizDownsamplePipelineLayout, nullptr);
+  vkDestroyPipeline(m_pDevice, m_hizOcclusionCullingPipeline, nullptr);
+  vkDestroyPipelineLayout(m_pDevice, m_hizOcclusionCullingPipelineLayout, nullptr);
+  vkDestroyPipeline(m_pDevice, m_drawCompactionPipeline, nullptr);
+  vkDestroyPipeline(m_pDevice, m_meshletCullingPipeline, nullptr);
+
+  for (VkImageView mipView : m_hizMipViews) {
+    vkDestroyImageView(m_pDevice, mipView, nullptr);
+  }
+  vkDestroyImageView(m_pDevice, m_hizImage.imageView, nullptr);
+  g_MemoryAllocator.FreeImageMemory(m_hizImage.image);
+  vkDestroyImage(m_pDevice, m_hizImage.image, nullptr);
+
+  g_MemoryAllocator.FreeBufferMemory(m_visibilityBuffer.buffer);
+  vkDestroyBuffer(m_pDevice, m_visibilityBuffer.buffer, nullptr);
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    g_MemoryAllocator.FreeBufferMemory(m_cullingPlaneBuffers[i].buffer);
+    vkDestroyBuffer(m_pDevice, m_cullingPlaneBuffers[i].buffer, nullptr);
+    g_MemoryAllocator.FreeBufferMemory(m_cullingStatsBuffers[i].buffer);
+    vkDestroyBuffer(m_pDevice, m_cullingStatsBuffers[i].buffer, nullptr);
+  }
+
   // DepthOnly
   vkDestroyFramebuffer(m_pDevice, m_depthOnlyFramebuffer, nullptr);
   vkDestroyImageView(m_pDevice, m_depthOnlyBufferImage.imageView, nullptr);
+  g_MemoryAllocator.FreeImageMemory(m_depthOnlyBufferImage.image);
   vkDestroyImage(m_pDevice, m_depthOnlyBufferImage.image, nullptr);
-  vkFreeMemory(m_pDevice, m_depthOnlyBufferImage.memory, nullptr);
 
   vkDestroyPipeline(m_pDevice, m_depthGraphicePipeline, nullptr);
   vkDestroyRenderPass(m_pDevice, m_depthRenderPass, nullptr);
@@ -63,9 +91,29 @@ void CullingRenderPass::Cleanup() {
 void CullingRenderPass::Update(uint32_t imageIndex) {
   void* pData = nullptr;
 
+  if (g_RenderSetting.isGpuCulling) {
+    // instanceCount is written on the GPU, only the counters come back
+    pData = g_MemoryAllocator.GetMappedData(m_cullingStatsBuffers[imageIndex].buffer);
+    CullingStats stats = *reinterpret_cast<CullingStats*>(pData);
+
+    g_RenderSetting.afterViewCullingRenderingNum = stats.frustumVisibleCount;
+    g_RenderSetting.afterOcclusionCullingRenderingNum =
+        g_RenderSetting.isOcclusionCulling ? stats.occlusionVisibleCount : stats.frustumVisibleCount;
+    g_RenderSetting.drawCompactionRatio =
+        g_RenderSetting.beforeCullingRenderingNum == 0
+            ? 1.0f
+            : static_cast<float>(g_RenderSetting.afterOcclusionCullingRenderingNum) / g_RenderSetting.beforeCullingRenderingNum;
+    g_RenderSetting.meshletNum = static_cast<int>(g_BatchManager.m_meshletList.size());
+    g_RenderSetting.afterMeshletCullingNum =
+        g_BatchManager.IsMeshletCullingActive() ? stats.meshletVisibleCount : g_RenderSetting.meshletNum;
+    return;
+  }
+
+  std::vector<VkDrawIndexedIndirectCommand> commands{};
   if (g_RenderSetting.isOcclusionCulling) {
+    GetQueryResults();
+
     int accumulatedIndex = 0;
-    std::vector<VkDrawIndexedIndirectCommand> commands{};
     for (auto& batch : g_BatchManager.m_miniBatchList) {
       for (int i = 0; i < batch.m_drawIndexedCommands.size(); ++i) {
         if (m_passedSamples[accumulatedIndex++] != 0) {
@@ -77,57 +125,106 @@ void CullingRenderPass::Update(uint32_t imageIndex) {
       }
       commands.insert(commands.end(), batch.m_drawIndexedCommands.begin(), batch.m_drawIndexedCommands.end());
     }
-    vkMapMemory(m_pDevice, g_BatchManager.m_indirectDrawCommandBuffer.memory, 0, g_BatchManager.m_indirectDrawCommandBuffer.size, 0,
-                &pData);
-    memcpy(pData, commands.data(), g_BatchManager.m_indirectDrawCommandBuffer.size);
-    vkUnmapMemory(m_pDevice, g_BatchManager.m_indirectDrawCommandBuffer.memory);
+
+    // Levels picked by the last CullObjects(), the batch commands keep the full meshes
+    if (m_culledCommands.size() == commands.size()) {
+      for (size_t i = 0; i < commands.size(); ++i) {
+        commands[i].firstIndex = m_culledCommands[i].firstIndex;
+        commands[i].indexCount = m_culledCommands[i].indexCount;
+      }
+    }
+  } else if (m_culledCommands.size() * sizeof(VkDrawIndexedIndirectCommand) == g_BatchManager.m_indirectDrawCommandBuffer.size) {
+    commands = m_culledCommands;  // Frustum culling result of the last CullObjects()
+  } else {
+    for (auto& batch : g_BatchManager.m_miniBatchList) {
+      commands.insert(commands.end(), batch.m_drawIndexedCommands.begin(), batch.m_drawIndexedCommands.end());
+    }
+  }
+
+  pData = g_MemoryAllocator.GetMappedData(g_BatchManager.m_indirectDrawCommandBuffer.buffer);
+  memcpy(pData, commands.data(), g_BatchManager.m_indirectDrawCommandBuffer.size);
+
+  CompactDrawCommands(commands, imageIndex);
+}
+
+// CPU version of DrawCompactionCS, written at the same point of the frame as the indirect draw commands
+void CullingRenderPass::CompactDrawCommands(const std::vector<VkDrawIndexedIndirectCommand>& commands, uint32_t imageIndex) {
+  std::vector<VkDrawIndexedIndirectCommand> compactedCommands(commands.size());
+  std::vector<uint32_t> drawCounts(commands.size(), 0);
+
+  uint32_t visibleCount = 0;
+  uint32_t batchFirst = 0;
+  for (auto& batch : g_BatchManager.m_miniBatchList) {
+    uint32_t batchDrawCount = 0;
+    for (size_t i = 0; i < batch.m_drawIndexedCommands.size(); ++i) {
+      const VkDrawIndexedIndirectCommand& command = commands[batchFirst + i];
+      if (command.instanceCount == 0) continue;
+      compactedCommands[batchFirst + batchDrawCount++] = command;
+    }
+    drawCounts[batchFirst] = batchDrawCount;
+    visibleCount += batchDrawCount;
+    batchFirst += static_cast<uint32_t>(batch.m_drawIndexedCommands.size());
   }
 
+  // This frame's copies, the frames still in flight draw from their own
+  const GpuBuffer& compactedDrawCommandBuffer = g_BatchManager.m_compactedDrawCommandBuffers[imageIndex];
+  void* pData = g_MemoryAllocator.GetMappedData(compactedDrawCommandBuffer.buffer);
+  memcpy(pData, compactedCommands.data(), compactedDrawCommandBuffer.size);
+
+  const GpuBuffer& drawCountBuffer = g_BatchManager.m_drawCountBuffers[imageIndex];
+  pData = g_MemoryAllocator.GetMappedData(drawCountBuffer.buffer);
+  memcpy(pData, drawCounts.data(), drawCountBuffer.size);
+
   /*
    * Debug
    */
 
   // Number of Rendering Object
-  void* mappedMemory = nullptr;
-  {
-    vkMapMemory(m_pDevice, g_BatchManager.m_indirectDrawCommandBuffer.memory, 0, g_BatchManager.m_indirectDrawCommandBuffer.size, 0,
-                &mappedMemory);
-    VkDrawIndexedIndirectCommand* drawCommands = reinterpret_cast<VkDrawIndexedIndirectCommand*>(mappedMemory);
-    uint64_t commandCount =
-        static_cast<uint64_t>(g_BatchManager.m_indirectDrawCommandBuffer.size / sizeof(VkDrawIndexedIndirectCommand));
-    std::vector<VkDrawIndexedIndirectCommand> commandVector(drawCommands, drawCommands + commandCount);
-    uint64_t instantCount = 0;
-    for (int i = 0; i < commandVector.size(); ++i) {
-      instantCount += commandVector[i].instanceCount == 0 ? 0 : 1;
-    }
-    g_RenderSetting.afterViewCullingRenderingNum = instantCount;
-    vkUnmapMemory(m_pDevice, g_BatchManager.m_indirectDrawCommandBuffer.memory);
-  }
+  g_RenderSetting.afterViewCullingRenderingNum = visibleCount;
+  g_RenderSetting.afterOcclusionCullingRenderingNum = visibleCount;
+  g_RenderSetting.drawCompactionRatio = commands.empty() ? 1.0f : static_cast<float>(visibleCount) / commands.size();
 }
 
 void CullingRenderPass::Draw(uint32_t imageIndex, VkFence fence, VkSemaphore renderAvailable) {
+  CullObjects(imageIndex);
+  Record(imageIndex);
+  Submit(imageIndex, renderAvailable);
+}
+
+void CullingRenderPass::Record(uint32_t imageIndex) {
+  auto begin = std::chrono::high_resolution_clock::now();
   RecordCommands(imageIndex);
+  g_RenderSetting.cullingRecordTimeMs =
+      std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+}
 
+void CullingRenderPass::Submit(uint32_t imageIndex, VkSemaphore renderAvailable) {
   // RenderPass 1.
+  // Waits on the upload timeline only in the frame that first uses newly uploaded resources
+  const VkUtils::UploadTicket& uploadTicket = m_uploadTickets[imageIndex];
+  std::array<VkSemaphore, 2> waitSemaphores = {renderAvailable, g_ResourceManager.GetUploadTimeline()};
+  std::array<uint64_t, 2> waitValues = {0, uploadTicket.value};  // The binary semaphore's value is ignored
+
+  VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+  timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineSubmitInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+  timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+
   VkSubmitInfo basicSubmitInfo = {};
   basicSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  basicSubmitInfo.waitSemaphoreCount = 1;  // Number of semaphores to wait on
-  basicSubmitInfo.pWaitSemaphores = &renderAvailable;
+  basicSubmitInfo.pNext = uploadTicket.IsValid() ? &timelineSubmitInfo : nullptr;
+  basicSubmitInfo.waitSemaphoreCount = uploadTicket.IsValid() ? 2 : 1;  // Number of semaphores to wait on
+  basicSubmitInfo.pWaitSemaphores = waitSemaphores.data();
 
-  VkPipelineStageFlags basicWaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT};
+  VkPipelineStageFlags basicWaitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
   basicSubmitInfo.pWaitDstStageMask = basicWaitStages;                 // Stages to check semaphores at
   basicSubmitInfo.commandBufferCount = 1;                              // Number of command buffers to submit
   basicSubmitInfo.pCommandBuffers = &m_commandBuffers[imageIndex];     // Command buffer to submit
   basicSubmitInfo.signalSemaphoreCount = 1;                            // Number of semaphores to signal
   basicSubmitInfo.pSignalSemaphores = &m_renderAvailable[imageIndex];  // Semaphores to signal when command buffer finishes
-  // Command buffer  Ϸϸ, Signaled °  semaphore 迭.
+  // Command buffer가 실행을 완료하면, Signaled 상태가 될 semaphore 배열.
 
   VK_CHECK(vkQueueSubmit(m_pGraphicsQueue, 1, &basicSubmitInfo, nullptr));
-
-  if (g_RenderSetting.isOcclusionCulling) {
-    GetQueryResults();
-  }
 }
 
 void CullingRenderPass::CreateRenderPass() { CreateDepthRenderPass(); }
@@ -165,7 +262,7 @@ void CullingRenderPass::CreateDepthRenderPass() {
   // Conversion from VK_IMAGE_LAYER-UNDEFINED to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
   // Transition must happen after ..
   subpassDependencies[0].srcSubpass =
-      VK_SUBPASS_EXTERNAL;  // ܺο Ƿ, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
+      VK_SUBPASS_EXTERNAL;  // 외부에서 들어오므로, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
   subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;  // Pipeline stage
   subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;            // Stage access mask (memory access)
   // But most happen before ..
@@ -198,7 +295,10 @@ void CullingRenderPass::CreateDepthRenderPass() {
   VK_CHECK(vkCreateRenderPass(m_pDevice, &renderPassCreateInfo, nullptr, &m_depthRenderPass));
 }
 
-void CullingRenderPass::CreateFramebuffers() { CreateDepthFramebuffer(); }
+void CullingRenderPass::CreateFramebuffers() {
+  CreateDepthFramebuffer();
+  CreateHiZImage();
+}
 
 void CullingRenderPass::CreateDepthFramebuffer() {
   VkFormat depthImageFormat = VkUtils::ChooseSupportedFormat(m_pPhyscialDevice, {VK_FORMAT_D32_SFLOAT}, VK_IMAGE_TILING_OPTIMAL,
@@ -227,6 +327,30 @@ void CullingRenderPass::CreateDepthFramebuffer() {
   VK_CHECK(vkCreateFramebuffer(m_pDevice, &framebufferCreateInfo, nullptr, &m_depthOnlyFramebuffer));
 }
 
+void CullingRenderPass::CreateHiZImage() {
+  // Full chain down to 1x1, mip 0 has the same size as the depth buffer
+  m_hizMipLevels = static_cast<uint32_t>(std::floor(std::log2((std::max)(m_width, m_height)))) + 1;
+
+  VkUtils::CreateImage2D(m_pDevice, m_pPhyscialDevice, m_width, m_height, &m_hizImage.memory, &m_hizImage.image, VK_FORMAT_R32_SFLOAT,
+                         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_hizMipLevels);
+
+  VkUtils::CreateImageView(m_pDevice, m_hizImage.image, &m_hizImage.imageView, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0,
+                           m_hizMipLevels);
+
+  m_hizMipViews.resize(m_hizMipLevels);
+  for (uint32_t mip = 0; mip < m_hizMipLevels; ++mip) {
+    VkUtils::CreateImageView(m_pDevice, m_hizImage.image, &m_hizMipViews[mip], VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, mip,
+                             1);
+  }
+
+  // Written and read only by compute shaders, so it never leaves GENERAL
+  VkCommandBuffer commandBuffer = g_ResourceManager.CreateAndBeginCommandBuffer();
+  VkUtils::CmdImageBarrier(commandBuffer, m_hizImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                           VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, m_hizMipLevels);
+  g_ResourceManager.EndAndSummitCommandBuffer(commandBuffer);
+}
+
 void CullingRenderPass::CreatePipelineLayouts() {
   // -- PIPELINE LAYOUT (It's like Root signature in D3D12) --
 
@@ -246,14 +370,95 @@ void CullingRenderPass::CreatePipelineLayouts() {
 
     VK_CHECK(vkCreatePipelineLayout(m_pDevice, &grahpicsPipelineLayoutCreateInfo, nullptr, &m_graphicsPipelineLayout));
   }
+
+  // Frustum Culling Compute Pipeline
+  {
+    std::array<VkDescriptorSetLayout, 3> setLayouts = {
+        g_DescriptorManager.GetVkDescriptorSetLayout("ViewProjection_ALL0"),
+        g_DescriptorManager.GetVkDescriptorSetLayout("BATCH_ALL0"),
+        g_DescriptorManager.GetVkDescriptorSetLayout("CullingData0"),
+    };
+
+    VkPipelineLayoutCreateInfo computePipelineLayoutCreateInfo = {};
+    computePipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    computePipelineLayoutCreateInfo.setLayoutCount = setLayouts.size();
+    computePipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+    computePipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    computePipelineLayoutCreateInfo.pPushConstantRanges = &m_debugPushConstant;
+
+    VK_CHECK(vkCreatePipelineLayout(m_pDevice, &computePipelineLayoutCreateInfo, nullptr, &m_frustumCullingPipelineLayout));
+  }
+
+  // Hi-Z Downsample Compute Pipeline
+  {
+    std::array<VkDescriptorSetLayout, 1> setLayouts = {
+        g_DescriptorManager.GetVkDescriptorSetLayout("HiZLevel0"),
+    };
+
+    VkPipelineLayoutCreateInfo computePipelineLayoutCreateInfo = {};
+    computePipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    computePipelineLayoutCreateInfo.setLayoutCount = setLayouts.size();
+    computePipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+
+    VK_CHECK(vkCreatePipelineLayout(m_pDevice, &computePipelineLayoutCreateInfo, nullptr, &m_hizDownsamplePipelineLayout));
+  }
+
+  // Hi-Z Occlusion Culling Compute Pipeline
+  {
+    std::array<VkDescriptorSetLayout, 4> setLayouts = {
+        g_DescriptorManager.GetVkDescriptorSetLayout("ViewProjection_ALL0"),
+        g_DescriptorManager.GetVkDescriptorSetLayout("BATCH_ALL0"),
+        g_DescriptorManager.GetVkDescriptorSetLayout("CullingData0"),
+        g_DescriptorManager.GetVkDescriptorSetLayout("HiZTexture"),
+    };
+
+    VkPipelineLayoutCreateInfo computePipelineLayoutCreateInfo = {};
+    computePipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    computePipelineLayoutCreateInfo.setLayoutCount = setLayouts.size();
+    computePipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+    computePipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    computePipelineLayoutCreateInfo.pPushConstantRanges = &m_debugPushConstant;
+
+    VK_CHECK(vkCreatePipelineLayout(m_pDevice, &computePipelineLayoutCreateInfo, nullptr, &m_hizOcclusionCullingPipelineLayout));
+  }
 }
 
 void CullingRenderPass::CreatePipelines() {
   CreateDepthGraphicsPipeline();
+
+  CreateComputePipeline("Resources/Shaders/ViewFrustumCullingCS.spv", m_frustumCullingPipelineLayout, &m_frustumCullingPipeline);
+  CreateComputePipeline("Resources/Shaders/HiZDownsampleCS.spv", m_hizDownsamplePipelineLayout, &m_hizDownsamplePipeline);
+  CreateComputePipeline("Resources/Shaders/HiZOcclusionCullingCS.spv", m_hizOcclusionCullingPipelineLayout,
+                        &m_hizOcclusionCullingPipeline);
+  CreateComputePipeline("Resources/Shaders/DrawCompactionCS.spv", m_frustumCullingPipelineLayout, &m_drawCompactionPipeline);
+  CreateComputePipeline("Resources/Shaders/MeshletCullingCS.spv", m_hizOcclusionCullingPipelineLayout, &m_meshletCullingPipeline);
+}
+
+void CullingRenderPass::CreateComputePipeline(const std::string& shaderPath, VkPipelineLayout pipelineLayout,
+                                              VkPipeline* pOutPipeline) {
+  auto computeShaderCode = VkUtils::ReadFile(shaderPath);
+  VkShaderModule computeShaderModule = VkUtils::CreateShaderModule(m_pDevice, computeShaderCode);
+
+  VkPipelineShaderStageCreateInfo computeShaderCreateInfo = {};
+  computeShaderCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  computeShaderCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  computeShaderCreateInfo.module = computeShaderModule;
+  computeShaderCreateInfo.pName = "main";
+
+  VkComputePipelineCreateInfo pipelineCreateInfo = {};
+  pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineCreateInfo.stage = computeShaderCreateInfo;
+  pipelineCreateInfo.layout = pipelineLayout;
+  pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+  pipelineCreateInfo.basePipelineIndex = -1;
+
+  VK_CHECK(vkCreateComputePipelines(m_pDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, pOutPipeline));
+
+  vkDestroyShaderModule(m_pDevice, computeShaderModule, nullptr);
 }
 
 void CullingRenderPass::CreateDepthGraphicsPipeline() {
-  auto vertexShaderCode = VkUtils::ReadFile("Resources/Shaders/DepthOnlyVS.spv");
+  auto vertexShaderCode = VkUtils::ReadFile(g_BatchManager.GetVertexShaderPath("DepthOnlyVS"));
 
   // Build Shaders
   VkShaderModule vertexShaderModule = VkUtils::CreateShaderModule(m_pDevice, vertexShaderCode);
@@ -295,6 +500,7 @@ void CullingRenderPass::CreateDepthGraphicsPipeline() {
   attributeDescriptions[2].location = 2;
   attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
   attributeDescriptions[2].offset = offsetof(BasicVertex, tex);
+  g_BatchManager.ApplyVertexFormat(bindingDescription, attributeDescriptions);
   // -- VERTEX INPUT --
   VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo = {};
   vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -308,7 +514,7 @@ void CullingRenderPass::CreateDepthGraphicsPipeline() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -391,8 +597,8 @@ void CullingRenderPass::CreateDepthGraphicsPipeline() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_TRUE;           // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -433,13 +639,37 @@ void CullingRenderPass::SetupQueryPool() {
 }
 
 void CullingRenderPass::GetQueryResults() {
-  // We use vkGetQueryResults to copy the results into a host visible buffer
-  vkGetQueryPoolResults(m_pDevice, m_occlusionQueryPool, 0, static_cast<uint32_t>(g_BatchManager.m_meshes.size()),
-                        m_passedSamples.size() * sizeof(uint64_t), m_passedSamples.data(), sizeof(uint64_t),
-                        // Store results a 64 bit values and wait until the results have been finished
-                        // If you don't want to wait, you can use VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
-                        // which also returns the state of the result (ready) in the result
-                        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+  // (result, availability) pairs. Never waits, a query that is not finished yet keeps its last known result
+  std::vector<uint64_t> queryResults(m_passedSamples.size() * 2, 0);
+  vkGetQueryPoolResults(m_pDevice, m_occlusionQueryPool, 0, static_cast<uint32_t>(m_passedSamples.size()),
+                        queryResults.size() * sizeof(uint64_t), queryResults.data(), sizeof(uint64_t) * 2,
+                        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+  for (size_t i = 0; i < m_passedSamples.size(); ++i) {
+    if (queryResults[i * 2 + 1] != 0) {
+      m_passedSamples[i] = queryResults[i * 2];
+    }
+  }
+}
+
+void CullingRenderPass::SetupVisibilityBuffer() {
+  g_MemoryAllocator.FreeBufferMemory(m_visibilityBuffer.buffer);
+  vkDestroyBuffer(m_pDevice, m_visibilityBuffer.buffer, nullptr);
+
+  CreateVisibilityBuffer();
+  BindCullingDataDescriptorSets(true);
+}
+
+void CullingRenderPass::CreateVisibilityBuffer() {
+  m_visibilityBuffer.size = sizeof(uint32_t) * (std::max)(g_BatchManager.m_meshes.size(), size_t(1));
+  VkUtils::CreateBuffer(m_pDevice, m_pPhyscialDevice, m_visibilityBuffer.size,
+                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                        &m_visibilityBuffer.buffer, &m_visibilityBuffer.memory);
+
+  // Nothing was visible "last frame" : the first frame draws no occluders and tests everything against an empty Hi-Z
+  VkCommandBuffer commandBuffer = g_ResourceManager.CreateAndBeginCommandBuffer();
+  vkCmdFillBuffer(commandBuffer, m_visibilityBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+  g_ResourceManager.EndAndSummitCommandBuffer(commandBuffer);
 }
 
 void CullingRenderPass::CreateBuffers() {
@@ -449,11 +679,123 @@ void CullingRenderPass::CreateBuffers() {
 
 void CullingRenderPass::CreateShaderStorageBuffers() {
   m_frustumPlanes = CalculateFrustumPlanes(m_pCamera->ViewProj());
+
+  CreateVisibilityBuffer();
+
+  // Reset with vkCmdFillBuffer at the start of every culling command buffer, read back in Update()
+  m_cullingStatsBuffers.resize(MAX_FRAME_DRAWS);
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    m_cullingStatsBuffers[i].size = sizeof(CullingStats);
+    VkUtils::CreateBuffer(m_pDevice, m_pPhyscialDevice, m_cullingStatsBuffers[i].size,
+                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_cullingStatsBuffers[i].buffer,
+                          &m_cullingStatsBuffers[i].memory);
+  }
 }
 
-void CullingRenderPass::CreateUniformBuffers() {}
+void CullingRenderPass::CreateUniformBuffers() {
+  m_cullingPlaneBuffers.resize(MAX_FRAME_DRAWS);
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    m_cullingPlaneBuffers[i].size = sizeof(FrustumPlane) * 6 + sizeof(glm::vec4);
+    VkUtils::CreateBuffer(m_pDevice, m_pPhyscialDevice, m_cullingPlaneBuffers[i].size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_cullingPlaneBuffers[i].buffer,
+                          &m_cullingPlaneBuffers[i].memory);
+  }
+}
 
 void CullingRenderPass::CreateDesrciptorSets() {
+  BindCullingDataDescriptorSets(false);
+
+  /*
+   * HiZLevel{mip} : source (depth buffer for mip 0, previous mip otherwise) -> destination mip
+   */
+  for (uint32_t mip = 0; mip < m_hizMipLevels; ++mip) {
+    VkDescriptorImageInfo srcImageInfo = {};
+    srcImageInfo.imageView = mip == 0 ? m_depthOnlyBufferImage.imageView : m_hizMipViews[mip - 1];
+    srcImageInfo.imageLayout = mip == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorImageInfo dstImageInfo = {};
+    dstImageInfo.imageView = m_hizMipViews[mip];
+    dstImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkUtils::DescriptorBuilder hizLevelBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+    hizLevelBuilder.BindImage(0, &srcImageInfo, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    hizLevelBuilder.BindImage(1, &dstImageInfo, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+    g_DescriptorManager.AddDescriptorSet(&hizLevelBuilder, "HiZLevel" + std::to_string(mip));
+  }
+
+  VkDescriptorImageInfo hizImageInfo{VK_NULL_HANDLE, m_hizImage.imageView, VK_IMAGE_LAYOUT_GENERAL};
+  VkUtils::DescriptorBuilder hizBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+  hizBuilder.BindImage(0, &hizImageInfo, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+  g_DescriptorManager.AddDescriptorSet(&hizBuilder, "HiZTexture");
+}
+
+// CullingData : frustum planes + stats counters + last frame visibility + compaction output + meshlet culling in/out
+void CullingRenderPass::BindCullingDataDescriptorSets(bool isUpdate) {
+  for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    VkDescriptorBufferInfo planeBufferInfo = {};
+    planeBufferInfo.buffer = m_cullingPlaneBuffers[i].buffer;  // Buffer to get data from
+    planeBufferInfo.offset = 0;                                // Position of start of data
+    planeBufferInfo.range = m_cullingPlaneBuffers[i].size;     // size of data
+
+    VkDescriptorBufferInfo statsBufferInfo = {};
+    statsBufferInfo.buffer = m_cullingStatsBuffers[i].buffer;
+    statsBufferInfo.offset = 0;
+    statsBufferInfo.range = m_cullingStatsBuffers[i].size;
+
+    VkDescriptorBufferInfo visibilityBufferInfo = {};
+    visibilityBufferInfo.buffer = m_visibilityBuffer.buffer;
+    visibilityBufferInfo.offset = 0;
+    visibilityBufferInfo.range = m_visibilityBuffer.size;
+
+    VkDescriptorBufferInfo compactedCommandBufferInfo = {};
+    compactedCommandBufferInfo.buffer = g_BatchManager.m_compactedDrawCommandBuffers[i].buffer;
+    compactedCommandBufferInfo.offset = 0;
+    compactedCommandBufferInfo.range = g_BatchManager.m_compactedDrawCommandBuffers[i].size;
+
+    VkDescriptorBufferInfo drawCountBufferInfo = {};
+    drawCountBufferInfo.buffer = g_BatchManager.m_drawCountBuffers[i].buffer;
+    drawCountBufferInfo.offset = 0;
+    drawCountBufferInfo.range = g_BatchManager.m_drawCountBuffers[i].size;
+
+    VkDescriptorBufferInfo meshletBufferInfo = {};
+    meshletBufferInfo.buffer = g_BatchManager.m_meshletBuffer.buffer;
+    meshletBufferInfo.offset = 0;
+    meshletBufferInfo.range = g_BatchManager.m_meshletBuffer.size;
+
+    VkDescriptorBufferInfo sceneIndexBufferInfo = {};
+    sceneIndexBufferInfo.buffer = g_BatchManager.m_indicesBuffer.buffer;
+    sceneIndexBufferInfo.offset = 0;
+    sceneIndexBufferInfo.range = VK_WHOLE_SIZE;
+
+    VkDescriptorBufferInfo culledIndexBufferInfo = {};
+    culledIndexBufferInfo.buffer = g_BatchManager.m_culledIndicesBuffer.buffer;
+    culledIndexBufferInfo.offset = 0;
+    culledIndexBufferInfo.range = g_BatchManager.m_culledIndicesBuffer.size;
+
+    VkDescriptorBufferInfo meshletIndexCountBufferInfo = {};
+    meshletIndexCountBufferInfo.buffer = g_BatchManager.m_meshletIndexCountBuffer.buffer;
+    meshletIndexCountBufferInfo.offset = 0;
+    meshletIndexCountBufferInfo.range = g_BatchManager.m_meshletIndexCountBuffer.size;
+
+    VkUtils::DescriptorBuilder cullingBuilder = VkUtils::DescriptorBuilder::Begin(&g_DescriptorLayoutCache, &g_DescriptorAllocator);
+    cullingBuilder.BindBuffer(0, &planeBufferInfo, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(1, &statsBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(2, &visibilityBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(3, &compactedCommandBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(4, &drawCountBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(5, &meshletBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(6, &sceneIndexBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(7, &culledIndexBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+    cullingBuilder.BindBuffer(8, &meshletIndexCountBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    if (isUpdate) {
+      g_DescriptorManager.UpdateDescriptorSet(&cullingBuilder,
+                                              g_DescriptorManager.GetVkDescriptorSet("CullingData" + std::to_string(i)));
+    } else {
+      g_DescriptorManager.AddDescriptorSet(&cullingBuilder, "CullingData" + std::to_string(i));
+    }
+  }
 }
 
 void CullingRenderPass::CreatePushConstantRange() {
@@ -484,11 +826,12 @@ void CullingRenderPass::CreateCommandBuffers() {
   // Triple Command Buffer
   //
   m_commandBuffers.resize(MAX_FRAME_DRAWS);
+  m_uploadTickets.resize(MAX_FRAME_DRAWS);
 
   VkCommandBufferAllocateInfo cbAllocInfo = {};
   cbAllocInfo = {};
   cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  cbAllocInfo.commandPool = m_pGraphicsCommandPool;  // ش ť йи ť Ŀǵ ť  డϴ.
+  cbAllocInfo.commandPool = m_pGraphicsCommandPool;  // 해당 큐 패밀리의 큐에서만 커맨드 큐 동작이 실행가능하다.
   cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;  // VK_COMMAND_BUFFER_LEVEL_PRIMARY		: buffer you submit directly to
                                                         // queue. cant be called by other buffers
   // VK_COMMAND_BUFFER_LEVEL_SECONDARY	: buffer can't be called directly. Can be called from other buffers via 'vkCmdExecuteCommands'
@@ -501,8 +844,10 @@ void CullingRenderPass::CreateCommandBuffers() {
 
 void CullingRenderPass::RecordCommands(uint32_t currentImage) {
   g_RenderSetting.beforeCullingRenderingNum = 0;
-  for (auto& miniBatch : g_BatchManager.m_miniBatchList) {
-    g_RenderSetting.beforeCullingRenderingNum += miniBatch.m_drawIndexedCommands.size();
+  m_miniBatchFirstIndex.resize(g_BatchManager.m_miniBatchList.size());
+  for (size_t i = 0; i < g_BatchManager.m_miniBatchList.size(); ++i) {
+    m_miniBatchFirstIndex[i] = static_cast<uint32_t>(g_RenderSetting.beforeCullingRenderingNum);
+    g_RenderSetting.beforeCullingRenderingNum += g_BatchManager.m_miniBatchList[i].m_drawIndexedCommands.size();
   }
 
   // information about how to begin each command buffer
@@ -514,6 +859,9 @@ void CullingRenderPass::RecordCommands(uint32_t currentImage) {
   // Start recording commands to command buffer!
   VK_CHECK(vkBeginCommandBuffer(m_commandBuffers[currentImage], &bufferBeginInfo));
 
+  // First graphics work of the frame, takes ownership of whatever the transfer queue finished uploading
+  m_uploadTickets[currentImage] = g_ResourceManager.CmdAcquireUploads(m_commandBuffers[currentImage]);
+
   // Information about how to begin a render pass (only needed for graphical applications)
   VkRenderPassBeginInfo depthOnlyRenderPassBeginInfo = {};
   depthOnlyRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -528,14 +876,17 @@ void CullingRenderPass::RecordCommands(uint32_t currentImage) {
   depthOnlyRenderPassBeginInfo.clearValueCount = static_cast<uint32_t>(depthOnlyClearValue.size());
   depthOnlyRenderPassBeginInfo.framebuffer = m_depthOnlyFramebuffer;
 
-  if (g_RenderSetting.isOcclusionCulling) {
+  if (g_RenderSetting.isGpuCulling) {
+    RecordGpuCullingCommands(currentImage);
+  } else if (g_RenderSetting.isOcclusionCulling) {
     // Must be done outside of render pass
     vkCmdResetQueryPool(m_commandBuffers[currentImage], m_occlusionQueryPool, 0,
                         static_cast<uint32_t>(g_BatchManager.m_meshes.size()));
 
     // Begin Render Pass
+    // INLINE : 렌더 패스의 내용을 직접 명령 버퍼에 기록하는 것을 의미, SECONDARY : vkCmdExecuteCommands로만 기록
     vkCmdBeginRenderPass(m_commandBuffers[currentImage], &depthOnlyRenderPassBeginInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);  //  н    ۿ ϴ  ǹ
+                         g_RenderSetting.isMultiThreadingRecord ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
 
     RecordOcclusionCullingCommands(currentImage);
 
@@ -544,69 +895,358 @@ void CullingRenderPass::RecordCommands(uint32_t currentImage) {
   VK_CHECK(vkEndCommandBuffer(m_commandBuffers[currentImage]));
 }
 
-void CullingRenderPass::RecordOcclusionCullingCommands(uint32_t currentImage) {
-  /*
-   * BoundingBox Renderer
-   */
-  std::vector<VkDrawIndexedIndirectCommand> commands{};
+void CullingRenderPass::CullObjects(uint32_t currentImage) {
+  m_frustumPlanes = CalculateFrustumPlanes(m_pCamera->ViewProj());
+
+  if (g_RenderSetting.isGpuCulling) {
+    // FrustumPlane is (normal, distance), the same 16 bytes as the vec4 planes[6] of ViewFrustumCullingCS
+    uint8_t* pData = reinterpret_cast<uint8_t*>(g_MemoryAllocator.GetMappedData(m_cullingPlaneBuffers[currentImage].buffer));
+    memcpy(pData, m_frustumPlanes.data(), sizeof(FrustumPlane) * 6);
+
+    glm::vec4 lodParams(m_width, m_height, g_RenderSetting.isLodSelection ? g_RenderSetting.lodScreenSize : 0.0f, 0.0f);
+    memcpy(pData + sizeof(FrustumPlane) * 6, &lodParams, sizeof(glm::vec4));
+    return;
+  }
+
+  std::vector<VkDrawIndexedIndirectCommand>& commands = m_culledCommands;
+  commands.clear();
   for (auto& batch : g_BatchManager.m_miniBatchList) {
     commands.insert(commands.end(), batch.m_drawIndexedCommands.begin(), batch.m_drawIndexedCommands.end());
   }
 
-  std::array<FrustumPlane, 6>& frustumPlanes = m_frustumPlanes;
-  std::vector<std::future<void>> futures;
-  futures.reserve(commands.size());
+  m_worldBounds.Resize(commands.size());
+  m_visibleFlags.resize(commands.size());
 
-  for (int i = 0; i < commands.size(); ++i) {
-    if (g_RenderSetting.isMultiThreading) {
-      futures.push_back(g_ThreadPool.Submit([i, currentImage, & commands, &frustumPlanes]() -> void {
-        AABB aabb = g_BatchManager.m_boundingBoxList[i];
-        glm::mat4& transform = g_BatchManager.m_transforms[currentImage][i].currentTransform;
-        aabb.max = transform * aabb.max;
-        aabb.min = transform * aabb.min;
+  // Subtrees outside the frustum are skipped, the BVH was refit to this frame's transforms by BatchManager::Update
+  const BVH& sceneBVH = g_BatchManager.m_sceneBVH;
+  if (g_RenderSetting.isBvhCulling && sceneBVH.GetPrimitiveCount() == commands.size()) {
+    sceneBVH.CullFrustum(m_frustumPlanes, m_visibleFlags.data());
+    for (size_t i = 0; i < commands.size(); ++i) commands[i].instanceCount = m_visibleFlags[i];
+    SelectLods(currentImage);
+    return;
+  }
 
-        commands[i].instanceCount = (int)isAABBInsideFrustum(frustumPlanes, aabb);
-      }));
-    } else {
-      AABB aabb = g_BatchManager.m_boundingBoxList[i];
-      glm::mat4& transform = g_BatchManager.m_transforms[currentImage][i].currentTransform;
-      aabb.max = transform * aabb.max;
-      aabb.min = transform * aabb.min;
+  // World bounds from all 8 corners, then 4 / 8 boxes per iteration (SSE2 / AVX2)
+  auto cullRange = [&](size_t rangeBegin, size_t rangeEnd) {
+    ComputeWorldBounds(g_BatchManager.m_boundingBoxList, g_BatchManager.m_transforms[currentImage], rangeBegin, rangeEnd,
+                       m_worldBounds);
+    CullAABBs(m_frustumPlanes, m_worldBounds, rangeBegin, rangeEnd, m_visibleFlags.data());
+    for (size_t i = rangeBegin; i < rangeEnd; ++i) commands[i].instanceCount = m_visibleFlags[i];
+  };
 
-      commands[i].instanceCount = (int)isAABBInsideFrustum(m_frustumPlanes, aabb);
-    }
-  }
   if (g_RenderSetting.isMultiThreading) {
-    for (auto& future : futures) {
-      future.get();
+    ParallelForRange(0, commands.size(), 1024, cullRange);  // Multiple of 8, every chunk but the last stays on the SIMD path
+  } else {
+    cullRange(0, commands.size());
+  }
+  SelectLods(currentImage);
+}
+
+// CPU version of the LOD selection of ViewFrustumCullingCS, for the draws that survived CullObjects()
+void CullingRenderPass::SelectLods(uint32_t currentImage) {
+  if (!g_RenderSetting.isLodSelection || g_BatchManager.m_lodTableList.size() != m_culledCommands.size()) return;
+
+  const glm::mat4 viewProj = m_pCamera->ViewProj();
+  const glm::vec2 viewport(m_width, m_height);
+  auto selectRange = [&](size_t rangeBegin, size_t rangeEnd) {
+    for (size_t i = rangeBegin; i < rangeEnd; ++i) {
+      VkDrawIndexedIndirectCommand& command = m_culledCommands[i];
+      const MeshLodTable& lodTable = g_BatchManager.m_lodTableList[i];
+      if (command.instanceCount == 0 || lodTable.lodCount <= 1) continue;
+
+      glm::mat4 mvp = viewProj * g_BatchManager.m_transforms[currentImage][i].currentTransform;
+      float projectedSize = ComputeProjectedSize(g_BatchManager.m_boundingBoxList[i], mvp, viewport);
+      const MeshLod& lod = lodTable.levels[MeshSimplifier::SelectLod(projectedSize, lodTable.lodCount, g_RenderSetting.lodScreenSize)];
+      command.firstIndex = lod.firstIndex;
+      command.indexCount = lod.indexCount;
     }
+  };
+
+  if (g_RenderSetting.isMultiThreading) {
+    ParallelForRange(0, m_culledCommands.size(), 1024, selectRange);
+  } else {
+    selectRange(0, m_culledCommands.size());
   }
+}
 
-  g_ShaderSetting.batchIdx = 0;
-  {
-    vkCmdBindPipeline(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_depthGraphicePipeline);
-
-    for (int i = 0; i < commands.size(); ++i) {
-      {
-        VkDeviceSize vertexOffset = 0;  // Always bind at offset 0 since indirect commands handle offsets
-        vkCmdBindVertexBuffers(m_commandBuffers[currentImage], 0, 1, &g_BatchManager.m_bbVertexBuffers[i].buffer, &vertexOffset);
-
-        // Bind the index buffer with the correct offset
-        vkCmdBindIndexBuffer(m_commandBuffers[currentImage], g_BatchManager.m_bbIndexBuffers[i].buffer, 0, VK_INDEX_TYPE_UINT32);
-
-        vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
-                                &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0,
-                                nullptr);
-        vkCmdBindDescriptorSets(m_commandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
-                                &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
-        vkCmdPushConstants(m_commandBuffers[currentImage], m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
-                           &g_ShaderSetting);
-
-        vkCmdBeginQuery(m_commandBuffers[currentImage], m_occlusionQueryPool, g_ShaderSetting.batchIdx, 0);
-        vkCmdDrawIndexed(m_commandBuffers[currentImage], g_BatchManager.m_meshes[i].indexCount, commands[i].instanceCount, 0, 0, 0);
-        vkCmdEndQuery(m_commandBuffers[currentImage], m_occlusionQueryPool, g_ShaderSetting.batchIdx);
-      }
-      g_ShaderSetting.batchIdx += 1;
+void CullingRenderPass::RecordOcclusionCullingCommands(uint32_t currentImage) {
+  if (!g_RenderSetting.isMultiThreadingRecord) {
+    RecordOcclusionCullingRange(m_commandBuffers[currentImage], currentImage, 0, m_culledCommands.size());
+    return;
+  }
+
+  // One secondary command buffer per mesh range, recorded on g_ThreadPool and stitched into the primary in order
+  VkCommandBufferInheritanceInfo inheritanceInfo = {};
+  inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass = m_depthRenderPass;
+  inheritanceInfo.subpass = 0;
+  inheritanceInfo.framebuffer = m_depthOnlyFramebuffer;
+
+  m_commandRecorder.Reset(currentImage);
+  std::vector<VkCommandBuffer> secondaryCommandBuffers =
+      m_commandRecorder.RecordRanges(currentImage, inheritanceInfo, m_culledCommands.size(), 256,
+                                     [&](VkCommandBuffer commandBuffer, size_t rangeBegin, size_t rangeEnd) {
+                                       RecordOcclusionCullingRange(commandBuffer, currentImage, rangeBegin, rangeEnd);
+                                     });
+
+  if (!secondaryCommandBuffers.empty()) {
+    vkCmdExecuteCommands(m_commandBuffers[currentImage], static_cast<uint32_t>(secondaryCommandBuffers.size()),
+                         secondaryCommandBuffers.data());
+  }
+}
+
+void CullingRenderPass::RecordOcclusionCullingRange(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t rangeBegin,
+                                                    size_t rangeEnd) {
+  /*
+   * Occlusion Query Renderer (one query per mesh)
+   */
+  std::vector<VkDrawIndexedIndirectCommand>& commands = m_culledCommands;
+
+  // Local copy, ranges are recorded concurrently
+  ShaderSetting shaderSetting = g_ShaderSetting;
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_depthGraphicePipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0, nullptr);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
+
+  // Every mesh lives in the scene geometry buffers, only batchIdx changes when the range crosses into the next batch
+  VkDeviceSize vertexOffset = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &g_BatchManager.m_verticesBuffer.buffer, &vertexOffset);
+  vkCmdBindIndexBuffer(commandBuffer, g_BatchManager.m_indicesBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+  size_t batch = 0;
+  size_t boundBatch = SIZE_MAX;
+
+  for (size_t i = rangeBegin; i < rangeEnd; ++i) {
+    while (batch + 1 < m_miniBatchFirstIndex.size() && m_miniBatchFirstIndex[batch + 1] <= i) ++batch;
+
+    MiniBatch& miniBatch = g_BatchManager.m_miniBatchList[batch];
+    if (batch != boundBatch) {
+      shaderSetting.batchIdx = m_miniBatchFirstIndex[batch];  // + firstInstance (local draw index) = mesh index
+      vkCmdPushConstants(commandBuffer, m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &shaderSetting);
+      boundBatch = batch;
     }
+
+    const VkDrawIndexedIndirectCommand& draw = miniBatch.m_drawIndexedCommands[i - m_miniBatchFirstIndex[batch]];
+    vkCmdBeginQuery(commandBuffer, m_occlusionQueryPool, static_cast<uint32_t>(i), 0);
+    vkCmdDrawIndexed(commandBuffer, draw.indexCount, commands[i].instanceCount, draw.firstIndex, draw.vertexOffset,
+                     draw.firstInstance);
+    vkCmdEndQuery(commandBuffer, m_occlusionQueryPool, static_cast<uint32_t>(i));
+  }
+}
+
+void CullingRenderPass::RecordGpuCullingCommands(uint32_t currentImage) {
+  VkCommandBuffer commandBuffer = m_commandBuffers[currentImage];
+  const uint32_t drawCount = static_cast<uint32_t>(g_RenderSetting.beforeCullingRenderingNum);
+
+  /*
+   * Two-phase occlusion culling, nothing is read back or waited on by the host
+   *  1. Early : frustum test, draws that were visible last frame become occluders (depth prepass -> Hi-Z)
+   *  2. Late  : frustum + Hi-Z test of every draw, the result is the final instanceCount and next frame's visibility
+   *  3. Meshlets : meshlets of the visible draws are tested again (frustum, cone, Hi-Z), survivors are copied to the culled
+   *     index buffer and their index count replaces the indexCount of the draw
+   *  4. Compaction : surviving commands are packed per mini-batch, the count buffer feeds vkCmdDrawIndexedIndirectCount
+   */
+  const bool isMeshletCulling = g_BatchManager.IsMeshletCullingActive();
+
+  ShaderSetting cullingSetting = g_ShaderSetting;
+  cullingSetting.cullingFlags = 0;
+  if (g_RenderSetting.isOcclusionCulling) cullingSetting.cullingFlags |= CULLING_FLAG_HIZ;
+  if (isMeshletCulling) cullingSetting.cullingFlags |= CULLING_FLAG_MESHLET;
+  if (isMeshletCulling && g_RenderSetting.isMeshletConeCulling) cullingSetting.cullingFlags |= CULLING_FLAG_MESHLET_CONE;
+
+  // The previous frame must be done reading the draw commands, counts and culled indices before they are cleared and rewritten
+  VkMemoryBarrier memoryBarrier = {};
+  memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memoryBarrier.srcAccessMask =
+      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0,
+                       nullptr);
+
+  // Counters start from zero
+  vkCmdFillBuffer(commandBuffer, m_cullingStatsBuffers[currentImage].buffer, 0, VK_WHOLE_SIZE, 0);
+  vkCmdFillBuffer(commandBuffer, g_BatchManager.m_drawCountBuffers[currentImage].buffer, 0, VK_WHOLE_SIZE, 0);
+  if (isMeshletCulling) vkCmdFillBuffer(commandBuffer, g_BatchManager.m_meshletIndexCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+  if (!g_RenderSetting.isOcclusionCulling) {
+    // No late pass : everything counts as visible, so the early pass is a plain frustum test
+    vkCmdFillBuffer(commandBuffer, m_visibilityBuffer.buffer, 0, VK_WHOLE_SIZE, 1);
+  }
+
+  memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0,
+                       nullptr, 0, nullptr);
+
+  /*
+   * 1. Early : instanceCount = in frustum && visible last frame
+   */
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_frustumCullingPipeline);
+  std::array<VkDescriptorSet, 3> frustumSets = {
+      g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)),
+      g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)),
+      g_DescriptorManager.GetVkDescriptorSet("CullingData" + std::to_string(currentImage)),
+  };
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_frustumCullingPipelineLayout, 0,
+                          static_cast<uint32_t>(frustumSets.size()), frustumSets.data(), 0, nullptr);
+  vkCmdPushConstants(commandBuffer, m_frustumCullingPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &cullingSetting);
+  vkCmdDispatch(commandBuffer, (drawCount + 255) / 256, 1, 1);
+
+  if (g_RenderSetting.isOcclusionCulling) {
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr,
+                         0, nullptr);
+
+    // Occluders -> Hi-Z pyramid
+    RecordDepthPrepassCommands(currentImage);
+    RecordHiZBuildCommands(currentImage);
+
+    /*
+     * 2. Late : every draw in the frustum is tested against the pyramid, newly visible ones are drawn by the lighting pass too
+     */
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizOcclusionCullingPipeline);
+    std::array<VkDescriptorSet, 4> occlusionSets = {
+        frustumSets[0],
+        frustumSets[1],
+        frustumSets[2],
+        g_DescriptorManager.GetVkDescriptorSet("HiZTexture"),
+    };
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizOcclusionCullingPipelineLayout, 0,
+                            static_cast<uint32_t>(occlusionSets.size()), occlusionSets.data(), 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_hizOcclusionCullingPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
+                       &cullingSetting);
+    vkCmdDispatch(commandBuffer, (drawCount + 255) / 256, 1, 1);
+  }
+
+  /*
+   * 3. Meshlets : final instanceCount -> culled indices + index count per draw
+   */
+  if (isMeshletCulling) RecordMeshletCullingCommands(currentImage, cullingSetting);
+
+  /*
+   * 4. Compaction : final instanceCount (and meshlet index count) -> packed commands + per mini-batch draw count
+   */
+  memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier,
+                       0, nullptr, 0, nullptr);
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_drawCompactionPipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_frustumCullingPipelineLayout, 0,
+                          static_cast<uint32_t>(frustumSets.size()), frustumSets.data(), 0, nullptr);
+  vkCmdPushConstants(commandBuffer, m_frustumCullingPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &cullingSetting);
+  vkCmdDispatch(commandBuffer, (drawCount + 255) / 256, 1, 1);
+
+  // Draw commands and culled indices are consumed by the lighting pass, the counters by Update() on the host
+  memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  memoryBarrier.dstAccessMask =
+      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                           VK_PIPELINE_STAGE_HOST_BIT,
+                       0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+void CullingRenderPass::RecordMeshletCullingCommands(uint32_t currentImage, const ShaderSetting& cullingSetting) {
+  VkCommandBuffer commandBuffer = m_commandBuffers[currentImage];
+  const uint32_t meshletCount = static_cast<uint32_t>(g_BatchManager.m_meshletList.size());
+
+  // Final instanceCount of the early / late pass
+  VkMemoryBarrier memoryBarrier = {};
+  memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier,
+                       0, nullptr, 0, nullptr);
+
+  // Same sets as the Hi-Z occlusion culling, the pyramid is only sampled when CULLING_FLAG_HIZ is set
+  std::array<VkDescriptorSet, 4> meshletSets = {
+      g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)),
+      g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)),
+      g_DescriptorManager.GetVkDescriptorSet("CullingData" + std::to_string(currentImage)),
+      g_DescriptorManager.GetVkDescriptorSet("HiZTexture"),
+  };
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshletCullingPipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizOcclusionCullingPipelineLayout, 0,
+                          static_cast<uint32_t>(meshletSets.size()), meshletSets.data(), 0, nullptr);
+  vkCmdPushConstants(commandBuffer, m_hizOcclusionCullingPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting),
+                     &cullingSetting);
+  vkCmdDispatch(commandBuffer, (meshletCount + 31) / 32, 1, 1);
+}
+
+void CullingRenderPass::RecordDepthPrepassCommands(uint32_t currentImage) {
+  VkCommandBuffer commandBuffer = m_commandBuffers[currentImage];
+
+  VkRenderPassBeginInfo depthOnlyRenderPassBeginInfo = {};
+  depthOnlyRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  depthOnlyRenderPassBeginInfo.renderPass = m_depthRenderPass;
+  depthOnlyRenderPassBeginInfo.renderArea.offset = {0, 0};
+  depthOnlyRenderPassBeginInfo.renderArea.extent = {m_width, m_height};
+
+  std::array<VkClearValue, 1> depthOnlyClearValue = {};
+  depthOnlyClearValue[0].depthStencil = {1.0f, 0};
+
+  depthOnlyRenderPassBeginInfo.pClearValues = depthOnlyClearValue.data();
+  depthOnlyRenderPassBeginInfo.clearValueCount = static_cast<uint32_t>(depthOnlyClearValue.size());
+  depthOnlyRenderPassBeginInfo.framebuffer = m_depthOnlyFramebuffer;
+
+  // One indirect draw per mini-batch, few enough that recording inline is cheaper than secondaries
+  vkCmdBeginRenderPass(commandBuffer, &depthOnlyRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+  ShaderSetting shaderSetting = g_ShaderSetting;
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_depthGraphicePipeline);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 0, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("ViewProjection_ALL" + std::to_string(currentImage)), 0, nullptr);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipelineLayout, 1, 1,
+                          &g_DescriptorManager.GetVkDescriptorSet("BATCH_ALL" + std::to_string(currentImage)), 0, nullptr);
+
+  VkDeviceSize vertexOffset = 0;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &g_BatchManager.m_verticesBuffer.buffer, &vertexOffset);
+  vkCmdBindIndexBuffer(commandBuffer, g_BatchManager.m_indicesBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+  for (size_t i = 0; i < g_BatchManager.m_miniBatchList.size(); ++i) {
+    MiniBatch& miniBatch = g_BatchManager.m_miniBatchList[i];
+    shaderSetting.batchIdx = m_miniBatchFirstIndex[i];
+
+    vkCmdPushConstants(commandBuffer, m_graphicsPipelineLayout, VK_SHADER_STAGE_ALL, 0, sizeof(ShaderSetting), &shaderSetting);
+
+    vkCmdDrawIndexedIndirect(commandBuffer, g_BatchManager.m_indirectDrawCommandBuffer.buffer, miniBatch.m_indirectCommandsOffset,
+                             static_cast<uint32_t>(miniBatch.m_drawIndexedCommands.size()), sizeof(VkDrawIndexedIndirectCommand));
+  }
+
+  vkCmdEndRenderPass(commandBuffer);
+}
+
+void CullingRenderPass::RecordHiZBuildCommands(uint32_t currentImage) {
+  VkCommandBuffer commandBuffer = m_commandBuffers[currentImage];
+
+  VkUtils::CmdImageBarrier(commandBuffer, m_depthOnlyBufferImage.image, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT,
+                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                           VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizDownsamplePipeline);
+
+  // Mip 0 copies the depth buffer, every next mip keeps the max (farthest) depth of its 2x2 footprint
+  for (uint32_t mip = 0; mip < m_hizMipLevels; ++mip) {
+    uint32_t mipWidth = (std::max)(m_width >> mip, 1u);
+    uint32_t mipHeight = (std::max)(m_height >> mip, 1u);
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hizDownsamplePipelineLayout, 0, 1,
+                            &g_DescriptorManager.GetVkDescriptorSet("HiZLevel" + std::to_string(mip)), 0, nullptr);
+    vkCmdDispatch(commandBuffer, (mipWidth + 7) / 8, (mipHeight + 7) / 8, 1);
+
+    VkUtils::CmdImageBarrier(commandBuffer, m_hizImage.image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, mip, 1);
   }
 }
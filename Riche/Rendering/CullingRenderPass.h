@@ -6,8 +6,11 @@
 #include "IRenderPass.h"
 #include "Mesh.h"
 #include "Utils/BoundingBox.h"
+#include "Utils/FrustumCulling.h"
 #include "Utils/ModelLoader.h"
+#include "Utils/Parallel.h"
 #include "VkUtils/ChooseFunc.h"
+#include "VkUtils/CommandRecorder.h"
 #include "VkUtils/DescriptorBuilder.h"
 #include "VkUtils/DescriptorManager.h"
 #include "VkUtils/QueueFamilyIndices.h"
@@ -15,7 +18,19 @@
 #include "VkUtils/ShaderModule.h"
 #include "VulkanRenderer.h"
 
-const static int HIZ_MIP_LEVEL = 3;
+// Written by ViewFrustumCullingCS / HiZOcclusionCullingCS / MeshletCullingCS, read back for the editor stats
+struct CullingStats {
+  uint32_t frustumVisibleCount;
+  uint32_t occlusionVisibleCount;
+  uint32_t meshletVisibleCount;
+};
+
+// ShaderSetting::cullingFlags, CULLING_FLAG_* of CommonData.glsl
+enum CullingFlag : uint32_t {
+  CULLING_FLAG_HIZ = 1 << 0,
+  CULLING_FLAG_MESHLET = 1 << 1,
+  CULLING_FLAG_MESHLET_CONE = 1 << 2,
+};
 
 class Camera;
 class CullingRenderPass : public IRenderPass {
@@ -28,13 +43,19 @@ class CullingRenderPass : public IRenderPass {
                           Editor* editor, const uint32_t width, const uint32_t height);
   virtual void Cleanup();
 
-  virtual void Update(uint32_t imageIndex);
+  void Update(uint32_t imageIndex);  // occlusion readback of the previous frame ("OcclusionReadback" task)
 
   void SetupQueryPool();
   void GetQueryResults();
+  void SetupVisibilityBuffer();  // after the scene is rebuilt, every draw starts as not visible
 
   virtual void Draw(uint32_t imageIndex, VkFence fence, VkSemaphore renderAvailable);
 
+  // Draw() split into steps for the frame task graph
+  void CullObjects(uint32_t imageIndex);
+  void Record(uint32_t imageIndex);
+  void Submit(uint32_t imageIndex, VkSemaphore renderAvailable);
+
   VkImageView& GetFrameBufferImageView() { return m_depthOnlyBufferImage.imageView; };
   VkSemaphore& GetSemaphore(uint32_t imageIndex) { return m_renderAvailable[imageIndex]; };
 
@@ -45,15 +66,21 @@ class CullingRenderPass : public IRenderPass {
 
   virtual void CreateFramebuffers();
   void CreateDepthFramebuffer();
+  void CreateHiZImage();
 
   virtual void CreatePipelineLayouts();
   virtual void CreatePipelines();
   void CreateDepthGraphicsPipeline();
+  void CreateComputePipeline(const std::string& shaderPath, VkPipelineLayout pipelineLayout, VkPipeline* pOutPipeline);
 
   virtual void CreateBuffers();
   void CreateShaderStorageBuffers();
   void CreateUniformBuffers();
   void CreateDesrciptorSets();
+  void CreateVisibilityBuffer();
+  void BindCullingDataDescriptorSets(bool isUpdate);
+  void CompactDrawCommands(const std::vector<VkDrawIndexedIndirectCommand>& commands, uint32_t imageIndex);
+  void SelectLods(uint32_t currentImage);
 
   void CreatePushConstantRange();
 
@@ -61,6 +88,11 @@ class CullingRenderPass : public IRenderPass {
   virtual void CreateCommandBuffers();
   virtual void RecordCommands(uint32_t currentImage);
   void RecordOcclusionCullingCommands(uint32_t currentImage);
+  void RecordOcclusionCullingRange(VkCommandBuffer commandBuffer, uint32_t currentImage, size_t rangeBegin, size_t rangeEnd);
+  void RecordGpuCullingCommands(uint32_t currentImage);
+  void RecordDepthPrepassCommands(uint32_t currentImage);
+  void RecordHiZBuildCommands(uint32_t currentImage);
+  void RecordMeshletCullingCommands(uint32_t currentImage, const ShaderSetting& cullingSetting);
 
  private:
   // - Main Objects
@@ -76,9 +108,11 @@ class CullingRenderPass : public IRenderPass {
   // - Rendering Graphics Pipeline
   VkCommandPool m_pGraphicsCommandPool;
   std::vector<VkCommandBuffer> m_commandBuffers;
+  VkUtils::ParallelCommandRecorder m_commandRecorder;  // Secondary command buffers (isMultiThreadingRecord)
 
   std::vector<VkSemaphore> m_renderAvailable;
   std::vector<VkFence> m_fence;
+  std::vector<VkUtils::UploadTicket> m_uploadTickets;  // Upload timeline value the frame's submit waits for
 
   // -- Only Depth Rendering Pipeline
   VkRenderPass m_depthRenderPass;
@@ -87,7 +121,27 @@ class CullingRenderPass : public IRenderPass {
   VkPipelineLayout m_graphicsPipelineLayout;
 
   GpuImage m_depthOnlyBufferImage;
-  VkFramebuffer m_depthOnlyFramebuffer;  // mipmap  .
+  VkFramebuffer m_depthOnlyFramebuffer;  // mipmap 별로 생성.
+
+  // -- GPU Culling (isGpuCulling)
+  VkPipeline m_frustumCullingPipeline;
+  VkPipelineLayout m_frustumCullingPipelineLayout;
+  VkPipeline m_hizDownsamplePipeline;
+  VkPipelineLayout m_hizDownsamplePipelineLayout;
+  VkPipeline m_hizOcclusionCullingPipeline;
+  VkPipelineLayout m_hizOcclusionCullingPipelineLayout;
+  VkPipeline m_drawCompactionPipeline;  // Use m_frustumCullingPipelineLayout
+  VkPipeline m_meshletCullingPipeline;  // Use m_hizOcclusionCullingPipelineLayout
+
+  GpuImage m_hizImage;                      // max depth pyramid, always in VK_IMAGE_LAYOUT_GENERAL
+  std::vector<VkImageView> m_hizMipViews;  // one view per mip, storage image targets of the downsample
+  uint32_t m_hizMipLevels = 1;
+
+  std::vector<GpuBuffer> m_cullingPlaneBuffers;  // frustum planes (vec4 x 6) + LOD parameters (vec4) per frame
+  std::vector<GpuBuffer> m_cullingStatsBuffers;  // CullingStats per frame
+  GpuBuffer m_visibilityBuffer;                  // uint per draw, visible in the previous frame (shared by every frame)
+
+  std::vector<uint32_t> m_miniBatchFirstIndex;  // batchIdx of the first draw of each mini-batch
 
   VkQueryPool m_occlusionQueryPool;
   std::vector<uint64_t> m_passedSamples;
@@ -95,4 +149,7 @@ class CullingRenderPass : public IRenderPass {
   VkPushConstantRange m_debugPushConstant;
 
   std::array<FrustumPlane, 6> m_frustumPlanes;
+  std::vector<VkDrawIndexedIndirectCommand> m_culledCommands;  // CullObjects() result, read when recording
+  AABBSoA m_worldBounds;                                       // world space bounds of every draw, rebuilt by CullObjects()
+  std::vector<uint32_t> m_visibleFlags;
 };
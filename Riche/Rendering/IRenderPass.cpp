@@ -21,7 +21,7 @@ IRenderPass::IRenderPass(VkDevice device, VkPhysicalDevice physicalDevice) {
   vkCreateRayTracingPipelinesKHR =
       reinterpret_cast<PFN_vkCreateRayTracingPipelinesKHR>(vkGetDeviceProcAddr(device, "vkCreateRayTracingPipelinesKHR"));
 
-  // Լ ε Ȯ
+  // 함수 로딩 확인
   if (!vkGetBufferDeviceAddressKHR || !vkCreateAccelerationStructureKHR || !vkDestroyAccelerationStructureKHR ||
       !vkGetAccelerationStructureBuildSizesKHR || !vkGetAccelerationStructureDeviceAddressKHR ||
       !vkCmdBuildAccelerationStructuresKHR || !vkBuildAccelerationStructuresKHR || !vkCmdTraceRaysKHR ||
@@ -82,19 +82,8 @@ void IRenderPass::CreateAccelerationStructure(VkDevice device, VkPhysicalDevice
   bufferCreateInfo.size = buildSizeInfo.accelerationStructureSize;
   bufferCreateInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
   VK_CHECK(vkCreateBuffer(device, &bufferCreateInfo, nullptr, &accelerationStructure.buffer));
-  VkMemoryRequirements memoryRequirements{};
-  vkGetBufferMemoryRequirements(device, accelerationStructure.buffer, &memoryRequirements);
-  VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
-  memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-  memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-  VkMemoryAllocateInfo memoryAllocateInfo{};
-  memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memoryAllocateInfo.pNext = &memoryAllocateFlagsInfo;
-  memoryAllocateInfo.allocationSize = memoryRequirements.size;
-  memoryAllocateInfo.memoryTypeIndex =
-      VkUtils::FindMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-  VK_CHECK(vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &accelerationStructure.memory));
-  VK_CHECK(vkBindBufferMemory(device, accelerationStructure.buffer, accelerationStructure.memory, 0));
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(accelerationStructure.buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                  &accelerationStructure.memory));
   // Acceleration structure
   VkAccelerationStructureCreateInfoKHR accelerationStructureCreate_info{};
   accelerationStructureCreate_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
@@ -118,25 +107,12 @@ void IRenderPass::CreateAccelerationStructureBuffer(VkDevice device, VkPhysicalD
   bufferCreateInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
   VK_CHECK(vkCreateBuffer(device, &bufferCreateInfo, nullptr, &accelerationStructure.buffer));
 
-  VkMemoryRequirements memoryRequirements{};
-  vkGetBufferMemoryRequirements(device, accelerationStructure.buffer, &memoryRequirements);
-
-  VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
-  memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-  memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-
-  VkMemoryAllocateInfo memoryAllocateInfo{};
-  memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memoryAllocateInfo.pNext = &memoryAllocateFlagsInfo;
-  memoryAllocateInfo.allocationSize = memoryRequirements.size;
-  memoryAllocateInfo.memoryTypeIndex =
-      VkUtils::FindMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-  VK_CHECK(vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &accelerationStructure.memory));
-  VK_CHECK(vkBindBufferMemory(device, accelerationStructure.buffer, accelerationStructure.memory, 0));
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(accelerationStructure.buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                  &accelerationStructure.memory));
 }
 
-ScratchBuffer IRenderPass::CreateScratchBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size) {
+ScratchBuffer IRenderPass::CreateScratchBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size,
+                                               uint32_t linearPool) {
   ScratchBuffer scratchBuffer{};
 
   // Buffer and memory
@@ -145,21 +121,8 @@ ScratchBuffer IRenderPass::CreateScratchBuffer(VkDevice device, VkPhysicalDevice
   bufferCreateInfo.size = size;
   bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
   VK_CHECK(vkCreateBuffer(device, &bufferCreateInfo, nullptr, &scratchBuffer.handle));
-
-  VkMemoryRequirements memoryRequirements{};
-  vkGetBufferMemoryRequirements(device, scratchBuffer.handle, &memoryRequirements);
-
-  VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
-  memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-  memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-  VkMemoryAllocateInfo memoryAllocateInfo = {};
-  memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memoryAllocateInfo.pNext = &memoryAllocateFlagsInfo;
-  memoryAllocateInfo.allocationSize = memoryRequirements.size;
-  memoryAllocateInfo.memoryTypeIndex =
-      VkUtils::FindMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-  VK_CHECK(vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &scratchBuffer.memory));
-  VK_CHECK(vkBindBufferMemory(device, scratchBuffer.handle, scratchBuffer.memory, 0));
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(scratchBuffer.handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &scratchBuffer.memory,
+                                                  linearPool));
 
   // Buffer device address
   VkBufferDeviceAddressInfoKHR bufferDeviceAddresInfo{};
@@ -53,8 +53,6 @@ class IRenderPass {
                           Editor* editor, const uint32_t width, const uint32_t height) = 0;
   virtual void Cleanup() = 0;
 
-  virtual void Update(uint32_t imageIndex) = 0;
-
   virtual void Draw(uint32_t imageIndex, VkFence fence, VkSemaphore renderAvailable) = 0;
 
   VkDeviceAddress GetVkDeviceAddress(VkDevice device, VkBuffer buffer);
@@ -69,7 +67,9 @@ class IRenderPass {
                                          AccelerationStructure& accelerationStructure,
                                          VkAccelerationStructureBuildSizesInfoKHR buildSizeInfo);
 
-  ScratchBuffer CreateScratchBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size);
+  // linearPool : transient scratch, released with the pool instead of FreeBufferMemory
+  ScratchBuffer CreateScratchBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size,
+                                    uint32_t linearPool = VkUtils::MemoryAllocator::INVALID_POOL);
 
  private:
   // - Rendering Pipeline
@@ -7,11 +7,19 @@ class Mesh {
 
  public:
   std::vector<BasicVertex> vertices;
-  std::vector<RayTracingVertex> ray_vertices;
   std::vector<uint32_t> indices;
-
-  uint64_t vertexOffset;
-  uint64_t indexOffset;
+  // VertexFormat::Packed scenes only, quantized copy of vertices and the row-major 3x4 that decodes its positions
+  std::vector<PackedVertex> packed_vertices;
+  VkTransformMatrixKHR vertexDecode = {{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}}};
+  // Clusters of indices, in index order (MeshletBuilder::BuildMeshlets)
+  std::vector<Meshlet> meshlets;
+  // LOD 1.. (MeshSimplifier::BuildLods), their index lists follow indices in the scene index buffer
+  std::vector<uint32_t> lod_indices;
+  std::vector<MeshLod> lods;
+
+  // Byte offsets of the mesh in BatchManager::m_verticesBuffer / m_indicesBuffer (set by AddDataToMiniBatch)
+  uint64_t vertexOffset = 0;
+  uint64_t indexOffset = 0;
 
   // Only vb
   uint32_t vertexCount = 0;
@@ -0,0 +1,116 @@
+#include "ObjectPicker.h"
+
+#include <chrono>
+
+#include "BatchSystem.h"
+#include "Camera.h"
+
+// Möller–Trumbore, both faces count as a hit (the ObjectID pass does not cull back faces either)
+static float IntersectRayTriangle(const Ray& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+  const float EPSILON = 1e-8f;
+  const float MISS = std::numeric_limits<float>::max();
+
+  glm::vec3 edge1 = v1 - v0;
+  glm::vec3 edge2 = v2 - v0;
+  glm::vec3 p = glm::cross(ray.direction, edge2);
+  float det = glm::dot(edge1, p);
+  if (std::abs(det) < EPSILON) return MISS;
+
+  float invDet = 1.0f / det;
+  glm::vec3 s = ray.origin - v0;
+  float u = glm::dot(s, p) * invDet;
+  if (u < 0.0f || u > 1.0f) return MISS;
+
+  glm::vec3 q = glm::cross(s, edge1);
+  float v = glm::dot(ray.direction, q) * invDet;
+  if (v < 0.0f || u + v > 1.0f) return MISS;
+
+  float t = glm::dot(edge2, q) * invDet;
+  return t >= 0.0f ? t : MISS;
+}
+
+Ray ObjectPicker::ScreenPointToRay(Camera& camera, glm::vec2 screenPos, glm::vec2 screenSize) {
+  // Pixel center -> NDC, the projection already flips y so the top row is -1 like the framebuffer
+  glm::vec2 ndc = (screenPos + 0.5f) / screenSize * 2.0f - 1.0f;
+
+  glm::vec4 farPoint = camera.InvView() * camera.InvProj() * glm::vec4(ndc, 1.0f, 1.0f);
+  farPoint /= farPoint.w;
+
+  Ray ray;
+  ray.origin = camera.Position();
+  ray.direction = glm::normalize(glm::vec3(farPoint) - ray.origin);
+  return ray;
+}
+
+PickResult ObjectPicker::Pick(const Ray& ray) {
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  const std::vector<Mesh>& meshes = g_BatchManager.m_meshes;
+  if (m_meshBVHs.size() != meshes.size()) Reset();
+
+  PickResult result;
+  uint32_t hitTriangle = UINT32_MAX;
+
+  // The scene BVH is fitted to the same transforms the frame is drawn with (BatchManager::RefitSceneBVH)
+  RayHit hit = g_BatchManager.m_sceneBVH.Raycast(
+      ray, std::numeric_limits<float>::max(), [&](uint32_t meshIndex, const Ray& worldRay, float& closestDistance) {
+        if (meshIndex >= meshes.size()) return false;
+
+        // Object space ray, the direction is not renormalized so t stays a world space distance
+        glm::mat4 worldToObject = glm::inverse(g_BatchManager.m_sceneBVHTransforms[meshIndex]);
+        Ray objectRay;
+        objectRay.origin = glm::vec3(worldToObject * glm::vec4(worldRay.origin, 1.0f));
+        objectRay.direction = glm::vec3(worldToObject * glm::vec4(worldRay.direction, 0.0f));
+
+        const Mesh& mesh = meshes[meshIndex];
+        RayHit triangleHit =
+            GetMeshBVH(meshIndex).Raycast(objectRay, closestDistance, [&mesh](uint32_t triangle, const Ray& r, float& closest) {
+              float t = IntersectRayTriangle(r, mesh.vertices[mesh.indices[triangle * 3 + 0]].pos,
+                                             mesh.vertices[mesh.indices[triangle * 3 + 1]].pos,
+                                             mesh.vertices[mesh.indices[triangle * 3 + 2]].pos);
+              if (t >= closest) return false;
+              closest = t;
+              return true;
+            });
+        if (!triangleHit.IsHit()) return false;
+
+        closestDistance = triangleHit.distance;
+        hitTriangle = triangleHit.primitive;
+        return true;
+      });
+
+  if (hit.IsHit()) {
+    result.entity = static_cast<int>(hit.primitive);
+    result.distance = hit.distance;
+    result.triangle = hitTriangle;
+    result.position = ray.origin + ray.direction * hit.distance;
+  }
+  result.timeUs = std::chrono::duration<float, std::micro>(std::chrono::high_resolution_clock::now() - begin).count();
+
+  m_lastResult = result;
+  return result;
+}
+
+void ObjectPicker::Reset() {
+  m_meshBVHs.clear();
+  m_meshBVHs.resize(g_BatchManager.m_meshes.size());
+}
+
+const BVH& ObjectPicker::GetMeshBVH(uint32_t meshIndex) {
+  std::unique_ptr<BVH>& bvh = m_meshBVHs[meshIndex];
+  if (bvh) return *bvh;
+
+  // One primitive per triangle, object space
+  const Mesh& mesh = g_BatchManager.m_meshes[meshIndex];
+  std::vector<AABB> triangleBoxes(mesh.indices.size() / 3);
+  for (size_t i = 0; i < triangleBoxes.size(); ++i) {
+    glm::vec3 v0 = mesh.vertices[mesh.indices[i * 3 + 0]].pos;
+    glm::vec3 v1 = mesh.vertices[mesh.indices[i * 3 + 1]].pos;
+    glm::vec3 v2 = mesh.vertices[mesh.indices[i * 3 + 2]].pos;
+    triangleBoxes[i] = {glm::vec4(glm::min(glm::min(v0, v1), v2), 1.0f), glm::vec4(glm::max(glm::max(v0, v1), v2), 1.0f)};
+  }
+
+  bvh = std::make_unique<BVH>();
+  bvh->Build(triangleBoxes);
+  return *bvh;
+}
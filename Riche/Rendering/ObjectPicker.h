@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Utils/BVH.h"
+#include "Utils/Singleton.h"
+
+class Camera;
+
+struct PickResult {
+  int entity = -1;  // mesh index (the same id the ObjectID pass writes), -1 on a miss
+  float distance = std::numeric_limits<float>::max();
+  uint32_t triangle = UINT32_MAX;  // index of the first index of the triangle inside the mesh / 3
+  glm::vec3 position = glm::vec3(0.0f);
+  float timeUs = 0.0f;
+};
+
+/*
+ * ObjectPicker : mouse picking on the CPU, nothing is read back from the GPU
+ *  - Camera ray -> g_BatchManager.m_sceneBVH (world space mesh boxes) -> per mesh triangle BVH in object space.
+ *  - Triangle BVHs are built the first time a ray reaches the mesh's box and kept until the scene changes,
+ *    so a scene with millions of triangles does not pay for meshes nobody clicks on.
+ */
+class ObjectPicker : public Singleton<ObjectPicker> {
+  friend class Singleton<ObjectPicker>;
+
+ public:
+  static Ray ScreenPointToRay(Camera& camera, glm::vec2 screenPos, glm::vec2 screenSize);
+
+  PickResult Pick(const Ray& ray);
+  void Reset();  // Drops every triangle BVH, BatchManager::RebuildBatchManager calls it when the meshes change
+
+  const PickResult& GetLastResult() const { return m_lastResult; }
+
+ private:
+  ObjectPicker() = default;
+
+  const BVH& GetMeshBVH(uint32_t meshIndex);
+
+  std::vector<std::unique_ptr<BVH>> m_meshBVHs;  // per mesh, nullptr until first needed
+  PickResult m_lastResult;
+};
+
+#define g_ObjectPicker ObjectPicker::Get()
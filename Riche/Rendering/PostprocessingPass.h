@@ -80,5 +80,5 @@
 //  VkPipelineLayout m_graphicsPipelineLayout;
 //
 //  GpuImage m_depthOnlyBufferImage;
-//  VkFramebuffer m_depthOnlyFramebuffer;  // mipmap  .d
+//  VkFramebuffer m_depthOnlyFramebuffer;  // mipmap 별로 생성.d
 //};
@@ -8,12 +8,35 @@ class RenderSetting : public Singleton<RenderSetting> {
  public:
   bool isWireRendering = false;
   bool isOcclusionCulling = true;
+  bool isGpuCulling = true;  // Frustum + Hi-Z occlusion culling in compute, no CPU readback of the draw commands
+  bool isBvhCulling = true;  // CPU frustum culling walks g_BatchManager.m_sceneBVH instead of every box
+  bool isMeshletCulling = true;  // GPU culling only : meshlets of the visible draws are culled again, survivors are drawn
+  bool isMeshletConeCulling = false;  // Back-facing meshlets too, off since every pipeline draws both faces (VK_CULL_MODE_NONE)
+  bool isLodSelection = true;  // Draws switch to a simplified level (Mesh::lods) below lodScreenSize pixels
+  float lodScreenSize = 256.0f;  // projected AABB size where LOD 1 starts, every halving goes one level further
+  bool isTextureMipmaps = true;  // Off clamps LightingPS to mip 0 (the old sampling) to compare texture bandwidth in one scene
+  bool isTextureCookOnLoad = false;  // Loader jobs BCn encode textures without an up to date .rtex (slow first load, see --cook)
+  bool isTextureStreaming = true;  // Set before a scene is loaded : textures load their mip tail, TextureStreamer pages in the rest
+  int textureBudgetMB = 256;  // TextureStreamer residency, the least recently wanted textures drop back to their tail above it
+  float textureStreamingBias = 1.0f;  // levels finer than the screen-size estimate (UVs usually tile more than once)
+  bool isTexturePacking = true;  // Set before a scene is loaded : small power of two textures share atlas pages (TexturePacker)
+  bool isGpuPicking = false;  // Debug only : read the ObjectID image back instead of the CPU ray cast (stalls the queue)
   bool isRenderBoundingBox = false;
   bool isMultiThreading = false;
+  bool isMultiThreadingRecord = false;  // Record passes into secondary command buffers on g_ThreadPool
 
   int beforeCullingRenderingNum = 0;
   int afterViewCullingRenderingNum = 0;
   int afterOcclusionCullingRenderingNum = 0;
+  float drawCompactionRatio = 1.0f;  // surviving / total draw commands after compaction
+  int meshletNum = 0;
+  int afterMeshletCullingNum = 0;
+  float residentTextureMB = 0.0f;
+  int loadingTextureNum = 0;
+
+  float cullingRecordTimeMs = 0.0f;
+  float lightingRecordTimeMs = 0.0f;
+  float pickTimeUs = 0.0f;
 
 
 
@@ -0,0 +1,327 @@
+#include "TextureStreamer.h"
+
+#include "BatchSystem.h"
+#include "RenderSetting.h"
+
+uint32_t TextureStreamer::ComputeTailMip(uint32_t width, uint32_t height, uint32_t mipCount) {
+  uint32_t mip = 0;
+  while (mip + 1 < mipCount && ((std::max)(width, height) >> mip) > TAIL_SIZE) ++mip;
+  return mip;
+}
+
+VkDeviceSize TextureStreamer::ComputeChainBytes(VkFormat format, uint32_t width, uint32_t height, uint32_t firstMip,
+                                                uint32_t mipCount) {
+  VkDeviceSize bytes = 0;
+  for (uint32_t mip = firstMip; mip < mipCount; ++mip) {
+    const VkDeviceSize levelWidth = (std::max)(width >> mip, 1u);
+    const VkDeviceSize levelHeight = (std::max)(height >> mip, 1u);
+    if (format == VK_FORMAT_R8G8B8A8_UNORM) {
+      bytes += levelWidth * levelHeight * 4;
+    } else {
+      bytes += ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * TextureCooker::GetBlockSize(format);
+    }
+  }
+  return bytes;
+}
+
+void TextureStreamer::AddTexture(uint32_t index, const VkUtils::ResourceManager::DecodedTexture& texture, VkFormat format) {
+  if (index >= m_textures.size()) m_textures.resize(index + 1);
+
+  StreamedTexture& streamed = m_textures[index];
+  streamed.path = texture.filename;
+  streamed.format = format;
+  streamed.width = static_cast<uint32_t>(texture.sourceWidth);
+  streamed.height = static_cast<uint32_t>(texture.sourceHeight);
+  streamed.mipCount = VkUtils::ComputeMipLevels(streamed.width, streamed.height);
+  streamed.tailMip = ComputeTailMip(streamed.width, streamed.height, streamed.mipCount);
+  streamed.residentMip = texture.firstMip;
+  streamed.wantedMip = streamed.tailMip;
+  streamed.lastWantedFrame = 0;
+}
+
+void TextureStreamer::ResetTexture(uint32_t index, const VkUtils::ResourceManager::DecodedTexture& texture, VkFormat format) {
+  if (index >= m_textures.size()) return;
+
+  StreamedTexture& streamed = m_textures[index];
+  if (streamed.pendingImage.image != VK_NULL_HANDLE) m_retiredImages.push_back(streamed.pendingImage);
+  streamed.pendingImage = {};
+  if (streamed.job.valid()) stbi_image_free(streamed.job.get().pixels);
+  streamed.isLoading = false;
+  AddTexture(index, texture, format);
+}
+
+void TextureStreamer::Update(VkDevice device, const glm::mat4& viewProj, const glm::vec2& viewport, uint32_t imageIndex,
+                             int currentFrame) {
+  // The fence of currentFrame signalled, every frame up to the one that retired these has finished
+  for (const RetiredImage& retired : m_frameRetiredImages[currentFrame]) {
+    if (retired.imguiTextureID != VK_NULL_HANDLE) ImGui_ImplVulkan_RemoveTexture(retired.imguiTextureID);
+    DestroyImage(device, retired.image);
+  }
+  m_frameRetiredImages[currentFrame].clear();
+
+  if (m_textures.empty()) return;
+  ++m_frame;
+
+  UploadDecodedTextures(device);
+  SwapAcquiredTextures(device, imageIndex, currentFrame);
+
+  if (m_frame % UPDATE_INTERVAL == 0) {
+    UpdateWantedMips(viewProj, viewport, imageIndex);
+    ScheduleLoads();
+  }
+
+  g_RenderSetting.residentTextureMB = static_cast<float>(GetResidentBytes()) / (1024.0f * 1024.0f);
+  g_RenderSetting.loadingTextureNum = static_cast<int>(GetLoadingCount());
+}
+
+// Finest level any visible mesh using the texture asks for, the textures nobody sees ask for their tail only
+void TextureStreamer::UpdateWantedMips(const glm::mat4& viewProj, const glm::vec2& viewport, uint32_t imageIndex) {
+  const std::vector<ObjectID>& objectIDs = g_BatchManager.m_objectIDList;
+  const std::vector<AABB>& boxes = g_BatchManager.m_boundingBoxList;
+  const std::vector<Transform>& transforms = g_BatchManager.m_transforms[imageIndex];
+  const std::array<FrustumPlane, 6> frustum = CalculateFrustumPlanes(viewProj);
+
+  std::vector<uint32_t> wantedMips(m_textures.size(), UINT32_MAX);
+  const size_t meshCount = (std::min)(objectIDs.size(), (std::min)(boxes.size(), transforms.size()));
+  for (size_t i = 0; i < meshCount; ++i) {
+    // Atlas pages (TexturePacker) and the single tiles left over were never added, their textures are resident as a whole
+    const int textureIndex = objectIDs[i].textureIndex;
+    if (textureIndex < 0 || textureIndex >= static_cast<int>(m_textures.size()) || m_textures[textureIndex].path.empty()) continue;
+
+    const glm::mat4& model = transforms[i].currentTransform;
+    if (!isAABBInsideFrustum(frustum, TransformAABB(boxes[i], model))) continue;
+
+    // Texels across the largest side over the pixels the mesh covers, each doubling is one level coarser
+    const StreamedTexture& texture = m_textures[textureIndex];
+    const float projectedSize = (std::max)(ComputeProjectedSize(boxes[i], viewProj * model, viewport), 1.0f);
+    const float level = std::log2(static_cast<float>((std::max)(texture.width, texture.height)) / projectedSize) -
+                        g_RenderSetting.textureStreamingBias;
+    const uint32_t mip = level > 0.0f ? (std::min)(static_cast<uint32_t>(level), texture.tailMip) : 0;
+    wantedMips[textureIndex] = (std::min)(wantedMips[textureIndex], mip);
+  }
+
+  for (size_t i = 0; i < m_textures.size(); ++i) {
+    StreamedTexture& texture = m_textures[i];
+    if (wantedMips[i] == UINT32_MAX) {
+      texture.wantedMip = texture.tailMip;
+      continue;
+    }
+    texture.wantedMip = wantedMips[i];
+    texture.lastWantedFrame = m_frame;
+  }
+}
+
+void TextureStreamer::UploadDecodedTextures(VkDevice device) {
+  bool isUploading = false;
+  for (StreamedTexture& texture : m_textures) {
+    if (!texture.isLoading || !texture.job.valid() || !texture.job.IsReady()) continue;
+
+    // Every upload of the frame shares one staging ring submit
+    if (!isUploading) {
+      g_ResourceManager.BeginUploadBatch();
+      isUploading = true;
+    }
+
+    VkUtils::ResourceManager::DecodedTexture decoded = texture.job.get();
+    GpuImage& image = texture.pendingImage;
+    VkFormat format;
+    g_ResourceManager.UploadTexture(decoded, &image.memory, &image.image, &image.size, &format);
+    VkUtils::CreateImageView(device, image.image, &image.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+
+    // The file may hold fewer levels than asked for, or the .rtex may have changed since the texture was added
+    texture.loadingMip = decoded.firstMip;
+    texture.format = format;
+  }
+  if (isUploading) g_ResourceManager.EndUploadBatch(true);
+}
+
+void TextureStreamer::SwapAcquiredTextures(VkDevice device, uint32_t imageIndex, int currentFrame) {
+  // Uploads dropped before they were swapped in, their acquire was recorded by this frame at the latest
+  auto retiredEnd = std::partition(m_retiredImages.begin(), m_retiredImages.end(),
+                                   [](const GpuImage& image) { return g_ResourceManager.IsAcquirePending(image.image); });
+  for (auto iter = retiredEnd; iter != m_retiredImages.end(); ++iter) m_frameRetiredImages[currentFrame].push_back({*iter});
+  m_retiredImages.erase(retiredEnd, m_retiredImages.end());
+
+  for (uint32_t i = 0; i < m_textures.size(); ++i) {
+    StreamedTexture& texture = m_textures[i];
+    if (texture.pendingImage.image == VK_NULL_HANDLE || g_ResourceManager.IsAcquirePending(texture.pendingImage.image)) continue;
+
+    // The frames in flight still sample the old image (and draw its ImGui id), it waits until every set dropped it
+    GpuImage& image = g_BatchManager.m_diffuseImages[i];
+    VkDescriptorSet& imguiTextureID = g_BatchManager.m_textureIdList[i];
+    m_swappedOutImages.push_back({image, imguiTextureID, i});
+    image = texture.pendingImage;
+    texture.pendingImage = {};
+    texture.residentMip = texture.loadingMip;
+    texture.isLoading = false;
+    imguiTextureID = ImGui_ImplVulkan_AddTexture(g_BatchManager.m_sampler, image.imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    for (std::vector<uint32_t>& elements : m_staleElements) {
+      if (std::find(elements.begin(), elements.end(), i) == elements.end()) elements.push_back(i);
+    }
+  }
+
+  WriteStaleElements(device, imageIndex);
+
+  // Held by no set anymore, the frames that bound one holding it are this frame at the latest
+  auto heldEnd = std::partition(m_swappedOutImages.begin(), m_swappedOutImages.end(), [this](const RetiredImage& retired) {
+    return std::any_of(m_staleElements.begin(), m_staleElements.end(), [&retired](const std::vector<uint32_t>& elements) {
+      return std::find(elements.begin(), elements.end(), retired.index) != elements.end();
+    });
+  });
+  m_frameRetiredImages[currentFrame].insert(m_frameRetiredImages[currentFrame].end(), heldEnd, m_swappedOutImages.end());
+  m_swappedOutImages.erase(heldEnd, m_swappedOutImages.end());
+}
+
+// The set of imageIndex is not used by a pending frame, it catches up on the swaps the other frames made
+void TextureStreamer::WriteStaleElements(VkDevice device, uint32_t imageIndex) {
+  std::vector<uint32_t>& elements = m_staleElements[imageIndex];
+  if (elements.empty()) return;
+
+  std::vector<VkDescriptorImageInfo> imageInfos(elements.size());
+  std::vector<VkWriteDescriptorSet> writes(elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    imageInfos[i].sampler = g_BatchManager.m_sampler;
+    imageInfos[i].imageView = g_BatchManager.m_diffuseImages[elements[i]].imageView;
+    imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    // Only the element of the texture, UPDATE_AFTER_BIND binding of the bindless set
+    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet = g_DescriptorManager.GetVkDescriptorSet("DiffuseTextureList" + std::to_string(imageIndex));
+    writes[i].dstBinding = 0;
+    writes[i].dstArrayElement = elements[i];
+    writes[i].descriptorCount = 1;
+    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    writes[i].pImageInfo = &imageInfos[i];
+  }
+  vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  elements.clear();
+}
+
+void TextureStreamer::DestroyImage(VkDevice device, const GpuImage& image) {
+  vkDestroyImageView(device, image.imageView, nullptr);
+  g_MemoryAllocator.FreeImageMemory(image.image);
+  vkDestroyImage(device, image.image, nullptr);
+}
+
+// Bytes the texture holds once its load finished, a finer load counts from the moment it starts
+VkDeviceSize TextureStreamer::GetCommittedBytes(const StreamedTexture& texture) const {
+  uint32_t mip = texture.isLoading ? (std::min)(texture.residentMip, texture.loadingMip) : texture.residentMip;
+  return ComputeChainBytes(texture.format, texture.width, texture.height, mip, texture.mipCount);
+}
+
+void TextureStreamer::ScheduleLoads() {
+  const VkDeviceSize budget = static_cast<VkDeviceSize>((std::max)(g_RenderSetting.textureBudgetMB, 0)) * 1024 * 1024;
+
+  VkDeviceSize committedBytes = 0;
+  uint32_t loadCount = 0;
+  for (const StreamedTexture& texture : m_textures) {
+    committedBytes += GetCommittedBytes(texture);
+    if (texture.isLoading) ++loadCount;
+  }
+
+  // LRU : textures nobody wanted in the last pass go back to their tail, visible ones only give up what they do not need
+  std::vector<uint32_t> victims;
+  for (uint32_t i = 0; i < m_textures.size(); ++i) {
+    const StreamedTexture& texture = m_textures[i];
+    if (!texture.isLoading && texture.residentMip < texture.wantedMip) victims.push_back(i);
+  }
+  std::sort(victims.begin(), victims.end(),
+            [this](uint32_t a, uint32_t b) { return m_textures[a].lastWantedFrame < m_textures[b].lastWantedFrame; });
+  size_t nextVictim = 0;
+  auto evict = [&](uint64_t newerThan) {
+    if (nextVictim == victims.size() || loadCount >= MAX_LOADS_IN_FLIGHT) return false;
+    StreamedTexture& victim = m_textures[victims[nextVictim]];
+    if (victim.lastWantedFrame >= newerThan) return false;
+
+    // The bytes come back when the coarser image is swapped in, this pass already counts them as free
+    const VkDeviceSize freedBytes =
+        GetCommittedBytes(victim) - ComputeChainBytes(victim.format, victim.width, victim.height, victim.wantedMip, victim.mipCount);
+    Load(victims[nextVictim++], victim.wantedMip);
+    committedBytes -= freedBytes;
+    ++loadCount;
+    return true;
+  };
+
+  // The budget went down (or the editor loaded a full texture)
+  while (committedBytes > budget && evict(UINT64_MAX)) {
+  }
+
+  // Most recently wanted first, then the ones furthest from what they want
+  std::vector<uint32_t> requests;
+  for (uint32_t i = 0; i < m_textures.size(); ++i) {
+    const StreamedTexture& texture = m_textures[i];
+    if (!texture.isLoading && texture.wantedMip < texture.residentMip) requests.push_back(i);
+  }
+  std::sort(requests.begin(), requests.end(), [this](uint32_t a, uint32_t b) {
+    const StreamedTexture& textureA = m_textures[a];
+    const StreamedTexture& textureB = m_textures[b];
+    if (textureA.lastWantedFrame != textureB.lastWantedFrame) return textureA.lastWantedFrame > textureB.lastWantedFrame;
+    return textureA.residentMip - textureA.wantedMip > textureB.residentMip - textureB.wantedMip;
+  });
+
+  for (uint32_t index : requests) {
+    if (loadCount >= MAX_LOADS_IN_FLIGHT) break;
+
+    // The finest level that fits, otherwise make room for the next pass
+    StreamedTexture& texture = m_textures[index];
+    const VkDeviceSize residentBytes = GetCommittedBytes(texture);
+    bool isScheduled = false;
+    for (uint32_t mip = texture.wantedMip; mip < texture.residentMip; ++mip) {
+      const VkDeviceSize bytes = ComputeChainBytes(texture.format, texture.width, texture.height, mip, texture.mipCount);
+      if (committedBytes - residentBytes + bytes > budget) continue;
+
+      Load(index, mip);
+      committedBytes += bytes - residentBytes;
+      ++loadCount;
+      isScheduled = true;
+      break;
+    }
+    if (!isScheduled) evict(texture.lastWantedFrame);
+  }
+}
+
+void TextureStreamer::Load(uint32_t index, uint32_t mip) {
+  StreamedTexture& texture = m_textures[index];
+  const uint32_t maxSize = (std::max)((std::max)(texture.width, texture.height) >> mip, 1u);
+  const bool isCooking = g_RenderSetting.isTextureCookOnLoad;
+
+  texture.job = g_ThreadPool.Submit([path = texture.path, isCooking, maxSize]() {
+    return VkUtils::ResourceManager::DecodeTexture(path, TextureCooker::TextureSlot::BaseColor, isCooking, maxSize);
+  });
+  texture.isLoading = true;
+  texture.loadingMip = mip;
+}
+
+void TextureStreamer::Cleanup(VkDevice device) {
+  for (StreamedTexture& texture : m_textures) {
+    if (texture.job.valid()) stbi_image_free(texture.job.get().pixels);
+    if (texture.pendingImage.image != VK_NULL_HANDLE) m_retiredImages.push_back(texture.pendingImage);
+  }
+  for (const GpuImage& image : m_retiredImages) DestroyImage(device, image);
+  m_retiredImages.clear();
+
+  // The ImGui ids went with the ImGui descriptor pool (Editor::Cleanup)
+  for (const RetiredImage& retired : m_swappedOutImages) DestroyImage(device, retired.image);
+  m_swappedOutImages.clear();
+  for (std::vector<RetiredImage>& images : m_frameRetiredImages) {
+    for (const RetiredImage& retired : images) DestroyImage(device, retired.image);
+    images.clear();
+  }
+  for (std::vector<uint32_t>& elements : m_staleElements) elements.clear();
+  m_textures.clear();
+}
+
+VkDeviceSize TextureStreamer::GetResidentBytes() const {
+  VkDeviceSize bytes = 0;
+  for (const StreamedTexture& texture : m_textures) {
+    bytes += ComputeChainBytes(texture.format, texture.width, texture.height, texture.residentMip, texture.mipCount);
+  }
+  return bytes;
+}
+
+uint32_t TextureStreamer::GetLoadingCount() const {
+  return static_cast<uint32_t>(std::count_if(m_textures.begin(), m_textures.end(), [](const StreamedTexture& texture) {
+    return texture.isLoading;
+  }));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Image.h"
+#include "Utils/Singleton.h"
+#include "Utils/ThreadPool.h"
+#include "VkUtils/ResourceManager.h"
+
+/*
+ * TextureStreamer : mip residency of BatchManager::m_diffuseImages under RenderSetting::textureBudgetMB
+ *  - Scenes load the mip tail of every texture only (largest side <= TAIL_SIZE). The image of a texture always holds
+ *    residentMip .. its last mip, a finer or coarser residency is a new image swapped in for the old one.
+ *  - The wanted mip comes from the same screen-size estimate as the LOD selection (ComputeProjectedSize of the meshes using the
+ *    texture), assuming their UVs cover the texture once, plus RenderSetting::textureStreamingBias finer levels.
+ *  - New residencies are decoded on g_ThreadPool (ResourceManager::DecodeTexture with maxSize), uploaded through the staging ring
+ *    and written into u_DiffuseTextureList in place once the graphics queue acquired them. There is one set per frame in flight,
+ *    a set is only written when its own frame comes, the old image goes when no set holds it and its last frame finished.
+ *  - Over budget the least recently wanted textures drop back to their tail first (LRU on lastWantedFrame).
+ */
+
+struct StreamedTexture {
+  std::string path;
+  VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+  uint32_t width = 0;  // mip 0 of the source
+  uint32_t height = 0;
+  uint32_t mipCount = 1;
+  uint32_t tailMip = 0;
+
+  uint32_t residentMip = 0;  // finest level in m_diffuseImages
+  uint32_t wantedMip = 0;
+  uint64_t lastWantedFrame = 0;
+
+  // - A new residency on its way : decoding (job) -> uploaded, not acquired yet (pendingImage) -> swapped
+  bool isLoading = false;
+  uint32_t loadingMip = 0;
+  JobHandle<VkUtils::ResourceManager::DecodedTexture> job;
+  GpuImage pendingImage;
+};
+
+class TextureStreamer : public Singleton<TextureStreamer> {
+  friend class Singleton<TextureStreamer>;
+
+ public:
+  static constexpr uint32_t TAIL_SIZE = 64;
+  static constexpr uint32_t MAX_LOADS_IN_FLIGHT = 4;
+  static constexpr uint32_t UPDATE_INTERVAL = 4;  // frames between two wanted mip passes over the meshes
+
+  // Registers m_diffuseImages[index], loaded by the model loader from DecodeTexture(path, ..., TAIL_SIZE)
+  void AddTexture(uint32_t index, const VkUtils::ResourceManager::DecodedTexture& texture, VkFormat format);
+  // The editor replaced the image (full residency), an older load of the slot is dropped
+  void ResetTexture(uint32_t index, const VkUtils::ResourceManager::DecodedTexture& texture, VkFormat format);
+
+  // Once per frame before the lighting pass is recorded, after Draw waited the fence of currentFrame. Nothing is waited here,
+  // only the DiffuseTextureList set of imageIndex is written.
+  void Update(VkDevice device, const glm::mat4& viewProj, const glm::vec2& viewport, uint32_t imageIndex, int currentFrame);
+  void Cleanup(VkDevice device);
+
+  VkDeviceSize GetResidentBytes() const;
+  uint32_t GetLoadingCount() const;
+
+  static uint32_t ComputeTailMip(uint32_t width, uint32_t height, uint32_t mipCount);
+  static VkDeviceSize ComputeChainBytes(VkFormat format, uint32_t width, uint32_t height, uint32_t firstMip, uint32_t mipCount);
+
+ private:
+  TextureStreamer() = default;
+
+  struct RetiredImage {
+    GpuImage image;
+    VkDescriptorSet imguiTextureID = VK_NULL_HANDLE;
+    uint32_t index = UINT32_MAX;  // element of u_DiffuseTextureList it was swapped out of
+  };
+
+  void UpdateWantedMips(const glm::mat4& viewProj, const glm::vec2& viewport, uint32_t imageIndex);
+  void UploadDecodedTextures(VkDevice device);
+  void SwapAcquiredTextures(VkDevice device, uint32_t imageIndex, int currentFrame);
+  void WriteStaleElements(VkDevice device, uint32_t imageIndex);
+  void DestroyImage(VkDevice device, const GpuImage& image);
+  void ScheduleLoads();
+  void Load(uint32_t index, uint32_t mip);
+  VkDeviceSize GetCommittedBytes(const StreamedTexture& texture) const;
+
+  std::vector<StreamedTexture> m_textures;       // same index as m_diffuseImages (ObjectID::textureIndex)
+  std::vector<GpuImage> m_retiredImages;         // uploads nobody swaps in anymore, retired once acquired
+  std::vector<RetiredImage> m_swappedOutImages;  // still held by a DiffuseTextureList set not rewritten yet
+  // Per DiffuseTextureList set (imageIndex) the elements other frames swapped, per currentFrame what goes once it comes again
+  std::array<std::vector<uint32_t>, MAX_FRAME_DRAWS> m_staleElements;
+  std::array<std::vector<RetiredImage>, MAX_FRAME_DRAWS> m_frameRetiredImages;
+  uint64_t m_frame = 0;
+};
+
+#define g_TextureStreamer TextureStreamer::Get()
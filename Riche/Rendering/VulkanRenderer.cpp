@@ -4,6 +4,7 @@
 #include "Camera.h"
 #include "CullingRenderPass.h"
 #include "Editor/Editor.h"
+#include "TextureStreamer.h"
 
 namespace {
 VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
@@ -35,6 +36,7 @@ void VulkanRenderer::Initialize(GLFWwindow* newWindow, Camera* camera) {
     CreateSurface();
     GetPhysicalDevice();
     CreateLogicalDevice();
+    g_MemoryAllocator.Initialize(mainDevice.logicalDevice, mainDevice.physicalDevice);  // before the first buffer / image
     CreateSwapChain();
 
     CreateCommandPool();
@@ -51,51 +53,46 @@ void VulkanRenderer::Initialize(GLFWwindow* newWindow, Camera* camera) {
     m_pEditor->Initialize(window, instance, mainDevice.logicalDevice, mainDevice.physicalDevice, m_queueFamilyIndices, m_graphicsQueue,
                           m_camera);
 
-    // ü ġ  Ķ 
+    // 물체 배치를 위한 파라미터 설정
     const int numColumns = 1;
-    const int numRows = 1;          // 5 * 4 = 20  ü
-    const float spacingX = 200.0f;  // X 
-    const float spacingZ = 200.0f;  // Z 
-    const float baseHeight = 0.0f;  //  ü 
+    const int numRows = 1;          // 5 * 4 = 20 개의 물체
+    const float spacingX = 200.0f;  // X축 간격
+    const float spacingZ = 200.0f;  // Z축 간격
+    const float baseHeight = 0.0f;  // 모든 물체의 높이
 
-    // Mesh   ( ڵ )
+    // Mesh들을 저장할 벡터 (기존 코드와 동일)
     std::vector<Mesh>& outMeshes = g_BatchManager.m_meshes;
 
-    //  ׸ ġ  ü εմϴ.
+    // 각 그리드 위치에 대해 물체를 로드합니다.
     for (int row = 0; row < numRows; ++row) {
       for (int col = 0; col < numColumns; ++col) {
-        //  ġ: x z ڿ , y 
+        // 계산된 위치: x와 z는 격자에 따라, y는 고정
         glm::vec3 pos(col * spacingX, baseHeight, row * spacingZ);
-        // ġ  ڷ ߰ ε loadGltfModel ȣ
+        // 위치 정보를 인자로 추가한 오버로딩된 loadGltfModel 호출
       }
     }
+    // Every vertex/index/texture upload of the scene goes through a handful of staging ring submits,
+    // the first culling submit waits for them on the GPU
+    g_ResourceManager.BeginUploadBatch();
+    // Sponza is static, so it is rasterized and traced from 16 byte quantized vertices (must be set before loading)
+    g_BatchManager.m_vertexFormat = VertexFormat::Packed;
     loadGltfModel(mainDevice.logicalDevice, "Resources/Models/Sponza/glTF/", "sponza.gltf", outMeshes, 0.1f);
 
-    //   ڵ忡  BatchManager ͸ flushϰų ߰ ۾ 
-    g_BatchManager.FlushMiniBatch(g_BatchManager.m_miniBatchList, g_ResourceManager);
+    // 이후 기존 코드에 따라 BatchManager의 데이터를 flush하거나 추가 작업 진행
+    g_BatchManager.FlushMiniBatch(g_BatchManager.m_miniBatchList);
+    g_ResourceManager.EndUploadBatch();
 
-    int rayCount = 0, count = 0;
-    for (Mesh& mesh : outMeshes) {
-      for (RayTracingVertex& vertex : mesh.ray_vertices) {
-        g_BatchManager.m_allMeshVertices.push_back(vertex);
-      }
-      for (uint32_t& index : mesh.indices) {
-        g_BatchManager.m_allMeshIndices.push_back(index);
-      }
-      mesh.vertexOffset = g_BatchManager.m_accmulatedVertexOffset;
-      mesh.indexOffset = g_BatchManager.m_accmulatedIndexOffset;
-      g_BatchManager.m_accmulatedVertexOffset += mesh.ray_vertices.size() * sizeof(RayTracingVertex);
-      g_BatchManager.m_accmulatedIndexOffset += mesh.indices.size() * sizeof(uint32_t);
-      rayCount += mesh.ray_vertices.size();
-      count += mesh.vertices.size();
-    }
+    uint64_t vertexCount = 0;
+    for (const Mesh& mesh : outMeshes) vertexCount += mesh.vertexCount;
 
-    // ü ߰Ǹ, ⿡ Լ ߰Ǵ Ͱ  ȿ ̰ ϰ ;
+    // 물체가 추가되면, 여기에 함수가 추가되는 것과 같은 효과를 보이게 하고 싶어
 
-    std::cout << "Ray : " << rayCount << " Non : " << count << std::endl;
+    std::cout << "Vertices : " << vertexCount << " | vertex memory " << vertexCount * g_BatchManager.GetVertexStride() / 1024
+              << " KB (full format " << vertexCount * sizeof(BasicVertex) / 1024 << " KB)" << std::endl;
 
     g_BatchManager.CreateBatchManagerBuffers(mainDevice.logicalDevice, mainDevice.physicalDevice);
     g_BatchManager.CreateDescriptorSets(mainDevice.logicalDevice, mainDevice.physicalDevice);
+    g_BatchManager.BuildSceneBVH();
 
     CreateBuffers();
 
@@ -109,6 +106,7 @@ void VulkanRenderer::Initialize(GLFWwindow* newWindow, Camera* camera) {
 
     m_pEditor->m_pCullingPass = m_pCullingRenderPass.get();
     m_pEditor->m_pLightingPass = m_pLightingRenderPass.get();
+    m_pEditor->m_pFrameGraph = &m_frameGraph;
 
     /// OffScreen Pipeline
     CreateRenderPass();
@@ -116,6 +114,8 @@ void VulkanRenderer::Initialize(GLFWwindow* newWindow, Camera* camera) {
     CreateOffScrrenDescriptorSet();
     CreatePipelines();
 
+    CreateFrameGraph();
+
   } catch (const std::runtime_error& e) {
     printf("ERROR: %s\n", e.what());
     return;
@@ -124,32 +124,23 @@ void VulkanRenderer::Initialize(GLFWwindow* newWindow, Camera* camera) {
   return;
 }
 
-void VulkanRenderer::Update(uint32_t imageIndex) {
+void VulkanRenderer::UpdateCamera(uint32_t imageIndex) {
   void* pData = nullptr;
 
-  g_BatchManager.Update(mainDevice.logicalDevice, imageIndex);
-  // Camera Update
-  {
-    m_camera->Update();
-
-    m_viewProjections[imageIndex].prevView = m_viewProjections[imageIndex].view;
-    m_viewProjections[imageIndex].prevProjection = m_viewProjections[imageIndex].projection;
-    m_viewProjections[imageIndex].prevViewInverse = m_viewProjections[imageIndex].viewInverse;
-    m_viewProjections[imageIndex].prevProjInverse = m_viewProjections[imageIndex].projInverse;
+  m_camera->Update();
 
-    m_viewProjections[imageIndex].view = m_camera->View();
-    m_viewProjections[imageIndex].projection = m_camera->Proj();
-    m_viewProjections[imageIndex].viewInverse = m_camera->InvView();
-    m_viewProjections[imageIndex].projInverse = m_camera->InvProj();
+  m_viewProjections[imageIndex].prevView = m_viewProjections[imageIndex].view;
+  m_viewProjections[imageIndex].prevProjection = m_viewProjections[imageIndex].projection;
+  m_viewProjections[imageIndex].prevViewInverse = m_viewProjections[imageIndex].viewInverse;
+  m_viewProjections[imageIndex].prevProjInverse = m_viewProjections[imageIndex].projInverse;
 
-    vkMapMemory(mainDevice.logicalDevice, m_viewProjectionBuffers[imageIndex].memory, 0, sizeof(ViewProjection), 0, &pData);
-    memcpy(pData, &m_viewProjections[imageIndex], sizeof(ViewProjection));
-    vkUnmapMemory(mainDevice.logicalDevice, m_viewProjectionBuffers[imageIndex].memory);
-  }
-  m_pCullingRenderPass->Update(imageIndex);
-  m_pLightingRenderPass->Update(imageIndex);
+  m_viewProjections[imageIndex].view = m_camera->View();
+  m_viewProjections[imageIndex].projection = m_camera->Proj();
+  m_viewProjections[imageIndex].viewInverse = m_camera->InvView();
+  m_viewProjections[imageIndex].projInverse = m_camera->InvProj();
 
-  m_pEditor->Update();
+  pData = g_MemoryAllocator.GetMappedData(m_viewProjectionBuffers[imageIndex].buffer);
+  memcpy(pData, &m_viewProjections[imageIndex], sizeof(ViewProjection));
 }
 
 void VulkanRenderer::Draw() {
@@ -161,17 +152,88 @@ void VulkanRenderer::Draw() {
   vkResetFences(mainDevice.logicalDevice, 1, &drawFences[currentFrame]);
 
   // -- Get Next Image --, Get index of next image to be drawn to, and signal semaphore when ready to be drawn to
-  uint32_t imageIndex;  // swapchain ̹ ۿ index  ´.
+  uint32_t imageIndex;  // swapchain의 이미지 버퍼에서 index 값을 갖고온다.
   vkAcquireNextImageKHR(mainDevice.logicalDevice, m_swapchain, (std::numeric_limits<uint32_t>::max)(), imageAvailable[currentFrame],
                         VK_NULL_HANDLE, &imageIndex);
 
-  Update(imageIndex);
+  // Update -> Culling -> TLAS refit -> Record -> Submit, see CreateFrameGraph()
+  m_frameImageIndex = imageIndex;
+  m_frameGraph.Execute();
 
-  m_pCullingRenderPass->Draw(imageIndex, drawFences[currentFrame], imageAvailable[imageIndex]);
-  m_pLightingRenderPass->Draw(imageIndex, drawFences[currentFrame], m_pCullingRenderPass->GetSemaphore(imageIndex));
+  // Get next frame
+  currentFrame = (currentFrame + 1) % MAX_FRAME_DRAWS;
+}
 
-  RecordCommands(imageIndex);
+void VulkanRenderer::CreateFrameGraph() {
+  /*
+   * Every task names what it reads and writes, the graph orders tasks touching the same resource in the order added here.
+   * - "Queue" : every vkQueueSubmit (graphics / transfer may be the same VkQueue)
+   * - "GraphicsCommandPool" : all pass command buffers come from m_graphicsCommandPool, recording must not overlap
+   */
+  m_frameGraph.AddTask("BatchUpload", {"Transforms", "BoundingBoxes"}, {"TransformSSBO", "AABBSSBO", "SceneBVH"},
+                       [this]() { g_BatchManager.Update(mainDevice.logicalDevice, m_frameImageIndex); });
+
+  m_frameGraph.AddTask("CameraUpload", {}, {"Camera", "CameraUBO"}, [this]() { UpdateCamera(m_frameImageIndex); });
+
+  m_frameGraph.AddTask("OcclusionReadback", {"OcclusionResults"}, {"DrawCommands", "IndirectBuffer", "Stats"},
+                       [this]() { m_pCullingRenderPass->Update(m_frameImageIndex); });
+
+  m_frameGraph.AddTask("FrustumCulling", {"Camera", "Transforms", "BoundingBoxes", "SceneBVH", "DrawCommands"},
+                       {"CulledCommands", "CullingPlaneUBO"},
+                       [this]() { m_pCullingRenderPass->CullObjects(m_frameImageIndex); });
+
+  // Uploads and u_DiffuseTextureList swaps, ImGui texture ids are replaced too so it stays on the main thread
+  m_frameGraph.AddTask("TextureStreaming", {"Camera", "Transforms", "BoundingBoxes"}, {"TextureDescriptors", "Queue"},
+                       [this]() {
+                         g_TextureStreamer.Update(mainDevice.logicalDevice, m_camera->ViewProj(),
+                                                  glm::vec2(swapChainExtent.width, swapChainExtent.height), m_frameImageIndex,
+                                                  currentFrame);
+                       },
+                       TaskAffinity::MainThread);
+
+  m_frameGraph.AddTask("ObjectPicking", {"Camera", "SceneBVH"}, {"PickResult", "Queue"},
+                       [this]() { m_pLightingRenderPass->UpdateObjectPicking(); });
+
+  m_frameGraph.AddTask("TLASInstanceFill", {"Transforms"}, {"TLASInstances"},
+                       [this]() { m_pLightingRenderPass->UpdateTLASInstances(m_frameImageIndex); });
+
+  m_frameGraph.AddTask("TLASRefit", {"TLASInstances"}, {"TLAS", "Queue", "ChangeFlag"}, [this]() { m_pLightingRenderPass->RefitTLAS(); });
+
+  m_frameGraph.AddTask("EditorUpdate", {"PickResult"}, {"EditorState"}, [this]() { m_pEditor->Update(); }, TaskAffinity::MainThread);
+
+  m_frameGraph.AddTask("CullingRecord", {"CulledCommands", "DrawCommands"}, {"CullingCommandBuffer", "GraphicsCommandPool", "Stats"},
+                       [this]() { m_pCullingRenderPass->Record(m_frameImageIndex); });
+
+  m_frameGraph.AddTask("CullingSubmit",
+                       {"CullingCommandBuffer", "TransformSSBO", "AABBSSBO", "CameraUBO", "CullingPlaneUBO", "IndirectBuffer"},
+                       {"Queue", "OcclusionResults"},
+                       [this]() { m_pCullingRenderPass->Submit(m_frameImageIndex, imageAvailable[m_frameImageIndex]); });
+
+  m_frameGraph.AddTask("LightingRecord", {"DrawCommands", "TextureDescriptors"}, {"LightingCommandBuffer", "GraphicsCommandPool"},
+                       [this]() { m_pLightingRenderPass->Record(m_frameImageIndex); });
+
+  m_frameGraph.AddTask("LightingSubmit", {"LightingCommandBuffer", "TLAS", "TransformSSBO", "CameraUBO", "IndirectBuffer"}, {"Queue"},
+                       [this]() {
+                         m_pLightingRenderPass->Submit(m_frameImageIndex, m_pCullingRenderPass->GetSemaphore(m_frameImageIndex));
+                       });
+
+  // ImGui (and the gizmo editing transforms) stays on the main thread. Imports and texture changes picked in the UI are only
+  // queued here, they run in SceneEdits.
+  m_frameGraph.AddTask("SwapchainRecord", {"EditorState", "Stats", "Camera", "ChangeFlag", "TextureDescriptors"},
+                       {"Transforms", "SwapchainCommandBuffer", "GraphicsCommandPool"},
+                       [this]() { RecordCommands(m_frameImageIndex); }, TaskAffinity::MainThread);
+
+  m_frameGraph.AddTask("Present", {"SwapchainCommandBuffer"}, {"Queue"}, [this]() { SubmitAndPresent(m_frameImageIndex); },
+                       TaskAffinity::MainThread);
+
+  // Sync point after every submit of the frame : uploads, scene buffer / BVH / AS rebuilds and u_DiffuseTextureList writes
+  m_frameGraph.AddTask("SceneEdits", {},
+                       {"Queue", "TextureDescriptors", "Transforms", "BoundingBoxes", "SceneBVH", "TransformSSBO", "AABBSSBO",
+                        "DrawCommands", "IndirectBuffer", "OcclusionResults", "TLASInstances", "TLAS", "EditorState"},
+                       [this]() { m_pEditor->ApplySceneEdits(); }, TaskAffinity::MainThread);
+}
 
+void VulkanRenderer::SubmitAndPresent(uint32_t imageIndex) {
   // 2. Submit command buffer to queue for execution, making sure it waits for the image to be signalled as available before drawing
   // and signals when it has finished rendering (wait a fence)
   // -- SUBMIT COOMAND BUUFER TO RENDER --, Queue submission information
@@ -179,15 +241,15 @@ void VulkanRenderer::Draw() {
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submitInfo.waitSemaphoreCount = 1;  // Number of semaphores to wait on
   submitInfo.pWaitSemaphores = &m_pLightingRenderPass->GetSemaphore(
-      imageIndex);  // List of semaphores to wait on, Command buffer ϱ ؾϴ semaphores
-  // ,  semphore signaled °   ϰ,  Ŀ Command buffer Ѵ.
+      imageIndex);  // List of semaphores to wait on, Command buffer가 실행하기전 대기해야하는 semaphores
+  // 즉, 이 semphore가 signaled 상태가 될 때까지 대기하고, 그 후에 Command buffer를 실행한다.
   VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
   submitInfo.pWaitDstStageMask = waitStages;                            // Stages to check semaphores at
   submitInfo.commandBufferCount = 1;                                    // Number of command buffers to submit
   submitInfo.pCommandBuffers = &m_swapchainCommandBuffers[imageIndex];  // Command buffer to submit
   submitInfo.signalSemaphoreCount = 1;                                  // Number of semaphores to signal
   submitInfo.pSignalSemaphores = &renderFinished[currentFrame];         // Semaphores to signal when command buffer finishes
-  // Command buffer  Ϸϸ, Signaled °  semaphore 迭.
+  // Command buffer가 실행을 완료하면, Signaled 상태가 될 semaphore 배열.
 
   // Submit command buffer to queue
   VkResult result = vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, drawFences[currentFrame]);
@@ -206,20 +268,18 @@ void VulkanRenderer::Draw() {
   presentInfo.pImageIndices = &imageIndex;                      // Index of images in swapchain to present
 
   result = vkQueuePresentKHR(m_presentationQueue,
-                             &presentInfo);  //  Ϸ Graphicsť present ϴ Լ. , presentQueue Ѵٰ   .
+                             &presentInfo);  // 렌더링 완료된 Graphics큐를 present 하는 함수. 즉, presentQueue로 전송한다고 볼 수 있음.
   if (result != VK_SUCCESS) {
     throw std::runtime_error("Failed to Present swapchain!");
   }
   if (g_BatchManager.oldImage.image != VK_NULL_HANDLE) {
     vkQueueWaitIdle(m_graphicsQueue);
     vkDestroyImageView(mainDevice.logicalDevice, g_BatchManager.oldImage.imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(g_BatchManager.oldImage.image);
     vkDestroyImage(mainDevice.logicalDevice, g_BatchManager.oldImage.image, nullptr);
-    vkFreeMemory(mainDevice.logicalDevice, g_BatchManager.oldImage.memory, nullptr);
 
     g_BatchManager.oldImage.image = VK_NULL_HANDLE;
   }
-  // Get next frame
-  currentFrame = (currentFrame + 1) % MAX_FRAME_DRAWS;
 }
 
 void VulkanRenderer::Cleanup() {
@@ -227,8 +287,8 @@ void VulkanRenderer::Cleanup() {
   vkDeviceWaitIdle(mainDevice.logicalDevice);
 
   for (int i = 0; i < MAX_FRAME_DRAWS; ++i) {
+    g_MemoryAllocator.FreeBufferMemory(m_viewProjectionBuffers[i].buffer);
     vkDestroyBuffer(mainDevice.logicalDevice, m_viewProjectionBuffers[i].buffer, nullptr);
-    vkFreeMemory(mainDevice.logicalDevice, m_viewProjectionBuffers[i].memory, nullptr);
   }
 
   g_ResourceManager.Cleanup();
@@ -239,9 +299,7 @@ void VulkanRenderer::Cleanup() {
   m_pCullingRenderPass->Cleanup();
   m_pLightingRenderPass->Cleanup();
 
-  for (auto& batch : g_BatchManager.m_miniBatchList) {
-    batch.Cleanup(mainDevice.logicalDevice);
-  }
+  g_TextureStreamer.Cleanup(mainDevice.logicalDevice);
   g_BatchManager.Cleanup(mainDevice.logicalDevice);
 
   vkDestroyPipeline(mainDevice.logicalDevice, m_offScreenPipeline, nullptr);
@@ -252,15 +310,17 @@ void VulkanRenderer::Cleanup() {
     vkDestroyFramebuffer(mainDevice.logicalDevice, framebuffer, nullptr);
   }
   for (auto& image : m_swapchainImages) {
-    // VkImageView VkImage  ؼ 並  ̹Ƿ, ȣؼ ıؾѴ.
-    // ݸ, VkImage ü   Ҵ ޸  ǹǷ ı ʿ䰡 .
+    // VkImageView는 VkImage를 직접 참조해서 뷰를 생성한 것이므로, 호출해서 파괴해야한다.
+    // 반면, VkImage는 스왑체인이 생성될 때 할당된 메모리 내에서 관리되므로 파괴할 필요가 없다.
     vkDestroyImageView(mainDevice.logicalDevice, image.imageView, nullptr);
   }
   for (int i = 0; i < m_swapchainDepthStencilImages.size(); ++i) {
     vkDestroyImageView(mainDevice.logicalDevice, m_swapchainDepthStencilImages[i].imageView, nullptr);
+    g_MemoryAllocator.FreeImageMemory(m_swapchainDepthStencilImages[i].image);
     vkDestroyImage(mainDevice.logicalDevice, m_swapchainDepthStencilImages[i].image, nullptr);
-    vkFreeMemory(mainDevice.logicalDevice, m_swapchainDepthStencilImageMemories[i], nullptr);
   }
+  g_MemoryAllocator.PrintStats();
+  g_MemoryAllocator.Cleanup();
 
   vkDestroySampler(mainDevice.logicalDevice, m_linearWrapSS, nullptr);
   vkDestroySampler(mainDevice.logicalDevice, m_linearClampSS, nullptr);
@@ -384,31 +444,31 @@ void VulkanRenderer::CreateLogicalDevice() {
 
   vkGetPhysicalDeviceFeatures2(mainDevice.physicalDevice, &deviceFeatures2);
 
-  VkPhysicalDeviceBufferDeviceAddressFeaturesKHR bufferDeviceAddressFeatures = {};
-  bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR;
-  bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
-
   VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures = {};
   accelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
   accelerationStructureFeatures.accelerationStructure = VK_TRUE;
   accelerationStructureFeatures.descriptorBindingAccelerationStructureUpdateAfterBind = VK_TRUE;
-  accelerationStructureFeatures.pNext = &bufferDeviceAddressFeatures;
 
   VkPhysicalDeviceRayTracingPipelineFeaturesKHR raytracingFeatures = {};
   raytracingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
   raytracingFeatures.rayTracingPipeline = VK_TRUE;
   raytracingFeatures.pNext = &accelerationStructureFeatures;
 
-  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
-  indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
-  indexingFeatures.runtimeDescriptorArray = VK_TRUE;                     // 迭 ũ 
-  indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;  //  ε
-  indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
-  indexingFeatures.descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE;
-  indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
-  indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
-  indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
-  indexingFeatures.pNext = &raytracingFeatures;
+  // Core 1.2 features in one struct, it must not be chained together with the per-feature structs it replaces
+  VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+  vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  vulkan12Features.drawIndirectCount = VK_TRUE;  // vkCmdDrawIndexedIndirectCount of the compacted draws
+  vulkan12Features.timelineSemaphore = VK_TRUE;  // Upload completion (ResourceManager::m_uploadTimeline)
+  vulkan12Features.bufferDeviceAddress = VK_TRUE;
+  vulkan12Features.scalarBlockLayout = VK_TRUE;  // Culling, compaction and hit shaders read scalar layout buffers
+  vulkan12Features.runtimeDescriptorArray = VK_TRUE;                     // 배열 크기 동적
+  vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;  // 동적 인덱싱
+  vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+  vulkan12Features.descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE;
+  vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+  vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+  vulkan12Features.pNext = &raytracingFeatures;
 
   deviceFeatures2.features.depthBiasClamp = VK_FALSE;
   deviceFeatures2.features.samplerAnisotropy = VK_TRUE;
@@ -416,7 +476,7 @@ void VulkanRenderer::CreateLogicalDevice() {
   deviceFeatures2.features.drawIndirectFirstInstance = VK_TRUE;
   deviceFeatures2.features.fillModeNonSolid = VK_TRUE;
   deviceFeatures2.features.wideLines = VK_TRUE;
-  deviceFeatures2.pNext = &indexingFeatures;
+  deviceFeatures2.pNext = &vulkan12Features;
 
   // Information to create logical device (someties called device)
   VkDeviceCreateInfo deviceCreateInfo = {};
@@ -430,7 +490,7 @@ void VulkanRenderer::CreateLogicalDevice() {
 
   //// Pyhsical Device Features the logical device will be using
   // VkPhysicalDeviceFeatures deviceFeatures = {};
-  // deviceFeatures.depthBiasClamp = VK_FALSE;  // Rasterizer ش     
+  // deviceFeatures.depthBiasClamp = VK_FALSE;  // Rasterizer에서 해당 기능을 지원할 것인지에 대한 여부
   // deviceFeatures.samplerAnisotropy = VK_TRUE;
   // deviceFeatures.multiDrawIndirect = VK_TRUE;
   // deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
@@ -624,10 +684,10 @@ void VulkanRenderer::CreateOffScreenRenderPass() {
   depthStencilAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
   // REFERENCES
-  // FrameBuffer   Ͽ, attachment 迭 Ѵٰ  ȴ.
+  // FrameBuffer를 만들 때 사용하였던, attachment 배열을 참조한다고 보면 된다.
   // Attachment reference uses an attachment index that refers to index in the attachment list passed to renderPassCreateInfo
   VkAttachmentReference swapChainColourAttachmentRef = {};
-  swapChainColourAttachmentRef.attachment = 0;  // 󸶳  attachment ִ X, ° attachment ϳ .
+  swapChainColourAttachmentRef.attachment = 0;  // 얼마나 많은 attachment가 있는지 정의X, 몇번째 attachment를 참조하냐의 느낌.
   swapChainColourAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
   VkAttachmentReference depthStencilAttachmentRef = {};
@@ -650,7 +710,7 @@ void VulkanRenderer::CreateOffScreenRenderPass() {
   // Conversion from VK_IMAGE_LAYER-UNDEFINED to VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
   // Transition must happen after ..
   subpassDependencies[0].srcSubpass =
-      VK_SUBPASS_EXTERNAL;  // ܺο Ƿ, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
+      VK_SUBPASS_EXTERNAL;  // 외부에서 들어오므로, Subpass index(VK_SUBPASS_EXTERNAL = Special value meaning outside of renderpass)
   subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;  // Pipeline stage
   subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;            // Stage access mask (memory access)
   // But most happen before ..
@@ -800,7 +860,7 @@ void VulkanRenderer::CreatePipelines() {
   // -- INPUT ASSEMBLY --
   VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
   inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  // List versus Strip: ӵ (Strip),    (List)
+  // List versus Strip: 연속된 점(Strip), 딱 딱 끊어서 (List)
   inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;  // Primitive type to assemble vertices
   inputAssembly.primitiveRestartEnable = VK_FALSE;               // Allow overriding of "strip" topology to start new primitives
 
@@ -893,8 +953,8 @@ void VulkanRenderer::CreatePipelines() {
   depthStencilCreateInfo.depthTestEnable = VK_TRUE;            // Enable checking depth to determine fragment wrtie
   depthStencilCreateInfo.depthWriteEnable = VK_FALSE;          // Enable writing to depth buffer (to replace old values)
   depthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;  // Comparison operation that allows an overwrite (is in front)
-  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 
-                                                            // ȼ   Ư  ȿ ִ üũϴ ˻
+  depthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;     // Depth Bounds Test: Does the depth value exist between two bounds, 즉
+                                                            // 픽셀의 깊이 값이 특정 범위 안에 있는지를 체크하는 검사
   depthStencilCreateInfo.stencilTestEnable = VK_FALSE;  // Enable Stencil Test
 
   // -- GRAPHICS PIPELINE CREATION --
@@ -943,7 +1003,7 @@ void VulkanRenderer::CreateCommandBuffers() {
 
   VkCommandBufferAllocateInfo cbAllocInfo = {};
   cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  cbAllocInfo.commandPool = m_graphicsCommandPool;  // ش ť йи ť Ŀǵ ť  డϴ.
+  cbAllocInfo.commandPool = m_graphicsCommandPool;  // 해당 큐 패밀리의 큐에서만 커맨드 큐 동작이 실행가능하다.
   cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;  // VK_COMMAND_BUFFER_LEVEL_PRIMARY		: buffer you submit directly to
                                                         // queue. cant be called by other buffers
   // VK_COMMAND_BUFFER_LEVEL_SECONDARY	: buffer can't be called directly. Can be called from other buffers via
@@ -993,7 +1053,7 @@ void VulkanRenderer::FillOffScreenCommands(uint32_t currentImage) {
   renderPassBeginInfo.renderArea.extent = swapChainExtent;  // Size of region to run render pass on (starting at offset)
 
   std::array<VkClearValue, 2> clearValues = {};
-  clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};  //  ()
+  clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};  // 투명한 (검은)색
   clearValues[0].depthStencil.depth = 0.0f;
 
   clearValues[1].depthStencil.depth = 1.0f;
@@ -1008,7 +1068,7 @@ void VulkanRenderer::FillOffScreenCommands(uint32_t currentImage) {
 
   // Begin Render Pass
   vkCmdBeginRenderPass(m_swapchainCommandBuffers[currentImage], &renderPassBeginInfo,
-                       VK_SUBPASS_CONTENTS_INLINE);  //  н    ۿ ϴ  ǹ
+                       VK_SUBPASS_CONTENTS_INLINE);  // 렌더 패스의 내용을 직접 명령 버퍼에 기록하는 것을 의미
 
   vkCmdBindPipeline(m_swapchainCommandBuffers[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_offScreenPipeline);
 
@@ -1080,9 +1140,9 @@ bool VulkanRenderer::CheckInstanceExtensionSupport(std::vector<const char*>* che
   vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
 
   // you can see outputs are VK_KHR_surface -> VK_KHR_win32_surface
-  // VK_KHR_surface ÷  surface   ν ÷ ֹ ʴ Ϲ ̽ 
-  // VK_KHR_win32_surface Windows Vulkan   ִ surface . , ù°    ִ 
-  // ϰ ι° ش ÷ ° ȣۿ 
+  // VK_KHR_surface는 플랫폼에 독립적인 surface 생성 기능을 제공함으로써 플랫폼에 구애받지 않는 일반적인 인터페이스를 제공
+  // VK_KHR_win32_surface는 Windows에서 Vulkan이 사용할 수 있는 surface를 생성. 즉, 첫번째는 공통적으로 사용할 수 있는 기능을
+  // 제공하고 두번째는 해당 플랫폼에 맞게 상호작용을 담당
 
   // Check if given extensions are in list of available extensions
   for (const auto& checkExtensions : *checkExtensions) {
@@ -1176,8 +1236,8 @@ bool VulkanRenderer::CheckDeviceSuitable(VkPhysicalDevice device) {
 
   VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
   indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
-  indexingFeatures.runtimeDescriptorArray = VK_TRUE;                     // 迭 ũ 
-  indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;  //  ε
+  indexingFeatures.runtimeDescriptorArray = VK_TRUE;                     // 배열 크기 동적
+  indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;  // 동적 인덱싱
   indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
   indexingFeatures.descriptorBindingUniformBufferUpdateAfterBind = VK_TRUE;
   indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
@@ -1297,12 +1357,12 @@ VkExtent2D VulkanRenderer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& surf
 
 void VulkanRenderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
   createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-  // messageSeverity filed allows  ɰ  debug  ΰ. , ɰ  
+  // messageSeverity filed allows 어떤 심각도에 대해 debug를 보여줄 것인가. 즉, 심각도 수준을 선택
   createInfo.messageSeverity = /*VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |*/
       VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-  //    ޼   . GENERAL_BIT / VALIDATION_BIT / PERFORMANCE_BIT
+  // 어떤 유형의 디버그 메세지를 받을 것인지 설정. GENERAL_BIT / VALIDATION_BIT / PERFORMANCE_BIT
   createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
                            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-  createInfo.pfnUserCallback = debugCallback;  //  ޽ ȣ Call back Լ 
+  createInfo.pfnUserCallback = debugCallback;  // 디버그 메시지를 호출할 Call back 함수 지정
   createInfo.pUserData = nullptr;              // Optional
 }
\ No newline at end of file
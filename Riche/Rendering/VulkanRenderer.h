@@ -8,6 +8,7 @@
 #include "Swapchain.h"
 #include "Utils/ModelLoader.h"
 #include "Utils/StringUtil.h"
+#include "Utils/TaskGraph.h"
 #include "VkUtils/ChooseFunc.h"
 #include "VkUtils/DescriptorManager.h"
 #include "VkUtils/QueueFamilyIndices.h"
@@ -36,9 +37,9 @@ class VulkanRenderer {
 
   void Initialize(GLFWwindow* newWindow, Camera* newcamera);
 
-  void Update(uint32_t imageIndex);
-
   void Draw();
+
+  const TaskGraph& GetFrameGraph() const { return m_frameGraph; }
   void Cleanup();
 
  private:
@@ -103,6 +104,10 @@ class VulkanRenderer {
   std::shared_ptr<CullingRenderPass> m_pCullingRenderPass;
   std::shared_ptr<BasicLightingPass> m_pLightingRenderPass;
 
+  // - Frame Task Graph
+  TaskGraph m_frameGraph;
+  uint32_t m_frameImageIndex = 0;
+
   entt::registry m_registry;
 
   // - Descriptors
@@ -158,6 +163,11 @@ class VulkanRenderer {
   void RecordCommands(uint32_t currentImage);
   void FillOffScreenCommands(uint32_t currentImage);
 
+  // - Frame Functions
+  void CreateFrameGraph();
+  void UpdateCamera(uint32_t imageIndex);
+  void SubmitAndPresent(uint32_t imageIndex);
+
   // - Get Functions
   void GetPhysicalDevice();
 
@@ -29,8 +29,15 @@ layout(set = 1, binding = 0) readonly buffer SSBO_Model
 	Transform transform[];
 }ssbo_Model;
 
+layout(set = 1, binding = 2) buffer readonly SSBO_BoundingBoxBuffer {
+    AABB boundingBoxList[];
+};
 
 void main() {
-	mat4 model = nonuniformEXT(ssbo_Model.transform[u_ShaderSetting.batchIdx].currentModel);
-	gl_Position = u_Camera.projection * u_Camera.view * model * vec4(inPosition, 1.0);
+	// inPosition is a corner of the shared unit cube, one instance per mesh
+	AABB aabb = boundingBoxList[gl_InstanceIndex];
+	vec3 position = mix(aabb.minPos.xyz, aabb.maxPos.xyz, inPosition);
+
+	mat4 model = nonuniformEXT(ssbo_Model.transform[gl_InstanceIndex].currentModel);
+	gl_Position = u_Camera.projection * u_Camera.view * model * vec4(position, 1.0);
 }
\ No newline at end of file
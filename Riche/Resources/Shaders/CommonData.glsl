@@ -1,6 +1,9 @@
 struct ObjectID {
     int materialID;
-    float dummy[3];
+    int textureIndex;  // u_DiffuseTextureList element, the texture itself or the atlas page holding it (TexturePacker)
+    float maxLod;      // coarser page mips mix in the neighbouring tiles
+    float pad;
+    vec4 uvTransform;  // xy scale, zw offset of the tile in the page, (1, 1, 0, 0) for a texture of its own
 };
 
 struct Transform {
@@ -8,7 +11,7 @@ struct Transform {
     mat4 currentModel;
 };
 
-// AABB ü
+// AABB 구조체
 struct AABB
 {
     vec4 minPos;	// minimum coord
@@ -20,7 +23,7 @@ struct BoundingSphere {
     float radius;
 };
 
-// Indirect Draw 
+// Indirect Draw 명령
 struct IndircetDrawIndexedCommand {
     uint    indexCount;
     uint    instanceCount;
@@ -29,11 +32,63 @@ struct IndircetDrawIndexedCommand {
     uint    firstInstance;
 };
 
+// Meshlet (MeshletBuilder.h), firstIndex into the scene index buffer
+struct Meshlet {
+    vec4 boundingSphere;  // object space center, radius
+    vec4 cone;            // object space axis, cutoff (1 : never culled)
+    uint firstIndex;
+    uint triangleCount;
+    uint meshIndex;
+    uint localIndex;  // of the meshlet inside its mesh
+};
+
+// MeshLodTable (MeshSimplifier.h), per mesh, level 0 is the full mesh
+#define MAX_LOD_COUNT 5
+
+struct MeshLod {
+    uint firstIndex;  // into the scene index buffer
+    uint indexCount;
+    float error;
+    uint pad;
+};
+
+struct MeshLodTable {
+    uint lodCount;
+    uint pad[3];
+    MeshLod levels[MAX_LOD_COUNT];
+};
+
+// ShaderSetting::cullingFlags
+#define CULLING_FLAG_HIZ 1           // the Hi-Z pyramid was built this frame
+#define CULLING_FLAG_MESHLET 2       // MeshletCullingCS wrote the index counts of the draws
+#define CULLING_FLAG_MESHLET_CONE 4  // normal cone test of the meshlets
+
+// VertexFormat::Packed : 3x4 row-major decode of a mesh (VkTransformMatrixKHR), snorm16 position -> object space
+struct VertexDecode {
+    vec4 row[3];
+};
+
+vec3 DecodePosition(VertexDecode decode, vec3 packedPosition)
+{
+    vec4 position = vec4(packedPosition, 1.0);
+    return vec3(dot(decode.row[0], position), dot(decode.row[1], position), dot(decode.row[2], position));
+}
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded.xy, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -t : t;
+    normal.y += normal.y >= 0.0 ? -t : t;
+    return normalize(normal);
+}
+
 layout(push_constant) uniform readonly U_ShaderSetting 
 {
 	uint isDebugging;
 	uint batchIdx;
-    float padd[2];
+    uint cullingFlags;  // CULLING_FLAG_*, culling dispatches only
+    float maxTextureLod;  // lighting only, 0 = mip 0
 
     vec4 lightPos;
 }u_ShaderSetting;
\ No newline at end of file
@@ -0,0 +1,56 @@
+// Shared by ViewFrustumCullingCS / HiZOcclusionCullingCS
+
+bool IsAABBInFrustum(vec3 minPos, vec3 maxPos, mat4 model, vec4 frustumPlanes[6])
+{
+    // World space AABB from all 8 transformed corners (min/max alone are wrong under rotation)
+    vec3 center = 0.5 * (maxPos + minPos);
+    vec3 extent = 0.5 * (maxPos - minPos);
+    vec3 worldCenter = (model * vec4(center, 1.0)).xyz;
+    mat3 absModel = mat3(abs(model[0].xyz), abs(model[1].xyz), abs(model[2].xyz));
+    vec3 worldExtent = absModel * extent;
+
+    vec3 newMinPos = worldCenter - worldExtent;
+    vec3 newMaxPos = worldCenter + worldExtent;
+
+    for (int i = 0; i < 6; ++i)
+    {
+        // Corner farthest along the plane normal
+        vec3 positiveVertex = mix(newMinPos, newMaxPos, greaterThanEqual(frustumPlanes[i].xyz, vec3(0.0)));
+
+        // Even the farthest corner is behind the plane : outside
+        if (dot(frustumPlanes[i].xyz, positiveVertex) + frustumPlanes[i].w < 0.0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Largest side in pixels of the screen rectangle around the box, FLT_MAX when it crosses the near plane (BoundingBox.h)
+float ComputeProjectedSize(vec3 minPos, vec3 maxPos, mat4 mvp, vec2 viewport)
+{
+    vec2 ndcMin = vec2(3.402823e38);
+    vec2 ndcMax = vec2(-3.402823e38);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? maxPos.x : minPos.x, (i & 2) != 0 ? maxPos.y : minPos.y, (i & 4) != 0 ? maxPos.z : minPos.z);
+        vec4 clip = mvp * vec4(corner, 1.0);
+        if (clip.w <= 0.0) return 3.402823e38;
+
+        ndcMin = min(ndcMin, clip.xy / clip.w);
+        ndcMax = max(ndcMax, clip.xy / clip.w);
+    }
+
+    vec2 size = (ndcMax - ndcMin) * 0.5 * viewport;
+    return max(size.x, size.y);
+}
+
+// MeshSimplifier::SelectLod : the full mesh down to lod1ScreenSize pixels, then one level per halving (0 : always level 0)
+uint SelectLod(float projectedSize, uint lodCount, float lod1ScreenSize)
+{
+    if (lodCount <= 1 || lod1ScreenSize <= 0.0 || projectedSize >= lod1ScreenSize) return 0;
+    float level = floor(log2(lod1ScreenSize / max(projectedSize, 1e-3))) + 1.0;
+    return min(uint(level), lodCount - 1);
+}
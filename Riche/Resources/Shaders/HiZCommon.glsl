@@ -0,0 +1,43 @@
+// Shared by HiZOcclusionCullingCS / MeshletCullingCS, u_HiZTexture must be declared before the include
+
+bool IsBoxVisibleHiZ(vec3 bmin, vec3 bmax, mat4 mvp)
+{
+    vec2 screenMin = vec2(1.0);
+    vec2 screenMax = vec2(0.0);
+    float depthMin = 1.0;
+
+    // AABB의 8개 코너를 화면에 투영
+    for (uint i = 0; i < 8; ++i) {
+        vec3 corner = vec3((i & 1) != 0 ? bmax.x : bmin.x, (i & 2) != 0 ? bmax.y : bmin.y, (i & 4) != 0 ? bmax.z : bmin.z);
+        vec4 clipPos = mvp * vec4(corner, 1.0);
+
+        // Crosses the near plane, the projected rectangle is meaningless
+        if (clipPos.w <= 0.0) return true;
+
+        vec3 ndcPos = clipPos.xyz / clipPos.w;
+        screenMin = min(screenMin, ndcPos.xy * 0.5 + 0.5);
+        screenMax = max(screenMax, ndcPos.xy * 0.5 + 0.5);
+        depthMin = min(depthMin, ndcPos.z);
+    }
+
+    screenMin = clamp(screenMin, vec2(0.0), vec2(1.0));
+    screenMax = clamp(screenMax, vec2(0.0), vec2(1.0));
+
+    // Pick the mip where the rectangle covers at most 2x2 texels, so 4 fetches see the whole footprint
+    ivec2 baseSize = textureSize(u_HiZTexture, 0);
+    vec2 extent = (screenMax - screenMin) * vec2(baseSize);
+    int maxLevel = textureQueryLevels(u_HiZTexture) - 1;
+    int lod = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, maxLevel);
+
+    ivec2 mipSize = textureSize(u_HiZTexture, lod);
+    ivec2 texelMin = clamp(ivec2(screenMin * vec2(mipSize)), ivec2(0), mipSize - 1);
+    ivec2 texelMax = clamp(ivec2(screenMax * vec2(mipSize)), ivec2(0), mipSize - 1);
+
+    float maxDepth = texelFetch(u_HiZTexture, texelMin, lod).r;
+    maxDepth = max(maxDepth, texelFetch(u_HiZTexture, ivec2(texelMax.x, texelMin.y), lod).r);
+    maxDepth = max(maxDepth, texelFetch(u_HiZTexture, ivec2(texelMin.x, texelMax.y), lod).r);
+    maxDepth = max(maxDepth, texelFetch(u_HiZTexture, texelMax, lod).r);
+
+    // 가장 앞쪽 깊이가 Hi-Z의 가장 먼 깊이보다 앞이면 보인다
+    return depthMin <= maxDepth;
+}
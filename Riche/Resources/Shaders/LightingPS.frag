@@ -30,8 +30,20 @@ layout(set = 3, binding = 0) uniform texture2D u_DiffuseTextureList[];	// Bindle
 layout(location = 0) out vec4  outColour;	// Final output colour (must also have location)
 
 void main() {
-	int textureIdx = nonuniformEXT(ssbo_TextureID.handle[inIndex].materialID);
-	vec4 newColor = textureLod(sampler2D(nonuniformEXT(u_DiffuseTextureList[textureIdx]), linearWrapSS), inFragTexcoord, 0);
+	ObjectID objectID = ssbo_TextureID.handle[inIndex];
+	int textureIdx = nonuniformEXT(objectID.textureIndex);
+	// Unwrapped page coordinate for the lod, the derivatives of the texture on its own without a jump where the tile wraps
+	vec2 texcoord = inFragTexcoord * objectID.uvTransform.xy + objectID.uvTransform.zw;
+	// Trilinear over the mip chain, clamped only when the mips are turned off for comparison (or to the levels of an atlas tile)
+	float lod = min(textureQueryLod(sampler2D(nonuniformEXT(u_DiffuseTextureList[textureIdx]), linearWrapSS), texcoord).y,
+	                min(u_ShaderSetting.maxTextureLod, objectID.maxLod));
+	if (objectID.uvTransform.xy != vec2(1.0)) {
+		// Atlas tile : wrapped inside the tile, the bilinear footprint stays half a texel of the lod off the neighbouring tiles
+		vec2 tileSize = objectID.uvTransform.xy * vec2(textureSize(u_DiffuseTextureList[nonuniformEXT(textureIdx)], 0));
+		vec2 inset = 0.5 * exp2(lod) / tileSize;
+		texcoord = clamp(fract(inFragTexcoord), inset, 1.0 - inset) * objectID.uvTransform.xy + objectID.uvTransform.zw;
+	}
+	vec4 newColor = textureLod(sampler2D(nonuniformEXT(u_DiffuseTextureList[textureIdx]), linearWrapSS), texcoord, lod);
 //	vec4 shadow = textureLod(sampler2D(u_ShadowTexture, linearClampSS), inFragTexcoord, 0);
 //
 	outColour = newColor;
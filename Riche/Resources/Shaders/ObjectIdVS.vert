@@ -8,9 +8,15 @@
 
 #include "CommonData.glsl"
 
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec3 inPackedPosition; // snorm16 over the mesh bounds, see SSBO_VertexDecode
+layout(location = 1) in vec2 inPackedNormal;   // octahedral
+layout(location = 2) in vec2 inTexcoord;
+#else
 layout(location = 0) in vec3 inPosition; // output colour for vertex (location is required)
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexcoord;
+#endif
 
 layout(set = 0, binding = 0) readonly uniform U_Camera
 {
@@ -30,9 +36,19 @@ layout(set = 1, binding = 0) readonly buffer SSBO_Model
 	Transform transform[];
 }ssbo_Model;
 
+#ifdef PACKED_VERTEX
+layout(set = 1, binding = 4) readonly buffer SSBO_VertexDecode
+{
+	VertexDecode decode[];
+}ssbo_VertexDecode;
+#endif
+
 layout(location = 0) out int outIndex;
 
 void main() {
+#ifdef PACKED_VERTEX
+	vec3 inPosition = DecodePosition(ssbo_VertexDecode.decode[u_ShaderSetting.batchIdx + gl_BaseInstanceARB], inPackedPosition);
+#endif
 	mat4 model = nonuniformEXT(ssbo_Model.transform[u_ShaderSetting.batchIdx + gl_BaseInstanceARB].currentModel);
 	gl_Position = u_Camera.projection * u_Camera.view * model * vec4(inPosition, 1.0);
 
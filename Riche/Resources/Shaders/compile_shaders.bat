@@ -1,27 +1,40 @@
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o LightingVS.spv -V LightingVS.vert
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o LightingPS.spv -V LightingPS.frag
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o ObjectIdVS.spv -V ObjectIdVS.vert
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o ObjectIdPS.spv -V ObjectIdPS.frag
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o DepthOnlyVS.spv -V DepthOnlyVS.vert
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o BoundingBoxVS.spv -V BoundingBoxVS.vert
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o BoundingBoxPS.spv -V BoundingBoxPS.frag
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o ViewFrustumCullingCS.spv -V ViewFrustumCullingCS.comp
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o HiZOcclusionCullingCS.spv -V  HiZOcclusionCullingCS.comp
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RenderingQuadVS.spv -V RenderingQuadVS.vert
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RenderingQuadPS.spv -V RenderingQuadPS.frag
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe --version
-
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RaytracingShadow/Raygen.rgen.spv -V --target-env vulkan1.3 RaytracingShadow/Raygen.rgen
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RaytracingShadow/ClosestHit.rchit.spv -V --target-env vulkan1.3 RaytracingShadow/ClosestHit.rchit
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RaytracingShadow/Miss.rmiss.spv -V --target-env vulkan1.3 RaytracingShadow/Miss.rmiss
-C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe -o RaytracingShadow/Shadow.rmiss.spv -V --target-env vulkan1.3 RaytracingShadow/Shadow.rmiss
-
-
-
-pause
\ No newline at end of file
+@echo off
+rem Pre-build event of Riche.vcxproj ("compile_shaders.bat nopause"), every .spv the renderer loads is rebuilt from its source
+rem A failed compile stops the build instead of leaving a stale .spv behind
+rem The .spv files are build outputs (.gitignore), a missing one makes ShaderModule::ReadFile throw instead of loading stale code
+cd /d "%~dp0"
+set GLSLANG=C:/VulkanSDK/1.3.290.0/Bin/glslangValidator.exe
+if defined VULKAN_SDK set GLSLANG=%VULKAN_SDK%/Bin/glslangValidator.exe
+
+"%GLSLANG%" -o LightingVS.spv -V LightingVS.vert || exit /b 1
+"%GLSLANG%" -o LightingVS_Packed.spv -V -DPACKED_VERTEX LightingVS.vert || exit /b 1
+"%GLSLANG%" -o LightingPS.spv -V LightingPS.frag || exit /b 1
+
+"%GLSLANG%" -o ObjectIdVS.spv -V ObjectIdVS.vert || exit /b 1
+"%GLSLANG%" -o ObjectIdVS_Packed.spv -V -DPACKED_VERTEX ObjectIdVS.vert || exit /b 1
+"%GLSLANG%" -o ObjectIdPS.spv -V ObjectIdPS.frag || exit /b 1
+
+"%GLSLANG%" -o DepthOnlyVS.spv -V DepthOnlyVS.vert || exit /b 1
+"%GLSLANG%" -o DepthOnlyVS_Packed.spv -V -DPACKED_VERTEX DepthOnlyVS.vert || exit /b 1
+
+"%GLSLANG%" -o BoundingBoxVS.spv -V BoundingBoxVS.vert || exit /b 1
+"%GLSLANG%" -o BoundingBoxPS.spv -V BoundingBoxPS.frag || exit /b 1
+
+"%GLSLANG%" -o ViewFrustumCullingCS.spv -V ViewFrustumCullingCS.comp || exit /b 1
+"%GLSLANG%" -o HiZOcclusionCullingCS.spv -V  HiZOcclusionCullingCS.comp || exit /b 1
+"%GLSLANG%" -o HiZDownsampleCS.spv -V HiZDownsampleCS.comp || exit /b 1
+"%GLSLANG%" -o DrawCompactionCS.spv -V DrawCompactionCS.comp || exit /b 1
+"%GLSLANG%" -o MeshletCullingCS.spv -V MeshletCullingCS.comp || exit /b 1
+
+"%GLSLANG%" -o RenderingQuadVS.spv -V RenderingQuadVS.vert || exit /b 1
+"%GLSLANG%" -o RenderingQuadPS.spv -V RenderingQuadPS.frag || exit /b 1
+
+"%GLSLANG%" --version
+
+"%GLSLANG%" -o RaytracingShadow/Raygen.rgen.spv -V --target-env vulkan1.3 RaytracingShadow/Raygen.rgen || exit /b 1
+"%GLSLANG%" -o RaytracingShadow/ClosestHit.rchit.spv -V --target-env vulkan1.3 RaytracingShadow/ClosestHit.rchit || exit /b 1
+"%GLSLANG%" -o RaytracingShadow/ClosestHit_Packed.rchit.spv -V --target-env vulkan1.3 -DPACKED_VERTEX RaytracingShadow/ClosestHit.rchit || exit /b 1
+"%GLSLANG%" -o RaytracingShadow/Miss.rmiss.spv -V --target-env vulkan1.3 RaytracingShadow/Miss.rmiss || exit /b 1
+"%GLSLANG%" -o RaytracingShadow/Shadow.rmiss.spv -V --target-env vulkan1.3 RaytracingShadow/Shadow.rmiss || exit /b 1
+
+if not "%1"=="nopause" pause
@@ -0,0 +1,393 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "BoundingBox.h"
+
+/*
+ * BVH : bounding volume hierarchy over world space AABBs (one primitive per box)
+ *  - Binned SAH build, nodes live in one flat array, 32 bytes each. Children are allocated in pairs (right = left + 1)
+ *    and always after their parent, so a reverse walk of the array is a bottom-up order.
+ *  - CullFrustum() skips whole subtrees outside a plane and stops testing planes a subtree is fully inside of.
+ *  - Raycast() returns the closest primitive, the primitive test can be replaced (e.g. by a triangle test).
+ *  - UpdatePrimitive() refits the path from the primitive's leaf to the root, the topology is kept until the next Build().
+ *  Only depends on glm and BoundingBox.h, so it can be exercised with synthetic boxes without a device.
+ */
+
+struct BVHNode {
+  glm::vec3 min;
+  uint32_t leftFirst = 0;  // left child for interior nodes, first entry of the primitive index list for leaves
+  glm::vec3 max;
+  uint32_t count = 0;  // number of primitives, 0 for interior nodes
+
+  bool IsLeaf() const { return count > 0; }
+};
+static_assert(sizeof(BVHNode) == 32, "BVHNode must stay 32 bytes");
+
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;
+};
+
+struct RayHit {
+  static constexpr uint32_t INVALID_PRIMITIVE = UINT32_MAX;
+
+  uint32_t primitive = INVALID_PRIMITIVE;
+  float distance = std::numeric_limits<float>::max();
+
+  bool IsHit() const { return primitive != INVALID_PRIMITIVE; }
+};
+
+class BVH {
+ public:
+  static constexpr uint32_t BIN_COUNT = 12;
+  static constexpr uint32_t MAX_LEAF_SIZE = 4;
+  static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+  void Clear() {
+    m_nodes.clear();
+    m_primitiveIndices.clear();
+    m_boxes.clear();
+    m_parents.clear();
+    m_primitiveLeaves.clear();
+  }
+
+  void Build(const std::vector<AABB>& boxes) {
+    Clear();
+    if (boxes.empty()) return;
+
+    const uint32_t primitiveCount = static_cast<uint32_t>(boxes.size());
+    m_boxes = boxes;
+    m_primitiveIndices.resize(primitiveCount);
+    m_centroids.resize(primitiveCount);
+    for (uint32_t i = 0; i < primitiveCount; ++i) {
+      m_primitiveIndices[i] = i;
+      m_centroids[i] = (glm::vec3(boxes[i].min) + glm::vec3(boxes[i].max)) * 0.5f;
+    }
+
+    m_nodes.reserve(2 * primitiveCount - 1);
+    m_parents.reserve(2 * primitiveCount - 1);
+    m_nodes.emplace_back();
+    m_parents.push_back(INVALID_NODE);
+    m_nodes[0].leftFirst = 0;
+    m_nodes[0].count = primitiveCount;
+
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+      uint32_t nodeIndex = stack.back();
+      stack.pop_back();
+
+      UpdateNodeBounds(nodeIndex);
+
+      uint32_t leftCount = Split(nodeIndex);
+      if (leftCount == 0) continue;  // Stays a leaf
+
+      BVHNode& node = m_nodes[nodeIndex];
+      const uint32_t first = node.leftFirst;
+      const uint32_t count = node.count;
+      const uint32_t leftIndex = static_cast<uint32_t>(m_nodes.size());
+
+      BVHNode left, right;
+      left.leftFirst = first;
+      left.count = leftCount;
+      right.leftFirst = first + leftCount;
+      right.count = count - leftCount;
+
+      m_nodes[nodeIndex].leftFirst = leftIndex;
+      m_nodes[nodeIndex].count = 0;
+      m_nodes.push_back(left);
+      m_nodes.push_back(right);
+      m_parents.push_back(nodeIndex);
+      m_parents.push_back(nodeIndex);
+
+      stack.push_back(leftIndex);
+      stack.push_back(leftIndex + 1);
+    }
+
+    // Interior bounds were computed from the whole range already, leaves own their primitives
+    m_primitiveLeaves.resize(primitiveCount);
+    for (uint32_t nodeIndex = 0; nodeIndex < m_nodes.size(); ++nodeIndex) {
+      const BVHNode& node = m_nodes[nodeIndex];
+      if (!node.IsLeaf()) continue;
+      for (uint32_t i = 0; i < node.count; ++i) m_primitiveLeaves[m_primitiveIndices[node.leftFirst + i]] = nodeIndex;
+    }
+    m_centroids = std::vector<glm::vec3>();  // Only needed while building
+  }
+
+  // Full bottom-up refit with new boxes for every primitive, the topology is kept
+  void Refit(const std::vector<AABB>& boxes) {
+    if (boxes.size() != m_boxes.size()) {
+      Build(boxes);
+      return;
+    }
+    m_boxes = boxes;
+    for (size_t i = m_nodes.size(); i-- > 0;) RefitNode(static_cast<uint32_t>(i));
+  }
+
+  // Incremental refit : only the leaf of 'primitive' and its ancestors are touched
+  void UpdatePrimitive(uint32_t primitive, const AABB& box) {
+    m_boxes[primitive] = box;
+    for (uint32_t nodeIndex = m_primitiveLeaves[primitive]; nodeIndex != INVALID_NODE; nodeIndex = m_parents[nodeIndex]) {
+      RefitNode(nodeIndex);
+    }
+  }
+
+  // outVisible[primitive] = 1 if its box intersects the frustum, 0 otherwise (one entry per primitive)
+  void CullFrustum(const std::array<FrustumPlane, 6>& frustum, uint32_t* outVisible) const {
+    std::fill(outVisible, outVisible + m_boxes.size(), 0u);
+    if (m_nodes.empty()) return;
+
+    struct Entry {
+      uint32_t node;
+      uint32_t planeMask;  // planes the node is not fully inside of yet
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64);
+    stack.push_back({0, 0x3F});
+
+    while (!stack.empty()) {
+      Entry entry = stack.back();
+      stack.pop_back();
+      const BVHNode& node = m_nodes[entry.node];
+
+      glm::vec3 center = (node.min + node.max) * 0.5f;
+      glm::vec3 extent = (node.max - node.min) * 0.5f;
+
+      bool isOutside = false;
+      for (uint32_t p = 0; p < 6 && !isOutside; ++p) {
+        if ((entry.planeMask & (1u << p)) == 0) continue;
+        float centerDistance = glm::dot(frustum[p].normal, center) + frustum[p].distance;
+        float radius = glm::dot(glm::abs(frustum[p].normal), extent);
+        if (centerDistance + radius < 0.0f) {
+          isOutside = true;
+        } else if (centerDistance - radius >= 0.0f) {
+          entry.planeMask &= ~(1u << p);
+        }
+      }
+      if (isOutside) continue;
+
+      if (entry.planeMask == 0) {
+        MarkSubtree(entry.node, outVisible);
+      } else if (node.IsLeaf()) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+          uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+          outVisible[primitive] = isAABBInsideFrustum(frustum, m_boxes[primitive]) ? 1u : 0u;
+        }
+      } else {
+        stack.push_back({node.leftFirst, entry.planeMask});
+        stack.push_back({node.leftFirst + 1, entry.planeMask});
+      }
+    }
+  }
+
+  // primitiveTest(primitive, ray, inout closestDistance) -> true if it hit closer than closestDistance
+  template <typename PrimitiveTest>
+  RayHit Raycast(const Ray& ray, float maxDistance, PrimitiveTest&& primitiveTest) const {
+    RayHit hit;
+    hit.distance = maxDistance;
+    if (m_nodes.empty()) return hit;
+
+    const glm::vec3 invDirection = SafeInverse(ray.direction);
+
+    // Grows with the depth, SAH trees over skewed scenes can be far deeper than log2(primitives)
+    std::vector<uint32_t> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+      const BVHNode& node = m_nodes[stack.back()];
+      stack.pop_back();
+      if (IntersectRayAABB(ray.origin, invDirection, node.min, node.max, hit.distance) == std::numeric_limits<float>::max()) continue;
+
+      if (node.IsLeaf()) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+          uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+          if (primitiveTest(primitive, ray, hit.distance)) hit.primitive = primitive;
+        }
+        continue;
+      }
+
+      // Closer child is popped first, the farther one is often rejected by the shrunk hit distance
+      const BVHNode& left = m_nodes[node.leftFirst];
+      const BVHNode& right = m_nodes[node.leftFirst + 1];
+      float leftDistance = IntersectRayAABB(ray.origin, invDirection, left.min, left.max, hit.distance);
+      float rightDistance = IntersectRayAABB(ray.origin, invDirection, right.min, right.max, hit.distance);
+      uint32_t nearChild = leftDistance <= rightDistance ? node.leftFirst : node.leftFirst + 1;
+      uint32_t farChild = leftDistance <= rightDistance ? node.leftFirst + 1 : node.leftFirst;
+
+      const float MISS = std::numeric_limits<float>::max();
+      if ((std::max)(leftDistance, rightDistance) != MISS) stack.push_back(farChild);
+      if ((std::min)(leftDistance, rightDistance) != MISS) stack.push_back(nearChild);
+    }
+    return hit;
+  }
+
+  // Closest primitive box along the ray
+  RayHit Raycast(const Ray& ray, float maxDistance = std::numeric_limits<float>::max()) const {
+    const glm::vec3 invDirection = SafeInverse(ray.direction);
+    return Raycast(ray, maxDistance, [this, &invDirection](uint32_t primitive, const Ray& r, float& closestDistance) {
+      float t = IntersectRayAABB(r.origin, invDirection, m_boxes[primitive].min, m_boxes[primitive].max, closestDistance);
+      if (t == std::numeric_limits<float>::max()) return false;
+      closestDistance = t;
+      return true;
+    });
+  }
+
+  // 1 / direction with zero components nudged off zero, a slab at the ray origin would give 0 * inf = NaN otherwise
+  static glm::vec3 SafeInverse(const glm::vec3& direction) {
+    const float EPSILON = 1e-20f;
+    glm::vec3 safe;
+    for (int i = 0; i < 3; ++i) safe[i] = std::abs(direction[i]) < EPSILON ? (direction[i] < 0.0f ? -EPSILON : EPSILON) : direction[i];
+    return 1.0f / safe;
+  }
+
+  // Entry distance of the ray into [min, max] (0 when it starts inside), FLT_MAX on a miss or beyond maxDistance
+  static float IntersectRayAABB(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& min, const glm::vec3& max,
+                                float maxDistance) {
+    glm::vec3 t0 = (min - origin) * invDirection;
+    glm::vec3 t1 = (max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = (std::max)((std::max)(tNear.x, tNear.y), (std::max)(tNear.z, 0.0f));
+    float exit = (std::min)((std::min)(tFar.x, tFar.y), tFar.z);
+    return enter <= exit && enter < maxDistance ? enter : std::numeric_limits<float>::max();
+  }
+
+  bool IsEmpty() const { return m_nodes.empty(); }
+  uint32_t GetPrimitiveCount() const { return static_cast<uint32_t>(m_boxes.size()); }
+  const std::vector<BVHNode>& GetNodes() const { return m_nodes; }
+  const std::vector<uint32_t>& GetPrimitiveIndices() const { return m_primitiveIndices; }
+  const AABB& GetPrimitiveBox(uint32_t primitive) const { return m_boxes[primitive]; }
+
+ private:
+  std::vector<BVHNode> m_nodes;
+  std::vector<uint32_t> m_primitiveIndices;  // leaves reference [leftFirst, leftFirst + count) of this list
+  std::vector<AABB> m_boxes;                 // per primitive, world space
+  std::vector<uint32_t> m_parents;           // per node, kept out of BVHNode to keep it 32 bytes
+  std::vector<uint32_t> m_primitiveLeaves;   // per primitive
+  std::vector<glm::vec3> m_centroids;        // per primitive, Build() only
+
+  void UpdateNodeBounds(uint32_t nodeIndex) {
+    BVHNode& node = m_nodes[nodeIndex];
+    node.min = glm::vec3(std::numeric_limits<float>::max());
+    node.max = glm::vec3(std::numeric_limits<float>::lowest());
+    for (uint32_t i = 0; i < node.count; ++i) {
+      const AABB& box = m_boxes[m_primitiveIndices[node.leftFirst + i]];
+      node.min = glm::min(node.min, glm::vec3(box.min));
+      node.max = glm::max(node.max, glm::vec3(box.max));
+    }
+  }
+
+  void RefitNode(uint32_t nodeIndex) {
+    BVHNode& node = m_nodes[nodeIndex];
+    if (node.IsLeaf()) {
+      UpdateNodeBounds(nodeIndex);
+      return;
+    }
+    const BVHNode& left = m_nodes[node.leftFirst];
+    const BVHNode& right = m_nodes[node.leftFirst + 1];
+    node.min = glm::min(left.min, right.min);
+    node.max = glm::max(left.max, right.max);
+  }
+
+  void MarkSubtree(uint32_t nodeIndex, uint32_t* outVisible) const {
+    std::vector<uint32_t> stack = {nodeIndex};
+    while (!stack.empty()) {
+      const BVHNode& node = m_nodes[stack.back()];
+      stack.pop_back();
+      if (node.IsLeaf()) {
+        for (uint32_t i = 0; i < node.count; ++i) outVisible[m_primitiveIndices[node.leftFirst + i]] = 1u;
+      } else {
+        stack.push_back(node.leftFirst);
+        stack.push_back(node.leftFirst + 1);
+      }
+    }
+  }
+
+  static float SurfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+  }
+
+  // Binned SAH over primitive centroids, partitions the node's range and returns the left count (0 = keep as a leaf)
+  uint32_t Split(uint32_t nodeIndex) {
+    const BVHNode& node = m_nodes[nodeIndex];
+    if (node.count <= MAX_LEAF_SIZE) return 0;
+
+    glm::vec3 centroidMin(std::numeric_limits<float>::max());
+    glm::vec3 centroidMax(std::numeric_limits<float>::lowest());
+    for (uint32_t i = 0; i < node.count; ++i) {
+      const glm::vec3& c = m_centroids[m_primitiveIndices[node.leftFirst + i]];
+      centroidMin = glm::min(centroidMin, c);
+      centroidMax = glm::max(centroidMax, c);
+    }
+
+    struct Bin {
+      glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+      glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+      uint32_t count = 0;
+    };
+
+    float bestCost = std::numeric_limits<float>::max();
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis) {
+      float extent = centroidMax[axis] - centroidMin[axis];
+      if (extent <= 0.0f) continue;
+
+      Bin bins[BIN_COUNT];
+      float scale = BIN_COUNT / extent;
+      for (uint32_t i = 0; i < node.count; ++i) {
+        uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+        uint32_t b = (std::min)(BIN_COUNT - 1, static_cast<uint32_t>((m_centroids[primitive][axis] - centroidMin[axis]) * scale));
+        bins[b].min = glm::min(bins[b].min, glm::vec3(m_boxes[primitive].min));
+        bins[b].max = glm::max(bins[b].max, glm::vec3(m_boxes[primitive].max));
+        bins[b].count++;
+      }
+
+      // Sweep from both sides, cost of splitting after bin i = A(left) * N(left) + A(right) * N(right)
+      float leftArea[BIN_COUNT - 1], rightArea[BIN_COUNT - 1];
+      uint32_t leftCount[BIN_COUNT - 1], rightCount[BIN_COUNT - 1];
+      Bin leftBox, rightBox;
+      uint32_t leftSum = 0, rightSum = 0;
+      for (uint32_t i = 0; i < BIN_COUNT - 1; ++i) {
+        leftSum += bins[i].count;
+        leftCount[i] = leftSum;
+        leftBox.min = glm::min(leftBox.min, bins[i].min);
+        leftBox.max = glm::max(leftBox.max, bins[i].max);
+        leftArea[i] = leftSum > 0 ? SurfaceArea(leftBox.min, leftBox.max) : 0.0f;
+
+        rightSum += bins[BIN_COUNT - 1 - i].count;
+        rightCount[BIN_COUNT - 2 - i] = rightSum;
+        rightBox.min = glm::min(rightBox.min, bins[BIN_COUNT - 1 - i].min);
+        rightBox.max = glm::max(rightBox.max, bins[BIN_COUNT - 1 - i].max);
+        rightArea[BIN_COUNT - 2 - i] = rightSum > 0 ? SurfaceArea(rightBox.min, rightBox.max) : 0.0f;
+      }
+
+      for (uint32_t i = 0; i < BIN_COUNT - 1; ++i) {
+        if (leftCount[i] == 0 || rightCount[i] == 0) continue;
+        float cost = leftArea[i] * leftCount[i] + rightArea[i] * rightCount[i];
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestSplit = i;
+        }
+      }
+    }
+
+    // Splitting must beat testing every primitive of the node, large nodes are split regardless
+    if (bestAxis < 0) return 0;  // Every centroid is at the same position
+    float leafCost = SurfaceArea(node.min, node.max) * node.count;
+    if (bestCost >= leafCost && node.count <= MAX_LEAF_SIZE * 4) return 0;
+
+    float scale = BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+    uint32_t* first = m_primitiveIndices.data() + node.leftFirst;
+    uint32_t* middle = std::partition(first, first + node.count, [&](uint32_t primitive) {
+      float offset = (m_centroids[primitive][bestAxis] - centroidMin[bestAxis]) * scale;
+      return (std::min)(BIN_COUNT - 1, static_cast<uint32_t>(offset)) <= bestSplit;
+    });
+    return static_cast<uint32_t>(middle - first);
+  }
+};
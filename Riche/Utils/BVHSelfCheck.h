@@ -0,0 +1,179 @@
+#pragma once
+#include <random>
+#include <vector>
+
+#include "BVH.h"
+
+/*
+ * BVH self-check : build, full refit, incremental refit and both queries against brute force over synthetic scenes.
+ *  - Uniform random boxes, many copies of one box (every centroid equal) and an exponentially spaced row that gives
+ *    a very unbalanced tree.
+ *  - Structure : every primitive sits in exactly one leaf, every node contains its children and primitives.
+ *  - Queries : CullFrustum against isAABBInsideFrustum per box, Raycast against the closest IntersectRayAABB over all boxes.
+ */
+
+struct BVHSelfCheckResult {
+  const char* scene = "";
+  uint32_t primitiveCount = 0;
+  uint32_t maxDepth = 0;
+  uint32_t structureErrors = 0;  // after Build, Refit and UpdatePrimitive
+  uint32_t cullMismatches = 0;
+  uint32_t rayMismatches = 0;
+
+  bool IsPassed() const { return structureErrors == 0 && cullMismatches == 0 && rayMismatches == 0; }
+};
+
+// Returns the number of broken invariants, maxDepth is the deepest leaf (root = 0)
+static uint32_t ValidateBVH(const BVH& bvh, uint32_t& maxDepth) {
+  const std::vector<BVHNode>& nodes = bvh.GetNodes();
+  const std::vector<uint32_t>& primitiveIndices = bvh.GetPrimitiveIndices();
+  if (nodes.empty()) return bvh.GetPrimitiveCount() == 0 ? 0 : 1;
+
+  auto contains = [](const glm::vec3& outerMin, const glm::vec3& outerMax, const glm::vec3& innerMin, const glm::vec3& innerMax) {
+    return glm::all(glm::lessThanEqual(outerMin, innerMin)) && glm::all(glm::lessThanEqual(innerMax, outerMax));
+  };
+
+  uint32_t errors = 0;
+  std::vector<uint32_t> seen(bvh.GetPrimitiveCount(), 0);
+  std::vector<std::pair<uint32_t, uint32_t>> stack = {{0, 0}};  // node, depth
+  while (!stack.empty()) {
+    auto [nodeIndex, depth] = stack.back();
+    stack.pop_back();
+    const BVHNode& node = nodes[nodeIndex];
+    maxDepth = (std::max)(maxDepth, depth);
+
+    if (node.IsLeaf()) {
+      for (uint32_t i = 0; i < node.count; ++i) {
+        const uint32_t primitive = primitiveIndices[node.leftFirst + i];
+        const AABB& box = bvh.GetPrimitiveBox(primitive);
+        seen[primitive]++;
+        errors += contains(node.min, node.max, glm::vec3(box.min), glm::vec3(box.max)) ? 0 : 1;
+      }
+      continue;
+    }
+    // Children are allocated after their parent, in pairs
+    if (node.leftFirst <= nodeIndex || node.leftFirst + 1 >= nodes.size()) {
+      errors++;
+      continue;
+    }
+    for (uint32_t child = node.leftFirst; child <= node.leftFirst + 1; ++child) {
+      errors += contains(node.min, node.max, nodes[child].min, nodes[child].max) ? 0 : 1;
+      stack.push_back({child, depth + 1});
+    }
+  }
+
+  for (uint32_t count : seen) errors += count == 1 ? 0 : 1;
+  return errors;
+}
+
+static void CheckBVHQueries(const BVH& bvh, const std::vector<AABB>& boxes, std::mt19937& rng, BVHSelfCheckResult& result) {
+  glm::vec3 sceneMin(std::numeric_limits<float>::max());
+  glm::vec3 sceneMax(std::numeric_limits<float>::lowest());
+  for (const AABB& box : boxes) {
+    sceneMin = glm::min(sceneMin, glm::vec3(box.min));
+    sceneMax = glm::max(sceneMax, glm::vec3(box.max));
+  }
+  const glm::vec3 sceneCenter = (sceneMin + sceneMax) * 0.5f;
+  const float sceneRadius = glm::length(sceneMax - sceneMin) * 0.5f + 1.0f;
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+  // Cameras around the scene looking at random points inside it
+  std::vector<uint32_t> visible(boxes.size());
+  for (uint32_t view = 0; view < 8; ++view) {
+    glm::vec3 direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 1e-3f, 0.0f));
+    glm::vec3 eye = sceneCenter + direction * sceneRadius;
+    glm::vec3 target = sceneCenter + glm::vec3(unit(rng), unit(rng), unit(rng)) * (sceneMax - sceneMin) * 0.5f;
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.05f, sceneRadius * 2.0f) *
+                               glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+    std::array<FrustumPlane, 6> frustum = CalculateFrustumPlanes(viewProjection);
+
+    bvh.CullFrustum(frustum, visible.data());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      result.cullMismatches += visible[i] != (isAABBInsideFrustum(frustum, boxes[i]) ? 1u : 0u) ? 1 : 0;
+    }
+  }
+
+  // Rays from outside and from inside the scene, the closest distance must match (ties may pick either primitive)
+  for (uint32_t r = 0; r < 256; ++r) {
+    Ray ray;
+    ray.origin = sceneCenter + glm::vec3(unit(rng), unit(rng), unit(rng)) * sceneRadius;
+    glm::vec3 target = sceneCenter + glm::vec3(unit(rng), unit(rng), unit(rng)) * (sceneMax - sceneMin) * 0.5f;
+    ray.direction = glm::normalize(target - ray.origin + glm::vec3(0.0f, 1e-3f, 0.0f));
+
+    const glm::vec3 invDirection = BVH::SafeInverse(ray.direction);
+    float closest = std::numeric_limits<float>::max();
+    for (const AABB& box : boxes) {
+      closest = (std::min)(closest, BVH::IntersectRayAABB(ray.origin, invDirection, box.min, box.max, closest));
+    }
+    result.rayMismatches += bvh.Raycast(ray).distance != closest ? 1 : 0;
+  }
+}
+
+static std::vector<BVHSelfCheckResult> RunBVHSelfCheck() {
+  struct Scene {
+    const char* name;
+    std::vector<AABB> boxes;
+  };
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+  std::vector<Scene> scenes(3);
+  scenes[0].name = "Uniform";
+  for (uint32_t i = 0; i < 20000; ++i) {
+    glm::vec3 center(position(rng), position(rng), position(rng));
+    glm::vec3 extent(size(rng), size(rng), size(rng));
+    scenes[0].boxes.push_back({glm::vec4(center - extent, 1.0f), glm::vec4(center + extent, 1.0f)});
+  }
+  scenes[1].name = "Coincident";
+  scenes[1].boxes.assign(1000, {glm::vec4(-1.0f, -1.0f, -1.0f, 1.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)});
+  scenes[2].name = "Skewed";
+  for (uint32_t i = 0; i < 60; ++i) {
+    // Every split only peels the far end off the row, the tree is about 4x deeper than a balanced one
+    float x = std::pow(2.0f, static_cast<float>(i));
+    scenes[2].boxes.push_back({glm::vec4(x, -1.0f, -1.0f, 1.0f), glm::vec4(x + 1.0f, 1.0f, 1.0f, 1.0f)});
+  }
+
+  std::vector<BVHSelfCheckResult> results;
+  for (Scene& scene : scenes) {
+    BVHSelfCheckResult result;
+    result.scene = scene.name;
+    result.primitiveCount = static_cast<uint32_t>(scene.boxes.size());
+
+    BVH bvh;
+    bvh.Build(scene.boxes);
+    result.structureErrors += ValidateBVH(bvh, result.maxDepth);
+    CheckBVHQueries(bvh, scene.boxes, rng, result);
+
+    // Full refit : every box moves, the topology is kept
+    std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+    for (AABB& box : scene.boxes) {
+      glm::vec4 move(offset(rng), offset(rng), offset(rng), 0.0f);
+      box.min += move;
+      box.max += move;
+    }
+    bvh.Refit(scene.boxes);
+    result.structureErrors += ValidateBVH(bvh, result.maxDepth);
+    CheckBVHQueries(bvh, scene.boxes, rng, result);
+
+    // Incremental refit of every 7th primitive
+    for (uint32_t i = 0; i < scene.boxes.size(); i += 7) {
+      glm::vec4 move(offset(rng), offset(rng), offset(rng), 0.0f);
+      scene.boxes[i].min += move;
+      scene.boxes[i].max += move;
+      bvh.UpdatePrimitive(i, scene.boxes[i]);
+    }
+    result.structureErrors += ValidateBVH(bvh, result.maxDepth);
+    CheckBVHQueries(bvh, scene.boxes, rng, result);
+
+    results.push_back(result);
+  }
+
+  std::cout << "[BVH Self-Check]" << std::endl;
+  for (const BVHSelfCheckResult& result : results) {
+    std::cout << "  " << result.scene << " (" << result.primitiveCount << " boxes, depth " << result.maxDepth
+              << ") : structure errors " << result.structureErrors << ", cull mismatches " << result.cullMismatches
+              << ", ray mismatches " << result.rayMismatches << (result.IsPassed() ? " - passed" : " - FAILED") << std::endl;
+  }
+  return results;
+}
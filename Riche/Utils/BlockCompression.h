@@ -0,0 +1,311 @@
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * BlockCompression : CPU encoders of the BCn formats cooked by TextureCooker, one 4x4 block at a time
+ *  - A block is 16 RGBA8 texels, row major (the caller clamps the edge of an image that is not a multiple of 4).
+ *  - BC1 : opaque RGB, 5:6:5 endpoints on the principal axis of the block, 4 colour mode.
+ *  - BC4 / BC5 : min / max endpoints, 8 value mode. BC5 is two BC4 blocks (R, G), the X / Y of a tangent space normal map.
+ *  - BC7 : mode 6 only (one subset, RGBA 7.7.7.7 + p-bit endpoints, 4 bit indices), principal axis fit and one least
+ *    squares refinement. Below a full mode search in quality, but one code path that is fast enough to cook a scene.
+ */
+
+namespace BlockCompression {
+
+static constexpr uint32_t BLOCK_DIM = 4;
+static constexpr uint32_t BLOCK_TEXELS = BLOCK_DIM * BLOCK_DIM;
+
+// Endpoints of the line through the block (first 'channels' of RGBA) : mean + principal axis (power iteration)
+static void FitEndpoints(const glm::vec4* texels, int channels, glm::vec4& outMin, glm::vec4& outMax) {
+  glm::vec4 mask(0.0f);
+  for (int c = 0; c < channels; ++c) mask[c] = 1.0f;
+
+  glm::vec4 mean(0.0f);
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) mean += texels[i] * mask;
+  mean /= float(BLOCK_TEXELS);
+
+  glm::mat4 covariance(0.0f);
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    glm::vec4 d = (texels[i] - mean) * mask;
+    covariance += glm::outerProduct(d, d);
+  }
+
+  // Start from the widest channel range, a few iterations are enough for 16 points
+  glm::vec4 axis(0.0f);
+  glm::vec4 low(255.0f), high(0.0f);
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    low = glm::min(low, texels[i]);
+    high = glm::max(high, texels[i]);
+  }
+  axis = (high - low) * mask;
+
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    glm::vec4 next = covariance * axis;
+    float length = glm::length(next);
+    if (length < 1e-6f) break;
+    axis = next / length;
+  }
+
+  float axisLength = glm::length(axis);
+  if (axisLength < 1e-6f) {
+    outMin = outMax = mean;
+    return;
+  }
+  axis /= axisLength;
+
+  float tMin = FLT_MAX, tMax = -FLT_MAX;
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    float t = glm::dot((texels[i] - mean) * mask, axis);
+    tMin = (std::min)(tMin, t);
+    tMax = (std::max)(tMax, t);
+  }
+  outMin = glm::clamp(mean + axis * tMin, 0.0f, 255.0f);
+  outMax = glm::clamp(mean + axis * tMax, 0.0f, 255.0f);
+}
+
+static void LoadBlock(const uint8_t* rgba, glm::vec4* texels) {
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    texels[i] = glm::vec4(rgba[i * 4 + 0], rgba[i * 4 + 1], rgba[i * 4 + 2], rgba[i * 4 + 3]);
+  }
+}
+
+// LSB first into a zeroed block
+struct BitWriter {
+  uint8_t* out;
+  uint32_t position = 0;
+
+  void Write(uint32_t value, uint32_t bitCount) {
+    for (uint32_t bit = 0; bit < bitCount; ++bit, ++position) {
+      if ((value >> bit) & 1) out[position >> 3] |= uint8_t(1u << (position & 7));
+    }
+  }
+};
+
+//
+// BC1
+//
+static uint16_t ToRgb565(const glm::vec4& color) {
+  uint32_t r = static_cast<uint32_t>(color.r * 31.0f / 255.0f + 0.5f);
+  uint32_t g = static_cast<uint32_t>(color.g * 63.0f / 255.0f + 0.5f);
+  uint32_t b = static_cast<uint32_t>(color.b * 31.0f / 255.0f + 0.5f);
+  return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static glm::vec4 FromRgb565(uint16_t color) {
+  uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+  return glm::vec4((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255.0f);
+}
+
+// 8 bytes
+static void EncodeBC1Block(const uint8_t* rgba, uint8_t* out) {
+  glm::vec4 texels[BLOCK_TEXELS];
+  LoadBlock(rgba, texels);
+
+  glm::vec4 low, high;
+  FitEndpoints(texels, 3, low, high);
+  uint16_t color0 = ToRgb565(high);
+  uint16_t color1 = ToRgb565(low);
+  if (color0 < color1) std::swap(color0, color1);
+
+  // color0 > color1 selects the 4 colour mode, equal endpoints are a flat block (index 0 everywhere)
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    glm::vec3 palette[4];
+    palette[0] = FromRgb565(color0);
+    palette[1] = FromRgb565(color1);
+    palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+    palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+      uint32_t best = 0;
+      float bestError = FLT_MAX;
+      for (uint32_t p = 0; p < 4; ++p) {
+        glm::vec3 d = glm::vec3(texels[i]) - palette[p];
+        float error = glm::dot(d, d);
+        if (error < bestError) {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= best << (i * 2);
+    }
+  }
+
+  memcpy(out, &color0, 2);
+  memcpy(out + 2, &color1, 2);
+  memcpy(out + 4, &indices, 4);
+}
+
+//
+// BC4 / BC5
+//
+// 8 bytes, one channel of the block
+static void EncodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out) {
+  uint32_t low = 255, high = 0;
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    low = (std::min)(low, uint32_t(rgba[i * 4 + channel]));
+    high = (std::max)(high, uint32_t(rgba[i * 4 + channel]));
+  }
+
+  // red0 > red1 selects the 8 value mode, equal endpoints are a flat block
+  uint64_t indices = 0;
+  if (high != low) {
+    float palette[8];
+    palette[0] = float(high);
+    palette[1] = float(low);
+    for (uint32_t p = 2; p < 8; ++p) palette[p] = ((8 - p) * high + (p - 1) * low) / 7.0f;
+
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+      float value = rgba[i * 4 + channel];
+      uint64_t best = 0;
+      float bestError = FLT_MAX;
+      for (uint32_t p = 0; p < 8; ++p) {
+        float error = std::abs(value - palette[p]);
+        if (error < bestError) {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= best << (i * 3);
+    }
+  }
+
+  out[0] = static_cast<uint8_t>(high);
+  out[1] = static_cast<uint8_t>(low);
+  memcpy(out + 2, &indices, 6);  // 48 bits, little endian
+}
+
+// 16 bytes
+static void EncodeBC5Block(const uint8_t* rgba, uint8_t* out) {
+  EncodeBC4Block(rgba, 0, out);
+  EncodeBC4Block(rgba, 1, out + 8);
+}
+
+//
+// BC7 (mode 6)
+//
+static constexpr uint32_t BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// 7 bit endpoint + shared p-bit, the p-bit with the smaller error wins
+static void QuantizeBC7Endpoint(const glm::vec4& endpoint, uint32_t* outColor, uint32_t* outPBit) {
+  float bestError = FLT_MAX;
+  for (uint32_t p = 0; p < 2; ++p) {
+    uint32_t color[4];
+    float error = 0.0f;
+    for (int c = 0; c < 4; ++c) {
+      int quantized = static_cast<int>(std::floor((endpoint[c] - float(p)) / 2.0f + 0.5f));
+      color[c] = static_cast<uint32_t>(std::clamp(quantized, 0, 127));
+      float d = float((color[c] << 1) | p) - endpoint[c];
+      error += d * d;
+    }
+    if (error < bestError) {
+      bestError = error;
+      memcpy(outColor, color, sizeof(color));
+      *outPBit = p;
+    }
+  }
+}
+
+// Best index per texel against the quantized endpoints, returns the squared error of the block
+static float SelectBC7Indices(const glm::vec4* texels, const uint32_t* color0, uint32_t pBit0, const uint32_t* color1, uint32_t pBit1,
+                              uint32_t* outIndices) {
+  glm::vec4 e0, e1;
+  for (int c = 0; c < 4; ++c) {
+    e0[c] = float((color0[c] << 1) | pBit0);
+    e1[c] = float((color1[c] << 1) | pBit1);
+  }
+
+  glm::vec4 palette[16];
+  for (uint32_t p = 0; p < 16; ++p) {
+    // Same rounding as the decoder, ((64 - w) * e0 + w * e1 + 32) >> 6
+    palette[p] = glm::floor(((64.0f - BC7_WEIGHTS4[p]) * e0 + float(BC7_WEIGHTS4[p]) * e1 + 32.0f) / 64.0f);
+  }
+
+  float totalError = 0.0f;
+  for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+    float bestError = FLT_MAX;
+    for (uint32_t p = 0; p < 16; ++p) {
+      glm::vec4 d = texels[i] - palette[p];
+      float error = glm::dot(d, d);
+      if (error < bestError) {
+        bestError = error;
+        outIndices[i] = p;
+      }
+    }
+    totalError += bestError;
+  }
+  return totalError;
+}
+
+// 16 bytes
+static void EncodeBC7Block(const uint8_t* rgba, uint8_t* out) {
+  glm::vec4 texels[BLOCK_TEXELS];
+  LoadBlock(rgba, texels);
+
+  glm::vec4 low, high;
+  FitEndpoints(texels, 4, low, high);
+
+  uint32_t color0[4], color1[4], pBit0, pBit1;
+  uint32_t indices[BLOCK_TEXELS];
+  QuantizeBC7Endpoint(low, color0, &pBit0);
+  QuantizeBC7Endpoint(high, color1, &pBit1);
+  float error = SelectBC7Indices(texels, color0, pBit0, color1, pBit1, indices);
+
+  // Least squares endpoints for the chosen weights, kept only if the block gets better
+  if (error > 0.0f) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    glm::vec4 ax(0.0f), bx(0.0f);
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+      float b = BC7_WEIGHTS4[indices[i]] / 64.0f;
+      float a = 1.0f - b;
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+      ax += a * texels[i];
+      bx += b * texels[i];
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) > 1e-6f) {
+      glm::vec4 refinedLow = glm::clamp((ax * bb - bx * ab) / determinant, 0.0f, 255.0f);
+      glm::vec4 refinedHigh = glm::clamp((bx * aa - ax * ab) / determinant, 0.0f, 255.0f);
+
+      uint32_t refinedColor0[4], refinedColor1[4], refinedPBit0, refinedPBit1;
+      uint32_t refinedIndices[BLOCK_TEXELS];
+      QuantizeBC7Endpoint(refinedLow, refinedColor0, &refinedPBit0);
+      QuantizeBC7Endpoint(refinedHigh, refinedColor1, &refinedPBit1);
+      float refinedError = SelectBC7Indices(texels, refinedColor0, refinedPBit0, refinedColor1, refinedPBit1, refinedIndices);
+      if (refinedError < error) {
+        memcpy(color0, refinedColor0, sizeof(color0));
+        memcpy(color1, refinedColor1, sizeof(color1));
+        memcpy(indices, refinedIndices, sizeof(indices));
+        pBit0 = refinedPBit0;
+        pBit1 = refinedPBit1;
+      }
+    }
+  }
+
+  // The anchor (texel 0) index is stored without its top bit : swap the endpoints when it is set
+  if (indices[0] & 8) {
+    std::swap_ranges(color0, color0 + 4, color1);
+    std::swap(pBit0, pBit1);
+    for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) indices[i] = 15 - indices[i];
+  }
+
+  memset(out, 0, 16);
+  BitWriter writer = {out};
+  writer.Write(1u << 6, 7);  // mode 6
+  for (int c = 0; c < 4; ++c) {
+    writer.Write(color0[c], 7);
+    writer.Write(color1[c], 7);
+  }
+  writer.Write(pBit0, 1);
+  writer.Write(pBit1, 1);
+  writer.Write(indices[0], 3);
+  for (uint32_t i = 1; i < BLOCK_TEXELS; ++i) writer.Write(indices[i], 4);
+}
+
+}  // namespace BlockCompression
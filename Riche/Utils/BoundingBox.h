@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Parallel.h"
+
 struct FrustumPlane {
   glm::vec3 normal;
   float distance;
@@ -10,14 +12,6 @@ struct AABB {
   glm::vec4 max;  // maximum coord
 };
 
-struct AABBBufferList {
-  VkBuffer vertexBuffer;
-  VkDeviceMemory vertexBufferMemory;
-
-  VkBuffer indexBuffer;
-  VkDeviceMemory indexBufferMemory;
-};
-
 struct BoundingSphere {
   glm::vec3 center;
   float radius;
@@ -50,19 +44,19 @@ static std::array<FrustumPlane, 6> CalculateFrustumPlanes(const glm::mat4& viewP
                 viewProjectionMatrix[2][3] + viewProjectionMatrix[2][1]);
   planes[3].distance = viewProjectionMatrix[3][3] + viewProjectionMatrix[3][1];
 
-  // Near plane (Vulkan z = 0)
+  // Near plane (Vulkan의 z = 0)
   planes[4].normal =
       glm::vec3(viewProjectionMatrix[0][3] + viewProjectionMatrix[0][2], viewProjectionMatrix[1][3] + viewProjectionMatrix[1][2],
                 viewProjectionMatrix[2][3] + viewProjectionMatrix[2][2]);
   planes[4].distance = viewProjectionMatrix[3][3] + viewProjectionMatrix[3][2];
 
-  // Far plane (Vulkan z = 1)
+  // Far plane (Vulkan의 z = 1)
   planes[5].normal =
       glm::vec3(viewProjectionMatrix[0][3] - viewProjectionMatrix[0][2], viewProjectionMatrix[1][3] - viewProjectionMatrix[1][2],
                 viewProjectionMatrix[2][3] - viewProjectionMatrix[2][2]);
   planes[5].distance = viewProjectionMatrix[3][3] - viewProjectionMatrix[3][2];
 
-  // Normalize the planes (distance  ̷  )
+  // Normalize the planes (distance는 노멀의 길이로 나누지 않음)
   for (auto& plane : planes) {
     float length = glm::length(plane.normal);
     plane.normal /= length;
@@ -76,20 +70,20 @@ static bool isAABBInsideFrustum(const std::array<FrustumPlane, 6>& frustum, cons
   for (int i = 0; i < 6; i++) {
     const FrustumPlane& plane = frustum[i];
 
-    // ٿ ڽ "  "  
+    // 바운딩 박스의 "가장 먼 쪽" 점 선택
     glm::vec3 positiveVertex =
         glm::vec3((plane.normal.x < 0) ? aabb.min.x : aabb.max.x, (plane.normal.y < 0) ? aabb.min.y : aabb.max.y,
                   (plane.normal.z < 0) ? aabb.min.z : aabb.max.z);
 
-    //    Ÿ 
+    // 평면과 점 사이의 거리 계산
     float distance = glm::dot(plane.normal, positiveVertex) + plane.distance;
 
-    // Ʈ  ۿ 
-    if (distance >= 0) {
-      return true;
+    // "가장 먼 쪽" 점도 평면 뒤에 있으면 오브젝트가 프러스텀 밖에 있음
+    if (distance < 0) {
+      return false;
     }
   }
-  return false;  // AABB  ȿ 
+  return true;  // AABB가 프러스텀 안에 있음 (또는 걸쳐 있음)
 }
 
 
@@ -98,21 +92,28 @@ static AABB ComputeAABB(const std::vector<VERTEX>& vertices) {
   glm::vec3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
   glm::vec3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
 
-  // Update min/max, visiting each point
-  for (const auto& vertex : vertices) {
-    min = glm::min(min, vertex.pos);
-    max = glm::max(max, vertex.pos);
-  }
-
-  return {glm::vec4(min, 1.0f), glm::vec4(max, 1.0f)};
+  // Update min/max, visiting each point (large meshes are split across the job system)
+  AABB identity = {glm::vec4(min, 1.0f), glm::vec4(max, 1.0f)};
+  return ParallelReduce(
+      0, vertices.size(), 16384, identity,
+      [&vertices](size_t begin, size_t end, AABB bounds) {
+        glm::vec3 localMin = bounds.min;
+        glm::vec3 localMax = bounds.max;
+        for (size_t i = begin; i < end; ++i) {
+          localMin = glm::min(localMin, glm::vec3(vertices[i].pos));
+          localMax = glm::max(localMax, glm::vec3(vertices[i].pos));
+        }
+        return AABB{glm::vec4(localMin, 1.0f), glm::vec4(localMax, 1.0f)};
+      },
+      [](const AABB& a, const AABB& b) { return AABB{glm::min(a.min, b.min), glm::max(a.max, b.max)}; });
 }
 
 static std::vector<glm::vec3> CreateAABBVertexBuffer(const AABB& aabb) {
-  // AABB ü min max glm::vec4 , ⼭ ġ  մϴ.
+  // AABB 구조체의 min과 max는 glm::vec4 형식이지만, 여기서는 위치 정보로 사용합니다.
   glm::vec3 min = glm::vec3(aabb.min);
   glm::vec3 max = glm::vec3(aabb.max);
 
-  // 8 ڳʸ մϴ.
+  // 8개의 코너를 정의합니다.
   std::vector<glm::vec3> vertices = {
       glm::vec3(min.x, min.y, min.z),  // 0
       glm::vec3(max.x, min.y, min.z),  // 1
@@ -130,7 +131,7 @@ static std::vector<glm::vec3> CreateAABBVertexBuffer(const AABB& aabb) {
 static std::vector<uint32_t> CreateAABBIndexBuffer() {
   const uint32_t PRIMITIVE_RESTART = 0xFFFFFFFF;
 
-  //  迭 Ʒ  Ǿ ִٰ :
+  // 정점 배열은 아래와 같이 구성되어 있다고 가정:
   // 0: bottom front left
   // 1: bottom front right
   // 2: top front right
@@ -140,16 +141,16 @@ static std::vector<uint32_t> CreateAABBIndexBuffer() {
   // 6: top back right
   // 7: top back left
   //
-  // 12 ()  ϴ.
+  // 12개 에지(라인)는 다음과 같습니다.
   // Bottom face (y = min): edges: 0-1, 1-5, 5-4, 4-0
   // Top face (y = max):    edges: 3-2, 2-6, 6-7, 7-3
   // Vertical edges:       edges: 0-3, 1-2, 5-6, 4-7
 
-  //std::vector<uint32_t> indices = {// ظ (y = min): v0, v1, v5, v4
+  //std::vector<uint32_t> indices = {// 밑면 (y = min): v0, v1, v5, v4
   //                                 0, 1, 1, 5, 5, 4, 4, 0,
-  //                                 //  (y = max): v3, v2, v6, v7
+  //                                 // 윗면 (y = max): v3, v2, v6, v7
   //                                 3, 2, 2, 6, 6, 7, 7, 3,
-  //                                 //  ()
+  //                                 // 수직선 (측면)
   //                                 0, 3, 1, 2, 5, 6, 4, 7};
 
       std::vector<uint32_t> indices = {// --- Front (z=min)
@@ -175,13 +176,13 @@ static std::vector<uint32_t> CreateAABBIndexBuffer() {
 }
 
 static AABB TransformAABB(const AABB& aabb, const glm::mat4& modelMatrix) {
-  // AABB 8  
+  // AABB의 8개의 꼭짓점 계산
   glm::vec3 corners[8] = {glm::vec3(aabb.min.x, aabb.min.y, aabb.min.z), glm::vec3(aabb.min.x, aabb.min.y, aabb.max.z),
                           glm::vec3(aabb.min.x, aabb.max.y, aabb.min.z), glm::vec3(aabb.min.x, aabb.max.y, aabb.max.z),
                           glm::vec3(aabb.max.x, aabb.min.y, aabb.min.z), glm::vec3(aabb.max.x, aabb.min.y, aabb.max.z),
                           glm::vec3(aabb.max.x, aabb.max.y, aabb.min.z), glm::vec3(aabb.max.x, aabb.max.y, aabb.max.z)};
 
-  // ȯ  Ͽ ο AABB 
+  // 변환된 꼭짓점들을 사용하여 새로운 AABB 계산
   glm::vec3 newMin(std::numeric_limits<float>::max());
   glm::vec3 newMax(std::numeric_limits<float>::lowest());
 
@@ -194,15 +195,35 @@ static AABB TransformAABB(const AABB& aabb, const glm::mat4& modelMatrix) {
   return {glm::vec4(newMin, 1.0f), glm::vec4(newMax, 1.0f)};
 }
 
+// Largest side in pixels of the screen rectangle around the box (object space AABB, mvp = projection * view * model).
+// A box crossing the near plane covers the screen, it returns FLT_MAX. Same as ComputeProjectedSize of CullingCommon.glsl.
+static float ComputeProjectedSize(const AABB& aabb, const glm::mat4& mvp, const glm::vec2& viewport) {
+  glm::vec2 ndcMin(std::numeric_limits<float>::max());
+  glm::vec2 ndcMax(std::numeric_limits<float>::lowest());
+
+  for (int i = 0; i < 8; ++i) {
+    glm::vec3 corner((i & 1) ? aabb.max.x : aabb.min.x, (i & 2) ? aabb.max.y : aabb.min.y, (i & 4) ? aabb.max.z : aabb.min.z);
+    glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+    if (clip.w <= 0.0f) return std::numeric_limits<float>::max();
+
+    glm::vec2 ndc = glm::vec2(clip) / clip.w;
+    ndcMin = glm::min(ndcMin, ndc);
+    ndcMax = glm::max(ndcMax, ndc);
+  }
+
+  glm::vec2 size = (ndcMax - ndcMin) * 0.5f * viewport;
+  return (std::max)(size.x, size.y);
+}
+
 static BoundingSphere ComputeBoundingSphere(const std::vector<glm::vec3>& vertices) {
-  // 1.   ߽ մϴ.
+  // 1. 모든 정점의 중심을 계산합니다.
   glm::vec3 center(0.0f);
   for (const auto& vertex : vertices) {
     center += vertex;
   }
   center /= static_cast<float>(vertices.size());
 
-  // 2. ߽κ   Ÿ   ū   մϴ.
+  // 2. 중심점으로부터 각 정점까지의 거리 중 가장 큰 값을 반지름으로 설정합니다.
   float radius = 0.0f;
   for (const auto& vertex : vertices) {
     float distance = glm::length(vertex - center);
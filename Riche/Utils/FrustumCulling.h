@@ -0,0 +1,189 @@
+#pragma once
+#include <immintrin.h>
+#include <intrin.h>
+
+#include "BoundingBox.h"
+#include "Rendering/Components.h"
+
+/*
+ * Batched frustum culling for the CPU path
+ *  - World bounds are kept as SoA center / extent arrays. The extent of a transformed box is |M| * extent,
+ *    which is exactly the AABB of its 8 transformed corners.
+ *  - A box is outside when dot(n, center) + dot(|n|, extent) + d < 0 for any plane (planes point inwards).
+ *  - CullAABBs() runs AVX2 (8 boxes) or SSE2 (4 boxes) picked once from cpuid, CullAABBsScalar() is the reference
+ *    both of them must match.
+ */
+
+enum class SimdLevel {
+  Scalar,
+  SSE2,
+  AVX2,
+};
+
+struct AABBSoA {
+  std::vector<float> centerX, centerY, centerZ;
+  std::vector<float> extentX, extentY, extentZ;
+
+  void Resize(size_t count) {
+    for (std::vector<float>* v : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ}) v->resize(count);
+  }
+  size_t Size() const { return centerX.size(); }
+};
+
+static SimdLevel DetectSimdLevel() {
+  int info[4] = {};
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+
+  __cpuid(info, 1);
+  const bool hasSSE2 = (info[3] & (1 << 26)) != 0;
+  const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+  const bool hasAVX = (info[2] & (1 << 28)) != 0;
+
+  bool hasAVX2 = false;
+  if (maxLeaf >= 7) {
+    __cpuidex(info, 7, 0);
+    hasAVX2 = (info[1] & (1 << 5)) != 0;
+  }
+
+  // The OS must save the YMM registers on context switch too
+  if (hasOSXSAVE && hasAVX && hasAVX2 && (_xgetbv(0) & 0x6) == 0x6) return SimdLevel::AVX2;
+  if (hasSSE2) return SimdLevel::SSE2;
+  return SimdLevel::Scalar;
+}
+
+static SimdLevel GetSimdLevel() {
+  static const SimdLevel s_level = DetectSimdLevel();
+  return s_level;
+}
+
+static const char* GetSimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::AVX2:
+      return "AVX2";
+    case SimdLevel::SSE2:
+      return "SSE2";
+    default:
+      return "Scalar";
+  }
+}
+
+// World space bounds of boxes[begin, end) with transforms[i].currentTransform, written to the same indices of 'out'
+static void ComputeWorldBounds(const std::vector<AABB>& boxes, const std::vector<Transform>& transforms, size_t begin, size_t end,
+                               AABBSoA& out) {
+  for (size_t i = begin; i < end; ++i) {
+    const glm::mat4& model = transforms[i].currentTransform;
+    glm::vec3 center = (glm::vec3(boxes[i].min) + glm::vec3(boxes[i].max)) * 0.5f;
+    glm::vec3 extent = (glm::vec3(boxes[i].max) - glm::vec3(boxes[i].min)) * 0.5f;
+
+    glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+    glm::vec3 worldExtent = glm::abs(glm::vec3(model[0])) * extent.x + glm::abs(glm::vec3(model[1])) * extent.y +
+                            glm::abs(glm::vec3(model[2])) * extent.z;
+
+    out.centerX[i] = worldCenter.x;
+    out.centerY[i] = worldCenter.y;
+    out.centerZ[i] = worldCenter.z;
+    out.extentX[i] = worldExtent.x;
+    out.extentY[i] = worldExtent.y;
+    out.extentZ[i] = worldExtent.z;
+  }
+}
+
+// outVisible[i] = 1 if bounds[i] intersects the frustum, 0 otherwise
+static void CullAABBsScalar(const std::array<FrustumPlane, 6>& frustum, const AABBSoA& bounds, size_t begin, size_t end,
+                            uint32_t* outVisible) {
+  for (size_t i = begin; i < end; ++i) {
+    uint32_t visible = 1;
+    for (const FrustumPlane& plane : frustum) {
+      float distance = plane.normal.x * bounds.centerX[i] + plane.normal.y * bounds.centerY[i] + plane.normal.z * bounds.centerZ[i] +
+                       std::abs(plane.normal.x) * bounds.extentX[i] + std::abs(plane.normal.y) * bounds.extentY[i] +
+                       std::abs(plane.normal.z) * bounds.extentZ[i] + plane.distance;
+      visible &= distance >= 0.0f ? 1u : 0u;
+    }
+    outVisible[i] = visible;
+  }
+}
+
+static void CullAABBsSSE2(const std::array<FrustumPlane, 6>& frustum, const AABBSoA& bounds, size_t begin, size_t end,
+                          uint32_t* outVisible) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    const __m128 cx = _mm_loadu_ps(&bounds.centerX[i]);
+    const __m128 cy = _mm_loadu_ps(&bounds.centerY[i]);
+    const __m128 cz = _mm_loadu_ps(&bounds.centerZ[i]);
+    const __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+    const __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+    const __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (const FrustumPlane& plane : frustum) {
+      const __m128 nx = _mm_set1_ps(plane.normal.x);
+      const __m128 ny = _mm_set1_ps(plane.normal.y);
+      const __m128 nz = _mm_set1_ps(plane.normal.z);
+
+      // Same order of operations as CullAABBsScalar, so boxes on a plane get the same answer
+      __m128 distance = _mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy));
+      distance = _mm_add_ps(distance, _mm_mul_ps(nz, cz));
+      distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, nx), ex));
+      distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey));
+      distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+      distance = _mm_add_ps(distance, _mm_set1_ps(plane.distance));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+    }
+    // All ones -> 1, zero -> 0
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outVisible + i), _mm_srli_epi32(_mm_castps_si128(inside), 31));
+  }
+  CullAABBsScalar(frustum, bounds, i, end, outVisible);
+}
+
+static void CullAABBsAVX2(const std::array<FrustumPlane, 6>& frustum, const AABBSoA& bounds, size_t begin, size_t end,
+                          uint32_t* outVisible) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    const __m256 cx = _mm256_loadu_ps(&bounds.centerX[i]);
+    const __m256 cy = _mm256_loadu_ps(&bounds.centerY[i]);
+    const __m256 cz = _mm256_loadu_ps(&bounds.centerZ[i]);
+    const __m256 ex = _mm256_loadu_ps(&bounds.extentX[i]);
+    const __m256 ey = _mm256_loadu_ps(&bounds.extentY[i]);
+    const __m256 ez = _mm256_loadu_ps(&bounds.extentZ[i]);
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const FrustumPlane& plane : frustum) {
+      const __m256 nx = _mm256_set1_ps(plane.normal.x);
+      const __m256 ny = _mm256_set1_ps(plane.normal.y);
+      const __m256 nz = _mm256_set1_ps(plane.normal.z);
+
+      // No FMA : a fused multiply-add rounds once and would disagree with the scalar reference on the planes
+      __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy));
+      distance = _mm256_add_ps(distance, _mm256_mul_ps(nz, cz));
+      distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_andnot_ps(signMask, nx), ex));
+      distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_andnot_ps(signMask, ny), ey));
+      distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_andnot_ps(signMask, nz), ez));
+      distance = _mm256_add_ps(distance, _mm256_set1_ps(plane.distance));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(outVisible + i), _mm256_srli_epi32(_mm256_castps_si256(inside), 31));
+  }
+  CullAABBsScalar(frustum, bounds, i, end, outVisible);
+}
+
+static void CullAABBs(const std::array<FrustumPlane, 6>& frustum, const AABBSoA& bounds, size_t begin, size_t end,
+                      uint32_t* outVisible, SimdLevel level = GetSimdLevel()) {
+  switch (level) {
+    case SimdLevel::AVX2:
+      CullAABBsAVX2(frustum, bounds, begin, end, outVisible);
+      break;
+    case SimdLevel::SSE2:
+      CullAABBsSSE2(frustum, bounds, begin, end, outVisible);
+      break;
+    default:
+      CullAABBsScalar(frustum, bounds, begin, end, outVisible);
+      break;
+  }
+}
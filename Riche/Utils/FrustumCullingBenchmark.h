@@ -0,0 +1,112 @@
+#pragma once
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "BVH.h"
+#include "FrustumCulling.h"
+
+/*
+ * Boxes/sec microbenchmark : per-box isAABBInsideFrustum (previous CPU path, min/max transformed only)
+ * vs the SoA kernels (scalar reference and the SIMD level picked at runtime) vs the BVH walk, 10k - 1M boxes.
+ * The BVH is built from TransformAABB corners, not the center / |M| extent bounds of the kernels. Boxes touching a plane can
+ * differ between the two by rounding alone, so the BVH is checked against isAABBInsideFrustum over its own boxes.
+ */
+
+struct FrustumCullingBenchmarkResult {
+  uint32_t boxCount = 0;
+  double legacyMs = 0.0;       // transform min/max + isAABBInsideFrustum
+  double boundsMs = 0.0;       // ComputeWorldBounds (shared by the two kernels below)
+  double scalarMs = 0.0;       // CullAABBsScalar
+  double simdMs = 0.0;         // CullAABBs with GetSimdLevel()
+  double bvhBuildMs = 0.0;     // BVH::Build over the world boxes (once per scene, not per frame)
+  double bvhMs = 0.0;          // BVH::CullFrustum
+  uint32_t simdMismatchCount = 0;  // CullAABBs != CullAABBsScalar
+  uint32_t bvhMismatchCount = 0;   // BVH::CullFrustum != isAABBInsideFrustum on the same world boxes
+};
+
+static std::vector<FrustumCullingBenchmarkResult> RunFrustumCullingBenchmark(uint32_t repeatCount = 5) {
+  using Clock = std::chrono::high_resolution_clock;
+  const std::array<uint32_t, 3> boxCounts = {10000, 100000, 1000000};
+
+  // Best of 'repeatCount' runs, the first one also warms the caches
+  auto bestMs = [repeatCount](auto&& fn) {
+    double best = std::numeric_limits<double>::max();
+    for (uint32_t r = 0; r < repeatCount; ++r) {
+      auto begin = Clock::now();
+      fn();
+      best = (std::min)(best, std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+    }
+    return best;
+  };
+
+  // Camera at the origin looking down -z, boxes spread around it so about 5% of them survive
+  glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.05f, 500.0f) *
+                             glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  std::array<FrustumPlane, 6> frustum = CalculateFrustumPlanes(viewProjection);
+
+  std::vector<FrustumCullingBenchmarkResult> results;
+  for (uint32_t boxCount : boxCounts) {
+    std::mt19937 rng(boxCount);
+    std::uniform_real_distribution<float> position(-300.0f, 300.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+    std::vector<AABB> boxes(boxCount);
+    std::vector<Transform> transforms(boxCount);
+    for (uint32_t i = 0; i < boxCount; ++i) {
+      glm::vec3 extent(size(rng), size(rng), size(rng));
+      boxes[i] = {glm::vec4(-extent, 1.0f), glm::vec4(extent, 1.0f)};
+      transforms[i].currentTransform =
+          glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng))), angle(rng),
+                      glm::normalize(glm::vec3(position(rng), position(rng), position(rng)) + glm::vec3(0.0f, 1e-3f, 0.0f)));
+    }
+
+    FrustumCullingBenchmarkResult result;
+    result.boxCount = boxCount;
+
+    std::vector<uint32_t> legacyVisible(boxCount);
+    result.legacyMs = bestMs([&]() {
+      for (uint32_t i = 0; i < boxCount; ++i) {
+        AABB aabb = boxes[i];
+        aabb.max = transforms[i].currentTransform * aabb.max;
+        aabb.min = transforms[i].currentTransform * aabb.min;
+        legacyVisible[i] = isAABBInsideFrustum(frustum, aabb);
+      }
+    });
+
+    AABBSoA bounds;
+    bounds.Resize(boxCount);
+    result.boundsMs = bestMs([&]() { ComputeWorldBounds(boxes, transforms, 0, boxCount, bounds); });
+
+    std::vector<uint32_t> scalarVisible(boxCount);
+    std::vector<uint32_t> simdVisible(boxCount);
+    result.scalarMs = bestMs([&]() { CullAABBsScalar(frustum, bounds, 0, boxCount, scalarVisible.data()); });
+    result.simdMs = bestMs([&]() { CullAABBs(frustum, bounds, 0, boxCount, simdVisible.data()); });
+
+    std::vector<AABB> worldBoxes(boxCount);
+    for (uint32_t i = 0; i < boxCount; ++i) worldBoxes[i] = TransformAABB(boxes[i], transforms[i].currentTransform);
+
+    BVH bvh;
+    std::vector<uint32_t> bvhVisible(boxCount);
+    auto buildBegin = Clock::now();
+    bvh.Build(worldBoxes);  // Timed once, a 1M box build is too slow to repeat
+    result.bvhBuildMs = std::chrono::duration<double, std::milli>(Clock::now() - buildBegin).count();
+    result.bvhMs = bestMs([&]() { bvh.CullFrustum(frustum, bvhVisible.data()); });
+
+    for (uint32_t i = 0; i < boxCount; ++i) {
+      result.simdMismatchCount += scalarVisible[i] != simdVisible[i] ? 1 : 0;
+      result.bvhMismatchCount += (isAABBInsideFrustum(frustum, worldBoxes[i]) ? 1u : 0u) != bvhVisible[i] ? 1 : 0;
+    }
+    results.push_back(result);
+  }
+
+  std::cout << "[Frustum Culling Benchmark] SIMD level: " << GetSimdLevelName(GetSimdLevel()) << std::endl;
+  for (const FrustumCullingBenchmarkResult& result : results) {
+    std::cout << "  " << result.boxCount << " boxes : legacy " << result.legacyMs << " ms, bounds " << result.boundsMs
+              << " ms, scalar " << result.scalarMs << " ms, simd " << result.simdMs << " ms, bvh " << result.bvhMs << " ms (build "
+              << result.bvhBuildMs << " ms), mismatches simd " << result.simdMismatchCount << " / bvh " << result.bvhMismatchCount
+              << std::endl;
+  }
+  return results;
+}
@@ -0,0 +1,193 @@
+#pragma once
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Rendering/Mesh.h"
+
+/*
+ * GltfAccessor : strided views of tinygltf accessors, decoded straight into the final Mesh arrays (loadGltfModel)
+ *  - A View points into model.buffers, nothing is copied before the interleaved BasicVertex / uint32 index is written.
+ *  - Float and normalized integer components (KHR_mesh_quantization exports load too).
+ *  - u8 / u16 indices are widened 16 / 8 at a time with SSE2 (x64 baseline) when they are tightly packed.
+ *  - Decode* work on [begin, end), the loader splits large primitives by vertex / index range across g_JobSystem.
+ */
+
+namespace GltfAccessor {
+
+static constexpr size_t DECODE_GRAIN = 64 * 1024;  // elements per ParallelForRange chunk, smaller primitives decode inline
+
+struct View {
+  const uint8_t* data = nullptr;
+  size_t count = 0;
+  size_t stride = 0;
+  int componentType = -1;
+  int componentCount = 0;
+  bool normalized = false;
+
+  bool IsValid() const { return data != nullptr; }
+};
+
+// Invalid View for a missing / sparse accessor or one that does not fit in its buffer
+static View MakeView(const tinygltf::Model& model, int accessorIndex) {
+  View view;
+  if (accessorIndex < 0 || accessorIndex >= static_cast<int>(model.accessors.size())) return view;
+
+  const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+  if (accessor.bufferView < 0 || accessor.sparse.isSparse || accessor.count == 0) return view;
+
+  const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+  const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+  int stride = accessor.ByteStride(bufferView);
+  if (stride <= 0) return view;
+
+  size_t elementSize = tinygltf::GetNumComponentsInType(accessor.type) * tinygltf::GetComponentSizeInBytes(accessor.componentType);
+  size_t offset = bufferView.byteOffset + accessor.byteOffset;
+  if (offset + (accessor.count - 1) * stride + elementSize > buffer.data.size()) return view;
+
+  view.data = buffer.data.data() + offset;
+  view.count = accessor.count;
+  view.stride = static_cast<size_t>(stride);
+  view.componentType = accessor.componentType;
+  view.componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+  view.normalized = accessor.normalized;
+  return view;
+}
+
+static bool IsIndexType(int componentType) {
+  return componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE || componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ||
+         componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+}
+
+// Component c of element i, normalized integers map to [0, 1] / [-1, 1]
+static float ReadComponent(const View& view, size_t i, int c) {
+  const uint8_t* element = view.data + i * view.stride;
+  switch (view.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+      float value;
+      memcpy(&value, element + c * sizeof(float), sizeof(float));
+      return value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      return view.normalized ? element[c] / 255.0f : float(element[c]);
+    case TINYGLTF_COMPONENT_TYPE_BYTE: {
+      int8_t value = static_cast<int8_t>(element[c]);
+      return view.normalized ? (std::max)(value / 127.0f, -1.0f) : float(value);
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+      uint16_t value;
+      memcpy(&value, element + c * sizeof(uint16_t), sizeof(uint16_t));
+      return view.normalized ? value / 65535.0f : float(value);
+    }
+    case TINYGLTF_COMPONENT_TYPE_SHORT: {
+      int16_t value;
+      memcpy(&value, element + c * sizeof(int16_t), sizeof(int16_t));
+      return view.normalized ? (std::max)(value / 32767.0f, -1.0f) : float(value);
+    }
+    default:
+      return 0.0f;
+  }
+}
+
+// Missing components (and a missing attribute) read as 0
+template <int N>
+static glm::vec<N, float> Read(const View& view, size_t i) {
+  glm::vec<N, float> value(0.0f);
+  if (!view.IsValid() || i >= view.count) return value;
+
+  const int count = (std::min)(N, view.componentCount);
+  if (view.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+    memcpy(&value, view.data + i * view.stride, count * sizeof(float));
+    return value;
+  }
+  for (int c = 0; c < count; ++c) value[c] = ReadComponent(view, i, c);
+  return value;
+}
+
+// Interleaves POSITION (scaled) / NORMAL / TEXCOORD_0 of vertices [begin, end) into out, which already has positions.count entries
+static void DecodeVertices(const View& positions, const View& normals, const View& texcoords, float scale, BasicVertex* out,
+                           size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    BasicVertex& vertex = out[i];
+    vertex.pos = Read<3>(positions, i) * scale;
+    vertex.normal = Read<3>(normals, i);
+    vertex.tex = Read<2>(texcoords, i);
+  }
+}
+
+// Indices [begin, end) widened to uint32 into out, which already has view.count entries
+static void DecodeIndices(const View& view, uint32_t* out, size_t begin, size_t end) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = begin;
+
+  switch (view.componentType) {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      if (view.stride == sizeof(uint32_t)) {
+        memcpy(out + begin, view.data + begin * sizeof(uint32_t), (end - begin) * sizeof(uint32_t));
+        return;
+      }
+      for (; i < end; ++i) memcpy(&out[i], view.data + i * view.stride, sizeof(uint32_t));
+      return;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      if (view.stride == sizeof(uint16_t)) {
+        for (; i + 8 <= end; i += 8) {
+          __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(view.data + i * sizeof(uint16_t)));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(indices, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(indices, zero));
+        }
+      }
+      for (; i < end; ++i) {
+        uint16_t index;
+        memcpy(&index, view.data + i * view.stride, sizeof(uint16_t));
+        out[i] = index;
+      }
+      return;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      if (view.stride == sizeof(uint8_t)) {
+        for (; i + 16 <= end; i += 16) {
+          __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i*>(view.data + i));
+          __m128i low = _mm_unpacklo_epi8(indices, zero);
+          __m128i high = _mm_unpackhi_epi8(indices, zero);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(low, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(low, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpacklo_epi16(high, zero));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 12), _mm_unpackhi_epi16(high, zero));
+        }
+      }
+      for (; i < end; ++i) out[i] = view.data[i * view.stride];
+      return;
+
+    default:
+      return;
+  }
+}
+
+// Load time of one glTF file, the job times are summed over the workers (they overlap)
+struct LoadTimings {
+  float parseMs = 0.0f;          // tinygltf JSON + buffers, single threaded
+  float decodeMs = 0.0f;         // accessors -> Mesh::vertices / indices
+  float optimizeMs = 0.0f;       // MeshOptimizer, meshlets, LODs, packing
+  float jobsMs = 0.0f;           // wall time from the first submitted primitive to the last one collected
+  float assembleMs = 0.0f;       // mini-batches, entities, bounds (main thread, inside jobsMs)
+  float textureMs = 0.0f;        // wall time from the submitted decodes to the last upload (overlaps the geometry jobs)
+  float textureDecodeMs = 0.0f;  // stb_image / .rtex loads, summed over the decode jobs
+  float totalMs = 0.0f;
+  uint64_t vertexCount = 0;
+  uint64_t indexCount = 0;
+};
+
+static void PrintTimings(const char* name, const LoadTimings& timings) {
+  std::cout << "[glTF] " << name << " : " << timings.vertexCount << " vertices, " << timings.indexCount << " indices, parse "
+            << timings.parseMs << " ms, decode " << timings.decodeMs << " ms, optimize " << timings.optimizeMs
+            << " ms (summed over jobs), jobs " << timings.jobsMs << " ms (assemble " << timings.assembleMs << " ms), textures "
+            << timings.textureMs << " ms (decode " << timings.textureDecodeMs << " ms summed over jobs), total " << timings.totalMs
+            << " ms" << std::endl;
+}
+
+}  // namespace GltfAccessor
@@ -0,0 +1,422 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Singleton.h"
+
+/*
+ * Work-stealing job system
+ *  - Every registered thread (the thread that called Initialize() is index 0, workers are 1..N) owns a Chase-Lev deque.
+ *    The owner pushes/pops at the bottom without locking, idle threads steal from the top of other deques.
+ *  - Jobs come from a per-thread ring pool and keep their callable in an inline buffer,
+ *    so scheduling a small lambda does not allocate.
+ *  - Completion is tracked with JobCounter. A waiting thread keeps executing jobs instead of blocking.
+ */
+
+class JobCounter {
+ public:
+  explicit JobCounter(uint32_t initial = 0) : m_count(initial) {}
+  JobCounter(const JobCounter&) = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  void Add(uint32_t n = 1) { m_count.fetch_add(n, std::memory_order_relaxed); }
+  void Done(uint32_t n = 1) { m_count.fetch_sub(n, std::memory_order_acq_rel); }
+  bool IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+  uint32_t Value() const { return m_count.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<uint32_t> m_count;
+};
+
+struct alignas(64) Job {
+  static constexpr size_t INLINE_SIZE = 128 - sizeof(void*) * 3;
+
+  using InvokeFn = void (*)(Job*);
+
+  alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+  InvokeFn invoke = nullptr;
+  JobCounter* counter = nullptr;
+  std::atomic<bool> busy = false;
+
+  template <typename F>
+  void Bind(F&& f) {
+    using Fn = std::decay_t<F>;
+    if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t)) {
+      new (storage) Fn(std::forward<F>(f));
+      invoke = [](Job* job) {
+        Fn* fn = std::launder(reinterpret_cast<Fn*>(job->storage));
+        struct Guard {
+          Fn* fn;
+          ~Guard() { fn->~Fn(); }
+        } guard{fn};
+        (*fn)();
+      };
+    } else {
+      // Large captures fall back to the heap
+      Fn* heapFn = new Fn(std::forward<F>(f));
+      std::memcpy(storage, &heapFn, sizeof(heapFn));
+      invoke = [](Job* job) {
+        Fn* fn = nullptr;
+        std::memcpy(&fn, job->storage, sizeof(fn));
+        std::unique_ptr<Fn> guard(fn);
+        (*fn)();
+      };
+    }
+  }
+};
+
+// Chase-Lev deque (fixed capacity, C11 memory model version by Le et al.)
+class WorkStealingDeque {
+ public:
+  static constexpr int64_t CAPACITY = 4096;
+  static constexpr int64_t MASK = CAPACITY - 1;
+
+  // Owner thread only
+  bool Push(Job* job) {
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) return false;
+
+    m_jobs[b & MASK].store(job, std::memory_order_relaxed);
+    m_bottom.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner thread only
+  Job* Pop() {
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    Job* job = m_jobs[b & MASK].load(std::memory_order_relaxed);
+    if (t == b) {
+      // Last element, race against stealers
+      if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = nullptr;
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  // Any thread
+  Job* Steal() {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+
+    Job* job = m_jobs[t & MASK].load(std::memory_order_acquire);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+    return job;
+  }
+
+ private:
+  alignas(64) std::atomic<int64_t> m_top = 0;
+  alignas(64) std::atomic<int64_t> m_bottom = 0;
+  alignas(64) std::atomic<Job*> m_jobs[CAPACITY] = {};
+};
+
+class JobSystem : public Singleton<JobSystem> {
+  friend class Singleton<JobSystem>;
+
+ public:
+  static constexpr uint32_t INVALID_THREAD_INDEX = UINT32_MAX;
+
+  // The calling thread is registered as thread 0 and takes part in Wait()
+  void Initialize(uint32_t numWorkers) {
+    if (!m_done.load()) return;
+    m_done.store(false);
+
+    m_contexts.clear();
+    for (uint32_t i = 0; i < numWorkers + 1; ++i) {
+      m_contexts.push_back(std::make_unique<ThreadContext>());
+    }
+
+    ThreadIndex() = 0;
+    m_threads.reserve(numWorkers);
+    for (uint32_t i = 1; i <= numWorkers; ++i) {
+      m_threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+  }
+
+  void Destroy() {
+    if (m_done.load()) return;
+    {
+      std::lock_guard<std::mutex> lk(m_sleepMutex);
+      m_done.store(true);
+    }
+    m_sleepCv.notify_all();
+
+    for (auto& thread : m_threads) {
+      if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+
+    // Run whatever is still queued so that no waiter is left hanging
+    while (RunOne(0)) {
+    }
+    ThreadIndex() = INVALID_THREAD_INDEX;
+  }
+
+  // Queue a job. counter (optional) is incremented now and decremented when the job finished.
+  template <typename F>
+  void Schedule(JobCounter* counter, F&& f) {
+    if (counter) counter->Add();
+
+    uint32_t threadIndex = ThreadIndex();
+    if (m_done.load(std::memory_order_relaxed) || threadIndex == INVALID_THREAD_INDEX) {
+      // Not a job system thread, there is no deque to push into
+      RunInline(counter, std::forward<F>(f));
+      return;
+    }
+
+    ThreadContext& ctx = *m_contexts[threadIndex];
+    Job* job = &ctx.pool[ctx.next++ & WorkStealingDeque::MASK];
+    if (job->busy.load(std::memory_order_acquire)) {
+      // Ring pool wrapped around onto a job that is still in flight
+      RunInline(counter, std::forward<F>(f));
+      return;
+    }
+
+    job->busy.store(true, std::memory_order_relaxed);
+    job->counter = counter;
+    job->Bind(std::forward<F>(f));
+
+    m_pending.fetch_add(1, std::memory_order_seq_cst);
+    if (!ctx.deque.Push(job)) {
+      m_pending.fetch_sub(1, std::memory_order_relaxed);
+      Execute(job);
+      return;
+    }
+
+    if (m_sleeping.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lk(m_sleepMutex);
+      m_sleepCv.notify_one();
+    }
+  }
+
+  // Help executing jobs until the counter reaches zero
+  void Wait(const JobCounter& counter) {
+    WaitUntil([&counter]() { return counter.IsDone(); });
+  }
+
+  template <typename Pred>
+  void WaitUntil(Pred&& isDone) {
+    uint32_t threadIndex = ThreadIndex();
+    while (!isDone()) {
+      if (!RunOne(threadIndex)) std::this_thread::yield();
+    }
+  }
+
+  // Execute at most one queued job, returns false if nothing was found
+  bool RunOne(uint32_t threadIndex) {
+    Job* job = nullptr;
+    const uint32_t count = static_cast<uint32_t>(m_contexts.size());
+    if (count == 0) return false;
+
+    if (threadIndex != INVALID_THREAD_INDEX) job = m_contexts[threadIndex]->deque.Pop();
+
+    uint32_t start = threadIndex == INVALID_THREAD_INDEX ? 0 : threadIndex + 1;
+    for (uint32_t i = 0; i < count && job == nullptr; ++i) {
+      uint32_t victim = (start + i) % count;
+      if (victim == threadIndex) continue;
+      job = m_contexts[victim]->deque.Steal();
+    }
+
+    if (job == nullptr) return false;
+
+    m_pending.fetch_sub(1, std::memory_order_relaxed);
+    Execute(job);
+    return true;
+  }
+
+  uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_contexts.size()); }
+  uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_threads.size()); }
+  uint32_t GetCurrentThreadIndex() const { return ThreadIndex(); }
+  bool IsRunning() const { return !m_done.load(std::memory_order_relaxed); }
+
+  JobSystem(JobSystem const&) = delete;
+  JobSystem(JobSystem&&) = delete;
+  JobSystem& operator=(JobSystem const&) = delete;
+  JobSystem& operator=(JobSystem&&) = delete;
+  ~JobSystem() { Destroy(); }
+
+ private:
+  struct ThreadContext {
+    WorkStealingDeque deque;
+    std::unique_ptr<Job[]> pool = std::make_unique<Job[]>(WorkStealingDeque::CAPACITY);
+    uint64_t next = 0;  // Only touched by the owner thread
+  };
+
+  static constexpr uint32_t SPIN_COUNT = 64;
+
+  std::vector<std::unique_ptr<ThreadContext>> m_contexts;
+  std::vector<std::thread> m_threads;
+  std::atomic<bool> m_done = true;
+
+  std::atomic<uint32_t> m_pending = 0;
+  std::atomic<uint32_t> m_sleeping = 0;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleepCv;
+
+ private:
+  JobSystem() = default;
+
+  static uint32_t& ThreadIndex() {
+    static thread_local uint32_t s_threadIndex = INVALID_THREAD_INDEX;
+    return s_threadIndex;
+  }
+
+  template <typename F>
+  static void RunInline(JobCounter* counter, F&& f) {
+    try {
+      f();
+    } catch (const std::exception& e) {
+      std::cerr << "[JobSystem] Job threw an exception: " << e.what() << std::endl;
+    } catch (...) {
+      std::cerr << "[JobSystem] Job threw an unknown exception" << std::endl;
+    }
+    if (counter) counter->Done();
+  }
+
+  static void Execute(Job* job) {
+    try {
+      job->invoke(job);
+    } catch (const std::exception& e) {
+      std::cerr << "[JobSystem] Job threw an exception: " << e.what() << std::endl;
+    } catch (...) {
+      std::cerr << "[JobSystem] Job threw an unknown exception" << std::endl;
+    }
+
+    // The slot may be reused as soon as busy is cleared, read the counter first
+    JobCounter* counter = job->counter;
+    job->busy.store(false, std::memory_order_release);
+    if (counter) counter->Done();
+  }
+
+  void WorkerLoop(uint32_t threadIndex) {
+    ThreadIndex() = threadIndex;
+
+    uint32_t spins = 0;
+    while (!m_done.load(std::memory_order_relaxed)) {
+      if (RunOne(threadIndex)) {
+        spins = 0;
+        continue;
+      }
+
+      if (++spins < SPIN_COUNT) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lk(m_sleepMutex);
+      m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+      m_sleepCv.wait(lk, [this]() { return m_done.load() || m_pending.load(std::memory_order_seq_cst) > 0; });
+      m_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+      spins = 0;
+    }
+  }
+};
+
+#define g_JobSystem JobSystem::Get()
+
+/*
+ * JobHandle : std::future-like result of ThreadPool::Submit.
+ * Waiting on it executes other jobs on the calling thread instead of sleeping.
+ */
+template <typename T>
+class JobHandle {
+  struct Empty {};
+  using ValueType = std::conditional_t<std::is_void_v<T>, Empty, T>;
+
+ public:
+  struct State {
+    std::atomic<uint32_t> refCount = 2;  // job + handle
+    JobCounter counter{1};
+    std::optional<ValueType> value;
+    std::exception_ptr error;
+
+    void Release() {
+      if (refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+  };
+
+  JobHandle() = default;
+  explicit JobHandle(State* state) : m_state(state) {}
+  JobHandle(JobHandle&& other) noexcept : m_state(std::exchange(other.m_state, nullptr)) {}
+  JobHandle& operator=(JobHandle&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      m_state = std::exchange(other.m_state, nullptr);
+    }
+    return *this;
+  }
+  JobHandle(const JobHandle&) = delete;
+  JobHandle& operator=(const JobHandle&) = delete;
+  ~JobHandle() { Reset(); }
+
+  bool valid() const { return m_state != nullptr; }
+  bool IsReady() const { return m_state && m_state->counter.IsDone(); }
+
+  void wait() const {
+    if (m_state) g_JobSystem.Wait(m_state->counter);
+  }
+
+  template <typename Rep, typename Period>
+  std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    g_JobSystem.WaitUntil([&]() { return IsReady() || std::chrono::steady_clock::now() >= deadline; });
+    return IsReady() ? std::future_status::ready : std::future_status::timeout;
+  }
+
+  T get() {
+    if (!m_state) throw std::future_error(std::future_errc::no_state);
+    wait();
+
+    State* state = std::exchange(m_state, nullptr);
+    std::exception_ptr error = state->error;
+    if constexpr (std::is_void_v<T>) {
+      state->Release();
+      if (error) std::rethrow_exception(error);
+    } else {
+      if (error) {
+        state->Release();
+        std::rethrow_exception(error);
+      }
+      T result = std::move(*state->value);
+      state->Release();
+      return result;
+    }
+  }
+
+ private:
+  void Reset() {
+    if (m_state) {
+      // Dropping a handle does not cancel the job, it only gives up the result
+      m_state->Release();
+      m_state = nullptr;
+    }
+  }
+
+  State* m_state = nullptr;
+};
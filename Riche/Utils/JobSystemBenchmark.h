@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "TaskQueue.h"
+#include "ThreadPool.h"
+
+/*
+ * Tasks/sec microbenchmark : single-mutex pool (previous ThreadPool) vs work-stealing JobSystem.
+ */
+
+// Previous ThreadPool implementation, kept only as the benchmark baseline
+class LegacyThreadPool {
+ public:
+  explicit LegacyThreadPool(uint32_t num_threads) {
+    threads.reserve(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back(std::bind(&LegacyThreadPool::ThreadWork, this));
+    }
+  }
+
+  ~LegacyThreadPool() {
+    {
+      std::unique_lock<std::mutex> lk(cond_mutex);
+      done = true;
+      cond_var.notify_all();
+    }
+    for (auto& thread : threads)
+      if (thread.joinable()) thread.join();
+  }
+
+  template <typename F, typename... Args>
+  auto Submit(F&& f, Args&&... args) {
+    using ReturnType = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+    auto bind_f = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+    auto wrapped_task = std::make_shared<std::packaged_task<ReturnType()>>(bind_f);
+    std::future<ReturnType> result_future = wrapped_task->get_future();
+    task_queue.Push([wrapped_task]() { (*wrapped_task)(); });
+    cond_var.notify_one();
+    return result_future;
+  }
+
+ private:
+  std::vector<std::thread> threads;
+  TaskQueue task_queue;
+  bool done = false;
+  std::condition_variable cond_var;
+  std::mutex cond_mutex;
+
+  void ThreadWork() {
+    std::function<void()> task;
+    while (true) {
+      bool pop_success;
+      {
+        std::unique_lock<std::mutex> lk(cond_mutex);
+        while (!done && task_queue.Empty()) cond_var.wait(lk);
+        if (done) return;
+        pop_success = task_queue.TryPop(task);
+      }
+      if (pop_success) {
+        task();
+        task = nullptr;
+      }
+    }
+  }
+};
+
+struct JobBenchmarkResult {
+  uint32_t taskCount = 0;
+  uint32_t workerCount = 0;
+  double legacyTasksPerSec = 0.0;    // LegacyThreadPool::Submit + future.get
+  double submitTasksPerSec = 0.0;    // g_ThreadPool.Submit + JobHandle.get
+  double scheduleTasksPerSec = 0.0;  // g_JobSystem.Schedule + JobCounter, in waves of WorkStealingDeque::CAPACITY
+};
+
+static JobBenchmarkResult RunJobSystemBenchmark(uint32_t taskCount = 100000) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  JobBenchmarkResult result;
+  result.taskCount = taskCount;
+  result.workerCount = g_JobSystem.GetWorkerCount();
+
+  // Small but not empty body, similar to one culling test
+  std::atomic<uint64_t> sink = 0;
+  auto body = [&sink](uint32_t i) { sink.fetch_add(i * 2654435761u >> 16, std::memory_order_relaxed); };
+
+  auto tasksPerSec = [taskCount](Clock::time_point begin) {
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    return seconds > 0.0 ? taskCount / seconds : 0.0;
+  };
+
+  {
+    LegacyThreadPool legacy((std::max)(result.workerCount, 1u));
+    std::vector<std::future<void>> futures;
+    futures.reserve(taskCount);
+
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < taskCount; ++i) futures.push_back(legacy.Submit(body, i));
+    for (auto& f : futures) f.get();
+    result.legacyTasksPerSec = tasksPerSec(begin);
+  }
+
+  {
+    std::vector<JobHandle<void>> handles;
+    handles.reserve(taskCount);
+
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < taskCount; ++i) handles.push_back(g_ThreadPool.Submit(body, i));
+    for (auto& h : handles) h.get();
+    result.submitTasksPerSec = tasksPerSec(begin);
+  }
+
+  {
+    // The ring pool and deque of thread 0 hold CAPACITY jobs, past that Schedule runs the job inline on this thread.
+    // Waves of CAPACITY keep every job on the deque, so the figure is scheduling throughput and not inline execution.
+    const uint32_t waveSize = static_cast<uint32_t>(WorkStealingDeque::CAPACITY);
+
+    auto begin = Clock::now();
+    for (uint32_t waveBegin = 0; waveBegin < taskCount; waveBegin += waveSize) {
+      JobCounter counter;
+      const uint32_t waveEnd = (std::min)(waveBegin + waveSize, taskCount);
+      for (uint32_t i = waveBegin; i < waveEnd; ++i) g_JobSystem.Schedule(&counter, [&body, i]() { body(i); });
+      g_JobSystem.Wait(counter);
+    }
+    result.scheduleTasksPerSec = tasksPerSec(begin);
+  }
+
+  std::cout << "[JobSystem Benchmark] tasks: " << taskCount << ", workers: " << result.workerCount << std::endl;
+  std::cout << "  legacy pool        : " << result.legacyTasksPerSec << " tasks/sec" << std::endl;
+  std::cout << "  ThreadPool::Submit : " << result.submitTasksPerSec << " tasks/sec" << std::endl;
+  std::cout << "  JobSystem::Schedule: " << result.scheduleTasksPerSec << " tasks/sec" << std::endl;
+  return result;
+}
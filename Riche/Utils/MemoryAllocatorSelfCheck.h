@@ -0,0 +1,346 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "VkUtils/MemoryAllocator.h"
+
+/*
+ * Allocator self-check, no device needed.
+ *  - Buddy : random allocate / free against a shadow list of the live ranges. Ranges inside the block, aligned, not overlapping,
+ *    used bytes and count match, everything merges back at the end.
+ *  - Linear : ranges aligned, increasing, bufferImageGranularity apart between buffers and images, Reset() starts over.
+ *  - MemoryAllocator : a standalone instance on mock DeviceCallbacks (host memory stands in for device memory). Separate
+ *    buffer / image pools when the granularity is > 1, dedicated memory above DEDICATED_THRESHOLD, empty blocks released
+ *    except the last one, maxMemoryAllocationCount, linear pools, the leak count of Cleanup, and a random allocate / free run
+ *    checked for overlaps, alignment, mapped pointers and the device memory count.
+ */
+
+struct AllocatorSelfCheckResult {
+  uint32_t operationCount = 0;
+  uint32_t peakAllocationCount = 0;
+  uint32_t buddyErrors = 0;
+  uint32_t linearErrors = 0;
+  uint32_t allocatorErrors = 0;  // MemoryAllocator on mock callbacks
+
+  bool IsPassed() const { return operationCount > 0 && buddyErrors == 0 && linearErrors == 0 && allocatorErrors == 0; }
+};
+
+static uint32_t CheckBuddyBlock(uint32_t operationCount, std::mt19937& rng, uint32_t& peakAllocationCount) {
+  struct Range {
+    VkDeviceSize offset;
+    VkDeviceSize size;  // allocated (rounded) size
+  };
+  const VkDeviceSize BLOCK_SIZE = 16ull * 1024 * 1024;
+  std::uniform_int_distribution<uint32_t> sizeShift(0, 20);     // 1 byte - 1MB, log-uniform
+  std::uniform_int_distribution<uint32_t> alignmentShift(0, 16);  // 1 byte - 64KB
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+  VkUtils::BuddyBlock block;
+  block.Initialize(BLOCK_SIZE);
+  std::vector<Range> live;
+  VkDeviceSize liveBytes = 0;
+  uint32_t errors = 0;
+
+  auto freeAt = [&](size_t index) {
+    block.Free(live[index].offset);
+    liveBytes -= live[index].size;
+    live[index] = live.back();
+    live.pop_back();
+  };
+
+  for (uint32_t op = 0; op < operationCount; ++op) {
+    if (live.empty() || chance(rng) < 0.55f) {
+      VkDeviceSize size = (VkDeviceSize(1) << sizeShift(rng)) + (rng() & 255);
+      VkDeviceSize alignment = VkDeviceSize(1) << alignmentShift(rng);
+      Range range = {};
+      if (!block.Allocate(size, alignment, &range.offset, &range.size)) continue;  // Full or too fragmented
+
+      bool isValid = range.size >= size && range.offset % alignment == 0 && range.offset % range.size == 0 &&
+                     range.offset + range.size <= BLOCK_SIZE;
+      for (const Range& other : live) {
+        isValid &= range.offset + range.size <= other.offset || other.offset + other.size <= range.offset;
+      }
+      errors += isValid ? 0 : 1;
+      live.push_back(range);
+      liveBytes += range.size;
+      peakAllocationCount = (std::max)(peakAllocationCount, static_cast<uint32_t>(live.size()));
+    } else {
+      freeAt(std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng));
+    }
+    errors += block.GetUsedBytes() == liveBytes && block.GetAllocationCount() == live.size() ? 0 : 1;
+  }
+
+  // Freed in random order, every buddy must merge back into one range the size of the block
+  while (!live.empty()) freeAt(std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng));
+  VkDeviceSize offset = 0, allocatedSize = 0;
+  errors += block.IsEmpty() && block.Allocate(BLOCK_SIZE, 1, &offset, &allocatedSize) && offset == 0 ? 0 : 1;
+  return errors;
+}
+
+static uint32_t CheckLinearBlock(uint32_t operationCount, std::mt19937& rng) {
+  const VkDeviceSize BLOCK_SIZE = 1024 * 1024;
+  const VkDeviceSize GRANULARITY = 1024;
+  std::uniform_int_distribution<VkDeviceSize> size(1, 16 * 1024);
+  std::uniform_int_distribution<uint32_t> alignmentShift(0, 12);
+
+  VkUtils::LinearBlock block;
+  block.Initialize(BLOCK_SIZE, GRANULARITY);
+  VkDeviceSize previousEnd = 0;
+  bool previousIsImage = false;
+  uint32_t errors = 0;
+
+  for (uint32_t op = 0; op < operationCount; ++op) {
+    VkDeviceSize allocationSize = size(rng);
+    VkDeviceSize alignment = VkDeviceSize(1) << alignmentShift(rng);
+    bool isImage = (rng() & 1) != 0;
+
+    VkDeviceSize offset = 0;
+    if (!block.Allocate(allocationSize, alignment, isImage, &offset)) {
+      block.Reset();
+      errors += block.GetUsedBytes() == 0 && block.GetAllocationCount() == 0 ? 0 : 1;
+      previousEnd = 0;
+      continue;
+    }
+
+    bool isValid = offset % alignment == 0 && offset >= previousEnd && offset + allocationSize <= BLOCK_SIZE;
+    if (previousEnd > 0 && isImage != previousIsImage) isValid &= offset % GRANULARITY == 0;
+    errors += isValid ? 0 : 1;
+    previousEnd = offset + allocationSize;
+    previousIsImage = isImage;
+  }
+  return errors;
+}
+
+// What the mock callbacks hand out, keyed by the fake VkDeviceMemory handle
+struct MockDeviceMemory {
+  uint32_t memoryTypeIndex = 0;
+  VkDeviceSize size = 0;
+  std::unique_ptr<uint8_t[]> pMappedData;  // HOST_VISIBLE types only, left uninitialized
+};
+
+struct MockDevice {
+  static constexpr uint32_t DEVICE_LOCAL_TYPE = 0;
+  static constexpr uint32_t HOST_VISIBLE_TYPE = 1;
+
+  VkPhysicalDeviceMemoryProperties memoryProperties = {};
+  std::map<uint64_t, MockDeviceMemory> memories;
+  uint64_t nextHandle = 1;
+  uint32_t allocateCount = 0;
+  uint32_t memoryLimit = 0;  // refuses allocations past this many live memories like a driver would, 0 : no limit
+  uint32_t errors = 0;       // frees of memory that is not live
+
+  MockDevice() {
+    memoryProperties.memoryTypeCount = 2;
+    memoryProperties.memoryTypes[DEVICE_LOCAL_TYPE].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    memoryProperties.memoryTypes[HOST_VISIBLE_TYPE].propertyFlags =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    memoryProperties.memoryHeapCount = 1;
+  }
+
+  VkUtils::MemoryAllocator::DeviceCallbacks GetCallbacks() {
+    VkUtils::MemoryAllocator::DeviceCallbacks callbacks;
+    callbacks.allocate = [this](uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory* pOutMemory, void** ppOutMappedData) {
+      if (memoryLimit > 0 && memories.size() >= memoryLimit) return VK_ERROR_TOO_MANY_OBJECTS;
+
+      const uint64_t handle = nextHandle++ << 4;
+      MockDeviceMemory& memory = memories[handle];
+      memory.memoryTypeIndex = memoryTypeIndex;
+      memory.size = size;
+      if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        memory.pMappedData.reset(new uint8_t[size]);
+      }
+      ++allocateCount;
+      *pOutMemory = (VkDeviceMemory)handle;
+      *ppOutMappedData = memory.pMappedData.get();
+      return VK_SUCCESS;
+    };
+    callbacks.free = [this](VkDeviceMemory memory) { errors += memories.erase((uint64_t)memory) == 1 ? 0 : 1; };
+    return callbacks;
+  }
+
+  const MockDeviceMemory* Find(VkDeviceMemory memory) const {
+    auto it = memories.find((uint64_t)memory);
+    return it != memories.end() ? &it->second : nullptr;
+  }
+};
+
+static uint32_t CheckMemoryAllocator(uint32_t operationCount, std::mt19937& rng) {
+  using VkUtils::MemoryAllocation;
+  using VkUtils::MemoryAllocator;
+  const VkMemoryPropertyFlags DEVICE_LOCAL = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  const VkMemoryPropertyFlags HOST_VISIBLE = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  const VkDeviceSize GRANULARITY = 1024;
+  const uint32_t MAX_MEMORY_COUNT = 32;
+
+  MockDevice device;
+  std::unique_ptr<MemoryAllocator> allocator = MemoryAllocator::CreateStandalone();
+  uint32_t errors = 0;
+  auto expect = [&errors](bool condition) { errors += condition ? 0 : 1; };
+  auto allocate = [&allocator](VkDeviceSize size, VkDeviceSize alignment, VkMemoryPropertyFlags properties, bool isImage,
+                               uint32_t linearPool = MemoryAllocator::INVALID_POOL) {
+    return allocator->Allocate({size, alignment, 0x3}, properties, isImage, linearPool);
+  };
+
+  // Buffers and images only share memory when the granularity can't separate them
+  for (VkDeviceSize granularity : {GRANULARITY, VkDeviceSize(1)}) {
+    allocator->Initialize(device.memoryProperties, granularity, MAX_MEMORY_COUNT, device.GetCallbacks());
+    MemoryAllocation buffer = allocate(4096, 256, DEVICE_LOCAL, false);
+    MemoryAllocation image = allocate(4096, 256, DEVICE_LOCAL, true);
+    expect(buffer.IsValid() && image.IsValid() && (buffer.memory == image.memory) == (granularity == 1));
+    allocator->Free(buffer);
+    allocator->Free(image);
+    expect(allocator->Cleanup() == 0 && device.memories.empty());
+  }
+
+  allocator->Initialize(device.memoryProperties, GRANULARITY, MAX_MEMORY_COUNT, device.GetCallbacks());
+
+  // Above the threshold the resource gets memory of its own size, freed with it
+  {
+    const VkDeviceSize size = MemoryAllocator::DEDICATED_THRESHOLD + 1;
+    MemoryAllocation dedicated = allocate(size, 256, DEVICE_LOCAL, false);
+    const MockDeviceMemory* memory = device.Find(dedicated.memory);
+    expect(dedicated.blockIndex == UINT32_MAX && dedicated.offset == 0 && memory && memory->size == size);
+    allocator->Free(dedicated);
+    expect(device.Find(dedicated.memory) == nullptr);
+  }
+
+  // Four half blocks need two blocks, the second goes back once empty and the first is reused without vkAllocateMemory
+  {
+    const VkDeviceSize size = MemoryAllocator::BLOCK_SIZE / 2;
+    std::vector<MemoryAllocation> halves;
+    for (uint32_t i = 0; i < 4; ++i) halves.push_back(allocate(size, 256, DEVICE_LOCAL, false));
+    expect(device.memories.size() == 2 && halves[0].memory == halves[1].memory && halves[2].memory == halves[3].memory);
+    for (const MemoryAllocation& half : halves) allocator->Free(half);
+    expect(device.memories.size() == 1 && allocator->GetStats().deviceMemoryCount == 1);
+
+    const uint32_t allocateCount = device.allocateCount;
+    MemoryAllocation reused = allocate(size, 256, DEVICE_LOCAL, false);
+    expect(device.allocateCount == allocateCount && device.Find(reused.memory) != nullptr);
+    allocator->Free(reused);
+  }
+
+  // Random allocate / free, at most 4 dedicated allocations so the run stays under MAX_MEMORY_COUNT
+  {
+    std::uniform_int_distribution<uint32_t> sizeShift(0, 20);  // 1 byte - 1MB, log-uniform
+    std::uniform_int_distribution<uint32_t> alignmentShift(0, 12);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    struct Live {
+      MemoryAllocation allocation;
+      bool isImage;
+    };
+    std::vector<Live> live;
+    uint32_t dedicatedCount = 0;
+
+    auto freeAt = [&](size_t index) {
+      dedicatedCount -= live[index].allocation.blockIndex == UINT32_MAX ? 1 : 0;
+      allocator->Free(live[index].allocation);
+      live[index] = live.back();
+      live.pop_back();
+    };
+
+    for (uint32_t op = 0; op < operationCount; ++op) {
+      if (live.size() < 256 && (live.empty() || chance(rng) < 0.55f)) {
+        const bool isDedicated = dedicatedCount < 4 && chance(rng) < 0.01f;
+        const VkDeviceSize size = isDedicated ? MemoryAllocator::DEDICATED_THRESHOLD + 1 + (rng() & 0xFFFFF)
+                                              : (VkDeviceSize(1) << sizeShift(rng)) + (rng() & 255);
+        const VkDeviceSize alignment = VkDeviceSize(1) << alignmentShift(rng);
+        const VkMemoryPropertyFlags properties = chance(rng) < 0.25f ? HOST_VISIBLE : DEVICE_LOCAL;
+        const bool isImage = (rng() & 1) != 0;
+
+        MemoryAllocation allocation = allocate(size, alignment, properties, isImage);
+        const MockDeviceMemory* memory = device.Find(allocation.memory);
+        bool isValid = memory && allocation.size == size && allocation.offset % alignment == 0 &&
+                       allocation.offset + size <= memory->size &&
+                       (device.memoryProperties.memoryTypes[memory->memoryTypeIndex].propertyFlags & properties) == properties &&
+                       allocation.pMappedData == (memory->pMappedData ? memory->pMappedData.get() + allocation.offset : nullptr);
+        for (const Live& other : live) {
+          if (other.allocation.memory != allocation.memory) continue;
+          isValid &= other.isImage == isImage;  // separate pools with a granularity > 1
+          isValid &= allocation.offset + size <= other.allocation.offset ||
+                     other.allocation.offset + other.allocation.size <= allocation.offset;
+        }
+        expect(isValid);
+        dedicatedCount += allocation.blockIndex == UINT32_MAX ? 1 : 0;
+        live.push_back({allocation, isImage});
+      } else {
+        freeAt(std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng));
+      }
+
+      VkUtils::MemoryStats stats = allocator->GetStats();
+      expect(stats.deviceMemoryCount == device.memories.size() && stats.allocationCount == live.size());
+    }
+    while (!live.empty()) freeAt(live.size() - 1);
+    expect(allocator->Cleanup() == 0 && device.memories.empty());
+  }
+
+  // maxMemoryAllocationCount : small resources share one memory, past the limit Allocate throws and nothing is counted
+  {
+    device.memoryLimit = 2;
+    allocator->Initialize(device.memoryProperties, GRANULARITY, device.memoryLimit, device.GetCallbacks());
+    std::vector<MemoryAllocation> small;
+    for (uint32_t i = 0; i < 10000; ++i) small.push_back(allocate(96, 4, DEVICE_LOCAL, false));
+    expect(device.memories.size() == 1);
+
+    const VkDeviceSize size = MemoryAllocator::DEDICATED_THRESHOLD + 1;
+    MemoryAllocation dedicated = allocate(size, 256, DEVICE_LOCAL, false);
+    bool isThrown = false;
+    try {
+      allocate(size, 256, DEVICE_LOCAL, false);
+    } catch (const std::exception&) {
+      isThrown = true;
+    }
+    expect(isThrown && allocator->GetStats().deviceMemoryCount == 2);
+
+    allocator->Free(dedicated);
+    MemoryAllocation retried = allocate(size, 256, DEVICE_LOCAL, false);
+    expect(retried.IsValid() && allocator->GetStats().deviceMemoryCount == 2);
+    allocator->Free(retried);
+    for (const MemoryAllocation& allocation : small) allocator->Free(allocation);
+    expect(allocator->Cleanup() == 0 && device.memories.empty());
+    device.memoryLimit = 0;
+  }
+
+  allocator->Initialize(device.memoryProperties, GRANULARITY, MAX_MEMORY_COUNT, device.GetCallbacks());
+
+  // Linear pool : granularity between a buffer and an image, Free is a no-op, Reset reuses the same memory
+  {
+    const uint32_t pool = allocator->CreateLinearPool(1024 * 1024, 256);
+    MemoryAllocation buffer = allocate(100, 16, DEVICE_LOCAL, false, pool);
+    MemoryAllocation image = allocate(100, 16, DEVICE_LOCAL, true, pool);
+    expect(buffer.isLinear && buffer.offset == 0 && image.memory == buffer.memory && image.offset == GRANULARITY);
+    allocator->Free(buffer);
+    expect(device.Find(buffer.memory) != nullptr);
+
+    const uint32_t allocateCount = device.allocateCount;
+    allocator->ResetLinearPool(pool);
+    MemoryAllocation reset = allocate(100, 16, DEVICE_LOCAL, false, pool);
+    expect(reset.memory == buffer.memory && reset.offset == 0 && device.allocateCount == allocateCount);
+    allocator->DestroyLinearPool(pool);
+    expect(device.Find(buffer.memory) == nullptr);
+  }
+
+  // Leaks : Cleanup counts what was never freed and still returns every memory to the device
+  allocate(4096, 256, DEVICE_LOCAL, false);
+  allocate(4096, 256, HOST_VISIBLE, true);
+  allocate(MemoryAllocator::DEDICATED_THRESHOLD + 1, 256, DEVICE_LOCAL, false);
+  expect(allocator->Cleanup() == 3 && device.memories.empty());
+
+  return errors + device.errors;
+}
+
+static AllocatorSelfCheckResult RunAllocatorSelfCheck(uint32_t operationCount = 200000) {
+  std::mt19937 rng(13);
+
+  AllocatorSelfCheckResult result;
+  result.operationCount = operationCount;
+  result.buddyErrors = CheckBuddyBlock(operationCount, rng, result.peakAllocationCount);
+  result.linearErrors = CheckLinearBlock(operationCount, rng);
+  result.allocatorErrors = CheckMemoryAllocator(operationCount / 4, rng);
+
+  std::cout << "[Allocator Self-Check] " << result.operationCount << " operations (peak " << result.peakAllocationCount
+            << " live buddy ranges) : buddy errors " << result.buddyErrors << ", linear errors " << result.linearErrors
+            << ", allocator errors " << result.allocatorErrors << (result.IsPassed() ? " - passed" : " - FAILED") << std::endl;
+  return result;
+}
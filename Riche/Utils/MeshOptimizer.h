@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "Rendering/Mesh.h"
+
+/*
+ * MeshOptimizer : import-time index/vertex processing of one triangle list (called from the loader jobs on g_ThreadPool)
+ *  1. Weld      : identical BasicVertex entries collapse into one (hash on the bits, BasicVertex::operator== decides)
+ *  2. Tipsify   : triangle order for the post-transform cache (Sander et al. 2007), linear time, hard boundaries are kept
+ *  3. Overdraw  : the Tipsify clusters (split further where it costs little cache efficiency) are sorted outside-in,
+ *                 kept only while the ACMR stays within OVERDRAW_THRESHOLD
+ *  4. Fetch     : vertices are renumbered in first-use order so the vertex buffer is read front to back
+ */
+
+struct MeshOptimizeStats {
+  uint32_t meshCount = 0;
+  uint64_t triangleCount = 0;
+  uint64_t vertexCountBefore = 0;
+  uint64_t vertexCountAfter = 0;
+  uint64_t cacheMissesBefore = 0;  // FIFO cache of MeshOptimizer::CACHE_SIZE entries
+  uint64_t cacheMissesAfter = 0;
+  uint64_t clusterCount = 0;  // clusters sorted for overdraw, 0 for meshes that kept the Tipsify order
+  float timeMs = 0.0f;
+
+  // Average cache miss ratio (transformed vertices per triangle) and average transform to vertex ratio
+  float AcmrBefore() const { return triangleCount ? float(cacheMissesBefore) / float(triangleCount) : 0.0f; }
+  float AcmrAfter() const { return triangleCount ? float(cacheMissesAfter) / float(triangleCount) : 0.0f; }
+  float AtvrBefore() const { return vertexCountBefore ? float(cacheMissesBefore) / float(vertexCountBefore) : 0.0f; }
+  float AtvrAfter() const { return vertexCountAfter ? float(cacheMissesAfter) / float(vertexCountAfter) : 0.0f; }
+
+  MeshOptimizeStats& operator+=(const MeshOptimizeStats& other) {
+    meshCount += other.meshCount;
+    triangleCount += other.triangleCount;
+    vertexCountBefore += other.vertexCountBefore;
+    vertexCountAfter += other.vertexCountAfter;
+    cacheMissesBefore += other.cacheMissesBefore;
+    cacheMissesAfter += other.cacheMissesAfter;
+    clusterCount += other.clusterCount;
+    timeMs += other.timeMs;
+    return *this;
+  }
+};
+
+namespace MeshOptimizer {
+
+static constexpr uint32_t CACHE_SIZE = 16;         // post-transform cache the order is tuned for
+static constexpr float OVERDRAW_THRESHOLD = 1.05f;  // allowed ACMR growth from splitting clusters for the overdraw sort
+static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+struct BasicVertexHash {
+  size_t operator()(const BasicVertex& v) const {
+    // +0.0f folds -0 into 0, the two compare equal but differ in bits
+    float values[8] = {v.pos.x + 0.0f,    v.pos.y + 0.0f,    v.pos.z + 0.0f, v.normal.x + 0.0f,
+                       v.normal.y + 0.0f, v.normal.z + 0.0f, v.tex.x + 0.0f, v.tex.y + 0.0f};
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a over 32 bit words
+    for (float value : values) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      hash = (hash ^ bits) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32));
+  }
+};
+
+// Misses of a FIFO cache, what ACMR and ATVR are built from
+static uint64_t CountCacheMisses(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE) {
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  uint32_t time = cacheSize + 1;
+  uint64_t misses = 0;
+  for (uint32_t index : indices) {
+    if (time - cacheTime[index] > cacheSize) {
+      cacheTime[index] = time++;
+      ++misses;
+    }
+  }
+  return misses;
+}
+
+// Identical vertices share one index, returns the remap (old -> new) and the new vertex count
+static uint32_t WeldVertices(const std::vector<BasicVertex>& vertices, std::vector<uint32_t>& indices, std::vector<uint32_t>& remap) {
+  std::unordered_map<BasicVertex, uint32_t, BasicVertexHash> unique;
+  unique.reserve(vertices.size());
+
+  remap.assign(vertices.size(), INVALID_INDEX);
+  uint32_t uniqueCount = 0;
+  for (uint32_t& index : indices) {
+    if (remap[index] == INVALID_INDEX) {
+      auto it = unique.try_emplace(vertices[index], uniqueCount).first;
+      if (it->second == uniqueCount) ++uniqueCount;
+      remap[index] = it->second;
+    }
+    index = remap[index];
+  }
+  return uniqueCount;
+}
+
+// Tipsify, pClusterStarts receives the first triangle of every hard boundary (where the fan had to restart cold)
+static std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+                                                 std::vector<uint32_t>* pClusterStarts, uint32_t cacheSize = CACHE_SIZE) {
+  const size_t triangleCount = indices.size() / 3;
+
+  // Vertex -> triangle adjacency, liveCount is the number of triangles of a vertex not emitted yet
+  std::vector<uint32_t> liveCount(vertexCount, 0);
+  for (uint32_t index : indices) ++liveCount[index];
+
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveCount[v];
+
+  std::vector<uint32_t> adjacency(indices.size());
+  std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+  for (size_t i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnd;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+
+  uint32_t time = cacheSize + 1;
+  uint32_t nextInputVertex = 0;  // cursor of the in-order scan once the dead-end stack runs dry
+
+  auto skipDeadEnd = [&]() -> uint32_t {
+    while (!deadEnd.empty()) {
+      uint32_t vertex = deadEnd.back();
+      deadEnd.pop_back();
+      if (liveCount[vertex] > 0) return vertex;
+    }
+    while (nextInputVertex < vertexCount) {
+      uint32_t vertex = nextInputVertex++;
+      if (liveCount[vertex] > 0) return vertex;
+    }
+    return INVALID_INDEX;
+  };
+
+  uint32_t fanningVertex = skipDeadEnd();
+  if (pClusterStarts && fanningVertex != INVALID_INDEX) pClusterStarts->push_back(0);
+
+  while (fanningVertex != INVALID_INDEX) {
+    candidates.clear();
+    for (uint32_t a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; ++a) {
+      uint32_t triangle = adjacency[a];
+      if (emitted[triangle]) continue;
+      emitted[triangle] = true;
+
+      for (uint32_t k = 0; k < 3; ++k) {
+        uint32_t vertex = indices[triangle * 3 + k];
+        output.push_back(vertex);
+        deadEnd.push_back(vertex);
+        candidates.push_back(vertex);
+        --liveCount[vertex];
+        if (time - cacheTime[vertex] > cacheSize) cacheTime[vertex] = time++;
+      }
+    }
+
+    // Next fan : the candidate that stays longest in the cache while its remaining triangles are emitted
+    uint32_t best = INVALID_INDEX;
+    int bestPriority = -1;
+    for (uint32_t vertex : candidates) {
+      if (liveCount[vertex] == 0) continue;
+      int priority = 0;
+      if (time - cacheTime[vertex] + 2 * liveCount[vertex] <= cacheSize) priority = static_cast<int>(time - cacheTime[vertex]);
+      if (priority > bestPriority) {
+        best = vertex;
+        bestPriority = priority;
+      }
+    }
+
+    if (best == INVALID_INDEX) {
+      // Only a restart from the in-order scan is a hard boundary, a dead-end vertex is usually still in the cache
+      bool coldRestart = std::none_of(deadEnd.begin(), deadEnd.end(), [&](uint32_t vertex) { return liveCount[vertex] > 0; });
+      best = skipDeadEnd();
+      if (pClusterStarts && coldRestart && best != INVALID_INDEX) pClusterStarts->push_back(static_cast<uint32_t>(output.size() / 3));
+    }
+    fanningVertex = best;
+  }
+
+  return output;
+}
+
+// Sorts clusters so the ones facing away from the mesh center are drawn first and hide the inner ones
+static std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<BasicVertex>& vertices,
+                                              const std::vector<uint32_t>& hardClusterStarts, uint32_t* pClusterCount,
+                                              float threshold = OVERDRAW_THRESHOLD, uint32_t cacheSize = CACHE_SIZE) {
+  const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+  // Soft boundaries : a hard cluster is split again wherever the run so far, starting from a cold cache, is within threshold
+  // of the cluster's ACMR, so reordering at that point costs little cache efficiency
+  std::vector<uint32_t> clusterStarts;
+  std::vector<uint32_t> cacheTime(vertices.size(), 0);
+  uint32_t time = cacheSize + 1;
+  auto missesOf = [&](uint32_t triangle) {
+    uint32_t misses = 0;
+    for (uint32_t k = 0; k < 3; ++k) {
+      uint32_t vertex = indices[triangle * 3 + k];
+      if (time - cacheTime[vertex] > cacheSize) {
+        cacheTime[vertex] = time++;
+        ++misses;
+      }
+    }
+    return misses;
+  };
+
+  for (size_t c = 0; c < hardClusterStarts.size(); ++c) {
+    uint32_t begin = hardClusterStarts[c];
+    uint32_t end = c + 1 < hardClusterStarts.size() ? hardClusterStarts[c + 1] : triangleCount;
+    if (begin >= end) continue;
+
+    time += cacheSize + 1;  // Cold cache
+    uint32_t clusterMisses = 0;
+    for (uint32_t t = begin; t < end; ++t) clusterMisses += missesOf(t);
+    float clusterThreshold = threshold * float(clusterMisses) / float(end - begin);
+
+    time += cacheSize + 1;
+    clusterStarts.push_back(begin);
+    uint32_t runStart = begin;
+    uint32_t runMisses = 0;
+    for (uint32_t t = begin; t < end; ++t) {
+      runMisses += missesOf(t);
+      if (t + 1 < end && float(runMisses) / float(t + 1 - runStart) <= clusterThreshold) {
+        clusterStarts.push_back(t + 1);
+        runStart = t + 1;
+        runMisses = 0;
+        time += cacheSize + 1;  // The next run may be drawn after any other cluster, it starts cold
+      }
+    }
+  }
+
+  // Sort key : how much the cluster faces away from the mesh centroid (area weighted centroid and normal)
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  std::vector<glm::vec3> triangleCentroid(triangleCount);
+  std::vector<glm::vec3> triangleNormal(triangleCount);  // length = 2 * area
+  for (uint32_t t = 0; t < triangleCount; ++t) {
+    const glm::vec3& p0 = vertices[indices[t * 3 + 0]].pos;
+    const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+    const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+    triangleCentroid[t] = (p0 + p1 + p2) / 3.0f;
+    triangleNormal[t] = glm::cross(p1 - p0, p2 - p0);
+    float area = glm::length(triangleNormal[t]);
+    meshCentroid += triangleCentroid[t] * area;
+    meshArea += area;
+  }
+  if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+  struct Cluster {
+    uint32_t begin, end;
+    float key;
+  };
+  std::vector<Cluster> clusters(clusterStarts.size());
+  for (size_t c = 0; c < clusterStarts.size(); ++c) {
+    Cluster& cluster = clusters[c];
+    cluster.begin = clusterStarts[c];
+    cluster.end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+    glm::vec3 centroid(0.0f), normal(0.0f);
+    float area = 0.0f;
+    for (uint32_t t = cluster.begin; t < cluster.end; ++t) {
+      float triangleArea = glm::length(triangleNormal[t]);
+      centroid += triangleCentroid[t] * triangleArea;
+      normal += triangleNormal[t];
+      area += triangleArea;
+    }
+    if (area > 0.0f) centroid /= area;
+    float normalLength = glm::length(normal);
+    cluster.key = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+  }
+  std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (const Cluster& cluster : clusters) {
+    output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+  }
+  if (pClusterCount) *pClusterCount = static_cast<uint32_t>(clusters.size());
+  return output;
+}
+
+// Vertices in first-use order, unreferenced ones are dropped. Returns the remap (old -> new) and the new vertex count
+static uint32_t OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>& remap) {
+  remap.assign(vertexCount, INVALID_INDEX);
+  uint32_t nextVertex = 0;
+  for (uint32_t& index : indices) {
+    if (remap[index] == INVALID_INDEX) remap[index] = nextVertex++;
+    index = remap[index];
+  }
+  return nextVertex;
+}
+
+template <typename VERTEX>
+static void RemapVertices(std::vector<VERTEX>& vertices, const std::vector<uint32_t>& remap, uint32_t newCount) {
+  if (vertices.empty()) return;
+  std::vector<VERTEX> remapped(newCount);
+  for (size_t i = 0; i < remap.size(); ++i) {
+    if (remap[i] != INVALID_INDEX) remapped[remap[i]] = vertices[i];
+  }
+  vertices.swap(remapped);
+}
+
+// Whole pipeline on one triangle list mesh, vertexCount/indexCount are left to the caller like before
+static MeshOptimizeStats OptimizeMesh(Mesh& mesh) {
+  MeshOptimizeStats stats;
+  if (mesh.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST || mesh.indices.empty() || mesh.indices.size() % 3 != 0) return stats;
+
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  stats.meshCount = 1;
+  stats.triangleCount = mesh.indices.size() / 3;
+  stats.vertexCountBefore = mesh.vertices.size();
+  stats.cacheMissesBefore = CountCacheMisses(mesh.indices, mesh.vertices.size());
+
+  std::vector<uint32_t> remap;
+  uint32_t vertexCount = WeldVertices(mesh.vertices, mesh.indices, remap);
+  RemapVertices(mesh.vertices, remap, vertexCount);
+
+  std::vector<uint32_t> clusterStarts;
+  mesh.indices = OptimizeVertexCache(mesh.indices, vertexCount, &clusterStarts);
+
+  // The overdraw order is kept only if it stays within OVERDRAW_THRESHOLD of the Tipsify ACMR, meshes made of many small
+  // disconnected pieces (every piece is a hard boundary) can lose more than that
+  uint32_t clusterCount = 0;
+  std::vector<uint32_t> overdrawIndices = OptimizeOverdraw(mesh.indices, mesh.vertices, clusterStarts, &clusterCount);
+  if (CountCacheMisses(overdrawIndices, vertexCount) <= OVERDRAW_THRESHOLD * CountCacheMisses(mesh.indices, vertexCount)) {
+    mesh.indices.swap(overdrawIndices);
+  } else {
+    clusterCount = 0;
+  }
+
+  vertexCount = OptimizeVertexFetch(mesh.indices, vertexCount, remap);
+  RemapVertices(mesh.vertices, remap, vertexCount);
+
+  stats.vertexCountAfter = vertexCount;
+  stats.cacheMissesAfter = CountCacheMisses(mesh.indices, vertexCount);
+  stats.clusterCount = clusterCount;
+  stats.timeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+  return stats;
+}
+
+static void PrintStats(const char* name, const MeshOptimizeStats& stats) {
+  std::cout << "[MeshOptimizer] " << name << " : " << stats.meshCount << " meshes, " << stats.triangleCount << " triangles, vertices "
+            << stats.vertexCountBefore << " -> " << stats.vertexCountAfter << ", ACMR " << stats.AcmrBefore() << " -> "
+            << stats.AcmrAfter() << ", ATVR " << stats.AtvrBefore() << " -> " << stats.AtvrAfter() << ", " << stats.clusterCount
+            << " overdraw clusters, " << stats.timeMs << " ms (summed over jobs)" << std::endl;
+}
+
+}  // namespace MeshOptimizer
@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "MeshOptimizer.h"
+#include "Rendering/Mesh.h"
+
+/*
+ * MeshSimplifier : import-time LOD chain of one triangle list (after MeshOptimizer::OptimizeMesh)
+ *  - Quadric error metric (Garland & Heckbert 1997), half-edge collapses onto existing vertices, so every level
+ *    indexes the original vertex buffer and only adds an index list.
+ *  - Collapses work on positions : every vertex the weld left at one position (hard edges keep one per normal) moves
+ *    together, so hard edges stay closed. Positions on a UV seam (copies with different UVs) and on open borders are locked,
+ *    the texture layout and the silhouette of open meshes stay put.
+ *  - Collapses run in passes over independent edges sorted by cost, a collapse that flips a triangle or would make the
+ *    surface non-manifold is rejected.
+ *  - SelectLod is the screen size rule shared with ViewFrustumCullingCS (projected AABB size, see ComputeProjectedSize).
+ */
+
+namespace MeshSimplifier {
+
+static constexpr float LOD_REDUCTION = 0.5f;         // triangles of a level relative to the previous one
+static constexpr float LOD_MIN_REDUCTION = 0.8f;     // the chain stops when a level keeps more than this (locked positions)
+static constexpr uint32_t LOD_MIN_TRIANGLES = 64;    // meshes / levels below this are not simplified further
+static constexpr uint32_t MAX_COLLAPSE_PASSES = 64;
+
+// Symmetric 4x4 : a2 ab ac ad b2 bc bd c2 cd d2
+struct Quadric {
+  double m[10] = {};
+
+  void AddPlane(const glm::dvec3& n, double d, double weight) {
+    m[0] += weight * n.x * n.x, m[1] += weight * n.x * n.y, m[2] += weight * n.x * n.z, m[3] += weight * n.x * d;
+    m[4] += weight * n.y * n.y, m[5] += weight * n.y * n.z, m[6] += weight * n.y * d;
+    m[7] += weight * n.z * n.z, m[8] += weight * n.z * d;
+    m[9] += weight * d * d;
+  }
+
+  Quadric& operator+=(const Quadric& other) {
+    for (int i = 0; i < 10; ++i) m[i] += other.m[i];
+    return *this;
+  }
+
+  // Weighted squared distance of p to the planes
+  double Evaluate(const glm::vec3& point) const {
+    double x = point.x, y = point.y, z = point.z;
+    double error = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z +
+                   2.0 * m[6] * y + m[7] * z * z + 2.0 * m[8] * z + m[9];
+    return (std::max)(error, 0.0);
+  }
+};
+
+// Vertices of the same position, the weld keeps one vertex per (position, normal, UV)
+struct PositionGroups {
+  std::vector<uint32_t> positionId;  // per vertex
+  std::vector<uint32_t> offsets;     // per position + 1, the vertices of position p are vertices[offsets[p], offsets[p + 1])
+  std::vector<uint32_t> vertices;
+
+  uint32_t GetPositionCount() const { return static_cast<uint32_t>(offsets.size() - 1); }
+};
+
+static PositionGroups GroupByPosition(const std::vector<BasicVertex>& vertices) {
+  PositionGroups groups;
+  groups.positionId.resize(vertices.size());
+  groups.vertices.resize(vertices.size());
+  for (uint32_t i = 0; i < groups.vertices.size(); ++i) groups.vertices[i] = i;
+  std::sort(groups.vertices.begin(), groups.vertices.end(), [&](uint32_t a, uint32_t b) {
+    const glm::vec3& pa = vertices[a].pos;
+    const glm::vec3& pb = vertices[b].pos;
+    return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+  });
+  for (uint32_t i = 0; i < groups.vertices.size(); ++i) {
+    if (i == 0 || vertices[groups.vertices[i]].pos != vertices[groups.vertices[i - 1]].pos) groups.offsets.push_back(i);
+    groups.positionId[groups.vertices[i]] = static_cast<uint32_t>(groups.offsets.size() - 1);
+  }
+  groups.offsets.push_back(static_cast<uint32_t>(groups.vertices.size()));
+  return groups;
+}
+
+// UV seam and border positions can not move
+static std::vector<uint8_t> ComputeLockedPositions(const std::vector<BasicVertex>& vertices, const std::vector<uint32_t>& indices,
+                                                   const PositionGroups& groups) {
+  std::vector<uint8_t> locked(groups.GetPositionCount(), 0);
+
+  // UV seam : moving one side would tear the texture apart. Copies that only differ in the normal (hard edge) may move.
+  for (uint32_t position = 0; position < groups.GetPositionCount(); ++position) {
+    const glm::vec2& uv = vertices[groups.vertices[groups.offsets[position]]].tex;
+    for (uint32_t i = groups.offsets[position] + 1; i < groups.offsets[position + 1]; ++i) {
+      locked[position] |= vertices[groups.vertices[i]].tex != uv ? 1 : 0;
+    }
+  }
+
+  // Border : an edge (between positions) used by a single triangle
+  std::vector<uint64_t> edges;
+  edges.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    for (int k = 0; k < 3; ++k) {
+      uint32_t a = groups.positionId[indices[i + k]];
+      uint32_t b = groups.positionId[indices[i + (k + 1) % 3]];
+      if (a == b) continue;
+      edges.push_back((uint64_t((std::min)(a, b)) << 32) | (std::max)(a, b));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  for (size_t i = 0; i < edges.size();) {
+    size_t j = i;
+    while (j < edges.size() && edges[j] == edges[i]) ++j;
+    if (j - i == 1) {
+      locked[edges[i] >> 32] = 1;
+      locked[edges[i] & 0xFFFFFFFFu] = 1;
+    }
+    i = j;
+  }
+
+  return locked;
+}
+
+// Moving position `from` onto `to` must not turn any remaining triangle of `from` around, and must keep the surface a
+// manifold : the only positions next to both are the third corners of the triangles on the edge (link condition)
+static bool IsCollapseValid(const std::vector<BasicVertex>& vertices, const PositionGroups& groups,
+                            const std::vector<uint32_t>& indices, const std::vector<uint32_t>& adjacencyOffsets,
+                            const std::vector<uint32_t>& adjacency, uint32_t from, uint32_t to) {
+  auto collectNeighbors = [&](uint32_t position, std::vector<uint32_t>& outNeighbors) {
+    for (uint32_t a = adjacencyOffsets[position]; a < adjacencyOffsets[position + 1]; ++a) {
+      for (int k = 0; k < 3; ++k) {
+        uint32_t neighbor = groups.positionId[indices[adjacency[a] * 3 + k]];
+        if (neighbor != position) outNeighbors.push_back(neighbor);
+      }
+    }
+    std::sort(outNeighbors.begin(), outNeighbors.end());
+    outNeighbors.erase(std::unique(outNeighbors.begin(), outNeighbors.end()), outNeighbors.end());
+  };
+  std::vector<uint32_t> fromNeighbors, toNeighbors, shared;
+  collectNeighbors(from, fromNeighbors);
+  collectNeighbors(to, toNeighbors);
+  std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(),
+                        std::back_inserter(shared));
+
+  uint32_t edgeTriangleCount = 0;
+  const glm::vec3& target = vertices[groups.vertices[groups.offsets[to]]].pos;
+  for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+    const uint32_t* triangle = &indices[adjacency[a] * 3];
+    for (int k = 0; k < 3; ++k) edgeTriangleCount += groups.positionId[triangle[k]] == to ? 1 : 0;
+  }
+  if (shared.size() != edgeTriangleCount) return false;
+
+  for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+    const uint32_t* triangle = &indices[adjacency[a] * 3];
+    uint32_t positions[3] = {groups.positionId[triangle[0]], groups.positionId[triangle[1]], groups.positionId[triangle[2]]};
+    if (positions[0] == to || positions[1] == to || positions[2] == to) continue;  // removed by the collapse
+
+    glm::vec3 p[3] = {vertices[triangle[0]].pos, vertices[triangle[1]].pos, vertices[triangle[2]].pos};
+    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+    for (int k = 0; k < 3; ++k) {
+      if (positions[k] == from) p[k] = target;
+    }
+    glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+    if (glm::dot(before, after) <= 0.0f) return false;
+  }
+  return true;
+}
+
+// Copy of position `to` that `vertex` (at position `from`) becomes : the one it shares a triangle with, so each side of a
+// hard edge keeps its own normal, otherwise the one with the closest normal
+static uint32_t FindCollapseTarget(const std::vector<BasicVertex>& vertices, const PositionGroups& groups,
+                                   const std::vector<uint32_t>& indices, const std::vector<uint32_t>& adjacencyOffsets,
+                                   const std::vector<uint32_t>& adjacency, uint32_t vertex, uint32_t from, uint32_t to) {
+  for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+    const uint32_t* triangle = &indices[adjacency[a] * 3];
+    if (triangle[0] != vertex && triangle[1] != vertex && triangle[2] != vertex) continue;
+    for (int k = 0; k < 3; ++k) {
+      if (groups.positionId[triangle[k]] == to) return triangle[k];
+    }
+  }
+
+  uint32_t best = groups.vertices[groups.offsets[to]];
+  float bestDot = -2.0f;
+  for (uint32_t i = groups.offsets[to]; i < groups.offsets[to + 1]; ++i) {
+    float d = glm::dot(vertices[vertex].normal, vertices[groups.vertices[i]].normal);
+    if (d > bestDot) {
+      bestDot = d;
+      best = groups.vertices[i];
+    }
+  }
+  return best;
+}
+
+// Simplified copy of indices with at most targetIndexCount indices (or as close as the locked vertices allow).
+// pOutError receives the largest collapse error, as a distance.
+static std::vector<uint32_t> Simplify(const std::vector<BasicVertex>& vertices, const std::vector<uint32_t>& indices,
+                                      size_t targetIndexCount, float* pOutError = nullptr) {
+  const size_t vertexCount = vertices.size();
+  const PositionGroups groups = GroupByPosition(vertices);
+  const uint32_t positionCount = groups.GetPositionCount();
+  std::vector<uint8_t> locked = ComputeLockedPositions(vertices, indices, groups);
+
+  std::vector<Quadric> quadrics(positionCount);
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    glm::dvec3 p0 = vertices[indices[i]].pos, p1 = vertices[indices[i + 1]].pos, p2 = vertices[indices[i + 2]].pos;
+    glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+    double area = glm::length(normal);
+    if (area <= 0.0) continue;
+    normal /= area;
+
+    // Area weighted, so large flat regions resist more than slivers
+    for (int k = 0; k < 3; ++k) quadrics[groups.positionId[indices[i + k]]].AddPlane(normal, -glm::dot(normal, p0), area);
+  }
+
+  struct Collapse {
+    uint32_t from;  // positions
+    uint32_t to;
+    double cost;
+  };
+
+  // Triangles are kept only while their three corners are at three positions
+  auto isDegenerate = [&groups](uint32_t a, uint32_t b, uint32_t c) {
+    a = groups.positionId[a], b = groups.positionId[b], c = groups.positionId[c];
+    return a == b || b == c || c == a;
+  };
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    if (isDegenerate(indices[i], indices[i + 1], indices[i + 2])) continue;
+    result.insert(result.end(), {indices[i], indices[i + 1], indices[i + 2]});
+  }
+
+  std::vector<uint32_t> remap(vertexCount);
+  std::vector<uint8_t> touched(positionCount);
+  std::vector<uint32_t> adjacencyOffsets(positionCount + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<uint64_t> edges;
+  std::vector<Collapse> collapses;
+  double maxCost = 0.0;
+
+  for (uint32_t pass = 0; pass < MAX_COLLAPSE_PASSES && result.size() > targetIndexCount; ++pass) {
+    // Position -> triangle adjacency of the current triangles
+    std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+    for (uint32_t index : result) ++adjacencyOffsets[groups.positionId[index] + 1];
+    for (size_t p = 0; p < positionCount; ++p) adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+    adjacency.resize(result.size());
+    std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < result.size(); ++i) adjacency[cursor[groups.positionId[result[i]]]++] = static_cast<uint32_t>(i / 3);
+
+    // Unique edges between positions, each one collapses in its cheaper allowed direction
+    edges.clear();
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (int k = 0; k < 3; ++k) {
+        uint32_t a = groups.positionId[result[i + k]], b = groups.positionId[result[i + (k + 1) % 3]];
+        edges.push_back((uint64_t((std::min)(a, b)) << 32) | (std::max)(a, b));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    collapses.clear();
+    for (uint64_t edge : edges) {
+      uint32_t a = static_cast<uint32_t>(edge >> 32), b = static_cast<uint32_t>(edge & 0xFFFFFFFFu);
+      Quadric q = quadrics[a];
+      q += quadrics[b];
+      if (!locked[a]) collapses.push_back({a, b, q.Evaluate(vertices[groups.vertices[groups.offsets[b]]].pos)});
+      if (!locked[b]) collapses.push_back({b, a, q.Evaluate(vertices[groups.vertices[groups.offsets[a]]].pos)});
+    }
+    if (collapses.empty()) break;
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+    // A collapse removes about two triangles, the neighborhood of a collapsed position is frozen for the rest of the pass
+    size_t collapseTarget = (result.size() - targetIndexCount) / 6 + 1;
+    size_t collapseCount = 0;
+    for (size_t v = 0; v < vertexCount; ++v) remap[v] = static_cast<uint32_t>(v);
+    std::fill(touched.begin(), touched.end(), 0);
+
+    for (const Collapse& collapse : collapses) {
+      if (collapseCount >= collapseTarget) break;
+      if (touched[collapse.from] || touched[collapse.to]) continue;
+      if (!IsCollapseValid(vertices, groups, result, adjacencyOffsets, adjacency, collapse.from, collapse.to)) continue;
+
+      for (uint32_t i = groups.offsets[collapse.from]; i < groups.offsets[collapse.from + 1]; ++i) {
+        uint32_t vertex = groups.vertices[i];
+        remap[vertex] = FindCollapseTarget(vertices, groups, result, adjacencyOffsets, adjacency, vertex, collapse.from, collapse.to);
+      }
+      quadrics[collapse.to] += quadrics[collapse.from];
+      maxCost = (std::max)(maxCost, collapse.cost);
+      ++collapseCount;
+
+      for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; ++a) {
+        for (int k = 0; k < 3; ++k) touched[groups.positionId[result[adjacency[a] * 3 + k]]] = 1;
+      }
+    }
+    if (collapseCount == 0) break;
+
+    // Triangles that lost an edge disappear
+    size_t writeIndex = 0;
+    for (size_t i = 0; i < result.size(); i += 3) {
+      uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+      if (isDegenerate(a, b, c)) continue;
+      result[writeIndex++] = a;
+      result[writeIndex++] = b;
+      result[writeIndex++] = c;
+    }
+    result.resize(writeIndex);
+  }
+
+  if (pOutError) *pOutError = static_cast<float>(std::sqrt(maxCost));
+  return result;
+}
+
+// Fills mesh.lods / mesh.lod_indices, every level has about half the triangles of the previous one. Returns the LOD count
+// including the full mesh.
+static uint32_t BuildLods(Mesh& mesh) {
+  mesh.lods.clear();
+  mesh.lod_indices.clear();
+  if (mesh.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) return 1;
+
+  std::vector<uint32_t> source = mesh.indices;
+  float error = 0.0f;
+  for (uint32_t level = 1; level < MAX_LOD_COUNT; ++level) {
+    size_t target = static_cast<size_t>(source.size() / 3 * LOD_REDUCTION) * 3;
+    if (target < LOD_MIN_TRIANGLES * 3) break;
+
+    // Each level continues from the previous one, its error adds up
+    float levelError = 0.0f;
+    std::vector<uint32_t> lod = Simplify(mesh.vertices, source, target, &levelError);
+    if (lod.size() > source.size() * LOD_MIN_REDUCTION) break;
+    error += levelError;
+
+    lod = MeshOptimizer::OptimizeVertexCache(lod, mesh.vertices.size(), nullptr);
+
+    MeshLod meshLod = {};
+    meshLod.firstIndex = static_cast<uint32_t>(mesh.indices.size() + mesh.lod_indices.size());
+    meshLod.indexCount = static_cast<uint32_t>(lod.size());
+    meshLod.error = error;
+    mesh.lods.push_back(meshLod);
+    mesh.lod_indices.insert(mesh.lod_indices.end(), lod.begin(), lod.end());
+
+    source = std::move(lod);
+  }
+
+  return static_cast<uint32_t>(mesh.lods.size()) + 1;
+}
+
+// Level of a draw from the largest side of its projected AABB in pixels : the full mesh down to lod1ScreenSize, then one
+// level per halving of the size
+static uint32_t SelectLod(float projectedSize, uint32_t lodCount, float lod1ScreenSize) {
+  if (lodCount <= 1 || lod1ScreenSize <= 0.0f || projectedSize >= lod1ScreenSize) return 0;
+  float level = std::floor(std::log2(lod1ScreenSize / (std::max)(projectedSize, 1e-3f))) + 1.0f;
+  return (std::min)(static_cast<uint32_t>(level), lodCount - 1);
+}
+
+}  // namespace MeshSimplifier
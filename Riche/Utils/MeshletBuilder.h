@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "BoundingBox.h"
+#include "Rendering/Mesh.h"
+
+/*
+ * MeshletBuilder : import-time clustering of one triangle list into Meshlets (after MeshOptimizer::OptimizeMesh)
+ *  - Greedy over the optimized triangle order, a meshlet closes at MAX_VERTICES unique vertices or MAX_TRIANGLES triangles.
+ *    The triangles stay where they are, so a meshlet is a contiguous index range and the vertex cache order is kept.
+ *  - Bounds : sphere around the meshlet vertices, normal cone (axis, cutoff) of its triangles.
+ *  - IsMeshletVisible / CullMeshlets are the CPU reference of MeshletCullingCS (frustum + cone, the Hi-Z step needs the pyramid).
+ */
+
+namespace MeshletBuilder {
+
+static constexpr uint32_t MAX_VERTICES = 64;
+static constexpr uint32_t MAX_TRIANGLES = 124;
+static constexpr float CONE_MIN_DOT = 0.1f;  // wider cones (close to a half sphere) are never back-facing as a whole
+
+static void ComputeMeshletBounds(const Mesh& mesh, Meshlet& meshlet) {
+  std::vector<glm::vec3> positions;
+  positions.reserve(meshlet.triangleCount * 3);
+
+  glm::vec3 axis(0.0f);
+  for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+    const uint32_t* triangle = &mesh.indices[meshlet.firstIndex + t * 3];
+    glm::vec3 p0 = mesh.vertices[triangle[0]].pos;
+    glm::vec3 p1 = mesh.vertices[triangle[1]].pos;
+    glm::vec3 p2 = mesh.vertices[triangle[2]].pos;
+    positions.insert(positions.end(), {p0, p1, p2});
+
+    axis += glm::cross(p1 - p0, p2 - p0);  // area weighted
+  }
+
+  BoundingSphere sphere = ComputeBoundingSphere(positions);
+  meshlet.boundingSphere = glm::vec4(sphere.center, sphere.radius);
+  meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+  float axisLength = glm::length(axis);
+  if (axisLength <= 0.0f) return;
+  axis /= axisLength;
+
+  float minDot = 1.0f;
+  for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+    glm::vec3 normal = glm::cross(positions[t * 3 + 1] - positions[t * 3], positions[t * 3 + 2] - positions[t * 3]);
+    float normalLength = glm::length(normal);
+    if (normalLength <= 0.0f) continue;  // degenerate, faces nowhere
+    minDot = (std::min)(minDot, glm::dot(normal / normalLength, axis));
+  }
+  if (minDot <= CONE_MIN_DOT) return;
+
+  // sin of the spread, tested against the center direction (bounding sphere variant of the apex test)
+  meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+}
+
+// Fills mesh.meshlets from mesh.indices / mesh.vertices, returns the meshlet count
+static uint32_t BuildMeshlets(Mesh& mesh) {
+  mesh.meshlets.clear();
+  if (mesh.indices.size() < 3 || mesh.topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) return 0;
+
+  // The meshlet a vertex was last counted in (+ 1), so membership is one compare
+  std::vector<uint32_t> vertexTag(mesh.vertices.size(), 0);
+  uint32_t vertexCount = 0;
+
+  Meshlet meshlet = {};
+  const uint32_t triangleCount = static_cast<uint32_t>(mesh.indices.size() / 3);
+  for (uint32_t t = 0; t < triangleCount; ++t) {
+    const uint32_t* triangle = &mesh.indices[t * 3];
+    uint32_t tag = static_cast<uint32_t>(mesh.meshlets.size()) + 1;
+    uint32_t newVertices = 0;
+    for (uint32_t k = 0; k < 3; ++k) {
+      bool isRepeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+      if (vertexTag[triangle[k]] != tag && !isRepeated) ++newVertices;
+    }
+
+    if (meshlet.triangleCount == MAX_TRIANGLES || vertexCount + newVertices > MAX_VERTICES) {
+      ComputeMeshletBounds(mesh, meshlet);
+      mesh.meshlets.push_back(meshlet);
+
+      meshlet = {};
+      meshlet.firstIndex = t * 3;
+      vertexCount = 0;
+      tag = static_cast<uint32_t>(mesh.meshlets.size()) + 1;
+    }
+
+    for (uint32_t k = 0; k < 3; ++k) {
+      if (vertexTag[triangle[k]] == tag) continue;
+      vertexTag[triangle[k]] = tag;
+      ++vertexCount;
+    }
+    ++meshlet.triangleCount;
+  }
+
+  ComputeMeshletBounds(mesh, meshlet);
+  mesh.meshlets.push_back(meshlet);
+  return static_cast<uint32_t>(mesh.meshlets.size());
+}
+
+// CPU version of the frustum and normal cone tests of MeshletCullingCS
+static bool IsMeshletVisible(const Meshlet& meshlet, const glm::mat4& model, const std::array<FrustumPlane, 6>& frustum,
+                             const glm::vec3& cameraPos, bool isConeCulling = true) {
+  glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+  float maxScale = (std::max)(scale.x, (std::max)(scale.y, scale.z));
+  float minScale = (std::min)(scale.x, (std::min)(scale.y, scale.z));
+
+  glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(meshlet.boundingSphere), 1.0f));
+  float radius = meshlet.boundingSphere.w * maxScale;
+
+  for (const FrustumPlane& plane : frustum) {
+    if (glm::dot(plane.normal, center) + plane.distance < -radius) return false;
+  }
+
+  // The cone only survives uniform scale, skewed normals make it meaningless
+  if (!isConeCulling || meshlet.cone.w >= 1.0f || maxScale > minScale * 1.01f) return true;
+
+  glm::vec3 axis = glm::normalize(glm::mat3(model) * glm::vec3(meshlet.cone));
+  glm::vec3 view = center - cameraPos;
+  return glm::dot(view, axis) < meshlet.cone.w * glm::length(view) + radius;
+}
+
+// CPU version of the MeshletCullingCS expansion : indices of the visible meshlets, in meshlet order. Returns the visible count.
+static uint32_t CullMeshlets(const Mesh& mesh, const glm::mat4& model, const std::array<FrustumPlane, 6>& frustum,
+                             const glm::vec3& cameraPos, std::vector<uint32_t>& outIndices, bool isConeCulling = true) {
+  uint32_t visibleCount = 0;
+  for (const Meshlet& meshlet : mesh.meshlets) {
+    if (!IsMeshletVisible(meshlet, model, frustum, cameraPos, isConeCulling)) continue;
+    outIndices.insert(outIndices.end(), mesh.indices.begin() + meshlet.firstIndex,
+                      mesh.indices.begin() + meshlet.firstIndex + meshlet.triangleCount * 3);
+    ++visibleCount;
+  }
+  return visibleCount;
+}
+
+}  // namespace MeshletBuilder
@@ -1,21 +1,162 @@
 #pragma once
 
 #include "BoundingBox.h"
+#include "GltfAccessor.h"
 #include "Rendering/Components.h"
 #include "Rendering/Image.h"
 #include "Rendering/Mesh.h"
+#include "Rendering/TextureStreamer.h"
 #include "Rendering/VulkanRenderer.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "Parallel.h"
 #include "Singleton.h"
+#include "TexturePacker.h"
 #include "ThreadPool.h"
+#include "VertexPacking.h"
 #include "VkUtils/ResourceManager.h"
 
 static entt::registry g_Registry;
 
-// future   ,  (Entt entity , MiniBatch  )
+// future 결과 수집 후, 기존 로직(Entt entity 생성, MiniBatch 등록 등)
 static uint64_t totalVertexOffset = 0;
 static uint64_t totalIndexOffset = 0;
 static int totalDiffuseOffset = 0;
 
+// Texture decodes of one model on g_ThreadPool, submitted before the geometry jobs so both overlap.
+// With isTextureStreaming only the mip tail is decoded, TextureStreamer pages in the finer levels.
+struct TextureLoadJob {
+  std::string path;
+  JobHandle<VkUtils::ResourceManager::DecodedTexture> handle;
+};
+
+static std::vector<TextureLoadJob> submitTextureDecodes(const std::vector<std::string>& texturePaths) {
+  const bool isCooking = g_RenderSetting.isTextureCookOnLoad;
+  const uint32_t maxSize = g_RenderSetting.isTextureStreaming ? TextureStreamer::TAIL_SIZE : 0;
+
+  std::vector<TextureLoadJob> jobs;
+  jobs.reserve(texturePaths.size());
+  for (const std::string& path : texturePaths) {
+    auto handle = g_ThreadPool.Submit([path, isCooking, maxSize]() {
+      return VkUtils::ResourceManager::DecodeTexture(path, TextureCooker::TextureSlot::BaseColor, isCooking, maxSize);
+    });
+    jobs.push_back({path, std::move(handle)});
+  }
+  return jobs;
+}
+
+struct PackedTexture {
+  size_t materialIndex;  // into m_materialTextures
+  VkUtils::ResourceManager::DecodedTexture texture;
+};
+
+// Pages of the small textures of one model, each page is uploaded like a decoded texture of its own
+static void uploadPackedTextures(VkDevice device, std::vector<PackedTexture>& textures) {
+  std::vector<TexturePacker::Tile> tiles(textures.size());
+  for (size_t i = 0; i < textures.size(); ++i) {
+    tiles[i] = {static_cast<uint32_t>(textures[i].texture.width), static_cast<uint32_t>(textures[i].texture.height)};
+  }
+  std::vector<TexturePacker::Page> pages;
+  std::vector<TexturePacker::Placement> placements = TexturePacker::Pack(tiles, pages);
+
+  const size_t firstPage = g_BatchManager.m_diffuseImages.size();
+  VkDeviceSize pageBytes = 0;
+  for (size_t page = 0; page < pages.size(); ++page) {
+    // malloc'ed, UploadTexture frees it with stbi_image_free like the pixels of a decoded file
+    VkUtils::ResourceManager::DecodedTexture pageTexture;
+    pageTexture.width = pageTexture.sourceWidth = static_cast<int>(pages[page].width);
+    pageTexture.height = pageTexture.sourceHeight = static_cast<int>(pages[page].height);
+    pageTexture.size = static_cast<VkDeviceSize>(pages[page].width) * pages[page].height * 4;
+    pageTexture.pixels = static_cast<stbi_uc*>(calloc(static_cast<size_t>(pageTexture.size), 1));
+    for (size_t i = 0; i < textures.size(); ++i) {
+      if (placements[i].page != page) continue;
+      TexturePacker::CopyTile(pageTexture.pixels, pages[page], placements[i], textures[i].texture.pixels, tiles[i]);
+    }
+
+    GpuImage _image;
+    VkFormat format;
+    g_ResourceManager.UploadTexture(pageTexture, &_image.memory, &_image.image, &_image.size, &format);
+    VkUtils::CreateImageView(device, _image.image, &_image.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+    g_BatchManager.m_diffuseImages.push_back(_image);
+    pageBytes += _image.size;
+  }
+
+  for (size_t i = 0; i < textures.size(); ++i) {
+    stbi_image_free(textures[i].texture.pixels);
+
+    MaterialTexture& materialTexture = g_BatchManager.m_materialTextures[textures[i].materialIndex];
+    materialTexture.textureIndex = static_cast<int>(firstPage + placements[i].page);
+    materialTexture.maxLod = TexturePacker::GetMaxLod(tiles[i]);
+    materialTexture.uvTransform = TexturePacker::GetUvTransform(pages[placements[i].page], placements[i], tiles[i]);
+  }
+  std::cout << "[Texture] " << textures.size() << " textures packed into " << pages.size() << " pages ("
+            << static_cast<float>(pageBytes) / (1024.0f * 1024.0f) << " MB)" << std::endl;
+}
+
+// Uploads each texture as soon as its decode finishes, m_materialTextures still follows the material order.
+// With isTexturePacking the small ones wait for the others and go into TexturePacker pages instead.
+// Returns the decode time summed over the jobs.
+static float uploadDecodedTextures(VkDevice device, std::vector<TextureLoadJob>& jobs) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  const size_t baseIndex = g_BatchManager.m_materialTextures.size();
+  g_BatchManager.m_materialTextures.resize(baseIndex + jobs.size());
+  std::vector<PackedTexture> packedTextures;
+
+  float decodeMs = 0.0f;
+  for (size_t remaining = jobs.size(); remaining > 0; --remaining) {
+    // A finished decode first, otherwise wait for the oldest one (get() helps with the queued jobs meanwhile)
+    size_t next = jobs.size();
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      if (!jobs[i].handle.valid()) continue;
+      if (next == jobs.size()) next = i;
+      if (jobs[i].handle.IsReady()) {
+        next = i;
+        break;
+      }
+    }
+
+    VkUtils::ResourceManager::DecodedTexture texture = jobs[next].handle.get();
+    decodeMs += texture.decodeMs;
+
+    // Decoded RGBA8 with every level (not streamed, not cooked)
+    if (g_RenderSetting.isTexturePacking && texture.pixels && texture.firstMip == 0 &&
+        TexturePacker::IsPackable(static_cast<uint32_t>(texture.width), static_cast<uint32_t>(texture.height))) {
+      packedTextures.push_back({baseIndex + next, std::move(texture)});
+      continue;
+    }
+    auto uploadBegin = Clock::now();
+
+    const uint32_t textureIndex = static_cast<uint32_t>(g_BatchManager.m_diffuseImages.size());
+    g_BatchManager.m_materialTextures[baseIndex + next].textureIndex = static_cast<int>(textureIndex);
+    GpuImage& _image = g_BatchManager.m_diffuseImages.emplace_back();
+    VkFormat format;
+    g_ResourceManager.UploadTexture(texture, &_image.memory, &_image.image, &_image.size, &format);
+    VkUtils::CreateImageView(device, _image.image, &_image.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+    if (g_RenderSetting.isTextureStreaming) g_TextureStreamer.AddTexture(textureIndex, texture, format);
+
+    float uploadMs = std::chrono::duration<float, std::milli>(Clock::now() - uploadBegin).count();
+    std::cout << "[Texture] " << jobs[next].path << " : " << texture.width << "x" << texture.height << " (mip "
+              << texture.firstMip << ")" << (format == VK_FORMAT_R8G8B8A8_UNORM ? " RGBA8" : " BCn") << ", decode " << texture.decodeMs
+              << " ms, upload " << uploadMs << " ms" << std::endl;
+  }
+
+  // A page for a single texture saves nothing
+  if (packedTextures.size() == 1) {
+    PackedTexture& packed = packedTextures[0];
+    MaterialTexture& materialTexture = g_BatchManager.m_materialTextures[packed.materialIndex];
+    materialTexture.textureIndex = static_cast<int>(g_BatchManager.m_diffuseImages.size());
+    GpuImage& _image = g_BatchManager.m_diffuseImages.emplace_back();
+    VkFormat format;
+    g_ResourceManager.UploadTexture(packed.texture, &_image.memory, &_image.image, &_image.size, &format);
+    VkUtils::CreateImageView(device, _image.image, &_image.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS);
+  } else if (!packedTextures.empty()) {
+    uploadPackedTextures(device, packedTextures);
+  }
+  return decodeMs;
+}
+
 static bool loadObjModel(VkDevice device, const std::string& filepath, const std::string& objName, std::vector<Mesh>& outMeshes,
                          float scale = 1.0f) {
   tinyobj::attrib_t attrib;
@@ -23,15 +164,28 @@ static bool loadObjModel(VkDevice device, const std::string& filepath, const std
   std::vector<tinyobj::material_t> materials;
   std::string warn, err;
 
-  // OBJ  ε
+  // OBJ 파일 로드
   bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, (filepath + objName).c_str(), filepath.c_str());
   if (!warn.empty()) std::cout << "[TinyObjLoader Warning] " << warn << std::endl;
   if (!err.empty()) std::cerr << "[TinyObjLoader Error] " << err << std::endl;
   if (!ret) return false;
 
-  std::vector<std::future<Mesh>> futures;
+  std::vector<std::string> texturePaths;
+  for (const tinyobj::material_t& mat : materials) {
+    if (mat.diffuse_texname.empty()) continue;
+
+    std::string texturePath = filepath + mat.diffuse_texname;
+    std::replace(texturePath.begin(), texturePath.end(), '\\', '/');
+    texturePaths.push_back(texturePath);
+  }
+  std::vector<TextureLoadJob> textureJobs = submitTextureDecodes(texturePaths);
+
+  std::vector<JobHandle<Mesh>> futures;
   futures.reserve(shapes.size());
 
+  MeshOptimizeStats optimizeStats;
+  std::mutex optimizeStatsMutex;
+
   for (size_t i = 0; i < shapes.size(); ++i) {
     auto future = g_ThreadPool.Submit([&, i]() -> Mesh {
       Mesh data;
@@ -62,9 +216,19 @@ static bool loadObjModel(VkDevice device, const std::string& filepath, const std
         }
 
         data.vertices.push_back(std::move(vertex));
-        // index (ܼ f ų, unique ó)
+        // index (단순히 f를 쓰거나, unique 처리)
         data.indices.push_back(static_cast<uint32_t>(f));
       }
+
+      // One vertex per index so far, welding and reordering happen here on the worker
+      MeshOptimizeStats stats = MeshOptimizer::OptimizeMesh(data);
+      {
+        std::lock_guard<std::mutex> lock(optimizeStatsMutex);
+        optimizeStats += stats;
+      }
+      MeshletBuilder::BuildMeshlets(data);  // in the final triangle order
+      MeshSimplifier::BuildLods(data);
+      if (g_BatchManager.m_vertexFormat == VertexFormat::Packed) PackMeshVertices(data);
       return data;
     });
 
@@ -79,7 +243,7 @@ static bool loadObjModel(VkDevice device, const std::string& filepath, const std
     partial.vertexCount = static_cast<uint32_t>(partial.vertices.size());
     partial.indexCount = static_cast<uint32_t>(partial.indices.size());
 
-    AddDataToMiniBatch(g_BatchManager.m_miniBatchList, g_ResourceManager, partial);
+    g_BatchManager.AddDataToMiniBatch(g_BatchManager.m_miniBatchList, partial);
 
     entt::entity object = g_Registry.create();
     ObjectID _id;
@@ -99,37 +263,36 @@ static bool loadObjModel(VkDevice device, const std::string& filepath, const std
 
     outMeshes.push_back(partial);
   }
+  MeshOptimizer::PrintStats(objName.c_str(), optimizeStats);
 
-  for (size_t i = 0; i < materials.size(); ++i) {
-    const tinyobj::material_t& mat = materials[i];
-
-    if (!mat.diffuse_texname.empty()) {
-      std::string texturePath = filepath + mat.diffuse_texname;
-      std::replace(texturePath.begin(), texturePath.end(), '\\', '/');
-
-      GpuImage _image;
-
-      g_ResourceManager.CreateTexture(texturePath, &_image.memory, &_image.image, &_image.size);
-      VkUtils::CreateImageView(device, _image.image, &_image.imageView, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-
-      g_BatchManager.m_diffuseImages.push_back(_image);
-    }
-  }
+  uploadDecodedTextures(device, textureJobs);
 
   return true;
 }
 
 static bool loadGltfModel(VkDevice device, const std::string& filepath, const std::string& gltfName, std::vector<Mesh>& outMeshes,
                           float scale = 1.0f, glm::vec3 pos = glm::vec3(0.0f)) {
+  using Clock = std::chrono::high_resolution_clock;
+  auto elapsedMs = [](Clock::time_point begin) { return std::chrono::duration<float, std::milli>(Clock::now() - begin).count(); };
+
+  GltfAccessor::LoadTimings timings;
+  auto loadBegin = Clock::now();
+
   tinygltf::TinyGLTF loader;
   tinygltf::Model model;
   std::string warn, err;
 
-  // glTF ε (.gltf  ASCII, .glb  Binary δ )
-  // ) .gltf ̶ 
+  // Textures are decoded by ResourceManager::CreateTexture from image.uri below, tinygltf only has to keep the uri
+  loader.SetImageLoader([](tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int,
+                           void*) { return true; },
+                        nullptr);
+
+  // glTF 로드 (.gltf의 경우 ASCII, .glb의 경우 Binary 로더 사용)
+  // 예시) .gltf 파일이라 가정
   bool ret = loader.LoadASCIIFromFile(&model, &err, &warn, (filepath + gltfName));
-  //  .glb:
+  // 만약 .glb라면:
   // bool ret = loader.LoadBinaryFromFile(&model, &err, &warn, (filepath + gltfName));
+  timings.parseMs = elapsedMs(loadBegin);
 
   if (!warn.empty()) {
     std::cout << "[tinygltf Warning] " << warn << std::endl;
@@ -142,251 +305,113 @@ static bool loadGltfModel(VkDevice device, const std::string& filepath, const st
     return false;
   }
 
-  // glTF   Mesh   ְ,  Mesh  Primitive   ֽϴ.
-  //  Primitive OBJ shape ϰ Ͽ Mesh ȯѴٰ մϴ.
-  std::vector<std::future<Mesh>> futures;
-  futures.reserve(model.meshes.size());  // δ mesh  * primitive ŭ   
+  // glTF의 materials에 대해 텍스처 등 로딩
+  // glTF에서는 PBRMetallicRoughness 구조 등에서 텍스처 index를 얻어올 수 있음
+  // 아래는 baseColorTexture만 로딩하는 예시
+  std::vector<std::string> texturePaths;
+  for (size_t i = 0; i < model.materials.size(); ++i) {
+    const tinygltf::Material& mat = model.materials[i];
+
+    // baseColorTexture에 대한 인덱스 확인
+    int texIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
+    if (texIndex < 0 || texIndex >= (int)model.textures.size()) continue;
+
+    const tinygltf::Texture& texture = model.textures[texIndex];
+    if (texture.source < 0 || texture.source >= (int)model.images.size()) continue;
+
+    std::string texturePath = model.images[texture.source].uri;
+    // 외부 파일일 경우, filepath + texturePath 등이 실제 파일 경로가 될 수도 있음
+    // 경로에 '\\' 등이 들어 있을 수 있으므로 교체
+    std::replace(texturePath.begin(), texturePath.end(), '\\', '/');
+
+    if (texturePath.find(":") == std::string::npos) {
+      texturePath = filepath + texturePath;
+    }
+    texturePaths.push_back(texturePath);
+  }
+  auto textureBegin = Clock::now();
+  std::vector<TextureLoadJob> textureJobs = submitTextureDecodes(texturePaths);
+
+  // glTF는 여러 개의 Mesh를 가질 수 있고, 각 Mesh는 여러 Primitive를 가질 수 있습니다.
+  // 각각의 Primitive를 OBJ의 shape와 유사하게 취급하여 Mesh로 변환한다고 가정합니다.
+  std::vector<JobHandle<Mesh>> futures;
+  futures.reserve(model.meshes.size());  // 실제로는 mesh 수 * primitive 수만큼 생길 수 있음
+
+  MeshOptimizeStats optimizeStats;
+  std::mutex optimizeStatsMutex;
+
+  auto jobsBegin = Clock::now();
 
-  // glTF  mesh ->  primitive  Ͽ ͸ 
+  // glTF의 각 mesh -> 각 primitive 에 대하여 데이터를 추출
   for (size_t meshIndex = 0; meshIndex < model.meshes.size(); ++meshIndex) {
     const tinygltf::Mesh& gltfMesh = model.meshes[meshIndex];
 
     for (size_t primIndex = 0; primIndex < gltfMesh.primitives.size(); ++primIndex) {
       const tinygltf::Primitive& primitive = gltfMesh.primitives[primIndex];
 
-      //  Ǯ ۾ 
+      // 스레드 풀에 작업을 제출
       auto future = g_ThreadPool.Submit([&, meshIndex, primIndex]() -> Mesh {
         Mesh data;
 
-        // materialID  (glTF primitive.material ε)
-        //   -1̰ų, unsigned(-1)     üũ
+        // materialID 설정 (glTF에서는 primitive.material이 인덱스)
+        // 없는 경우 -1이거나, unsigned(-1) 같은 값일 수 있으니 체크
         if (primitive.material >= 0 && primitive.material < static_cast<int>(model.materials.size())) {
           data.materialID = static_cast<int>(primitive.material);
         } else {
-          data.materialID = -1;  // ⺻
-        }
-
-        // ε  ó
-        std::vector<uint32_t> localIndices;
-        if (primitive.indices >= 0 && primitive.indices < static_cast<int>(model.accessors.size())) {
-          const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
-          const tinygltf::BufferView& indexBufferView = model.bufferViews[indexAccessor.bufferView];
-          const tinygltf::Buffer& indexBuffer = model.buffers[indexBufferView.buffer];
-
-          const uint8_t* dataPtr = indexBuffer.data.data() + indexBufferView.byteOffset + indexAccessor.byteOffset;
-          size_t indexCount = indexAccessor.count;
-          localIndices.reserve(indexCount);
-
-          // ε Ÿ (unsigned short, unsigned int )
-          if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT) {
-            for (size_t i = 0; i < indexCount; ++i) {
-              uint16_t idx = reinterpret_cast<const uint16_t*>(dataPtr)[i];
-              localIndices.push_back(static_cast<uint32_t>(idx));
-            }
-          } else if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT) {
-            for (size_t i = 0; i < indexCount; ++i) {
-              uint32_t idx = reinterpret_cast<const uint32_t*>(dataPtr)[i];
-              localIndices.push_back(idx);
-            }
-          } else if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE) {
-            for (size_t i = 0; i < indexCount; ++i) {
-              uint8_t idx = reinterpret_cast<const uint8_t*>(dataPtr)[i];
-              localIndices.push_back(static_cast<uint32_t>(idx));
-            }
-          } else {
-            //    ⼭  ó Ȥ 
-            std::cerr << "[tinygltf] Unsupported index component type.\n";
-          }
+          data.materialID = -1;  // 기본값
         }
 
-        // POSITION, NORMAL, TEXCOORD_0  Attribute ó
-        // glTF Attribute ̸: "POSITION", "NORMAL", "TEXCOORD_0" 
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> texcoords;
-        std::vector<glm::vec4> colors;
-
-        // glTF attributes std::map<std::string, int> 
-        auto itPos = primitive.attributes.find("POSITION");
-        if (itPos != primitive.attributes.end()) {
-          const tinygltf::Accessor& accessor = model.accessors[itPos->second];
-          const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-          const tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-          const size_t accessorCount = accessor.count;
-          positions.reserve(accessorCount);
-
-          const uint8_t* dataPtr = buffer.data.data() + view.byteOffset + accessor.byteOffset;
-          // stride 
-          size_t stride = accessor.ByteStride(view);
-          if (!stride) {
-            // ⺻ stride 
-            stride = tinygltf::GetNumComponentsInType(accessor.type) * tinygltf::GetComponentSizeInBytes(accessor.componentType);
-          }
-
-          for (size_t i = 0; i < accessorCount; ++i) {
-            const float* elem = reinterpret_cast<const float*>(dataPtr + stride * i);
-            glm::vec3 pos = glm::vec3(elem[0], elem[1], elem[2]) * scale;
-            positions.push_back(pos);
-          }
-        }
+        auto decodeBegin = Clock::now();
 
-        auto itNorm = primitive.attributes.find("NORMAL");
-        if (itNorm != primitive.attributes.end()) {
-          const tinygltf::Accessor& accessor = model.accessors[itNorm->second];
-          const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-          const tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-          const size_t accessorCount = accessor.count;
-          normals.reserve(accessorCount);
-
-          const uint8_t* dataPtr = buffer.data.data() + view.byteOffset + accessor.byteOffset;
-          size_t stride = accessor.ByteStride(view);
-          if (!stride) {
-            stride = tinygltf::GetNumComponentsInType(accessor.type) * tinygltf::GetComponentSizeInBytes(accessor.componentType);
-          }
+        // glTF의 attributes는 std::map<std::string, int> 형태, 없는 attribute는 invalid View (0으로 채워짐)
+        auto findAttribute = [&](const char* name) {
+          auto it = primitive.attributes.find(name);
+          return GltfAccessor::MakeView(model, it != primitive.attributes.end() ? it->second : -1);
+        };
+        GltfAccessor::View positions = findAttribute("POSITION");
+        GltfAccessor::View normals = findAttribute("NORMAL");
+        GltfAccessor::View texcoords = findAttribute("TEXCOORD_0");
 
-          for (size_t i = 0; i < accessorCount; ++i) {
-            const float* elem = reinterpret_cast<const float*>(dataPtr + stride * i);
-            glm::vec3 nor = glm::vec3(elem[0], elem[1], elem[2]);
-            normals.push_back(nor);
-          }
+        GltfAccessor::View indices = GltfAccessor::MakeView(model, primitive.indices);
+        if (indices.IsValid() && !GltfAccessor::IsIndexType(indices.componentType)) {
+          // 그 외 형식은 인덱스가 없는 것으로 처리
+          std::cerr << "[tinygltf] Unsupported index component type.\n";
+          indices = {};
         }
 
-        {
-          auto itTex = primitive.attributes.find("TEXCOORD_0");
-          if (itTex != primitive.attributes.end()) {
-            const tinygltf::Accessor& accessor = model.accessors[itTex->second];
-            const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-            const tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-            const size_t accessorCount = accessor.count;
-            texcoords.reserve(accessorCount);
-
-            const uint8_t* dataPtr = buffer.data.data() + view.byteOffset + accessor.byteOffset;
-            size_t stride = accessor.ByteStride(view);
-            if (!stride) {
-              stride = tinygltf::GetNumComponentsInType(accessor.type) * tinygltf::GetComponentSizeInBytes(accessor.componentType);
-            }
-
-            for (size_t i = 0; i < accessorCount; ++i) {
-              const float* elem = reinterpret_cast<const float*>(dataPtr + stride * i);
-              glm::vec2 uv = glm::vec2(elem[0], elem[1]);
-              texcoords.push_back(uv);
-            }
-          }
+        // Final arrays are sized once and written in place, a large primitive is decoded by several workers
+        data.vertices.resize(positions.count);
+        ParallelForRange(0, positions.count, GltfAccessor::DECODE_GRAIN, [&](size_t rangeBegin, size_t rangeEnd) {
+          GltfAccessor::DecodeVertices(positions, normals, texcoords, scale, data.vertices.data(), rangeBegin, rangeEnd);
+        });
+
+        if (indices.IsValid()) {
+          data.indices.resize(indices.count);
+          ParallelForRange(0, indices.count, GltfAccessor::DECODE_GRAIN, [&](size_t rangeBegin, size_t rangeEnd) {
+            GltfAccessor::DecodeIndices(indices, data.indices.data(), rangeBegin, rangeEnd);
+          });
+        } else {
+          // 인덱스가 없을 때. (drawArrays 방식)
+          data.indices.resize(positions.count);
+          for (size_t i = 0; i < positions.count; ++i) data.indices[i] = static_cast<uint32_t>(i);
         }
 
-        {
-          auto itColor = primitive.attributes.find("COLOR_0");
-          if (itColor != primitive.attributes.end()) {
-            const tinygltf::Accessor& accessor = model.accessors[itColor->second];
-            const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-            const tinygltf::Buffer& buffer = model.buffers[view.buffer];
-
-            size_t accessorCount = accessor.count;
-            colors.reserve(accessorCount);
-
-            const uint8_t* dataPtr = buffer.data.data() + view.byteOffset + accessor.byteOffset;
-            size_t stride = accessor.ByteStride(view);
-            if (!stride) {
-              stride = tinygltf::GetNumComponentsInType(accessor.type) * tinygltf::GetComponentSizeInBytes(accessor.componentType);
-            }
-
-            // glTF COLOR_0  VEC3 or VEC4
-            int numComponents = tinygltf::GetNumComponentsInType(accessor.type);
-
-            // componentType FLOAT / UNSIGNED_BYTE / UNSIGNED_SHORT  
-            // ⼭ FLOAT, UNSIGNED_BYTE(ȭ) 
-            if (accessor.componentType == TINYGLTF_PARAMETER_TYPE_FLOAT) {
-              for (size_t i = 0; i < accessorCount; ++i) {
-                const float* elem = reinterpret_cast<const float*>(dataPtr + stride * i);
-                if (numComponents == 3) {
-                  colors.push_back(glm::vec4(elem[0], elem[1], elem[2], 1.0f));
-                } else {
-                  // VEC4
-                  colors.push_back(glm::vec4(elem[0], elem[1], elem[2], elem[3]));
-                }
-              }
-            } else if (accessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE) {
-              // glTF "normalized" ÷װ true 찡 Ƿ
-              // 0~255  0~1 ȯ
-              bool normalized = accessor.normalized;  // tinygltf Accessor normalized 
-              for (size_t i = 0; i < accessorCount; ++i) {
-                const uint8_t* elem = reinterpret_cast<const uint8_t*>(dataPtr + stride * i);
-                if (numComponents == 3) {
-                  if (normalized) {
-                    colors.push_back(glm::vec4(elem[0] / 255.0f, elem[1] / 255.0f, elem[2] / 255.0f, 1.0f));
-                  } else {
-                    // ȭ -> ׳ 0~255 Ϸ, ʿ信  ó
-                    colors.push_back(glm::vec4(elem[0], elem[1], elem[2], 1.0f));
-                  }
-                } else {
-                  // numComponents == 4
-                  if (normalized) {
-                    colors.push_back(glm::vec4(elem[0] / 255.0f, elem[1] / 255.0f, elem[2] / 255.0f, elem[3] / 255.0f));
-                  } else {
-                    colors.push_back(glm::vec4(elem[0], elem[1], elem[2], elem[3]));
-                  }
-                }
-              }
-            } else {
-              // ʿϴٸ ٸ componentType (e.g. UNSIGNED_SHORT) ó
-              std::cerr << "[tinygltf] Unsupported COLOR_0 component type.\n";
-            }
-          }
-        }
+        float decodeMs = elapsedMs(decodeBegin);
+        auto optimizeBegin = Clock::now();
 
-        // vertex / index  
-        // tinyobjloader ÿ ϰ BasicVertex  data.vertices ִ´.
-        // ε ϴ  localIndices  ﰢ(Ǵ   )  Ҵ
-        // ε  positions.size()ŭ  push_back   .
-        if (!localIndices.empty()) {
-          data.indices.reserve(localIndices.size());
-          data.vertices.reserve(positions.size());  // rough
-
-          // 켱    BasicVertex · 
-          for (size_t i = 0; i < positions.size(); ++i) {
-            BasicVertex v{};
-            v.pos = positions[i];
-            v.normal = (i < normals.size()) ? normals[i] : glm::vec3(0, 0, 0);
-            v.tex = (i < texcoords.size()) ? texcoords[i] : glm::vec2(0, 0);
-            data.vertices.push_back(v);
-
-            RayTracingVertex rv{};
-            rv.pos = glm::vec4(v.pos, 1.0f);
-            rv.normal = glm::vec4(v.normal, 1.0f);
-            rv.tex = v.tex;
-            rv.padd[0] = meshIndex;
-            data.ray_vertices.push_back(rv);
-          }
+        MeshOptimizeStats stats = MeshOptimizer::OptimizeMesh(data);
+        MeshletBuilder::BuildMeshlets(data);  // in the final triangle order
+        MeshSimplifier::BuildLods(data);
+        // Packed after reordering so packed_vertices follows the final vertex order
+        if (g_BatchManager.m_vertexFormat == VertexFormat::Packed) PackMeshVertices(data);
 
-          // ε Ҵ
-          for (auto idx : localIndices) {
-            data.indices.push_back(idx);
-          }
-        } else {
-          // ε  . (drawArrays )
-          data.vertices.reserve(positions.size());
-
-          for (size_t i = 0; i < positions.size(); ++i) {
-            BasicVertex v{};
-            v.pos = positions[i];
-            v.normal = (i < normals.size()) ? normals[i] : glm::vec3(0, 0, 0);
-            v.tex = (i < texcoords.size()) ? texcoords[i] : glm::vec2(0, 0);
-            data.vertices.push_back(v);
-
-            RayTracingVertex rv{};
-            rv.pos = glm::vec4(v.pos, 1.0f);
-            rv.normal = glm::vec4(v.normal, 1.0f);
-            rv.tex = v.tex;
-            rv.padd[0] = meshIndex;
-            data.ray_vertices.push_back(rv);
-
-            data.indices.push_back(static_cast<uint32_t>(i));
-          }
+        float optimizeMs = elapsedMs(optimizeBegin);
+        {
+          std::lock_guard<std::mutex> lock(optimizeStatsMutex);
+          optimizeStats += stats;
+          timings.decodeMs += decodeMs;
+          timings.optimizeMs += optimizeMs;
         }
-
         return data;
       });
 
@@ -395,18 +420,21 @@ static bool loadGltfModel(VkDevice device, const std::string& filepath, const st
   }
 
 
-  totalDiffuseOffset = g_BatchManager.m_diffuseImages.size();
+  totalDiffuseOffset = g_BatchManager.m_materialTextures.size();
   
   for (auto& f : futures) {
     Mesh partial = f.get();
+    auto assembleBegin = Clock::now();
 
-    partial.vertexCount = static_cast<uint32_t>(partial.ray_vertices.size());
+    partial.vertexCount = static_cast<uint32_t>(partial.vertices.size());
     partial.indexCount = static_cast<uint32_t>(partial.indices.size());
+    timings.vertexCount += partial.vertexCount;
+    timings.indexCount += partial.indexCount;
 
-    // ҽ Ŵ    (ε) 
-    g_BatchManager.AddDataToMiniBatch(g_BatchManager.m_miniBatchList, g_ResourceManager, partial);
+    // 리소스 매니저를 통해 실제 버퍼 생성(업로드) 등
+    g_BatchManager.AddDataToMiniBatch(g_BatchManager.m_miniBatchList, partial);
 
-    // ƼƼ   
+    // 엔티티 생성 및 등록
     entt::entity object = g_Registry.create();
 
     ObjectID _id;
@@ -422,67 +450,21 @@ static bool loadGltfModel(VkDevice device, const std::string& filepath, const st
     g_BatchManager.m_trasformList.push_back(_transform);
     g_Registry.emplace<Transform>(object, _transform);
 
-    AABB _aabb = ComputeAABB(partial.vertices);  //   AABB  Լ
+    AABB _aabb = ComputeAABB(partial.vertices);  // 사용자 정의 AABB 계산 함수
     g_BatchManager.m_boundingBoxList.push_back(_aabb);
     g_Registry.emplace<AABB>(object, _aabb);
 
-    std::vector<glm::vec3> AABBvertex = CreateAABBVertexBuffer(_aabb);
-    std::vector<uint32_t> AABBIndics = CreateAABBIndexBuffer();
-
-    AABBBufferList _aabbBufferList;
-    g_ResourceManager.CreateVertexBuffer(AABBvertex.size() * sizeof(glm::vec3), &_aabbBufferList.vertexBufferMemory,
-                                         &_aabbBufferList.vertexBuffer, AABBvertex.data());
-    g_ResourceManager.CreateIndexBuffer(AABBIndics.size() * sizeof(uint32_t), &_aabbBufferList.indexBufferMemory,
-                                        &_aabbBufferList.indexBuffer, AABBIndics.data());
-    g_BatchManager.m_boundingBoxBufferList.push_back(_aabbBufferList);
-
-    GpuBuffer vertexBuffer;
-    GpuBuffer indexBuffer;
-
-    g_ResourceManager.CreateVertexBuffer(partial.vertices.size() * sizeof(BasicVertex), &vertexBuffer.memory, &vertexBuffer.buffer,
-                                         partial.vertices.data());
-    g_ResourceManager.CreateIndexBuffer(partial.indices.size() * sizeof(uint32_t), &indexBuffer.memory, &indexBuffer.buffer,
-                                        partial.indices.data());
-
-    g_BatchManager.m_bbVertexBuffers.push_back(std::move(vertexBuffer));
-    g_BatchManager.m_bbIndexBuffers.push_back(std::move(indexBuffer));
-
     outMeshes.push_back(std::move(partial));
+    timings.assembleMs += elapsedMs(assembleBegin);
   }
+  timings.jobsMs = elapsedMs(jobsBegin);
+  MeshOptimizer::PrintStats(gltfName.c_str(), optimizeStats);
 
-  // glTF materials  ؽó  ε
-  // glTF PBRMetallicRoughness   ؽó index   
-  // Ʒ baseColorTexture εϴ 
-  for (size_t i = 0; i < model.materials.size(); ++i) {
-    const tinygltf::Material& mat = model.materials[i];
-
-    // baseColorTexture  ε Ȯ
-    if (mat.pbrMetallicRoughness.baseColorTexture.index >= 0) {
-      int texIndex = mat.pbrMetallicRoughness.baseColorTexture.index;
-      if (texIndex < (int)model.textures.size()) {
-        const tinygltf::Texture& texture = model.textures[texIndex];
-        if (texture.source >= 0 && texture.source < (int)model.images.size()) {
-          const tinygltf::Image& image = model.images[texture.source];
-
-          std::string texturePath = image.uri;
-          // ܺ  , filepath + texturePath    ΰ   
-          // ο '\\'     Ƿ ü
-          std::replace(texturePath.begin(), texturePath.end(), '\\', '/');
-
-          if (texturePath.find(":") == std::string::npos) {
-            texturePath = filepath + texturePath;
-          }
-
-          GpuImage _image;
-
-          g_ResourceManager.CreateTexture(texturePath, &_image.memory, &_image.image, &_image.size);
-          VkUtils::CreateImageView(device, _image.image, &_image.imageView, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-
-          g_BatchManager.m_diffuseImages.push_back(_image);
-        }
-      }
-    }
-  }
+  // Decodes started before the geometry jobs, whatever is left is waited for here
+  timings.textureDecodeMs = uploadDecodedTextures(device, textureJobs);
+  timings.textureMs = elapsedMs(textureBegin);
+  timings.totalMs = elapsedMs(loadBegin);
+  GltfAccessor::PrintTimings(gltfName.c_str(), timings);
 
   std::cout << "mesh count: " << g_BatchManager.m_objectIDList.size() << std::endl;
   return true;
@@ -494,10 +476,10 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
   tinygltf::Model model;
   std::string warn, err;
 
-  // glTF ε (.gltf  ASCII, .glb  Binary δ )
-  // ⼭ .gltf ̶ 
+  // glTF 로드 (.gltf의 경우 ASCII, .glb의 경우 Binary 로더 사용)
+  // 여기서는 .gltf 파일이라 가정
   bool ret = loader.LoadASCIIFromFile(&model, &err, &warn, (filepath + gltfName));
-  //  .glb:
+  // 만약 .glb라면:
   // bool ret = loader.LoadBinaryFromFile(&model, &err, &warn, (filepath + gltfName));
 
   if (!warn.empty()) {
@@ -511,8 +493,8 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
     return false;
   }
 
-  // glTF   Mesh   ְ,  Mesh  Primitive   ֽϴ.
-  //  Mesh  Primitive  óϿ Mesh ͸ մϴ.
+  // glTF는 여러 개의 Mesh를 가질 수 있고, 각 Mesh는 여러 Primitive를 가질 수 있습니다.
+  // 각 Mesh의 각 Primitive를 순차적으로 처리하여 Mesh 데이터를 생성합니다.
   for (size_t meshIndex = 0; meshIndex < model.meshes.size(); ++meshIndex) {
     const tinygltf::Mesh& gltfMesh = model.meshes[meshIndex];
 
@@ -521,15 +503,15 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
 
       Mesh data;
 
-      // materialID  (glTF primitive.material ε)
-      //   -1 Ȥ unsigned(-1)     üũ
+      // materialID 설정 (glTF에서는 primitive.material이 인덱스)
+      // 없는 경우 -1 혹은 unsigned(-1) 같은 값일 수 있으니 체크
       if (primitive.material >= 0 && primitive.material < static_cast<int>(model.materials.size())) {
         data.materialID = static_cast<int>(primitive.material);
       } else {
-        data.materialID = -1;  // ⺻
+        data.materialID = -1;  // 기본값
       }
 
-      // ε  ó
+      // 인덱스 버퍼 처리
       std::vector<uint32_t> localIndices;
       if (primitive.indices >= 0 && primitive.indices < static_cast<int>(model.accessors.size())) {
         const tinygltf::Accessor& indexAccessor = model.accessors[primitive.indices];
@@ -540,7 +522,7 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
         size_t indexCount = indexAccessor.count;
         localIndices.reserve(indexCount);
 
-        // ε Ÿ (unsigned short, unsigned int )
+        // 인덱스 타입 (unsigned short, unsigned int 등)
         if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT) {
           for (size_t i = 0; i < indexCount; ++i) {
             uint16_t idx = reinterpret_cast<const uint16_t*>(dataPtr)[i];
@@ -560,15 +542,15 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
           std::cerr << "[tinygltf] Unsupported index component type.\n";
         }
       } else {
-        // ε  ,   TRIANGLES  positions.size() ŭ ε  
+        // 인덱스가 없는 경우, 예를 들어 TRIANGLES 모드라면 positions.size() 만큼 인덱스를 직접 생성
       }
 
-      // POSITION, NORMAL, TEXCOORD_0  Attribute ó
+      // POSITION, NORMAL, TEXCOORD_0 등 Attribute 처리
       std::vector<glm::vec3> positions;
       std::vector<glm::vec3> normals;
       std::vector<glm::vec2> texcoords;
 
-      // POSITION ó
+      // POSITION 처리
       auto itPos = primitive.attributes.find("POSITION");
       if (itPos != primitive.attributes.end()) {
         const tinygltf::Accessor& accessor = model.accessors[itPos->second];
@@ -591,7 +573,7 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
         }
       }
 
-      // NORMAL ó
+      // NORMAL 처리
       auto itNorm = primitive.attributes.find("NORMAL");
       if (itNorm != primitive.attributes.end()) {
         const tinygltf::Accessor& accessor = model.accessors[itNorm->second];
@@ -614,7 +596,7 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
         }
       }
 
-      // TEXCOORD_0 ó
+      // TEXCOORD_0 처리
       auto itTex = primitive.attributes.find("TEXCOORD_0");
       if (itTex != primitive.attributes.end()) {
         const tinygltf::Accessor& accessor = model.accessors[itTex->second];
@@ -637,7 +619,7 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
         }
       }
 
-      //  vertex / index 
+      // 최종 vertex / index 구성
       if (!localIndices.empty()) {
         data.indices.reserve(localIndices.size());
         data.vertices.reserve(positions.size());  // rough
@@ -654,7 +636,7 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
           data.indices.push_back(idx);
         }
       } else {
-        // ε  , drawArrays  ó (positions.size() ŭ  ε Ҵ)
+        // 인덱스가 없는 경우, drawArrays 방식으로 처리 (positions.size() 만큼 직접 인덱스 할당)
         data.vertices.reserve(positions.size());
         for (size_t i = 0; i < positions.size(); ++i) {
           BasicVertex v{};
@@ -666,15 +648,20 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
         }
       }
 
-      //  primitive  Mesh ͸ ٷ ó
-      // (ʿϸ,  Mesh ƼƼ , ̴Ϲġ   )
+      MeshOptimizer::OptimizeMesh(data);
+      MeshletBuilder::BuildMeshlets(data);
+      MeshSimplifier::BuildLods(data);
+      if (g_BatchManager.m_vertexFormat == VertexFormat::Packed) PackMeshVertices(data);
+
+      // 각 primitive에서 생성한 Mesh 데이터를 바로 처리
+      // (필요하면, 각 Mesh별로 엔티티 생성, 미니배치 등록 등을 수행)
       data.vertexCount = static_cast<uint32_t>(data.vertices.size());
       data.indexCount = static_cast<uint32_t>(data.indices.size());
 
-      // : ̴Ϲġ  ߰
-      AddDataToMiniBatch(g_BatchManager.m_miniBatchList, g_ResourceManager, data);
+      // 예: 미니배치에 데이터 추가
+      g_BatchManager.AddDataToMiniBatch(g_BatchManager.m_miniBatchList, data);
 
-      // ƼƼ    ()
+      // 엔티티 생성 및 등록 (예시)
       entt::entity object = g_Registry.create();
       ObjectID _id;
       _id.materialID = data.materialID;
@@ -687,27 +674,16 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
       g_BatchManager.m_trasformList.push_back(_transform);
       g_Registry.emplace<Transform>(object, _transform);
 
-      AABB _aabb = ComputeAABB(data.vertices);  //   AABB  Լ
+      AABB _aabb = ComputeAABB(data.vertices);  // 사용자 정의 AABB 계산 함수
       g_BatchManager.m_boundingBoxList.push_back(_aabb);
       g_Registry.emplace<AABB>(object, _aabb);
 
-      std::vector<glm::vec3> AABBvertex = CreateAABBVertexBuffer(_aabb);
-      std::vector<uint32_t> AABBIndics = CreateAABBIndexBuffer();
-
-      AABBBufferList _aabbBufferList;
-      size_t temp = AABBvertex.size() * sizeof(glm::vec3);
-      g_ResourceManager.CreateVertexBuffer(AABBvertex.size() * sizeof(glm::vec3), &_aabbBufferList.vertexBufferMemory,
-                                           &_aabbBufferList.vertexBuffer, AABBvertex.data());
-      g_ResourceManager.CreateIndexBuffer(AABBIndics.size() * sizeof(uint32_t), &_aabbBufferList.indexBufferMemory,
-                                          &_aabbBufferList.indexBuffer, AABBIndics.data());
-      g_BatchManager.m_boundingBoxBufferList.push_back(_aabbBufferList);
-
-      // outMeshes  Mesh  ߰
+      // outMeshes에 생성한 Mesh 데이터 추가
       outMeshes.push_back(std::move(data));
     }
   }
 
-  // glTF materials  ؽó  ε (baseColorTexture εϴ )
+  // glTF의 materials에 대해 텍스처 등 로딩 (baseColorTexture만 로딩하는 예제)
   for (size_t i = 0; i < model.materials.size(); ++i) {
     const tinygltf::Material& mat = model.materials[i];
 
@@ -726,9 +702,15 @@ static bool loadSeqGltfModel(VkDevice device, const std::string& filepath, const
 
           GpuImage _image;
 
-          g_ResourceManager.CreateTexture(texturePath, &_image.memory, &_image.image, &_image.size);
-          VkUtils::CreateImageView(device, _image.image, &_image.imageView, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+          VkFormat format;
+          g_ResourceManager.CreateTexture(texturePath, TextureCooker::TextureSlot::BaseColor, &_image.memory, &_image.image,
+                                          &_image.size, &format);
+          VkUtils::CreateImageView(device, _image.image, &_image.imageView, format, VK_IMAGE_ASPECT_COLOR_BIT, 0,
+                                   VK_REMAINING_MIP_LEVELS);
 
+          MaterialTexture materialTexture;
+          materialTexture.textureIndex = static_cast<int>(g_BatchManager.m_diffuseImages.size());
+          g_BatchManager.m_materialTextures.push_back(materialTexture);
           g_BatchManager.m_diffuseImages.push_back(_image);
         }
       }
@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+/*
+ * ParallelFor / ParallelReduce on top of g_ThreadPool (JobSystem)
+ *  - [begin, end) is split into chunks of 'grain' items. grain == 0 picks a size automatically (about 4 chunks per thread).
+ *  - Chunks are handed out through an atomic cursor, so one job per thread is scheduled, not one per chunk.
+ *  - The calling thread also takes chunks, and a single chunk runs inline without touching the job system.
+ */
+
+static size_t ComputeParallelGrain(size_t count, size_t grain) {
+  if (grain > 0) return grain;
+  size_t threads = (std::max)(size_t(g_JobSystem.GetThreadCount()), size_t(1));
+  return (std::max)((count + threads * 4 - 1) / (threads * 4), size_t(1));
+}
+
+// fn(rangeBegin, rangeEnd) is called once per chunk
+template <typename F>
+void ParallelForRange(size_t begin, size_t end, size_t grain, F&& fn) {
+  if (begin >= end) return;
+
+  const size_t count = end - begin;
+  grain = ComputeParallelGrain(count, grain);
+  const size_t chunkCount = (count + grain - 1) / grain;
+
+  if (chunkCount == 1 || !g_JobSystem.IsRunning()) {
+    fn(begin, end);
+    return;
+  }
+
+  std::atomic<size_t> nextChunk = 0;
+  auto runChunks = [&]() {
+    for (size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount;
+         chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+      size_t chunkBegin = begin + chunk * grain;
+      fn(chunkBegin, (std::min)(chunkBegin + grain, end));
+    }
+  };
+
+  JobCounter counter;
+  size_t helpers = (std::min)(chunkCount - 1, size_t(g_JobSystem.GetWorkerCount()));
+  for (size_t i = 0; i < helpers; ++i) {
+    g_JobSystem.Schedule(&counter, [&runChunks]() { runChunks(); });
+  }
+
+  runChunks();
+  g_JobSystem.Wait(counter);
+}
+
+// fn(index) is called once per item
+template <typename F>
+void ParallelFor(size_t begin, size_t end, size_t grain, F&& fn) {
+  ParallelForRange(begin, end, grain, [&fn](size_t rangeBegin, size_t rangeEnd) {
+    for (size_t i = rangeBegin; i < rangeEnd; ++i) fn(i);
+  });
+}
+
+/*
+ * rangeFn(rangeBegin, rangeEnd, identity) -> T : partial result of one chunk
+ * reduceFn(T, T) -> T : combine, applied in chunk order so the result does not depend on scheduling
+ */
+template <typename T, typename RangeFn, typename ReduceFn>
+T ParallelReduce(size_t begin, size_t end, size_t grain, T identity, RangeFn&& rangeFn, ReduceFn&& reduceFn) {
+  if (begin >= end) return identity;
+
+  const size_t count = end - begin;
+  grain = ComputeParallelGrain(count, grain);
+  const size_t chunkCount = (count + grain - 1) / grain;
+
+  if (chunkCount == 1 || !g_JobSystem.IsRunning()) {
+    return rangeFn(begin, end, identity);
+  }
+
+  std::vector<T> partials(chunkCount, identity);
+  ParallelForRange(0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+    for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+      size_t rangeBegin = begin + chunk * grain;
+      partials[chunk] = rangeFn(rangeBegin, (std::min)(rangeBegin + grain, end), identity);
+    }
+  });
+
+  T result = identity;
+  for (const T& partial : partials) result = reduceFn(result, partial);
+  return result;
+}
@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.h"
+
+/*
+ * TaskGraph : per-frame dependency graph on top of the JobSystem
+ *  - Tasks declare the resources they read and write (by name). Edges are derived in insertion order:
+ *    read-after-write, write-after-write and write-after-read, so the graph behaves like the serial order it replaces.
+ *  - Independent tasks run on worker threads, MainThread tasks run on the thread that calls Execute().
+ *  - Every Execute() records per-task timings and the critical path (longest chain of measured durations).
+ */
+
+enum class TaskAffinity {
+  Any,
+  MainThread,
+};
+
+struct CriticalPathEntry {
+  uint32_t task = 0;
+  double durationMs = 0.0;
+};
+
+struct TaskTiming {
+  double startMs = 0.0;  // relative to the beginning of Execute()
+  double endMs = 0.0;
+  uint32_t threadIndex = 0;
+};
+
+class TaskGraph {
+ public:
+  using TaskFn = std::function<void()>;
+
+  TaskGraph() = default;
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+
+  uint32_t AddTask(const std::string& name, std::initializer_list<std::string_view> reads, std::initializer_list<std::string_view> writes,
+                   TaskFn fn, TaskAffinity affinity = TaskAffinity::Any) {
+    uint32_t index = static_cast<uint32_t>(m_tasks.size());
+
+    Task task;
+    task.name = name;
+    task.fn = std::move(fn);
+    task.affinity = affinity;
+
+    auto addDependency = [&task](uint32_t dependency) {
+      if (std::find(task.dependencies.begin(), task.dependencies.end(), dependency) == task.dependencies.end()) {
+        task.dependencies.push_back(dependency);
+      }
+    };
+
+    for (std::string_view read : reads) {
+      ResourceState& resource = m_resources[std::string(read)];
+      if (resource.lastWriter != INVALID_TASK) addDependency(resource.lastWriter);
+      resource.readers.push_back(index);
+    }
+    for (std::string_view write : writes) {
+      ResourceState& resource = m_resources[std::string(write)];
+      if (resource.lastWriter != INVALID_TASK && resource.lastWriter != index) addDependency(resource.lastWriter);
+      for (uint32_t reader : resource.readers) {
+        if (reader != index) addDependency(reader);
+      }
+      resource.readers.clear();
+      resource.lastWriter = index;
+    }
+
+    for (uint32_t dependency : task.dependencies) {
+      m_tasks[dependency].successors.push_back(index);
+    }
+
+    m_tasks.push_back(std::move(task));
+    m_remaining = std::vector<std::atomic<uint32_t>>(m_tasks.size());
+    m_timings.resize(m_tasks.size());
+    return index;
+  }
+
+  // Must be called from a JobSystem thread (the main thread)
+  void Execute() {
+    const uint32_t taskCount = static_cast<uint32_t>(m_tasks.size());
+    if (taskCount == 0) return;
+
+    m_frameBegin = Clock::now();
+    m_completed.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < taskCount; ++i) {
+      m_remaining[i].store(static_cast<uint32_t>(m_tasks[i].dependencies.size()), std::memory_order_relaxed);
+    }
+
+    for (uint32_t i = 0; i < taskCount; ++i) {
+      if (m_tasks[i].dependencies.empty()) Dispatch(i);
+    }
+
+    const uint32_t threadIndex = g_JobSystem.GetCurrentThreadIndex();
+    while (m_completed.load(std::memory_order_acquire) < taskCount) {
+      uint32_t mainTask = PopMainThreadTask();
+      if (mainTask != INVALID_TASK) {
+        Run(mainTask);
+      } else if (!g_JobSystem.RunOne(threadIndex)) {
+        std::this_thread::yield();
+      }
+    }
+
+    m_frameTimeMs = ElapsedMs(Clock::now());
+    UpdateCriticalPath();
+  }
+
+  uint32_t GetTaskCount() const { return static_cast<uint32_t>(m_tasks.size()); }
+  const std::string& GetTaskName(uint32_t index) const { return m_tasks[index].name; }
+  const TaskTiming& GetTaskTiming(uint32_t index) const { return m_timings[index]; }
+
+  // Longest dependency chain of the last Execute(), copied out so it can be read while the next frame runs
+  const std::vector<CriticalPathEntry>& GetCriticalPath() const { return m_criticalPath; }
+  double GetCriticalPathMs() const { return m_criticalPathMs; }
+  double GetFrameTimeMs() const { return m_frameTimeMs; }
+
+ private:
+  using Clock = std::chrono::high_resolution_clock;
+  static constexpr uint32_t INVALID_TASK = UINT32_MAX;
+
+  struct Task {
+    std::string name;
+    TaskFn fn;
+    TaskAffinity affinity = TaskAffinity::Any;
+    std::vector<uint32_t> dependencies;
+    std::vector<uint32_t> successors;
+  };
+
+  struct ResourceState {
+    uint32_t lastWriter = INVALID_TASK;
+    std::vector<uint32_t> readers;  // since the last write
+  };
+
+  std::vector<Task> m_tasks;
+  std::unordered_map<std::string, ResourceState> m_resources;
+
+  std::vector<std::atomic<uint32_t>> m_remaining;
+  std::atomic<uint32_t> m_completed = 0;
+
+  std::mutex m_mainThreadMutex;
+  std::vector<uint32_t> m_mainThreadQueue;
+
+  Clock::time_point m_frameBegin;
+  std::vector<TaskTiming> m_timings;
+  std::vector<CriticalPathEntry> m_criticalPath;
+  double m_criticalPathMs = 0.0;
+  double m_frameTimeMs = 0.0;
+
+  double ElapsedMs(Clock::time_point time) const { return std::chrono::duration<double, std::milli>(time - m_frameBegin).count(); }
+
+  void Dispatch(uint32_t index) {
+    if (m_tasks[index].affinity == TaskAffinity::MainThread) {
+      std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+      m_mainThreadQueue.push_back(index);
+    } else {
+      g_JobSystem.Schedule(nullptr, [this, index]() { Run(index); });
+    }
+  }
+
+  uint32_t PopMainThreadTask() {
+    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+    if (m_mainThreadQueue.empty()) return INVALID_TASK;
+    uint32_t index = m_mainThreadQueue.front();
+    m_mainThreadQueue.erase(m_mainThreadQueue.begin());
+    return index;
+  }
+
+  void Run(uint32_t index) {
+    TaskTiming& timing = m_timings[index];
+    timing.threadIndex = g_JobSystem.GetCurrentThreadIndex();
+    timing.startMs = ElapsedMs(Clock::now());
+    m_tasks[index].fn();
+    timing.endMs = ElapsedMs(Clock::now());
+
+    for (uint32_t successor : m_tasks[index].successors) {
+      if (m_remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) Dispatch(successor);
+    }
+    m_completed.fetch_add(1, std::memory_order_release);
+  }
+
+  // Dependencies always point to earlier tasks, so insertion order is a topological order
+  void UpdateCriticalPath() {
+    const uint32_t taskCount = static_cast<uint32_t>(m_tasks.size());
+    std::vector<double> finish(taskCount, 0.0);
+    std::vector<uint32_t> parent(taskCount, INVALID_TASK);
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < taskCount; ++i) {
+      double start = 0.0;
+      for (uint32_t dependency : m_tasks[i].dependencies) {
+        if (finish[dependency] > start) {
+          start = finish[dependency];
+          parent[i] = dependency;
+        }
+      }
+      finish[i] = start + (m_timings[i].endMs - m_timings[i].startMs);
+      if (finish[i] > finish[last]) last = i;
+    }
+
+    m_criticalPath.clear();
+    for (uint32_t i = last; i != INVALID_TASK; i = parent[i]) {
+      m_criticalPath.push_back({i, m_timings[i].endMs - m_timings[i].startMs});
+    }
+    std::reverse(m_criticalPath.begin(), m_criticalPath.end());
+    m_criticalPathMs = finish[last];
+  }
+};
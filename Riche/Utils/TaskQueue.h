@@ -6,14 +6,14 @@
 
 class TaskQueue {
  public:
-  // ۾(push)
+  // 작업(push)
   void Push(std::function<void()> task) {
     std::lock_guard<std::mutex> lock(mutex_);
     queue_.push(std::move(task));
   }
 
-  // ۾(pop) - ϸ true, ϸ false
-  // (queue  false)
+  // 작업(pop) - 성공하면 true, 실패하면 false
+  // (queue가 비었으면 false)
   bool TryPop(std::function<void()>& outTask) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (queue_.empty()) return false;
@@ -23,7 +23,7 @@ class TaskQueue {
     return true;
   }
 
-  // queue  Ȯ
+  // queue가 비었는지 확인
   bool Empty() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return queue_.empty();
@@ -31,5 +31,5 @@ class TaskQueue {
 
  private:
   std::queue<std::function<void()>> queue_;
-  mutable std::mutex mutex_;  // mutable -> Empty() lock
+  mutable std::mutex mutex_;  // mutable -> Empty()도 lock
 };
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "Parallel.h"
+
+/*
+ * TextureCooker : offline BCn cook of the source images, cached next to them as <source>.rtex
+ *  - The format follows the material slot the caller passes : BC7 base colour, BC5 normal maps, BC1 masks. The batch cook
+ *    has no material to ask and falls back to GuessTextureSlot (file name), a load for another slot recooks the .rtex.
+ *  - The full mip chain (2x2 box filter) is cooked in, ResourceManager::CreateTexture uploads the blocks as they are.
+ *  - .rtex follows the KTX2 layout (identifier, header, level index, level data) without the data format descriptor.
+ *  - The header keeps the size, write time and a hash of the source bytes (+ format and cooker version). An unchanged size
+ *    and write time is trusted as is, only a changed one reads and hashes the source (e.g. a fresh checkout of the same file).
+ *    The cooker skips unchanged sources, CreateTexture ignores a stale .rtex and decodes the source instead.
+ *  - Batch cook : Riche.exe --cook <directory> [--force]
+ */
+
+namespace TextureCooker {
+
+static constexpr char COOKED_EXTENSION[] = ".rtex";
+static constexpr uint32_t COOKER_VERSION = 2;
+static constexpr uint8_t IDENTIFIER[12] = {0xAB, 'R', 'T', 'E', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A};
+
+enum class TextureSlot { BaseColor, Normal, Mask };
+
+struct FileHeader {
+  uint8_t identifier[12];
+  uint32_t vkFormat;
+  uint32_t blockSize;  // bytes per 4x4 block
+  uint32_t pixelWidth;
+  uint32_t pixelHeight;
+  uint32_t levelCount;
+  uint32_t cookerVersion;
+  uint32_t pad;
+  uint64_t sourceHash;
+  uint64_t sourceSize;
+  int64_t sourceWriteTime;  // std::filesystem::file_time_type ticks
+};
+
+struct LevelIndex {
+  uint64_t byteOffset;  // from the start of the level data
+  uint64_t byteLength;
+};
+
+struct CookedTexture {
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t blockSize = 0;
+  std::vector<LevelIndex> levels;  // mip 0 first
+  std::vector<uint8_t> data;
+};
+
+struct CookStats {
+  uint32_t cookedCount = 0;
+  uint32_t upToDateCount = 0;
+  uint32_t failedCount = 0;
+  uint64_t rgbaBytes = 0;  // what the same textures take as RGBA8 with mips
+  uint64_t cookedBytes = 0;
+  float timeMs = 0.0f;
+};
+
+// Fallback for callers without a material (the batch cook)
+static TextureSlot GuessTextureSlot(const std::string& path) {
+  std::string name = std::filesystem::path(path).stem().string();
+  std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  auto hasSuffix = [&name](const char* suffix) {
+    size_t length = strlen(suffix);
+    return name.size() >= length && name.compare(name.size() - length, length, suffix) == 0;
+  };
+  if (name.find("normal") != std::string::npos || hasSuffix("_ddn") || hasSuffix("_nrm") || hasSuffix("_n")) {
+    return TextureSlot::Normal;
+  }
+  if (name.find("mask") != std::string::npos || hasSuffix("_spec") || hasSuffix("_bump") || hasSuffix("_rough") ||
+      hasSuffix("_metal") || hasSuffix("_ao")) {
+    return TextureSlot::Mask;
+  }
+  return TextureSlot::BaseColor;
+}
+
+static VkFormat GetSlotFormat(TextureSlot slot) {
+  switch (slot) {
+    case TextureSlot::Normal:
+      return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureSlot::Mask:
+      return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    default:
+      return VK_FORMAT_BC7_UNORM_BLOCK;
+  }
+}
+
+static uint32_t GetBlockSize(VkFormat format) { return format == VK_FORMAT_BC1_RGB_UNORM_BLOCK ? 8 : 16; }
+
+static std::string GetCookedPath(const std::string& sourcePath) { return sourcePath + COOKED_EXTENSION; }
+
+// FNV-1a
+static uint64_t HashBytes(const uint8_t* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static uint64_t ComputeSourceHash(const std::vector<uint8_t>& source, VkFormat format) {
+  const uint32_t key[2] = {static_cast<uint32_t>(format), COOKER_VERSION};
+  return HashBytes(reinterpret_cast<const uint8_t*>(key), sizeof(key), HashBytes(source.data(), source.size()));
+}
+
+struct SourceStamp {
+  uint64_t size = 0;
+  int64_t writeTime = 0;
+};
+
+static bool GetSourceStamp(const std::string& path, SourceStamp& out) {
+  std::error_code error;
+  out.size = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+  if (error) return false;
+  out.writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+  return !error;
+}
+
+static bool ReadFileBytes(const std::string& path, std::vector<uint8_t>& out) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  out.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), out.size()));
+}
+
+static bool ReadHeader(std::ifstream& file, FileHeader& header) {
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+  return memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) == 0 && header.cookerVersion == COOKER_VERSION &&
+         header.levelCount > 0 && header.levelCount <= 16;
+}
+
+// The .rtex behind header was cooked from this source in this format : same size and write time, or else the same bytes
+static bool IsCookedUpToDate(const FileHeader& header, const std::string& sourcePath, const SourceStamp& stamp, VkFormat format) {
+  if (header.vkFormat != static_cast<uint32_t>(format)) return false;
+  if (header.sourceSize == stamp.size && header.sourceWriteTime == stamp.writeTime) return true;
+
+  std::vector<uint8_t> source;
+  return ReadFileBytes(sourcePath, source) && ComputeSourceHash(source, format) == header.sourceHash;
+}
+
+// 2x2 box filter, an odd edge repeats its last texel
+static std::vector<uint8_t> DownsampleRgba8(const std::vector<uint8_t>& src, uint32_t width, uint32_t height) {
+  const uint32_t dstWidth = (std::max)(width / 2, 1u);
+  const uint32_t dstHeight = (std::max)(height / 2, 1u);
+  std::vector<uint8_t> dst(size_t(dstWidth) * dstHeight * 4);
+
+  for (uint32_t y = 0; y < dstHeight; ++y) {
+    const uint32_t y0 = (std::min)(y * 2, height - 1), y1 = (std::min)(y * 2 + 1, height - 1);
+    for (uint32_t x = 0; x < dstWidth; ++x) {
+      const uint32_t x0 = (std::min)(x * 2, width - 1), x1 = (std::min)(x * 2 + 1, width - 1);
+      for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t sum = src[(size_t(y0) * width + x0) * 4 + c] + src[(size_t(y0) * width + x1) * 4 + c] +
+                       src[(size_t(y1) * width + x0) * 4 + c] + src[(size_t(y1) * width + x1) * 4 + c];
+        dst[(size_t(y) * dstWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+  return dst;
+}
+
+// One mip level into blocks, rows of blocks are spread over the job system
+static std::vector<uint8_t> EncodeLevel(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, VkFormat format) {
+  using namespace BlockCompression;
+  const uint32_t blocksX = (width + BLOCK_DIM - 1) / BLOCK_DIM;
+  const uint32_t blocksY = (height + BLOCK_DIM - 1) / BLOCK_DIM;
+  const uint32_t blockSize = GetBlockSize(format);
+  std::vector<uint8_t> blocks(size_t(blocksX) * blocksY * blockSize);
+
+  ParallelForRange(0, blocksY, 4, [&](size_t rowBegin, size_t rowEnd) {
+    uint8_t texels[BLOCK_TEXELS * 4];
+    for (size_t by = rowBegin; by < rowEnd; ++by) {
+      for (uint32_t bx = 0; bx < blocksX; ++bx) {
+        for (uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+          uint32_t x = (std::min)(bx * BLOCK_DIM + i % BLOCK_DIM, width - 1);
+          uint32_t y = (std::min)(static_cast<uint32_t>(by) * BLOCK_DIM + i / BLOCK_DIM, height - 1);
+          memcpy(&texels[i * 4], &rgba[(size_t(y) * width + x) * 4], 4);
+        }
+
+        uint8_t* out = &blocks[(by * blocksX + bx) * blockSize];
+        if (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK) {
+          EncodeBC1Block(texels, out);
+        } else if (format == VK_FORMAT_BC5_UNORM_BLOCK) {
+          EncodeBC5Block(texels, out);
+        } else {
+          EncodeBC7Block(texels, out);
+        }
+      }
+    }
+  });
+  return blocks;
+}
+
+enum class CookResult { Cooked, UpToDate, Failed };
+
+static CookResult CookTexture(const std::string& sourcePath, TextureSlot slot, bool isForced, CookStats& stats) {
+  const VkFormat format = GetSlotFormat(slot);
+  const std::string cookedPath = GetCookedPath(sourcePath);
+  SourceStamp stamp;
+  if (!GetSourceStamp(sourcePath, stamp)) return CookResult::Failed;
+
+  if (!isForced) {
+    std::ifstream cookedFile(cookedPath, std::ios::binary);
+    FileHeader header;
+    if (cookedFile && ReadHeader(cookedFile, header) && IsCookedUpToDate(header, sourcePath, stamp, format)) {
+      return CookResult::UpToDate;
+    }
+  }
+
+  std::vector<uint8_t> source;
+  if (!ReadFileBytes(sourcePath, source)) return CookResult::Failed;
+
+  int width, height, channels;
+  stbi_uc* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()), &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels) return CookResult::Failed;
+
+  std::vector<uint8_t> rgba(pixels, pixels + size_t(width) * height * 4);
+  stbi_image_free(pixels);
+
+  FileHeader header = {};
+  memcpy(header.identifier, IDENTIFIER, sizeof(IDENTIFIER));
+  header.vkFormat = static_cast<uint32_t>(format);
+  header.blockSize = GetBlockSize(format);
+  header.pixelWidth = static_cast<uint32_t>(width);
+  header.pixelHeight = static_cast<uint32_t>(height);
+  header.cookerVersion = COOKER_VERSION;
+  header.sourceHash = ComputeSourceHash(source, format);
+  header.sourceSize = stamp.size;
+  header.sourceWriteTime = stamp.writeTime;
+
+  std::vector<LevelIndex> levels;
+  std::vector<uint8_t> levelData;
+  uint32_t levelWidth = header.pixelWidth, levelHeight = header.pixelHeight;
+  while (true) {
+    std::vector<uint8_t> blocks = EncodeLevel(rgba, levelWidth, levelHeight, format);
+    levels.push_back({levelData.size(), blocks.size()});
+    levelData.insert(levelData.end(), blocks.begin(), blocks.end());
+    stats.rgbaBytes += rgba.size();
+
+    if (levelWidth == 1 && levelHeight == 1) break;
+    rgba = DownsampleRgba8(rgba, levelWidth, levelHeight);
+    levelWidth = (std::max)(levelWidth / 2, 1u);
+    levelHeight = (std::max)(levelHeight / 2, 1u);
+  }
+  header.levelCount = static_cast<uint32_t>(levels.size());
+
+  std::ofstream cookedFile(cookedPath, std::ios::binary | std::ios::trunc);
+  cookedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  cookedFile.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(LevelIndex));
+  cookedFile.write(reinterpret_cast<const char*>(levelData.data()), levelData.size());
+  if (!cookedFile) return CookResult::Failed;
+
+  stats.cookedBytes += levelData.size();
+  return CookResult::Cooked;
+}
+
+// The cooked blocks of sourcePath, false when there is no .rtex, it was cooked for another slot or the source changed since
+static bool LoadCookedTexture(const std::string& sourcePath, TextureSlot slot, CookedTexture& out) {
+  std::ifstream cookedFile(GetCookedPath(sourcePath), std::ios::binary);
+  FileHeader header;
+  if (!cookedFile || !ReadHeader(cookedFile, header)) return false;
+
+  // A source that is gone leaves the .rtex as the only copy, it is used as it is
+  SourceStamp stamp;
+  if (GetSourceStamp(sourcePath, stamp) && !IsCookedUpToDate(header, sourcePath, stamp, GetSlotFormat(slot))) return false;
+
+  out.format = static_cast<VkFormat>(header.vkFormat);
+  out.width = header.pixelWidth;
+  out.height = header.pixelHeight;
+  out.blockSize = header.blockSize;
+  out.levels.resize(header.levelCount);
+  if (!cookedFile.read(reinterpret_cast<char*>(out.levels.data()), out.levels.size() * sizeof(LevelIndex))) return false;
+
+  const LevelIndex& lastLevel = out.levels.back();
+  out.data.resize(static_cast<size_t>(lastLevel.byteOffset + lastLevel.byteLength));
+  return static_cast<bool>(cookedFile.read(reinterpret_cast<char*>(out.data.data()), out.data.size()));
+}
+
+static bool IsCookableSource(const std::filesystem::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+}
+
+// Every image under directory (recursive), returns the stats of the run
+static CookStats CookDirectory(const std::string& directory, bool isForced) {
+  CookStats stats;
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+    if (!entry.is_regular_file() || !IsCookableSource(entry.path())) continue;
+
+    const std::string sourcePath = entry.path().string();
+    switch (CookTexture(sourcePath, GuessTextureSlot(sourcePath), isForced, stats)) {
+      case CookResult::Cooked:
+        ++stats.cookedCount;
+        std::cout << "[Cooker] " << sourcePath << std::endl;
+        break;
+      case CookResult::UpToDate:
+        ++stats.upToDateCount;
+        break;
+      case CookResult::Failed:
+        ++stats.failedCount;
+        std::cerr << "[Cooker] Failed : " << sourcePath << std::endl;
+        break;
+    }
+  }
+
+  stats.timeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+  std::cout << "[Cooker] " << directory << " : " << stats.cookedCount << " cooked, " << stats.upToDateCount << " up to date, "
+            << stats.failedCount << " failed, " << stats.cookedBytes / 1024 << " KB blocks for " << stats.rgbaBytes / 1024
+            << " KB RGBA8, " << stats.timeMs << " ms" << std::endl;
+  return stats;
+}
+
+}  // namespace TextureCooker
@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+/*
+ * TexturePacker : import-time atlas pages for the small textures of a scene (OBJ scenes bring hundreds of them)
+ *  - Power of two RGBA8 textures up to MAX_TILE_SIZE share PAGE_SIZE wide pages : one image, view, allocation and
+ *    u_DiffuseTextureList element per page instead of per texture.
+ *  - Shelves of one tile height, the tallest first and the widest first inside a shelf. Every tile starts at a multiple of its
+ *    own size, so mip n of the page holds mip n of the tile untouched down to its smaller side (GetMaxLod).
+ *  - LightingPS wraps the UVs inside the tile and maps them with ObjectID::uvTransform, the page itself is an ordinary texture.
+ */
+
+namespace TexturePacker {
+
+static constexpr uint32_t PAGE_SIZE = 1024;
+static constexpr uint32_t MAX_TILE_SIZE = 256;
+
+struct Tile {
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+struct Placement {
+  uint32_t page = 0;
+  uint32_t x = 0;  // texels, top left of the tile
+  uint32_t y = 0;
+};
+
+struct Page {
+  uint32_t width = PAGE_SIZE;
+  uint32_t height = 0;  // the last page stops at its last shelf (power of two)
+};
+
+static bool IsPowerOfTwo(uint32_t value) { return value != 0 && (value & (value - 1)) == 0; }
+
+static uint32_t NextPowerOfTwo(uint32_t value) {
+  uint32_t result = 1;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+static bool IsPackable(uint32_t width, uint32_t height) {
+  return IsPowerOfTwo(width) && IsPowerOfTwo(height) && (std::max)(width, height) <= MAX_TILE_SIZE;
+}
+
+// Coarser page mips average the tile with its neighbours
+static float GetMaxLod(const Tile& tile) { return std::log2(static_cast<float>((std::min)(tile.width, tile.height))); }
+
+// Placements follow the order of tiles, every tile must be IsPackable
+static std::vector<Placement> Pack(const std::vector<Tile>& tiles, std::vector<Page>& outPages) {
+  std::vector<uint32_t> order(tiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&tiles](uint32_t a, uint32_t b) {
+    if (tiles[a].height != tiles[b].height) return tiles[a].height > tiles[b].height;
+    return tiles[a].width > tiles[b].width;
+  });
+
+  std::vector<Placement> placements(tiles.size());
+  outPages.clear();
+  uint32_t x = PAGE_SIZE;
+  uint32_t shelfY = 0;
+  uint32_t shelfHeight = 0;
+  for (uint32_t index : order) {
+    const Tile& tile = tiles[index];
+    if (tile.height != shelfHeight || x + tile.width > PAGE_SIZE) {
+      // Next shelf, or a new page once the shelves reach the bottom
+      shelfY += shelfHeight;
+      if (outPages.empty() || shelfY + tile.height > PAGE_SIZE) {
+        outPages.push_back({});
+        shelfY = 0;
+      }
+      shelfHeight = tile.height;
+      x = 0;
+    }
+
+    placements[index] = {static_cast<uint32_t>(outPages.size() - 1), x, shelfY};
+    x += tile.width;
+    outPages.back().height = (std::max)(outPages.back().height, NextPowerOfTwo(shelfY + tile.height));
+  }
+  return placements;
+}
+
+static void CopyTile(uint8_t* pageRgba, const Page& page, const Placement& placement, const uint8_t* tileRgba, const Tile& tile) {
+  for (uint32_t row = 0; row < tile.height; ++row) {
+    memcpy(pageRgba + (static_cast<size_t>(placement.y + row) * page.width + placement.x) * 4,
+           tileRgba + static_cast<size_t>(row) * tile.width * 4, static_cast<size_t>(tile.width) * 4);
+  }
+}
+
+// xy scale, zw offset : tile UVs [0, 1] to page UVs
+static glm::vec4 GetUvTransform(const Page& page, const Placement& placement, const Tile& tile) {
+  const glm::vec2 pageSize(static_cast<float>(page.width), static_cast<float>(page.height));
+  return glm::vec4(glm::vec2(static_cast<float>(tile.width), static_cast<float>(tile.height)) / pageSize,
+                   glm::vec2(static_cast<float>(placement.x), static_cast<float>(placement.y)) / pageSize);
+}
+
+}  // namespace TexturePacker
@@ -1,36 +1,29 @@
 #pragma once
-#include <future>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 
-#include "TaskQueue.h"
+#include "JobSystem.h"
 #include "Singleton.h"
 
+/*
+ * ThreadPool : Submit() facade over the work-stealing JobSystem.
+ * Submit returns a JobHandle (get / wait / wait_for / valid like std::future).
+ * Hot loops should use g_JobSystem.Schedule with a JobCounter instead, which never allocates.
+ */
 class ThreadPool : public Singleton<ThreadPool> {
   friend class Singleton<ThreadPool>;
 
  public:
   void Initialize(uint32_t pool_size = std::thread::hardware_concurrency() - 1) {
-    done = false;
-    static const uint32_t max_threads = std::thread::hardware_concurrency();
-    uint16_t const num_threads = pool_size == 0 ? max_threads - 1 : (std::min)(max_threads - 1, pool_size);
-
-    threads.reserve(num_threads);
-    for (uint16_t i = 0; i < num_threads; ++i) {
-      threads.emplace_back(std::bind(&ThreadPool::ThreadWork, this));
-    }
+    static const uint32_t max_threads = (std::max)(std::thread::hardware_concurrency(), 2u);
+    uint32_t const num_threads = pool_size == 0 ? max_threads - 1 : (std::min)(max_threads - 1, pool_size);
+    g_JobSystem.Initialize(num_threads);
   }
 
-  void Destroy() {
-    if (done) return;
-    {
-      std::unique_lock<std::mutex> lk(cond_mutex);
-      done = true;
-      cond_var.notify_all();
-    }
-    for (uint16_t i = 0; i < threads.size(); ++i)
-      if (threads[i].joinable()) threads[i].join();
-  }
+  void Destroy() { g_JobSystem.Destroy(); }
+
+  uint32_t Size() const { return g_JobSystem.GetWorkerCount(); }
 
   ThreadPool(ThreadPool const&) = delete;
   ThreadPool(ThreadPool&&) = delete;
@@ -41,45 +34,29 @@ class ThreadPool : public Singleton<ThreadPool> {
   template <typename F, typename... Args>
   auto Submit(F&& f, Args&&... args) {
     using ReturnType = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
-    auto bind_f = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-    auto wrapped_task = std::make_shared<std::packaged_task<ReturnType()>>(bind_f);
-    std::future<ReturnType> result_future = wrapped_task->get_future();
-    auto void_task = [wrapped_task]() { (*wrapped_task)(); };
-    task_queue.Push(std::move(void_task));
-    cond_var.notify_one();
-    return result_future;
+    using State = typename JobHandle<ReturnType>::State;
+
+    // One allocation for the shared result, the callable itself lives inside the job
+    State* state = new State();
+    g_JobSystem.Schedule(nullptr, [state, fn = std::forward<F>(f), params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+      try {
+        if constexpr (std::is_void_v<ReturnType>) {
+          std::apply(fn, std::move(params));
+          state->value.emplace();
+        } else {
+          state->value.emplace(std::apply(fn, std::move(params)));
+        }
+      } catch (...) {
+        state->error = std::current_exception();
+      }
+      state->counter.Done();
+      state->Release();
+    });
+    return JobHandle<ReturnType>(state);
   }
 
- private:
-  std::vector<std::thread> threads;
-  TaskQueue task_queue;
-  bool done = false;
-  std::condition_variable cond_var;
-  std::mutex cond_mutex;
-
  private:
   ThreadPool() = default;
-
-  void ThreadWork() {
-    std::function<void()> task;
-    bool pop_success;
-
-    while (true) {
-      {
-        std::unique_lock<std::mutex> lk(cond_mutex);
-        while (!done && task_queue.Empty()) cond_var.wait(lk);
-        if (done)
-          return;
-        else
-          pop_success = task_queue.TryPop(task);
-      }
-
-      if (pop_success) {
-        task();
-        task = nullptr;
-      }
-    }
-  }
 };
 
-#define g_ThreadPool ThreadPool::Get()
\ No newline at end of file
+#define g_ThreadPool ThreadPool::Get()
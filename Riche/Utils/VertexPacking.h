@@ -0,0 +1,69 @@
+#pragma once
+#include <glm/gtc/packing.hpp>
+
+#include "BoundingBox.h"
+#include "Rendering/Mesh.h"
+
+/*
+ * VertexPacking : BasicVertex (32 bytes) -> PackedVertex (16 bytes), see VertexFormat::Packed
+ *  - Position : snorm16 over the mesh AABB, Mesh::vertexDecode = translate(center) * scale(halfExtent).
+ *    The same 3x4 is the BLAS transformData and the VS decode (BATCH_ALL binding 4), so both agree bit for bit.
+ *  - Normal   : octahedral snorm16 x 2
+ *  - Texcoord : half float x 2
+ */
+
+static int16_t PackSnorm16(float value) { return static_cast<int16_t>(std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f)); }
+
+static glm::vec2 EncodeOctahedral(glm::vec3 normal) {
+  float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (length == 0.0f) return glm::vec2(0.0f, 0.0f);
+  normal /= length;
+
+  glm::vec2 encoded(normal.x, normal.y);
+  if (normal.z < 0.0f) {
+    // Lower hemisphere folds over the diagonals
+    encoded = (1.0f - glm::abs(glm::vec2(normal.y, normal.x))) *
+              glm::vec2(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+  }
+  return encoded;
+}
+
+static glm::vec3 DecodeOctahedral(glm::vec2 encoded) {
+  glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+  float t = glm::max(-normal.z, 0.0f);
+  normal.x += normal.x >= 0.0f ? -t : t;
+  normal.y += normal.y >= 0.0f ? -t : t;
+  return glm::normalize(normal);
+}
+
+// Fills mesh.packed_vertices and mesh.vertexDecode from mesh.vertices
+static void PackMeshVertices(Mesh& mesh) {
+  mesh.packed_vertices.clear();
+  if (mesh.vertices.empty()) return;
+
+  AABB aabb = ComputeAABB(mesh.vertices);
+  glm::vec3 center = (glm::vec3(aabb.min) + glm::vec3(aabb.max)) * 0.5f;
+  glm::vec3 halfExtent = (glm::vec3(aabb.max) - glm::vec3(aabb.min)) * 0.5f;
+  halfExtent = glm::max(halfExtent, glm::vec3(std::numeric_limits<float>::min()));  // flat meshes
+
+  mesh.vertexDecode = {{{halfExtent.x, 0.0f, 0.0f, center.x}, {0.0f, halfExtent.y, 0.0f, center.y}, {0.0f, 0.0f, halfExtent.z, center.z}}};
+
+  mesh.packed_vertices.resize(mesh.vertices.size());
+  for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+    const BasicVertex& vertex = mesh.vertices[i];
+    PackedVertex& packed = mesh.packed_vertices[i];
+
+    glm::vec3 position = (vertex.pos - center) / halfExtent;
+    packed.pos[0] = PackSnorm16(position.x);
+    packed.pos[1] = PackSnorm16(position.y);
+    packed.pos[2] = PackSnorm16(position.z);
+    packed.pos[3] = 0;
+
+    glm::vec2 normal = EncodeOctahedral(vertex.normal);
+    packed.normal[0] = PackSnorm16(normal.x);
+    packed.normal[1] = PackSnorm16(normal.y);
+
+    packed.tex[0] = glm::packHalf1x16(vertex.tex.x);
+    packed.tex[1] = glm::packHalf1x16(vertex.tex.y);
+  }
+}
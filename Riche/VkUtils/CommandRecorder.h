@@ -0,0 +1,112 @@
+#pragma once
+#include <vector>
+
+#include "Rendering/Core.h"
+#include "Utils/Parallel.h"
+
+namespace VkUtils {
+
+/*
+ * ParallelCommandRecorder : secondary command buffers recorded on g_JobSystem threads
+ *  - One VkCommandPool per (frame, job system thread). A pool is only used by the thread it belongs to, so no lock is needed.
+ *  - Reset(frame) recycles every buffer of that frame, call it once before recording the frame.
+ *  - RecordRanges() splits [0, count) into chunks, records each chunk into its own secondary buffer
+ *    and returns them in chunk order, ready for vkCmdExecuteCommands.
+ */
+class ParallelCommandRecorder {
+ public:
+  void Initialize(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount) {
+    m_pDevice = device;
+    m_threadCount = (std::max)(g_JobSystem.GetThreadCount(), 1u);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;  // Buffers are re-recorded every frame
+    poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+    m_frames.resize(frameCount);
+    for (auto& frame : m_frames) {
+      frame.resize(m_threadCount);
+      for (auto& threadPool : frame) {
+        VK_CHECK(vkCreateCommandPool(m_pDevice, &poolInfo, nullptr, &threadPool.pool));
+      }
+    }
+  }
+
+  void Cleanup() {
+    for (auto& frame : m_frames) {
+      for (auto& threadPool : frame) {
+        vkDestroyCommandPool(m_pDevice, threadPool.pool, nullptr);  // Frees its command buffers too
+      }
+    }
+    m_frames.clear();
+  }
+
+  void Reset(uint32_t frame) {
+    for (auto& threadPool : m_frames[frame]) {
+      VK_CHECK(vkResetCommandPool(m_pDevice, threadPool.pool, 0));
+      threadPool.used = 0;
+    }
+  }
+
+  // Secondary buffer from the calling thread's pool, already begun inside the render pass described by 'inheritance'
+  VkCommandBuffer BeginSecondary(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance) {
+    uint32_t threadIndex = g_JobSystem.GetCurrentThreadIndex();
+    if (threadIndex >= m_threadCount) {
+      throw std::runtime_error("Secondary command buffers must be recorded on a job system thread!");
+    }
+
+    ThreadCommandPool& threadPool = m_frames[frame][threadIndex];
+    if (threadPool.used == threadPool.buffers.size()) {
+      VkCommandBufferAllocateInfo cbAllocInfo = {};
+      cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      cbAllocInfo.commandPool = threadPool.pool;
+      cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+      cbAllocInfo.commandBufferCount = 1;
+
+      VkCommandBuffer commandBuffer;
+      VK_CHECK(vkAllocateCommandBuffers(m_pDevice, &cbAllocInfo, &commandBuffer));
+      threadPool.buffers.push_back(commandBuffer);
+    }
+    VkCommandBuffer commandBuffer = threadPool.buffers[threadPool.used++];
+
+    VkCommandBufferBeginInfo bufferBeginInfo = {};
+    bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    bufferBeginInfo.pInheritanceInfo = &inheritance;
+
+    VK_CHECK(vkBeginCommandBuffer(commandBuffer, &bufferBeginInfo));
+    return commandBuffer;
+  }
+
+  // fn(commandBuffer, rangeBegin, rangeEnd), grain == 0 picks a size automatically
+  template <typename F>
+  std::vector<VkCommandBuffer> RecordRanges(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance, size_t count,
+                                            size_t grain, F&& fn) {
+    if (count == 0) return {};
+
+    grain = ComputeParallelGrain(count, grain);
+    std::vector<VkCommandBuffer> commandBuffers((count + grain - 1) / grain, VK_NULL_HANDLE);
+
+    ParallelForRange(0, count, grain, [&](size_t rangeBegin, size_t rangeEnd) {
+      VkCommandBuffer commandBuffer = BeginSecondary(frame, inheritance);
+      fn(commandBuffer, rangeBegin, rangeEnd);
+      VK_CHECK(vkEndCommandBuffer(commandBuffer));
+      commandBuffers[rangeBegin / grain] = commandBuffer;
+    });
+    return commandBuffers;
+  }
+
+ private:
+  struct ThreadCommandPool {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> buffers;
+    uint32_t used = 0;
+  };
+
+  VkDevice m_pDevice = VK_NULL_HANDLE;
+  uint32_t m_threadCount = 0;
+  std::vector<std::vector<ThreadCommandPool>> m_frames;  // [frame][thread]
+};
+
+}  // namespace VkUtils
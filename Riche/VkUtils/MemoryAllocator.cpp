@@ -0,0 +1,407 @@
+#include "MemoryAllocator.h"
+
+namespace VkUtils {
+void MemoryAllocator::Initialize(VkDevice device, VkPhysicalDevice physicalDevice) {
+  m_pDevice = device;
+
+  VkPhysicalDeviceMemoryProperties memoryProperties;
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+  DeviceCallbacks callbacks;
+  callbacks.allocate = [this, memoryProperties](uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory* pOutMemory,
+                                                void** ppOutMappedData) {
+    // bufferDeviceAddress is enabled on the device, any block may back a buffer whose address is taken
+    VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo = {};
+    memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+    VkMemoryAllocateInfo memAllocInfo = {};
+    memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAllocInfo.pNext = &memoryAllocateFlagsInfo;
+    memAllocInfo.allocationSize = size;
+    memAllocInfo.memoryTypeIndex = memoryTypeIndex;
+    VkResult result = vkAllocateMemory(m_pDevice, &memAllocInfo, nullptr, pOutMemory);
+    if (result != VK_SUCCESS) return result;
+
+    *ppOutMappedData = nullptr;
+    if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+      result = vkMapMemory(m_pDevice, *pOutMemory, 0, VK_WHOLE_SIZE, 0, ppOutMappedData);
+    }
+    return result;
+  };
+  // Freeing mapped memory unmaps it
+  callbacks.free = [this](VkDeviceMemory memory) { vkFreeMemory(m_pDevice, memory, nullptr); };
+
+  Initialize(memoryProperties, deviceProperties.limits.bufferImageGranularity, deviceProperties.limits.maxMemoryAllocationCount,
+             callbacks);
+}
+
+void MemoryAllocator::Initialize(const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity,
+                                 uint32_t maxMemoryAllocationCount, const DeviceCallbacks& callbacks) {
+  m_memoryProperties = memoryProperties;
+  m_bufferImageGranularity = (std::max)(bufferImageGranularity, VkDeviceSize(1));
+  m_maxMemoryAllocationCount = maxMemoryAllocationCount;
+  m_callbacks = callbacks;
+
+  m_pools.clear();
+  m_pools.resize(VK_MAX_MEMORY_TYPES * 2);
+  for (uint32_t i = 0; i < m_pools.size(); ++i) {
+    m_pools[i].memoryTypeIndex = i / 2;
+    m_pools[i].isImage = i % 2 == 1;
+  }
+  m_linearPools.clear();
+  m_dedicated.clear();
+  m_bufferAllocations.clear();
+  m_imageAllocations.clear();
+  m_deviceMemoryCount = 0;
+  m_totalDeviceMemoryCount = 0;
+}
+
+uint32_t MemoryAllocator::Cleanup() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  uint32_t leakedAllocationCount = static_cast<uint32_t>(m_dedicated.size());
+
+  // Leak report, every resource should have been freed by its owner before this point
+  size_t leakCount = m_bufferAllocations.size() + m_imageAllocations.size();
+  if (leakCount > 0) {
+    std::cout << "[MemoryAllocator] " << leakCount << " resource allocation(s) leaked" << std::endl;
+    for (const auto& [handle, allocation] : m_bufferAllocations) {
+      std::cout << "  Buffer 0x" << std::hex << handle << std::dec << " : " << allocation.size << " bytes, memory type "
+                << allocation.memoryTypeIndex << (allocation.isLinear ? " (linear)" : "") << std::endl;
+    }
+    for (const auto& [handle, allocation] : m_imageAllocations) {
+      std::cout << "  Image 0x" << std::hex << handle << std::dec << " : " << allocation.size << " bytes, memory type "
+                << allocation.memoryTypeIndex << std::endl;
+    }
+  }
+  for (Pool& pool : m_pools) {
+    for (std::unique_ptr<Block>& block : pool.blocks) {
+      if (!block) continue;
+      leakedAllocationCount += block->buddy.GetAllocationCount();
+      if (!block->buddy.IsEmpty()) {
+        std::cout << "[MemoryAllocator] Block of memory type " << pool.memoryTypeIndex << " still holds "
+                  << block->buddy.GetAllocationCount() << " allocation(s), " << block->buddy.GetUsedBytes() << " bytes" << std::endl;
+      }
+      FreeDeviceMemory(block->memory);
+    }
+    pool.blocks.clear();
+  }
+  for (uint32_t i = 0; i < m_linearPools.size(); ++i) {
+    if (!m_linearPools[i].isAlive) continue;
+    std::cout << "[MemoryAllocator] Linear pool " << i << " was not destroyed" << std::endl;
+    for (LinearPoolBlock& block : m_linearPools[i].blocks) FreeDeviceMemory(block.memory);
+  }
+  m_linearPools.clear();
+  for (const auto& [memory, dedicated] : m_dedicated) {
+    std::cout << "[MemoryAllocator] Dedicated allocation of " << dedicated.size << " bytes was not freed" << std::endl;
+    FreeDeviceMemory(memory);
+  }
+  m_dedicated.clear();
+  m_bufferAllocations.clear();
+  m_imageAllocations.clear();
+  return leakedAllocationCount;
+}
+
+MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool isImage,
+                                           uint32_t linearPool) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  uint32_t memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, properties);
+  if (memoryTypeIndex == UINT32_MAX) {
+    throw std::runtime_error("Failed to find a suitable memory type!");
+  }
+
+  if (linearPool != INVALID_POOL) {
+    // Falls through to the general pools when the resource can't live in the pool's memory type
+    MemoryAllocation allocation =
+        AllocateFromLinearPool(linearPool, memoryTypeIndex, requirements.size, requirements.alignment, isImage);
+    if (allocation.IsValid()) return allocation;
+  }
+  if (requirements.size > DEDICATED_THRESHOLD) {
+    return AllocateDedicated(memoryTypeIndex, requirements.size);
+  }
+  return AllocateFromPool(memoryTypeIndex, requirements.size, requirements.alignment, isImage);
+}
+
+void MemoryAllocator::Free(const MemoryAllocation& allocation) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  FreeLocked(allocation);
+}
+
+uint32_t MemoryAllocator::CreateLinearPool(VkDeviceSize blockSize, VkDeviceSize minAlignment) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  uint32_t pool = 0;
+  while (pool < m_linearPools.size() && m_linearPools[pool].isAlive) ++pool;
+  if (pool == m_linearPools.size()) m_linearPools.emplace_back();
+
+  m_linearPools[pool] = {};
+  m_linearPools[pool].isAlive = true;
+  m_linearPools[pool].blockSize = blockSize;
+  m_linearPools[pool].minAlignment = minAlignment;
+  return pool;
+}
+
+void MemoryAllocator::ResetLinearPool(uint32_t pool) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  LinearPool& linearPool = m_linearPools[pool];
+  for (LinearPoolBlock& block : linearPool.blocks) block.linear.Reset();
+  linearPool.currentBlock = 0;
+}
+
+void MemoryAllocator::DestroyLinearPool(uint32_t pool) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  LinearPool& linearPool = m_linearPools[pool];
+  for (LinearPoolBlock& block : linearPool.blocks) FreeDeviceMemory(block.memory);
+  linearPool = {};
+}
+
+VkResult MemoryAllocator::AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties, VkDeviceMemory* pOutMemory,
+                                               uint32_t linearPool) {
+  VkMemoryRequirements memRequirements;
+  vkGetBufferMemoryRequirements(m_pDevice, buffer, &memRequirements);
+
+  MemoryAllocation allocation = Allocate(memRequirements, properties, false, linearPool);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool isInserted = m_bufferAllocations.emplace((uint64_t)buffer, allocation).second;
+    assert(isInserted && "Buffer handle still has an allocation, FreeBufferMemory must run before vkDestroyBuffer");
+  }
+  if (pOutMemory) *pOutMemory = allocation.memory;
+
+  return vkBindBufferMemory(m_pDevice, buffer, allocation.memory, allocation.offset);
+}
+
+VkResult MemoryAllocator::AllocateImageMemory(VkImage image, VkMemoryPropertyFlags properties, VkDeviceMemory* pOutMemory) {
+  VkMemoryRequirements memRequirements;
+  vkGetImageMemoryRequirements(m_pDevice, image, &memRequirements);
+
+  // Every image in this renderer is VK_IMAGE_TILING_OPTIMAL
+  MemoryAllocation allocation = Allocate(memRequirements, properties, true);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool isInserted = m_imageAllocations.emplace((uint64_t)image, allocation).second;
+    assert(isInserted && "Image handle still has an allocation, FreeImageMemory must run before vkDestroyImage");
+  }
+  if (pOutMemory) *pOutMemory = allocation.memory;
+
+  return vkBindImageMemory(m_pDevice, image, allocation.memory, allocation.offset);
+}
+
+void MemoryAllocator::FreeBufferMemory(VkBuffer buffer) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // The record leaves the map before the caller destroys the handle, see AllocateBufferMemory
+  auto it = m_bufferAllocations.find((uint64_t)buffer);
+  if (it == m_bufferAllocations.end()) return;
+  MemoryAllocation allocation = it->second;
+  m_bufferAllocations.erase(it);
+  FreeLocked(allocation);
+}
+
+void MemoryAllocator::FreeImageMemory(VkImage image) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_imageAllocations.find((uint64_t)image);
+  if (it == m_imageAllocations.end()) return;
+  MemoryAllocation allocation = it->second;
+  m_imageAllocations.erase(it);
+  FreeLocked(allocation);
+}
+
+uint8_t* MemoryAllocator::GetMappedData(VkBuffer buffer) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_bufferAllocations.find((uint64_t)buffer);
+  assert(it != m_bufferAllocations.end() && it->second.pMappedData && "Buffer memory is not HOST_VISIBLE");
+  return it->second.pMappedData;
+}
+
+MemoryStats MemoryAllocator::GetStats() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  MemoryStats stats;
+  stats.deviceMemoryCount = m_deviceMemoryCount;
+  stats.totalDeviceMemoryCount = m_totalDeviceMemoryCount;
+  stats.maxMemoryAllocationCount = m_maxMemoryAllocationCount;
+  for (const Pool& pool : m_pools) {
+    for (const std::unique_ptr<Block>& block : pool.blocks) {
+      if (!block) continue;
+      ++stats.blockCount;
+      stats.allocationCount += block->buddy.GetAllocationCount();
+      stats.reservedBytes += block->buddy.GetSize();
+      stats.usedBytes += block->buddy.GetUsedBytes();
+    }
+  }
+  for (const LinearPool& pool : m_linearPools) {
+    for (const LinearPoolBlock& block : pool.blocks) {
+      ++stats.blockCount;
+      stats.allocationCount += block.linear.GetAllocationCount();
+      stats.reservedBytes += block.linear.GetSize();
+      stats.usedBytes += block.linear.GetUsedBytes();
+    }
+  }
+  for (const auto& [memory, dedicated] : m_dedicated) {
+    ++stats.allocationCount;
+    stats.reservedBytes += dedicated.size;
+    stats.usedBytes += dedicated.size;
+  }
+  return stats;
+}
+
+void MemoryAllocator::PrintStats() {
+  MemoryStats stats = GetStats();
+  std::cout << "[MemoryAllocator] " << stats.allocationCount << " allocations in " << stats.deviceMemoryCount << " device memories ("
+            << stats.blockCount << " blocks, limit " << stats.maxMemoryAllocationCount << "), "
+            << stats.usedBytes / (1024.0 * 1024.0) << " / " << stats.reservedBytes / (1024.0 * 1024.0) << " MB used, "
+            << stats.totalDeviceMemoryCount << " vkAllocateMemory calls so far" << std::endl;
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; ++i) {
+    if ((memoryTypeBits & (1u << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+uint32_t MemoryAllocator::GetPoolIndex(uint32_t memoryTypeIndex, bool isImage) const {
+  // With a granularity of 1 buffers and images may share blocks
+  return memoryTypeIndex * 2 + (isImage && m_bufferImageGranularity > 1 ? 1 : 0);
+}
+
+VkResult MemoryAllocator::AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory* pOutMemory,
+                                               uint8_t** ppOutMappedData) {
+  if (m_maxMemoryAllocationCount > 0 && m_deviceMemoryCount >= m_maxMemoryAllocationCount) {
+    std::cout << "[MemoryAllocator] maxMemoryAllocationCount (" << m_maxMemoryAllocationCount << ") reached" << std::endl;
+  }
+
+  void* pMappedData = nullptr;
+  VkResult result = m_callbacks.allocate(memoryTypeIndex, size, pOutMemory, &pMappedData);
+  if (result != VK_SUCCESS) return result;
+
+  *ppOutMappedData = static_cast<uint8_t*>(pMappedData);
+  ++m_deviceMemoryCount;
+  ++m_totalDeviceMemoryCount;
+  return VK_SUCCESS;
+}
+
+void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory) {
+  m_callbacks.free(memory);
+  --m_deviceMemoryCount;
+}
+
+MemoryAllocation MemoryAllocator::AllocateFromPool(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceSize alignment,
+                                                   bool isImage) {
+  uint32_t poolIndex = GetPoolIndex(memoryTypeIndex, isImage);
+  Pool& pool = m_pools[poolIndex];
+
+  MemoryAllocation allocation;
+  allocation.size = size;
+  allocation.memoryTypeIndex = memoryTypeIndex;
+  allocation.poolIndex = poolIndex;
+
+  VkDeviceSize allocatedSize = 0;
+  for (uint32_t i = 0; i < pool.blocks.size(); ++i) {
+    Block* block = pool.blocks[i].get();
+    if (block && block->buddy.Allocate(size, alignment, &allocation.offset, &allocatedSize)) {
+      allocation.memory = block->memory;
+      allocation.pMappedData = block->pMappedData ? block->pMappedData + allocation.offset : nullptr;
+      allocation.blockIndex = i;
+      return allocation;
+    }
+  }
+
+  // Every block is full, open a new one (in a released slot if there is one)
+  uint32_t blockIndex = 0;
+  while (blockIndex < pool.blocks.size() && pool.blocks[blockIndex]) ++blockIndex;
+  if (blockIndex == pool.blocks.size()) pool.blocks.emplace_back();
+
+  std::unique_ptr<Block> block = std::make_unique<Block>();
+  VK_CHECK(AllocateDeviceMemory(memoryTypeIndex, BLOCK_SIZE, &block->memory, &block->pMappedData));
+  block->buddy.Initialize(BLOCK_SIZE);
+  block->buddy.Allocate(size, alignment, &allocation.offset, &allocatedSize);
+
+  allocation.memory = block->memory;
+  allocation.pMappedData = block->pMappedData ? block->pMappedData + allocation.offset : nullptr;
+  allocation.blockIndex = blockIndex;
+  pool.blocks[blockIndex] = std::move(block);
+  return allocation;
+}
+
+MemoryAllocation MemoryAllocator::AllocateFromLinearPool(uint32_t pool, uint32_t memoryTypeIndex, VkDeviceSize size,
+                                                         VkDeviceSize alignment, bool isImage) {
+  LinearPool& linearPool = m_linearPools[pool];
+  assert(linearPool.isAlive && "Linear pool was destroyed");
+  if (linearPool.memoryTypeIndex == UINT32_MAX) linearPool.memoryTypeIndex = memoryTypeIndex;
+  if (linearPool.memoryTypeIndex != memoryTypeIndex) return {};
+  alignment = (std::max)(alignment, linearPool.minAlignment);
+
+  MemoryAllocation allocation;
+  allocation.size = size;
+  allocation.memoryTypeIndex = memoryTypeIndex;
+  allocation.poolIndex = pool;
+  allocation.isLinear = true;
+
+  // Blocks are used in order, the ones after currentBlock are left over from before the last reset
+  for (; linearPool.currentBlock < linearPool.blocks.size(); ++linearPool.currentBlock) {
+    LinearPoolBlock& block = linearPool.blocks[linearPool.currentBlock];
+    if (block.linear.Allocate(size, alignment, isImage, &allocation.offset)) {
+      allocation.memory = block.memory;
+      allocation.pMappedData = block.pMappedData ? block.pMappedData + allocation.offset : nullptr;
+      allocation.blockIndex = linearPool.currentBlock;
+      return allocation;
+    }
+  }
+
+  LinearPoolBlock block;
+  VkDeviceSize blockSize = (std::max)(linearPool.blockSize, size);  // block offsets start at 0, aligned for anything
+  VK_CHECK(AllocateDeviceMemory(memoryTypeIndex, blockSize, &block.memory, &block.pMappedData));
+  block.linear.Initialize(blockSize, m_bufferImageGranularity);
+  block.linear.Allocate(size, alignment, isImage, &allocation.offset);
+
+  allocation.memory = block.memory;
+  allocation.pMappedData = block.pMappedData ? block.pMappedData + allocation.offset : nullptr;
+  allocation.blockIndex = linearPool.currentBlock;
+  linearPool.blocks.push_back(block);
+  return allocation;
+}
+
+MemoryAllocation MemoryAllocator::AllocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size) {
+  MemoryAllocation allocation;
+  allocation.size = size;
+  allocation.memoryTypeIndex = memoryTypeIndex;
+  VK_CHECK(AllocateDeviceMemory(memoryTypeIndex, size, &allocation.memory, &allocation.pMappedData));
+
+  m_dedicated[allocation.memory] = {size, memoryTypeIndex};
+  return allocation;
+}
+
+void MemoryAllocator::FreeLocked(const MemoryAllocation& allocation) {
+  if (!allocation.IsValid() || allocation.isLinear) return;
+
+  if (allocation.blockIndex == UINT32_MAX) {
+    m_dedicated.erase(allocation.memory);
+    FreeDeviceMemory(allocation.memory);
+    return;
+  }
+
+  Pool& pool = m_pools[allocation.poolIndex];
+  std::unique_ptr<Block>& block = pool.blocks[allocation.blockIndex];
+  block->buddy.Free(allocation.offset);
+
+  // Empty blocks go back to the device, except the last one of the pool so load / unload doesn't thrash vkAllocateMemory
+  if (block->buddy.IsEmpty()) {
+    size_t liveBlockCount = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const auto& b) { return b != nullptr; });
+    if (liveBlockCount > 1) {
+      FreeDeviceMemory(block->memory);
+      block.reset();
+    }
+  }
+}
+}  // namespace VkUtils
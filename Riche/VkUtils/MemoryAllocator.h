@@ -0,0 +1,273 @@
+#pragma once
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "Rendering/Core.h"
+#include "Utils/Singleton.h"
+
+namespace VkUtils {
+
+/*
+ * BuddyBlock : offset bookkeeping of one device memory block, no Vulkan calls
+ *  - Ranges are powers of two from MIN_ALLOCATION up to the block size and always aligned to their own size,
+ *    so any alignment up to the allocation size is free.
+ *  - Free() merges a range with its buddy for as long as the buddy is free too.
+ */
+class BuddyBlock {
+ public:
+  static constexpr VkDeviceSize MIN_ALLOCATION = 256;
+
+  // size : power of two, >= MIN_ALLOCATION
+  void Initialize(VkDeviceSize size) {
+    m_maxOrder = 0;
+    while ((MIN_ALLOCATION << m_maxOrder) < size) ++m_maxOrder;
+    m_freeLists.assign(m_maxOrder + 1, {});
+    m_freeLists[m_maxOrder].insert(0);
+    m_allocatedOrders.clear();
+    m_usedBytes = 0;
+  }
+
+  bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* pOutOffset, VkDeviceSize* pOutAllocatedSize) {
+    VkDeviceSize needed = (std::max)({size, alignment, MIN_ALLOCATION});
+    uint32_t order = 0;
+    while (order <= m_maxOrder && (MIN_ALLOCATION << order) < needed) ++order;
+    if (order > m_maxOrder) return false;
+
+    uint32_t current = order;
+    while (current <= m_maxOrder && m_freeLists[current].empty()) ++current;
+    if (current > m_maxOrder) return false;
+
+    // Lowest address first keeps the block packed towards the front
+    VkDeviceSize offset = *m_freeLists[current].begin();
+    m_freeLists[current].erase(m_freeLists[current].begin());
+    while (current > order) {
+      --current;
+      m_freeLists[current].insert(offset + (MIN_ALLOCATION << current));  // upper half stays free
+    }
+
+    m_allocatedOrders[offset] = order;
+    m_usedBytes += MIN_ALLOCATION << order;
+    *pOutOffset = offset;
+    *pOutAllocatedSize = MIN_ALLOCATION << order;
+    return true;
+  }
+
+  void Free(VkDeviceSize offset) {
+    auto it = m_allocatedOrders.find(offset);
+    assert(it != m_allocatedOrders.end() && "BuddyBlock : offset was not allocated");
+    uint32_t order = it->second;
+    m_allocatedOrders.erase(it);
+    m_usedBytes -= MIN_ALLOCATION << order;
+
+    while (order < m_maxOrder) {
+      VkDeviceSize buddy = offset ^ (MIN_ALLOCATION << order);
+      auto buddyIt = m_freeLists[order].find(buddy);
+      if (buddyIt == m_freeLists[order].end()) break;
+      m_freeLists[order].erase(buddyIt);
+      offset = (std::min)(offset, buddy);
+      ++order;
+    }
+    m_freeLists[order].insert(offset);
+  }
+
+  VkDeviceSize GetSize() const { return MIN_ALLOCATION << m_maxOrder; }
+  VkDeviceSize GetUsedBytes() const { return m_usedBytes; }
+  uint32_t GetAllocationCount() const { return static_cast<uint32_t>(m_allocatedOrders.size()); }
+  bool IsEmpty() const { return m_allocatedOrders.empty(); }
+
+ private:
+  uint32_t m_maxOrder = 0;
+  std::vector<std::set<VkDeviceSize>> m_freeLists;              // per order, free range offsets
+  std::unordered_map<VkDeviceSize, uint32_t> m_allocatedOrders;  // offset -> order
+  VkDeviceSize m_usedBytes = 0;
+};
+
+/*
+ * LinearBlock : bump allocator, nothing is freed on its own, Reset() releases everything at once
+ *  - Buffers and optimal images placed next to each other are kept bufferImageGranularity apart.
+ */
+class LinearBlock {
+ public:
+  void Initialize(VkDeviceSize size, VkDeviceSize bufferImageGranularity) {
+    m_size = size;
+    m_granularity = bufferImageGranularity;
+    Reset();
+  }
+
+  bool Allocate(VkDeviceSize size, VkDeviceSize alignment, bool isImage, VkDeviceSize* pOutOffset) {
+    VkDeviceSize offset = AlignUp(m_head, alignment);
+    if (m_head > 0 && isImage != m_lastIsImage) offset = AlignUp(offset, m_granularity);
+    if (offset + size > m_size) return false;
+
+    *pOutOffset = offset;
+    m_head = offset + size;
+    m_lastIsImage = isImage;
+    ++m_allocationCount;
+    return true;
+  }
+
+  void Reset() {
+    m_head = 0;
+    m_lastIsImage = false;
+    m_allocationCount = 0;
+  }
+
+  VkDeviceSize GetSize() const { return m_size; }
+  VkDeviceSize GetUsedBytes() const { return m_head; }
+  uint32_t GetAllocationCount() const { return m_allocationCount; }
+
+  static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+  }
+
+ private:
+  VkDeviceSize m_size = 0;
+  VkDeviceSize m_granularity = 1;
+  VkDeviceSize m_head = 0;
+  bool m_lastIsImage = false;
+  uint32_t m_allocationCount = 0;
+};
+
+struct MemoryAllocation {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;           // requested size
+  uint8_t* pMappedData = nullptr;  // HOST_VISIBLE memory is mapped once per device memory, nullptr otherwise
+  uint32_t memoryTypeIndex = UINT32_MAX;
+  uint32_t poolIndex = UINT32_MAX;   // general pool, or the linear pool when isLinear
+  uint32_t blockIndex = UINT32_MAX;  // UINT32_MAX : dedicated device memory
+  bool isLinear = false;
+
+  bool IsValid() const { return memory != VK_NULL_HANDLE; }
+};
+
+struct MemoryStats {
+  uint32_t deviceMemoryCount = 0;     // live vkAllocateMemory, what maxMemoryAllocationCount limits
+  uint32_t blockCount = 0;            // of which general and linear pool blocks
+  uint32_t allocationCount = 0;       // live resources placed in that memory
+  VkDeviceSize reservedBytes = 0;     // sum of the device memory sizes
+  VkDeviceSize usedBytes = 0;         // rounded allocation sizes, reservedBytes - usedBytes is free or lost to rounding
+  uint32_t totalDeviceMemoryCount = 0;  // vkAllocateMemory calls since Initialize
+  uint32_t maxMemoryAllocationCount = 0;
+};
+
+/*
+ * MemoryAllocator : device memory for every buffer and image, instead of one vkAllocateMemory per resource
+ *  - One general pool per memory type (and per buffer / optimal image when bufferImageGranularity > 1, so the two never
+ *    share a granularity page), made of BLOCK_SIZE BuddyBlocks. Resources above DEDICATED_THRESHOLD get their own memory.
+ *  - Linear pools hand out transient memory that is released together (ResetLinearPool), e.g. acceleration structure scratch.
+ *  - HOST_VISIBLE memory is mapped once, GetMappedData() replaces vkMapMemory / vkUnmapMemory of the resource.
+ *  - All device calls go through DeviceCallbacks, Initialize() with mock callbacks runs the allocator without a GPU.
+ */
+class MemoryAllocator : public Singleton<MemoryAllocator> {
+  friend class Singleton<MemoryAllocator>;
+
+ public:
+  static constexpr VkDeviceSize BLOCK_SIZE = 64ull * 1024 * 1024;  // 64MB
+  static constexpr VkDeviceSize DEDICATED_THRESHOLD = BLOCK_SIZE / 2;
+  static constexpr uint32_t INVALID_POOL = UINT32_MAX;
+
+  struct DeviceCallbacks {
+    // ppOutMappedData : whole memory mapped when the type is HOST_VISIBLE, nullptr otherwise
+    std::function<VkResult(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory* pOutMemory, void** ppOutMappedData)> allocate;
+    std::function<void(VkDeviceMemory memory)> free;
+  };
+
+  // An allocator besides g_MemoryAllocator, to be initialized with mock callbacks (MemoryAllocatorSelfCheck.h)
+  static std::unique_ptr<MemoryAllocator> CreateStandalone() { return std::unique_ptr<MemoryAllocator>(new MemoryAllocator()); }
+
+  void Initialize(VkDevice device, VkPhysicalDevice physicalDevice);
+  void Initialize(const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity,
+                  uint32_t maxMemoryAllocationCount, const DeviceCallbacks& callbacks);
+  // Reports what is still allocated (leaks) and frees every device memory, returns the number of leaked allocations
+  uint32_t Cleanup();
+
+  // isImage : VK_IMAGE_TILING_OPTIMAL image, buffers and linear images are false
+  MemoryAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool isImage,
+                            uint32_t linearPool = INVALID_POOL);
+  void Free(const MemoryAllocation& allocation);  // No-op for linear allocations, they go with ResetLinearPool
+
+  // minAlignment : on top of the resources' own alignment (e.g. acceleration structure scratch offsets)
+  uint32_t CreateLinearPool(VkDeviceSize blockSize, VkDeviceSize minAlignment = 1);
+  void ResetLinearPool(uint32_t pool);  // The GPU must be done with everything allocated from it
+  void DestroyLinearPool(uint32_t pool);
+
+  // Allocate + bind, the allocation is found again by the resource handle. Free before vkDestroyBuffer / vkDestroyImage :
+  // once destroyed the handle value can be handed out again, and another thread may register its new resource under it.
+  VkResult AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties, VkDeviceMemory* pOutMemory = nullptr,
+                                uint32_t linearPool = INVALID_POOL);
+  VkResult AllocateImageMemory(VkImage image, VkMemoryPropertyFlags properties, VkDeviceMemory* pOutMemory = nullptr);
+  void FreeBufferMemory(VkBuffer buffer);
+  void FreeImageMemory(VkImage image);
+  uint8_t* GetMappedData(VkBuffer buffer);
+
+  MemoryStats GetStats();
+  void PrintStats();
+
+ private:
+  MemoryAllocator() = default;
+
+  struct Block {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* pMappedData = nullptr;
+    BuddyBlock buddy;
+  };
+
+  struct Pool {
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    bool isImage = false;
+    std::vector<std::unique_ptr<Block>> blocks;  // nullptr : released, the index is reused
+  };
+
+  struct LinearPoolBlock {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t* pMappedData = nullptr;
+    LinearBlock linear;
+  };
+
+  struct LinearPool {
+    bool isAlive = false;
+    VkDeviceSize blockSize = 0;
+    VkDeviceSize minAlignment = 1;
+    uint32_t memoryTypeIndex = UINT32_MAX;  // fixed by the first allocation
+    uint32_t currentBlock = 0;
+    std::vector<LinearPoolBlock> blocks;
+  };
+
+  struct Dedicated {
+    VkDeviceSize size = 0;
+    uint32_t memoryTypeIndex = UINT32_MAX;
+  };
+
+  uint32_t FindMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const;
+  uint32_t GetPoolIndex(uint32_t memoryTypeIndex, bool isImage) const;
+  VkResult AllocateDeviceMemory(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceMemory* pOutMemory, uint8_t** ppOutMappedData);
+  void FreeDeviceMemory(VkDeviceMemory memory);
+  MemoryAllocation AllocateFromPool(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceSize alignment, bool isImage);
+  MemoryAllocation AllocateFromLinearPool(uint32_t pool, uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceSize alignment,
+                                          bool isImage);
+  MemoryAllocation AllocateDedicated(uint32_t memoryTypeIndex, VkDeviceSize size);
+  void FreeLocked(const MemoryAllocation& allocation);
+
+  VkDevice m_pDevice = VK_NULL_HANDLE;
+  DeviceCallbacks m_callbacks;
+  VkPhysicalDeviceMemoryProperties m_memoryProperties = {};
+  VkDeviceSize m_bufferImageGranularity = 1;
+  uint32_t m_maxMemoryAllocationCount = 0;
+
+  std::mutex m_mutex;
+  std::vector<Pool> m_pools;  // GetPoolIndex()
+  std::vector<LinearPool> m_linearPools;
+  std::map<VkDeviceMemory, Dedicated> m_dedicated;
+  std::unordered_map<uint64_t, MemoryAllocation> m_bufferAllocations;  // VkBuffer handle -> allocation
+  std::unordered_map<uint64_t, MemoryAllocation> m_imageAllocations;   // VkImage handle -> allocation
+  uint32_t m_deviceMemoryCount = 0;
+  uint32_t m_totalDeviceMemoryCount = 0;
+};
+
+}  // namespace VkUtils
+
+#define g_MemoryAllocator VkUtils::MemoryAllocator::Get()
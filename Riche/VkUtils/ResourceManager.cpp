@@ -39,6 +39,12 @@ void ResourceManager::WaitForFenceValue() {
 }
 
 void ResourceManager::Cleanup() {
+  FlushUploads();
+  WaitForUploads();
+  m_pendingAcquires.clear();
+  vkDestroySemaphore(m_pDevice, m_uploadTimeline, nullptr);
+  m_stagingRing.Cleanup();
+
   CleanupCommandPool();
   CleanupFence();
 }
@@ -100,7 +106,7 @@ void ResourceManager::EndAndSummitCommandBuffer(VkCommandBuffer commandbuffer) {
 
   vkWaitForFences(m_pDevice, 1, &fence, VK_TRUE, UINT64_MAX);
 
-  vkQueueWaitIdle(m_transferQueue);  // ť Idle °   ٸ. ⼭ Idle ¶,  ¿ ִ  ̾߱Ѵ.
+  vkQueueWaitIdle(m_transferQueue);  // 큐가 Idle 상태가 될 때까지 기다린다. 여기서 Idle 상태란, 대기 상태에 있는 것을 이야기한다.
   vkDestroyFence(m_pDevice, fence, nullptr);
 
   // Free Temporary command buffer back to pool
@@ -136,84 +142,343 @@ void ResourceManager::Initialize(VkDevice device, VkPhysicalDevice physicalDevic
   m_queueFamilyIndices = indices;
   CreateCommandPool();
   CreateFence();
+  CreateUploadTimeline();
+  m_stagingRing.Initialize(m_pDevice, m_pPhysicalDevice);
 }
 
-VkResult ResourceManager::CreateVertexBuffer(uint32_t sizePerVertex, uint32_t vertexNum, VkDeviceMemory* pOutVertexBufferMemory,
-                                             VkBuffer* pOutBuffer, void* pInitData) {
-  // Get size of buffer needed for vertices
-  VkDeviceSize bufferSize = sizePerVertex * vertexNum;
+void ResourceManager::CreateUploadTimeline() {
+  VkSemaphoreTypeCreateInfo timelineCreateInfo = {};
+  timelineCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  timelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  timelineCreateInfo.initialValue = 0;
 
-  VkBuffer pVertexBuffer;
-  VkDeviceMemory pVertexBufferMemory;
+  VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+  semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semaphoreCreateInfo.pNext = &timelineCreateInfo;
+  VK_CHECK(vkCreateSemaphore(m_pDevice, &semaphoreCreateInfo, nullptr, &m_uploadTimeline));
+}
 
-  // Temporaray buffer to "stage" vertex data befroe transferring to GPU
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
+void ResourceManager::BeginUploadBatch() { ++m_uploadBatchDepth; }
 
-  // Create Buffer, Allocate Memory and Bind to it
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+UploadTicket ResourceManager::EndUploadBatch(bool isQuiet) {
+  assert(m_uploadBatchDepth > 0 && "EndUploadBatch without BeginUploadBatch");
+  if (--m_uploadBatchDepth > 0) return {};
 
-  // MAP MEMORY TO VERTEX BUFFER
-  void* pData = nullptr;                                                 // 1. Create pointer to a point in normal memory
-  vkMapMemory(m_pDevice, stagingBufferMemory, 0, bufferSize, 0, &pData);  // 2. "Map" the vertex buffer memory to that point
-  memcpy(pData, pInitData, (size_t)bufferSize);                          // 3. Copy memory from vertices vector to that point
-  vkUnmapMemory(m_pDevice, stagingBufferMemory);                          // 4. "UnMap" the vertex buffer memory
+  uint32_t submitCount = m_uploadSubmitCount;
+  UploadTicket ticket = FlushUploads();
+  if (!isQuiet) {
+    std::cout << "[ResourceManager] Queued " << m_uploadedBytes / (1024 * 1024) << " MB in " << m_uploadSubmitCount - submitCount
+              << " submits (" << m_uploadSubmitCount << " total)" << std::endl;
+  }
+  m_uploadedBytes = 0;
+  return ticket;
+}
 
-  // Create Buffer win TRANSFER_DST_BIT to mark as recipient of transfer data
-  // Buffer Memory is to be DEVICE_LOCAL_BIT meaning memory is on the GPU and only accessible by it and not CPU (host)
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pVertexBuffer, &pVertexBufferMemory);
+UploadTicket ResourceManager::EndUpload() {
+  if (m_uploadBatchDepth > 0) return {};
+  UploadTicket ticket = FlushUploads();
+  WaitForUpload(ticket);
+  return ticket;
+}
 
-  // Copy staging buffer to vertex buffer on GPU
-  CopyBuffer(m_pDevice, m_transferQueue, m_transferCommandPool, stagingBuffer, pVertexBuffer, bufferSize);
+VkCommandBuffer ResourceManager::GetUploadCommandBuffer() {
+  if (m_uploadCommandBuffer == VK_NULL_HANDLE) m_uploadCommandBuffer = CreateAndBeginCommandBuffer();
+  return m_uploadCommandBuffer;
+}
 
-  *pOutBuffer = pVertexBuffer;
-  *pOutVertexBufferMemory = pVertexBufferMemory;
+UploadTicket ResourceManager::FlushUploads() {
+  if (m_uploadCommandBuffer == VK_NULL_HANDLE) return {m_submittedTimelineValue};
+  vkEndCommandBuffer(m_uploadCommandBuffer);
 
-  // Clean up staging buffer
-  vkDestroyBuffer(m_pDevice, stagingBuffer, nullptr);
-  vkFreeMemory(m_pDevice, stagingBufferMemory, nullptr);
+  const uint64_t signalValue = m_submittedTimelineValue + 1;
+  VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+  timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineSubmitInfo.signalSemaphoreValueCount = 1;
+  timelineSubmitInfo.pSignalSemaphoreValues = &signalValue;
 
-  return VK_SUCCESS;
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext = &timelineSubmitInfo;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &m_uploadCommandBuffer;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &m_uploadTimeline;
+  VK_CHECK(vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+  m_uploadSubmits.push_back({signalValue, m_uploadCommandBuffer, m_stagingRing.GetHead()});
+  m_uploadCommandBuffer = VK_NULL_HANDLE;
+  ++m_uploadSubmitCount;
+  {
+    std::lock_guard<std::mutex> lock(m_acquireMutex);
+    m_submittedTimelineValue = signalValue;
+  }
+  return {signalValue};
 }
 
-VkResult ResourceManager::CreateVertexBuffer(uint32_t vertexDataSize, VkDeviceMemory* pOutVertexBufferMemory, VkBuffer* pOutBuffer,
-                                             void* pInitData) {
-  // Get size of buffer needed for vertices
-  VkDeviceSize bufferSize = vertexDataSize;
+void ResourceManager::WaitForUploads() {
+  while (!m_uploadSubmits.empty()) RetireUploads(true);
+}
 
-  VkBuffer pVertexBuffer;
-  VkDeviceMemory pVertexBufferMemory;
+void ResourceManager::WaitForUpload(UploadTicket ticket) {
+  if (!ticket.IsValid()) return;
 
-  // Temporaray buffer to "stage" vertex data befroe transferring to GPU
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
+  VkSemaphoreWaitInfo waitInfo = {};
+  waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores = &m_uploadTimeline;
+  waitInfo.pValues = &ticket.value;
+  VK_CHECK(vkWaitSemaphores(m_pDevice, &waitInfo, UINT64_MAX));
+  RetireUploads(false);
+}
+
+bool ResourceManager::IsUploadComplete(UploadTicket ticket) const {
+  uint64_t completedValue = 0;
+  VK_CHECK(vkGetSemaphoreCounterValue(m_pDevice, m_uploadTimeline, &completedValue));
+  return completedValue >= ticket.value;
+}
+
+// Retires every finished submit in order, waiting for the oldest one first if asked to
+void ResourceManager::RetireUploads(bool waitForOldest) {
+  if (waitForOldest && !m_uploadSubmits.empty()) {
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_uploadTimeline;
+    waitInfo.pValues = &m_uploadSubmits.front().timelineValue;
+    VK_CHECK(vkWaitSemaphores(m_pDevice, &waitInfo, UINT64_MAX));
+  }
+
+  uint64_t completedValue = 0;
+  VK_CHECK(vkGetSemaphoreCounterValue(m_pDevice, m_uploadTimeline, &completedValue));
+  while (!m_uploadSubmits.empty() && m_uploadSubmits.front().timelineValue <= completedValue) {
+    UploadSubmit& submit = m_uploadSubmits.front();
+    m_stagingRing.Retire(submit.ringHead);
+    vkFreeCommandBuffers(m_pDevice, m_transferCommandPool, 1, &submit.commandBuffer);
+    m_uploadSubmits.pop_front();
+  }
+}
+
+// Release half of the queue family ownership transfer, recorded after the last copy into 'buffer'
+void ResourceManager::ReleaseBuffer(VkBuffer buffer) {
+  VkBufferMemoryBarrier bufferBarrier = {};
+  bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  bufferBarrier.dstAccessMask = 0;  // Ignored for a release, the acquire makes it visible
+  bufferBarrier.srcQueueFamilyIndex = IsOwnershipTransferNeeded() ? m_queueFamilyIndices.transferFamily : VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.dstQueueFamilyIndex = IsOwnershipTransferNeeded() ? m_queueFamilyIndices.graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+  bufferBarrier.buffer = buffer;
+  bufferBarrier.offset = 0;
+  bufferBarrier.size = VK_WHOLE_SIZE;
+
+  VkCommandBuffer commandBuffer = GetUploadCommandBuffer();
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+                       &bufferBarrier, 0, nullptr);
+
+  std::lock_guard<std::mutex> lock(m_acquireMutex);
+  PendingAcquire acquire;
+  acquire.buffer = buffer;
+  acquire.timelineValue = m_submittedTimelineValue + 1;  // signaled by the command buffer recording right now
+  m_pendingAcquires.push_back(acquire);
+}
+
+// Release (and layout transition) of an uploaded image, the acquire repeats the same transition on the graphics queue.
+// The transfer queue may not support graphics stages so the release only waits for the copy.
+// With mipLevels > 1 the image stays in TRANSFER_DST_OPTIMAL, the acquire blits the chain from mip 0 (extent).
+void ResourceManager::ReleaseImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkExtent2D extent,
+                                   uint32_t mipLevels) {
+  VkImageMemoryBarrier imageMemBarrier = {};
+  imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  imageMemBarrier.oldLayout = oldLayout;
+  imageMemBarrier.newLayout = newLayout;
+  imageMemBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  imageMemBarrier.dstAccessMask = 0;
+  imageMemBarrier.srcQueueFamilyIndex = IsOwnershipTransferNeeded() ? m_queueFamilyIndices.transferFamily : VK_QUEUE_FAMILY_IGNORED;
+  imageMemBarrier.dstQueueFamilyIndex = IsOwnershipTransferNeeded() ? m_queueFamilyIndices.graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+  imageMemBarrier.image = image;
+  imageMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  imageMemBarrier.subresourceRange.baseMipLevel = 0;
+  imageMemBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+  imageMemBarrier.subresourceRange.baseArrayLayer = 0;
+  imageMemBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+  VkCommandBuffer commandBuffer = GetUploadCommandBuffer();
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr,
+                       1, &imageMemBarrier);
+
+  std::lock_guard<std::mutex> lock(m_acquireMutex);
+  PendingAcquire acquire;
+  acquire.image = image;
+  acquire.oldLayout = oldLayout;
+  acquire.newLayout = newLayout;
+  acquire.extent = extent;
+  acquire.mipLevels = mipLevels;
+  acquire.timelineValue = m_submittedTimelineValue + 1;
+  m_pendingAcquires.push_back(acquire);
+}
+
+bool ResourceManager::IsAcquirePending(VkImage image) {
+  std::lock_guard<std::mutex> lock(m_acquireMutex);
+  return std::any_of(m_pendingAcquires.begin(), m_pendingAcquires.end(),
+                     [image](const PendingAcquire& acquire) { return acquire.image == image; });
+}
+
+UploadTicket ResourceManager::CmdAcquireUploads(VkCommandBuffer commandBuffer) {
+  std::vector<VkBufferMemoryBarrier> bufferBarriers;
+  std::vector<VkImageMemoryBarrier> imageBarriers;
+  std::vector<PendingAcquire> mipmapImages;
+  UploadTicket ticket;
+  {
+    std::lock_guard<std::mutex> lock(m_acquireMutex);
+    // Only what was submitted, a batch that is still recording is picked up by a later frame
+    auto submittedEnd =
+        std::stable_partition(m_pendingAcquires.begin(), m_pendingAcquires.end(),
+                              [this](const PendingAcquire& acquire) { return acquire.timelineValue <= m_submittedTimelineValue; });
+
+    for (auto it = m_pendingAcquires.begin(); it != submittedEnd; ++it) {
+      ticket.value = (std::max)(ticket.value, it->timelineValue);
+      if (it->mipLevels > 1) mipmapImages.push_back(*it);
+      if (!IsOwnershipTransferNeeded()) continue;
+
+      if (it->buffer != VK_NULL_HANDLE) {
+        VkBufferMemoryBarrier bufferBarrier = {};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = 0;
+        bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        bufferBarrier.srcQueueFamilyIndex = m_queueFamilyIndices.transferFamily;
+        bufferBarrier.dstQueueFamilyIndex = m_queueFamilyIndices.graphicsFamily;
+        bufferBarrier.buffer = it->buffer;
+        bufferBarrier.offset = 0;
+        bufferBarrier.size = VK_WHOLE_SIZE;
+        bufferBarriers.push_back(bufferBarrier);
+      } else {
+        VkImageMemoryBarrier imageMemBarrier = {};
+        imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemBarrier.oldLayout = it->oldLayout;
+        imageMemBarrier.newLayout = it->newLayout;
+        imageMemBarrier.srcAccessMask = 0;
+        imageMemBarrier.dstAccessMask =
+            it->mipLevels > 1 ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+        imageMemBarrier.srcQueueFamilyIndex = m_queueFamilyIndices.transferFamily;
+        imageMemBarrier.dstQueueFamilyIndex = m_queueFamilyIndices.graphicsFamily;
+        imageMemBarrier.image = it->image;
+        imageMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageMemBarrier.subresourceRange.baseMipLevel = 0;
+        imageMemBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageMemBarrier.subresourceRange.baseArrayLayer = 0;
+        imageMemBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(imageMemBarrier);
+      }
+    }
+    m_pendingAcquires.erase(m_pendingAcquires.begin(), submittedEnd);
+  }
+
+  // The submit waits on the timeline at ALL_COMMANDS, so the acquire only has to order itself against later reads
+  if (!bufferBarriers.empty() || !imageBarriers.empty()) {
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+  }
+
+  for (const PendingAcquire& acquire : mipmapImages) {
+    CmdGenerateMipmaps(commandBuffer, acquire.image, acquire.extent.width, acquire.extent.height, acquire.mipLevels);
+  }
+  return ticket;
+}
+
+uint8_t* ResourceManager::AllocateStaging(VkDeviceSize size, VkDeviceSize* pOutOffset) {
+  // 16 bytes keeps buffer-to-image copies aligned to the texel (and block) size
+  const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+  RetireUploads(false);
+  while (!m_stagingRing.Allocate(size, STAGING_ALIGNMENT, pOutOffset)) {
+    // Out of room : submit what this batch recorded so far, then wait for the oldest submit to give its range back
+    FlushUploads();
+    if (m_uploadSubmits.empty()) throw std::runtime_error("Staging allocation is larger than the staging ring");
+    RetireUploads(true);
+  }
+  m_uploadedBytes += size;
+  return m_stagingRing.GetMappedData(*pOutOffset);
+}
 
-  // Create Buffer, Allocate Memory and Bind to it
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+void ResourceManager::UploadToBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size) {
+  // Chunks of a quarter ring so a big buffer never has to wait for the whole ring to drain
+  const VkDeviceSize chunkSize = m_stagingRing.GetCapacity() / 4;
 
-  // MAP MEMORY TO VERTEX BUFFER
-  void* pData = nullptr;                                                 // 1. Create pointer to a point in normal memory
-  vkMapMemory(m_pDevice, stagingBufferMemory, 0, bufferSize, 0, &pData);  // 2. "Map" the vertex buffer memory to that point
-  memcpy(pData, pInitData, (size_t)bufferSize);                          // 3. Copy memory from vertices vector to that point
-  vkUnmapMemory(m_pDevice, stagingBufferMemory);                          // 4. "UnMap" the vertex buffer memory
+  for (VkDeviceSize copied = 0; copied < size; copied += chunkSize) {
+    VkDeviceSize copySize = (std::min)(chunkSize, size - copied);
+
+    VkDeviceSize stagingOffset;
+    uint8_t* pStaging = AllocateStaging(copySize, &stagingOffset);
+    memcpy(pStaging, static_cast<const uint8_t*>(pData) + copied, static_cast<size_t>(copySize));
+
+    VkBufferCopy bufferCopyRegion = {};
+    bufferCopyRegion.srcOffset = stagingOffset;
+    bufferCopyRegion.dstOffset = dstOffset + copied;
+    bufferCopyRegion.size = copySize;
+    vkCmdCopyBuffer(GetUploadCommandBuffer(), m_stagingRing.GetBuffer(), dstBuffer, 1, &bufferCopyRegion);
+  }
+}
+
+void ResourceManager::UploadToImage(VkImage dstImage, uint32_t width, uint32_t height, uint32_t texelSize, const void* pData,
+                                    uint32_t mipLevel, uint32_t blockDim) {
+  const uint32_t rowLength = (width + blockDim - 1) / blockDim;
+  const uint32_t rows = (height + blockDim - 1) / blockDim;
+  const VkDeviceSize rowSize = static_cast<VkDeviceSize>(rowLength) * texelSize;
+  const uint32_t rowsPerChunk = static_cast<uint32_t>((std::max)(VkDeviceSize(1), m_stagingRing.GetCapacity() / 4 / rowSize));
+
+  for (uint32_t row = 0; row < rows; row += rowsPerChunk) {
+    uint32_t rowCount = (std::min)(rowsPerChunk, rows - row);
+
+    VkDeviceSize stagingOffset;
+    uint8_t* pStaging = AllocateStaging(rowSize * rowCount, &stagingOffset);
+    memcpy(pStaging, static_cast<const uint8_t*>(pData) + rowSize * row, static_cast<size_t>(rowSize * rowCount));
+
+    VkBufferImageCopy imageRegion = {};
+    imageRegion.bufferOffset = stagingOffset;
+    imageRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageRegion.imageSubresource.mipLevel = mipLevel;
+    imageRegion.imageSubresource.baseArrayLayer = 0;
+    imageRegion.imageSubresource.layerCount = 1;
+    // Texels, the last block row may stop at the edge of the level
+    imageRegion.imageOffset = {0, static_cast<int32_t>(row * blockDim), 0};
+    imageRegion.imageExtent = {width, (std::min)(rowCount * blockDim, height - row * blockDim), 1};
+    vkCmdCopyBufferToImage(GetUploadCommandBuffer(), m_stagingRing.GetBuffer(), dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                           &imageRegion);
+  }
+}
+
+VkResult ResourceManager::CreateVertexBuffer(uint32_t sizePerVertex, uint32_t vertexNum, VkDeviceMemory* pOutVertexBufferMemory,
+                                             VkBuffer* pOutBuffer, void* pInitData) {
+  // Get size of buffer needed for vertices
+  VkDeviceSize bufferSize = sizePerVertex * vertexNum;
 
   // Create Buffer win TRANSFER_DST_BIT to mark as recipient of transfer data
   // Buffer Memory is to be DEVICE_LOCAL_BIT meaning memory is on the GPU and only accessible by it and not CPU (host)
   CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pVertexBuffer, &pVertexBufferMemory);
+               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pOutBuffer, pOutVertexBufferMemory);
+
+  // Stage through the ring, the copy is submitted with the rest of the batch
+  UploadToBuffer(*pOutBuffer, 0, pInitData, bufferSize);
+  ReleaseBuffer(*pOutBuffer);
+  EndUpload();
 
-  // Copy staging buffer to vertex buffer on GPU
-  CopyBuffer(m_pDevice, m_transferQueue, m_transferCommandPool, stagingBuffer, pVertexBuffer, bufferSize);
+  return VK_SUCCESS;
+}
 
-  *pOutBuffer = pVertexBuffer;
-  *pOutVertexBufferMemory = pVertexBufferMemory;
+VkResult ResourceManager::CreateVertexBuffer(uint32_t vertexDataSize, VkDeviceMemory* pOutVertexBufferMemory, VkBuffer* pOutBuffer,
+                                             void* pInitData) {
+  // Get size of buffer needed for vertices
+  VkDeviceSize bufferSize = vertexDataSize;
 
-  // Clean up staging buffer
-  vkDestroyBuffer(m_pDevice, stagingBuffer, nullptr);
-  vkFreeMemory(m_pDevice, stagingBufferMemory, nullptr);
+  // Create Buffer win TRANSFER_DST_BIT to mark as recipient of transfer data
+  // Buffer Memory is to be DEVICE_LOCAL_BIT meaning memory is on the GPU and only accessible by it and not CPU (host)
+  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pOutBuffer, pOutVertexBufferMemory);
+
+  // Stage through the ring, the copy is submitted with the rest of the batch
+  UploadToBuffer(*pOutBuffer, 0, pInitData, bufferSize);
+  ReleaseBuffer(*pOutBuffer);
+  EndUpload();
 
   return VK_SUCCESS;
 }
@@ -222,95 +487,210 @@ VkResult ResourceManager::CreateIndexBuffer(uint32_t indexDataSize, VkDeviceMemo
                                             void* pInitData) {
   VkDeviceSize bufferSize = indexDataSize;
 
-  VkBuffer pIndexBuffer;
-  VkDeviceMemory pIndexBufferMemory;
+  // Create Buffer win TRANSFER_DST_BIT to mark as recipient of transfer data
+  // Buffer Memory is to be DEVICE_LOCAL_BIT meaning memory is on the GPU and only accessible by it and not CPU (host)
+  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pOutBuffer, pOutIndexBufferMemory);
 
-  // Temporaray buffer to "stage" vertex data befroe transferring to GPU
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
+  // Stage through the ring, the copy is submitted with the rest of the batch
+  UploadToBuffer(*pOutBuffer, 0, pInitData, bufferSize);
+  ReleaseBuffer(*pOutBuffer);
+  EndUpload();
 
-  // Create Buffer, Allocate Memory and Bind to it
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer, &stagingBufferMemory);
+  return VK_SUCCESS;
+}
 
-  // MAP MEMORY TO VERTEX BUFFER
-  void* pData = nullptr;                                                 // 1. Create pointer to a point in normal memory
-  vkMapMemory(m_pDevice, stagingBufferMemory, 0, bufferSize, 0, &pData);  // 2. "Map" the vertex buffer memory to that point
-  memcpy(pData, pInitData, (size_t)bufferSize);                          // 3. Copy memory from vertices vector to that point
-  vkUnmapMemory(m_pDevice, stagingBufferMemory);                          // 4. "UnMap" the vertex buffer memory
+VkResult ResourceManager::CreateGeometryBuffer(VkDeviceSize dataSize, VkBufferUsageFlags usage, VkDeviceMemory* pOutBufferMemory,
+                                               VkBuffer* pOutBuffer, const void* pInitData) {
+  // The BLAS builds are recorded on the transfer queue and the draws on the graphics queue, so the buffer is shared
+  // concurrently by both families instead of being released to the graphics queue like the other uploads
+  uint32_t queueFamilies[] = {static_cast<uint32_t>(m_queueFamilyIndices.transferFamily),
+                              static_cast<uint32_t>(m_queueFamilyIndices.graphicsFamily)};
 
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pIndexBuffer, &pIndexBufferMemory);
+  VkBufferCreateInfo bufferCreateInfo = {};
+  bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferCreateInfo.size = dataSize;
+  bufferCreateInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                           VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+                           VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+  if (IsOwnershipTransferNeeded()) {
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    bufferCreateInfo.queueFamilyIndexCount = 2;
+    bufferCreateInfo.pQueueFamilyIndices = queueFamilies;
+  } else {
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  }
+  VK_CHECK(vkCreateBuffer(m_pDevice, &bufferCreateInfo, nullptr, pOutBuffer));
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(*pOutBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pOutBufferMemory));
 
-  // Copy staging buffer to vertex buffer on GPU
-  CopyBuffer(m_pDevice, m_transferQueue, m_transferCommandPool, stagingBuffer, pIndexBuffer, bufferSize);
+  // Stage through the ring, outside of an upload batch this waits so the BLAS builds can read it right away
+  UploadToBuffer(*pOutBuffer, 0, pInitData, dataSize);
+  EndUpload();
 
-  *pOutBuffer = pIndexBuffer;
-  *pOutIndexBufferMemory = pIndexBufferMemory;
+  return VK_SUCCESS;
+}
 
-  // Clean up staging buffer
-  vkDestroyBuffer(m_pDevice, stagingBuffer, nullptr);
-  vkFreeMemory(m_pDevice, stagingBufferMemory, nullptr);
+VkResult ResourceManager::CreateTexture(const std::string& filename, TextureCooker::TextureSlot slot, VkDeviceMemory* pOutImageMemory,
+                                        VkImage* pOutImage, VkDeviceSize* pOutImageSize, VkFormat* pOutFormat) {
+  DecodedTexture texture = DecodeTexture(filename, slot);
+  return UploadTexture(texture, pOutImageMemory, pOutImage, pOutImageSize, pOutFormat);
+}
 
-  return VK_SUCCESS;
+ResourceManager::DecodedTexture ResourceManager::DecodeTexture(const std::string& filename, TextureCooker::TextureSlot slot,
+                                                               bool isCooking, uint32_t maxSize) {
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  DecodedTexture texture;
+  texture.filename = filename;
+  texture.maxSize = maxSize;
+
+  if (isCooking) {
+    // Up to date .rtex only cost a stat of the source here
+    TextureCooker::CookStats stats;
+    TextureCooker::CookTexture(filename, slot, false, stats);
+  }
+
+  // Cooked blocks with their mips, nothing to decode or generate
+  TextureCooker::CookedTexture& cooked = texture.cooked;
+  if (TextureCooker::LoadCookedTexture(filename, slot, cooked)) {
+    texture.sourceWidth = static_cast<int>(cooked.width);
+    texture.sourceHeight = static_cast<int>(cooked.height);
+
+    // The kept levels move to the front of the data, offsets stay relative to the first one
+    while (maxSize > 0 && texture.firstMip + 1 < cooked.levels.size() &&
+           (std::max)(cooked.width >> texture.firstMip, cooked.height >> texture.firstMip) > maxSize) {
+      ++texture.firstMip;
+    }
+    if (texture.firstMip > 0) {
+      const VkDeviceSize dropped = cooked.levels[texture.firstMip].byteOffset;
+      cooked.data.erase(cooked.data.begin(), cooked.data.begin() + static_cast<size_t>(dropped));
+      cooked.levels.erase(cooked.levels.begin(), cooked.levels.begin() + texture.firstMip);
+      for (TextureCooker::LevelIndex& level : cooked.levels) level.byteOffset -= dropped;
+      cooked.width = (std::max)(cooked.width >> texture.firstMip, 1u);
+      cooked.height = (std::max)(cooked.height >> texture.firstMip, 1u);
+    }
+
+    texture.width = static_cast<int>(cooked.width);
+    texture.height = static_cast<int>(cooked.height);
+    texture.size = cooked.data.size();
+  } else {
+    DecodeSourcePixels(texture);
+  }
+
+  texture.decodeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - begin).count();
+  return texture;
 }
 
-VkResult ResourceManager::CreateTexture(const std::string& filename, VkDeviceMemory* pOutImageMemory, VkImage* pOutImage,
-                                        VkDeviceSize* pOutImageSize) {
-  // Load Image file
-  int width, height;
-  stbi_uc* imageData = LoadTextureFile(filename, &width, &height, pOutImageSize);
+void ResourceManager::DecodeSourcePixels(DecodedTexture& texture) {
+  texture.pixels = LoadTextureFile(texture.filename, &texture.width, &texture.height, &texture.size);
+  texture.sourceWidth = texture.width;
+  texture.sourceHeight = texture.height;
+  texture.firstMip = 0;
+
+  // Box filtered on the CPU down to maxSize, written back over the front of the decoded pixels
+  uint32_t width = static_cast<uint32_t>(texture.width), height = static_cast<uint32_t>(texture.height);
+  if (texture.maxSize > 0 && (std::max)(width, height) > texture.maxSize) {
+    std::vector<uint8_t> rgba(texture.pixels, texture.pixels + texture.size);
+    while ((std::max)(width, height) > texture.maxSize) {
+      rgba = TextureCooker::DownsampleRgba8(rgba, width, height);
+      width = (std::max)(width / 2, 1u);
+      height = (std::max)(height / 2, 1u);
+      ++texture.firstMip;
+    }
+    memcpy(texture.pixels, rgba.data(), rgba.size());
+    texture.width = static_cast<int>(width);
+    texture.height = static_cast<int>(height);
+    texture.size = rgba.size();
+  }
+}
 
-  // Create Staging Buffer to hold loaded data, ready to copy to device
-  VkBuffer imageStagingBuffer;
-  VkDeviceMemory imageStagingBufferMemory;
-  CreateBuffer(m_pDevice, m_pPhysicalDevice, *pOutImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &imageStagingBuffer,
-               &imageStagingBufferMemory);
+VkResult ResourceManager::UploadTexture(DecodedTexture& texture, VkDeviceMemory* pOutImageMemory, VkImage* pOutImage,
+                                        VkDeviceSize* pOutImageSize, VkFormat* pOutFormat) {
+  const TextureCooker::CookedTexture& cooked = texture.cooked;
+  if (!cooked.levels.empty()) {
+    VkFormatProperties cookedFormatProperties;
+    vkGetPhysicalDeviceFormatProperties(m_pPhysicalDevice, cooked.format, &cookedFormatProperties);
+
+    if (cookedFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) {
+      const uint32_t levelCount = static_cast<uint32_t>(cooked.levels.size());
+      VkUtils::CreateImage2D(m_pDevice, m_pPhysicalDevice, cooked.width, cooked.height, pOutImageMemory, pOutImage, cooked.format,
+                             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             levelCount);
+
+      CmdImageBarrier(GetUploadCommandBuffer(), *pOutImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, 0, levelCount);
+      for (uint32_t level = 0; level < levelCount; ++level) {
+        UploadToImage(*pOutImage, (std::max)(cooked.width >> level, 1u), (std::max)(cooked.height >> level, 1u), cooked.blockSize,
+                      cooked.data.data() + cooked.levels[level].byteOffset, level, BlockCompression::BLOCK_DIM);
+      }
+      ReleaseImage(*pOutImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      EndUpload();
+
+      *pOutImageSize = cooked.data.size();
+      if (pOutFormat) *pOutFormat = cooked.format;
+      texture.cooked = {};
+      return VK_SUCCESS;
+    }
+
+    // Without BC support (textureCompressionBC) the source is decoded after all, down to the same maxSize
+    texture.cooked = {};
+    DecodeSourcePixels(texture);
+  }
 
-  // Copy image data to staging buffer
-  void* pData;
-  vkMapMemory(m_pDevice, imageStagingBufferMemory, 0, *pOutImageSize, 0, &pData);
-  memcpy(pData, imageData, static_cast<size_t>(*pOutImageSize));
-  vkUnmapMemory(m_pDevice, imageStagingBufferMemory);
+  const int width = texture.width;
+  const int height = texture.height;
+  *pOutImageSize = texture.size;
 
-  // Free Original image data
-  stbi_image_free(imageData);
+  // The mip chain is blitted with a linear filter, without format support the texture keeps mip 0 only
+  VkFormatProperties formatProperties;
+  vkGetPhysicalDeviceFormatProperties(m_pPhysicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &formatProperties);
+  const VkFormatFeatureFlags blitFeatures =
+      VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  const bool isMipmapped = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+  const uint32_t mipLevels = isMipmapped ? ComputeMipLevels(width, height) : 1;
 
   // Create Image to hold final texture
   VkUtils::CreateImage2D(m_pDevice, m_pPhysicalDevice, width, height, pOutImageMemory, pOutImage, VK_FORMAT_R8G8B8A8_UNORM,
-                         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-  // Transition image to be DST for copy operation
-  TransitionImageLayout(m_pDevice, m_transferQueue, m_transferCommandPool, *pOutImage, VK_IMAGE_LAYOUT_UNDEFINED,
-                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-  // Copy Image data
-  CopyImage(m_pDevice, m_transferQueue, m_transferCommandPool, imageStagingBuffer, *pOutImage, width, height);
-  // Transition image to be shader readable for shader usage
-  TransitionImageLayout(m_pDevice, m_transferQueue, m_transferCommandPool, *pOutImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+                         VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mipLevels);
+
+  // Transition, copy and release to the graphics queue in the upload command buffer instead of three queue drains
+  CmdImageBarrier(GetUploadCommandBuffer(), *pOutImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT, 0, mipLevels);
+  UploadToImage(*pOutImage, width, height, 4, texture.pixels);
+  if (mipLevels > 1) {
+    // Levels 1.. are generated by the graphics queue when it acquires the image (CmdAcquireUploads)
+    ReleaseImage(*pOutImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}, mipLevels);
+  } else {
+    ReleaseImage(*pOutImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  }
 
-  // Destroy Staging buffer
-  vkDestroyBuffer(m_pDevice, imageStagingBuffer, nullptr);
-  vkFreeMemory(m_pDevice, imageStagingBufferMemory, nullptr);
+  // Free Original image data, it was copied into the ring
+  stbi_image_free(texture.pixels);
+  texture.pixels = nullptr;
+  EndUpload();
 
+  if (pOutFormat) *pOutFormat = VK_FORMAT_R8G8B8A8_UNORM;
   return VK_SUCCESS;
 }
 
 glm::vec4 ResourceManager::ReadPixelFromImage(VkImage image, uint32_t width, uint32_t height, int mouseX, int mouseY) {
-  // 0) ǥ ȯ (Vulkan   ϴ)
-  //      ǥ (0,0) -> ϴ(screenHeight)̶ 
-  //    Ʒ "mouseY"  
+  // 0) 좌표 변환 (Vulkan은 보통 원점이 하단)
+  //    만약 윈도우 좌표가 상단(0,0) -> 하단(screenHeight)이라면 뒤집기
+  //    아래에서는 "mouseY" 뒤집는 예시
   int flippedY = (height - 1) - mouseY;
 
-  //  üũ
+  // 경계 체크
   if (mouseX < 0 || mouseY < 0 || mouseX >= (int)width || mouseY >= (int)height) {
     std::cerr << "[ReadPixel] Invalid mouse pos" << std::endl;
-    return {-1, 0, 0, 0};  //   0
+    return {-1, 0, 0, 0};  // 범위를 벗어났으니 0
   }
   flippedY = mouseY;
 
-  // 1) Staging Buffer  (1ȼ = 4Ʈ RGBA)
+  // 1) Staging Buffer 만들기 (1픽셀 = 4바이트 RGBA)
   VkBuffer stagingBuffer;
   VkDeviceMemory stagingMemory;
   VkUtils::CreateBuffer(m_pDevice, m_pPhysicalDevice,
@@ -339,8 +719,8 @@ glm::vec4 ResourceManager::ReadPixelFromImage(VkImage image, uint32_t width, uin
   // Begine recording transfer commands
   vkBeginCommandBuffer(transferCommandBuffer, &beginInfo);
 
-  // 3) Image Layout ȯ: PRESENT_SRC_KHR -> TRANSFER_SRC_OPTIMAL
-  //    (pipelineBarrier Ȥ imageMemoryBarrier)
+  // 3) Image Layout 전환: PRESENT_SRC_KHR -> TRANSFER_SRC_OPTIMAL
+  //    (pipelineBarrier 혹은 imageMemoryBarrier)
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -361,10 +741,10 @@ glm::vec4 ResourceManager::ReadPixelFromImage(VkImage image, uint32_t width, uin
   vkCmdPipelineBarrier(transferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
                        nullptr, 1, &barrier);
 
-  // 4) vkCmdCopyImageToBuffer (1x1 ũ⸸ )
+  // 4) vkCmdCopyImageToBuffer (1x1 크기만 복사)
   VkBufferImageCopy region{};
   region.bufferOffset = 0;
-  // Ʒ rowLength, imageHeight 0̸ "ŸƮ"ϰ 
+  // 아래 rowLength, imageHeight가 0이면 "타이트"하게 복사
   region.bufferRowLength = 0;
   region.bufferImageHeight = 0;
   region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -372,11 +752,11 @@ glm::vec4 ResourceManager::ReadPixelFromImage(VkImage image, uint32_t width, uin
   region.imageSubresource.baseArrayLayer = 0;
   region.imageSubresource.layerCount = 1;
   region.imageOffset = {mouseX, flippedY, 0};
-  region.imageExtent = {1, 1, 1};  // 1ȼ
+  region.imageExtent = {1, 1, 1};  // 1픽셀
 
   vkCmdCopyImageToBuffer(transferCommandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &region);
 
-  // 5) ٽ Layout ȯ: TRANSFER_SRC_OPTIMAL -> PRESENT_SRC_KHR (ʿ)
+  // 5) 다시 Layout 전환: TRANSFER_SRC_OPTIMAL -> PRESENT_SRC_KHR (필요시)
   barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
   barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
   barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
@@ -396,21 +776,19 @@ glm::vec4 ResourceManager::ReadPixelFromImage(VkImage image, uint32_t width, uin
 
   // Submit Transfer command to transfer queue and wait until it finishes
   vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(m_transferQueue);  // ť Idle °   ٸ. ⼭ Idle ¶,  ¿ ִ  ̾߱Ѵ.
+  vkQueueWaitIdle(m_transferQueue);  // 큐가 Idle 상태가 될 때까지 기다린다. 여기서 Idle 상태란, 대기 상태에 있는 것을 이야기한다.
 
   // Free Temporary command buffer back to pool
   vkFreeCommandBuffers(m_pDevice, m_transferCommandPool, 1, &transferCommandBuffer);
 
-  // 7) Staging Buffer map ؼ ȼ б
+  // 7) Staging Buffer를 map 해서 픽셀 읽기
   float resultColor[4];
-  void* pData;
-  vkMapMemory(m_pDevice, stagingMemory, 0, 4 * sizeof(float), 0, &pData);
+  void* pData = g_MemoryAllocator.GetMappedData(stagingBuffer);
   std::memcpy(&resultColor, pData, 4 * sizeof(float));
-  vkUnmapMemory(m_pDevice, stagingMemory);
 
-  // 8) ¡ /޸ 
+  // 8) 스테이징 버퍼/메모리 정리
+  g_MemoryAllocator.FreeBufferMemory(stagingBuffer);
   vkDestroyBuffer(m_pDevice, stagingBuffer, nullptr);
-  vkFreeMemory(m_pDevice, stagingMemory, nullptr);
 
   return glm::vec4(resultColor[0], resultColor[1], resultColor[2], resultColor[3]);
 }
@@ -429,23 +807,8 @@ VkResult ResourceManager::CreateVkBuffer(VkDeviceSize bufferSize, VkBufferUsageF
   // In Vulkan Cookbook 166p, Buffers don't have their own memory.
   VK_CHECK(vkCreateBuffer(m_pDevice, &bufferCreateInfo, nullptr, pOutBuffer));
 
-  // GET BUFFER MEMORY REQUIRMENTS
-  VkMemoryRequirements memRequirements;
-  vkGetBufferMemoryRequirements(m_pDevice, *pOutBuffer, &memRequirements);
-
-  // ALLOCATE MEMORY TO BUFFER
-  VkMemoryAllocateInfo memAllocInfo = {};
-  memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memAllocInfo.allocationSize = memRequirements.size;
-  memAllocInfo.memoryTypeIndex = FindMemoryTypeIndex(
-      m_pPhysicalDevice, memRequirements.memoryTypeBits,  // Index of memory type on physical device that has required bit flags
-      bufferProperties);                                 // VK_MEMORY_.._HOST_VISIBLE_BIT : CPU can interact with memory(GPU)
-  // VK_MEMORY_.._HOST_COHERENT_BIT : Allows placement of data straight into buffer after mapping (otherwise would have to specify
-  // maually) Allocate Memory to VkDeviceMemory
-  VK_CHECK(vkAllocateMemory(m_pDevice, &memAllocInfo, nullptr, pOutBufferMemory));
-
-  // Bind memory to given vertex buffer
-  vkBindBufferMemory(m_pDevice, *pOutBuffer, *pOutBufferMemory, 0);
+  // ALLOCATE MEMORY TO BUFFER AND BIND
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(*pOutBuffer, bufferProperties, pOutBufferMemory));
 
   return VK_SUCCESS;
 }
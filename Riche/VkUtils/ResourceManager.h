@@ -1,12 +1,24 @@
 #pragma once
+#include <deque>
+
+#include "MemoryAllocator.h"
 #include "QueueFamilyIndices.h"
 #include "Rendering/Core.h"
+#include "StagingRing.h"
 #include "Utils/Singleton.h"
+#include "Utils/TextureCooker.h"
 #include "Utils/TextureUtils.h"
 
 namespace VkUtils {
 
-// TransferQueue ̿ؼ ϴ Vulkan Object ؼ ϴ Ŭ
+// Value of the upload timeline semaphore that signals once an upload (and its ownership release) is done
+struct UploadTicket {
+  uint64_t value = 0;  // 0 : nothing to wait for
+
+  bool IsValid() const { return value > 0; }
+};
+
+// TransferQueue를 이용해서 만들어야하는 Vulkan Object에 대해서 생성하는 클래스
 class ResourceManager : public Singleton<ResourceManager> {
   friend class Singleton<ResourceManager>;
 
@@ -23,6 +35,48 @@ class ResourceManager : public Singleton<ResourceManager> {
 
   void WaitForFenceValue();
 
+  // Upload batching : copies are recorded into one command buffer and staged through m_stagingRing,
+  // a submit only happens when the batch ends or the ring runs out of room. Every submit signals the next
+  // m_uploadTimeline value, nothing on the CPU waits for it unless the caller asks to.
+  struct UploadSubmit {
+    uint64_t timelineValue;
+    VkCommandBuffer commandBuffer;
+    VkDeviceSize ringHead;  // m_stagingRing head at submit, everything before it is retired with the submit
+  };
+
+  // Resource released by the transfer queue family, acquired by the graphics queue family on first use
+  struct PendingAcquire {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkImage image = VK_NULL_HANDLE;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // images only, the acquire repeats the release's transition
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkExtent2D extent = {};  // images with mipLevels > 1 : levels 1.. are generated from mip 0 after the acquire
+    uint32_t mipLevels = 1;
+    uint64_t timelineValue = 0;
+  };
+
+  StagingRing m_stagingRing;
+  VkSemaphore m_uploadTimeline = VK_NULL_HANDLE;
+  uint64_t m_submittedTimelineValue = 0;                   // value signaled by the last submit
+  VkCommandBuffer m_uploadCommandBuffer = VK_NULL_HANDLE;  // recording, signals m_submittedTimelineValue + 1
+  std::deque<UploadSubmit> m_uploadSubmits;                // in flight, oldest first
+  int m_uploadBatchDepth = 0;
+  uint32_t m_uploadSubmitCount = 0;
+  VkDeviceSize m_uploadedBytes = 0;
+
+  std::mutex m_acquireMutex;  // uploads happen on the main thread, acquires are recorded by the culling pass on a worker
+  std::vector<PendingAcquire> m_pendingAcquires;
+
+  void CreateUploadTimeline();
+  VkCommandBuffer GetUploadCommandBuffer();
+  uint8_t* AllocateStaging(VkDeviceSize size, VkDeviceSize* pOutOffset);
+  void RetireUploads(bool waitForOldest);
+  UploadTicket EndUpload();  // Outside of a batch every upload is still synchronous for the caller
+
+  bool IsOwnershipTransferNeeded() const { return m_queueFamilyIndices.transferFamily != m_queueFamilyIndices.graphicsFamily; }
+  void ReleaseBuffer(VkBuffer buffer);
+  void ReleaseImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkExtent2D extent = {}, uint32_t mipLevels = 1);
+
  public:
   VkQueue m_transferQueue;
   VkQueue m_computeQueue;
@@ -36,6 +90,8 @@ class ResourceManager : public Singleton<ResourceManager> {
   void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkQueue compute, QueueFamilyIndices indices);
   void Cleanup();
 
+  const QueueFamilyIndices& GetQueueFamilyIndices() const { return m_queueFamilyIndices; }
+
   VkCommandBuffer CreateAndBeginCommandBuffer();
   void CreateCommandBuffer();
   void BeginCommandBuffer();
@@ -45,11 +101,67 @@ class ResourceManager : public Singleton<ResourceManager> {
                               void* pInitData);
   VkResult CreateVertexBuffer(uint32_t vertexDataSize, VkDeviceMemory* pOutVertexBufferMemory, VkBuffer* pOutBuffer, void* pInitData);
   VkResult CreateIndexBuffer(uint32_t indexDataSize, VkDeviceMemory* pOutIndexBufferMemory, VkBuffer* pOutBuffer, void* pInitData);
-
-  VkResult CreateTexture(const std::string& filename, VkDeviceMemory* pOutImageMemory, VkImage* pOutImage,
-                         VkDeviceSize* pOutImageSize);
+  // Device local, addressable buffer read by both the raster passes and the acceleration structure builds (scene geometry)
+  VkResult CreateGeometryBuffer(VkDeviceSize dataSize, VkBufferUsageFlags usage, VkDeviceMemory* pOutBufferMemory,
+                                VkBuffer* pOutBuffer, const void* pInitData);
+
+  // Full mip chain, views should cover VK_REMAINING_MIP_LEVELS in *pOutFormat.
+  // The BCn blocks of an up to date <filename>.rtex (TextureCooker) are uploaded as they are, otherwise the source is
+  // decoded to RGBA8 and its mips are generated on the graphics queue (CmdAcquireUploads).
+  // slot : the material slot the texture is bound to, it picks the BCn format of the .rtex
+  VkResult CreateTexture(const std::string& filename, TextureCooker::TextureSlot slot, VkDeviceMemory* pOutImageMemory,
+                         VkImage* pOutImage, VkDeviceSize* pOutImageSize, VkFormat* pOutFormat = nullptr);
+
+  // CPU half of CreateTexture (file read, stb_image decode or .rtex load), no Vulkan calls so g_ThreadPool jobs can run it
+  struct DecodedTexture {
+    std::string filename;
+    TextureCooker::CookedTexture cooked;  // no levels when the source was decoded instead
+    stbi_uc* pixels = nullptr;            // RGBA8 level firstMip, freed by UploadTexture
+    int width = 0;                        // of level firstMip
+    int height = 0;
+    int sourceWidth = 0;  // mip 0 of the file
+    int sourceHeight = 0;
+    uint32_t firstMip = 0;
+    uint32_t maxSize = 0;  // as asked, UploadTexture decodes the source with it when the device can't sample the .rtex
+    VkDeviceSize size = 0;
+    float decodeMs = 0.0f;
+  };
+  // isCooking : a missing or stale .rtex is cooked first (BCn encode inside the calling job)
+  // maxSize : the finer levels are dropped until the largest side fits (TextureStreamer), 0 keeps mip 0
+  static DecodedTexture DecodeTexture(const std::string& filename, TextureCooker::TextureSlot slot, bool isCooking = false,
+                                      uint32_t maxSize = 0);
+  // stb_image decode of texture.filename into pixels, box filtered down to texture.maxSize
+  static void DecodeSourcePixels(DecodedTexture& texture);
+  // GPU half, records into the upload command buffer so it stays on the loading thread
+  VkResult UploadTexture(DecodedTexture& texture, VkDeviceMemory* pOutImageMemory, VkImage* pOutImage, VkDeviceSize* pOutImageSize,
+                         VkFormat* pOutFormat = nullptr);
   glm::vec4 ReadPixelFromImage(VkImage image, uint32_t width, uint32_t height, int mouseX, int mouseY);
 
+  // Everything uploaded between Begin/EndUploadBatch shares command buffers and submits. EndUploadBatch submits without waiting,
+  // the renderer waits for the ticket on the GPU the first frame the resources are used (see CmdAcquireUploads).
+  // Batches nest, only the outermost End submits. isQuiet skips the log line (per frame batches of the texture streamer).
+  void BeginUploadBatch();
+  UploadTicket EndUploadBatch(bool isQuiet = false);
+  UploadTicket FlushUploads();  // Submit what is recorded, don't wait
+  void WaitForUploads();
+  void WaitForUpload(UploadTicket ticket);
+  bool IsUploadComplete(UploadTicket ticket) const;
+
+  // Records the graphics side ownership acquire of everything uploaded (and submitted) since the last call.
+  // The returned ticket must be waited on by the submit of 'commandBuffer', on m_uploadTimeline (GetUploadTimeline).
+  // Mip chains of the acquired textures are blitted here too, the transfer queue may not support vkCmdBlitImage.
+  UploadTicket CmdAcquireUploads(VkCommandBuffer commandBuffer);
+  VkSemaphore GetUploadTimeline() const { return m_uploadTimeline; }
+  bool IsAcquirePending(VkImage image);  // true until CmdAcquireUploads picked the image up, it must not be sampled before
+
+  void UploadToBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size);
+  // dstImage must be in TRANSFER_DST_OPTIMAL, rows are split across submits when the image is larger than the ring.
+  // Block compressed levels pass blockDim = 4 and the block size as texelSize, a row is then a row of blocks.
+  void UploadToImage(VkImage dstImage, uint32_t width, uint32_t height, uint32_t texelSize, const void* pData,
+                     uint32_t mipLevel = 0, uint32_t blockDim = 1);
+
+  uint32_t GetUploadSubmitCount() const { return m_uploadSubmitCount; }
+
   VkResult CreateVkBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage, VkMemoryPropertyFlags bufferProperties,
                           VkBuffer* pOutBuffer, VkDeviceMemory* pOutBufferMemory);
 };
@@ -85,28 +197,10 @@ static void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDev
   // In Vulkan Cookbook 166p, Buffers don't have their own memory.
   VK_CHECK(vkCreateBuffer(device, &bufferCreateInfo, nullptr, pOutBuffer));
 
-  // GET BUFFER MEMORY REQUIRMENTS
-  VkMemoryRequirements memRequirements;
-  vkGetBufferMemoryRequirements(device, *pOutBuffer, &memRequirements);
-
-  VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo = {};
-  memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-  memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
-
-  // ALLOCATE MEMORY TO BUFFER
-  VkMemoryAllocateInfo memAllocInfo = {};
-  memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memAllocInfo.allocationSize = memRequirements.size;
-  memAllocInfo.memoryTypeIndex = FindMemoryTypeIndex(
-      physicalDevice, memRequirements.memoryTypeBits,  // Index of memory type on physical device that has required bit flags
-      bufferProperties);                               // VK_MEMORY_.._HOST_VISIBLE_BIT : CPU can interact with memory(GPU)
-  // VK_MEMORY_.._HOST_COHERENT_BIT : Allows placement of data straight into buffer after mapping (otherwise would have to specify
-  // maually) Allocate Memory to VkDeviceMemory
-  memAllocInfo.pNext = deviceAddressFlag ? &memoryAllocateFlagsInfo : VK_NULL_HANDLE;
-  VK_CHECK(vkAllocateMemory(device, &memAllocInfo, nullptr, pOutBufferMemory));
-
-  // Bind memory to given vertex buffer
-  vkBindBufferMemory(device, *pOutBuffer, *pOutBufferMemory, 0);
+  // ALLOCATE MEMORY TO BUFFER AND BIND
+  // *pOutBufferMemory is the shared block, free with g_MemoryAllocator.FreeBufferMemory before vkDestroyBuffer (not vkFreeMemory).
+  // Every block is allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, deviceAddressFlag no longer changes anything.
+  VK_CHECK(g_MemoryAllocator.AllocateBufferMemory(*pOutBuffer, bufferProperties, pOutBufferMemory));
 }
 
 static void CopyBuffer(VkDevice device, VkQueue transferQueue, VkCommandPool transferCommandPool, VkBuffer srcBuffer,
@@ -153,7 +247,7 @@ static void CopyBuffer(VkDevice device, VkQueue transferQueue, VkCommandPool tra
 
   // Submit Transfer command to transfer queue and wait until it finishes
   vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(transferQueue);  // ť Idle °   ٸ. ⼭ Idle ¶,  ¿ ִ  ̾߱Ѵ.
+  vkQueueWaitIdle(transferQueue);  // 큐가 Idle 상태가 될 때까지 기다린다. 여기서 Idle 상태란, 대기 상태에 있는 것을 이야기한다.
 
   // Free Temporary command buffer back to pool
   vkFreeCommandBuffers(device, transferCommandPool, 1, &transferCommandBuffer);
@@ -208,7 +302,7 @@ static void CopyImage(VkDevice device, VkQueue transferQueue, VkCommandPool tran
 
   // Submit Transfer command to transfer queue and wait until it finishes
   vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(transferQueue);  // ť Idle °   ٸ. ⼭ Idle ¶,  ¿ ִ  ̾߱Ѵ.
+  vkQueueWaitIdle(transferQueue);  // 큐가 Idle 상태가 될 때까지 기다린다. 여기서 Idle 상태란, 대기 상태에 있는 것을 이야기한다.
 
   // Free Temporary command buffer back to pool
   vkFreeCommandBuffers(device, transferCommandPool, 1, &transferCommandBuffer);
@@ -229,7 +323,7 @@ static VkResult CreateImage2D(VkDevice device, VkPhysicalDevice physicalDevice,
   imageCreateInfo.arrayLayers = 1;                            // Number of levels in image array
   imageCreateInfo.format = format;                            // Format type of image
   imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;           // How image data should be "tiled" (arranged for optimal reading)
-  imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // Layout of image data on creation (ӹۿ ° )
+  imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;  // Layout of image data on creation (프레임버퍼에 맞게 변형됨)
   imageCreateInfo.usage = usage;                              // Bit flags defining what image will be used for
   imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;            // Number of samples for multi-sampling
   imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;    // Whether image can be shared between queues
@@ -240,19 +334,8 @@ static VkResult CreateImage2D(VkDevice device, VkPhysicalDevice physicalDevice,
   }
 
   // CRAETE MEMORY FOR IMAGE
-  // Get memory requirements for a type of image
-  VkMemoryRequirements memRequirements;
-  vkGetImageMemoryRequirements(device, *pOutVkImage, &memRequirements);
-
-  VkMemoryAllocateInfo memAllocInfo = {};
-  memAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  memAllocInfo.allocationSize = memRequirements.size;
-  memAllocInfo.memoryTypeIndex = FindMemoryTypeIndex(physicalDevice, memRequirements.memoryTypeBits, propFlags);
-
-  VK_CHECK(vkAllocateMemory(device, &memAllocInfo, nullptr, pOutImageMemory));
-
-  // Connect memory to Image
-  VK_CHECK(vkBindImageMemory(device, *pOutVkImage, *pOutImageMemory, 0));
+  // Sub-allocated and bound, free with g_MemoryAllocator.FreeImageMemory before vkDestroyImage
+  VK_CHECK(g_MemoryAllocator.AllocateImageMemory(*pOutVkImage, propFlags, pOutImageMemory));
 
   return VK_SUCCESS;
 }
@@ -339,24 +422,24 @@ static void TransitionImageLayout(VkDevice device, VkQueue transferQueue, VkComm
     srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   } else if (oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-    // Depth attachment    : Depth attachment  б    ʿմϴ.
+    // Depth attachment로 쓰일 때 접근 권한: Depth attachment에 대한 읽기 및 쓰기 접근이 필요합니다.
     imageMemBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    // Shader read-only ̾ƿ ȯ Ŀ ̴ ܰ迡 б⸸ ʿմϴ.
+    // Shader read-only 레이아웃으로 전환 후에는 셰이더 단계에서 읽기만 필요합니다.
     imageMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    // srcStage: ̹ depth/stencil attachment    ׸Ʈ ׽Ʈ Ŀ  ϵ մϴ.
+    // srcStage: 이미지가 depth/stencil attachment로 사용될 때 최종 프래그먼트 테스트 후에 접근 가능하도록 설정합니다.
     srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    // dstStage: ̴ ܰ迡 о ϹǷ ׸Ʈ ̴ ߾ մϴ.
+    // dstStage: 셰이더 단계에서 읽어야 하므로 프래그먼트 셰이더에 맞추어 설정합니다.
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   } else if (oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
-    // Depth attachment    : Depth attachment  б    ʿմϴ.
+    // Depth attachment로 쓰일 때 접근 권한: Depth attachment에 대한 읽기 및 쓰기 접근이 필요합니다.
     imageMemBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    // Shader read-only ̾ƿ ȯ Ŀ ̴ ܰ迡 б⸸ ʿմϴ.
+    // Shader read-only 레이아웃으로 전환 후에는 셰이더 단계에서 읽기만 필요합니다.
     imageMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    // srcStage: Color attachment  ܰ color attachment output ܰ迡   ֵ մϴ.
+    // srcStage: Color attachment에 쓰는 단계인 color attachment output 단계에서 접근할 수 있도록 설정합니다.
     srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    // dstStage: ׸Ʈ ̴ б  ׸Ʈ ̴ ܰ մϴ.
+    // dstStage: 프래그먼트 셰이더에서 읽기 위해 프래그먼트 셰이더 단계로 설정합니다.
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   }
 
@@ -378,7 +461,7 @@ static void TransitionImageLayout(VkDevice device, VkQueue transferQueue, VkComm
 
   // Submit Transfer command to transfer queue and wait until it finishes
   vkQueueSubmit(transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(transferQueue);  // ť Idle °   ٸ. ⼭ Idle ¶,  ¿ ִ  ̾߱Ѵ.
+  vkQueueWaitIdle(transferQueue);  // 큐가 Idle 상태가 될 때까지 기다린다. 여기서 Idle 상태란, 대기 상태에 있는 것을 이야기한다.
 
   // Free Temporary command buffer back to pool
   vkFreeCommandBuffers(device, transferCommandPool, 1, &transferCommandBuffer);
@@ -418,23 +501,23 @@ static void CmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImag
     srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   } else if (oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-    // Depth attachment    : Depth attachment  б    ʿմϴ.
+    // Depth attachment로 쓰일 때 접근 권한: Depth attachment에 대한 읽기 및 쓰기 접근이 필요합니다.
     imageMemBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    // Shader read-only ̾ƿ ȯ Ŀ ̴ ܰ迡 б⸸ ʿմϴ.
+    // Shader read-only 레이아웃으로 전환 후에는 셰이더 단계에서 읽기만 필요합니다.
     imageMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    // srcStage: ̹ depth/stencil attachment    ׸Ʈ ׽Ʈ Ŀ  ϵ մϴ.
+    // srcStage: 이미지가 depth/stencil attachment로 사용될 때 최종 프래그먼트 테스트 후에 접근 가능하도록 설정합니다.
     srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    // dstStage: ̴ ܰ迡 о ϹǷ ׸Ʈ ̴ ߾ մϴ.
+    // dstStage: 셰이더 단계에서 읽어야 하므로 프래그먼트 셰이더에 맞추어 설정합니다.
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   } else if (oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL || oldLayout == VK_IMAGE_LAYOUT_GENERAL) {
-    // Depth attachment    : Depth attachment  б    ʿմϴ.
+    // Depth attachment로 쓰일 때 접근 권한: Depth attachment에 대한 읽기 및 쓰기 접근이 필요합니다.
     imageMemBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     imageMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    // srcStage: Color attachment  ܰ color attachment output ܰ迡   ֵ մϴ.
+    // srcStage: Color attachment에 쓰는 단계인 color attachment output 단계에서 접근할 수 있도록 설정합니다.
     srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    // dstStage: ׸Ʈ ̴ б  ׸Ʈ ̴ ܰ մϴ.
+    // dstStage: 프래그먼트 셰이더에서 읽기 위해 프래그먼트 셰이더 단계로 설정합니다.
     dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   }
 
@@ -448,7 +531,8 @@ static void CmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImag
 
 static void CmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
                             VkImageAspectFlags aspectFlag, VkAccessFlags srcAccessFlag, VkAccessFlags dstAccessFlag,
-                            VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+                            VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, uint32_t baseMipLevel = 0,
+                            uint32_t levelCount = 1) {
   VkImageMemoryBarrier imageMemBarrier = {};
   imageMemBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
   imageMemBarrier.oldLayout = oldLayout;                          // Layout to transition from
@@ -457,13 +541,13 @@ static void CmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImag
   imageMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;  // Queue family to transition to
   imageMemBarrier.image = image;                                  // image being aceesed and modified as part of barrier
   imageMemBarrier.subresourceRange.aspectMask = aspectFlag;       // Aspect of Image being altered
-  imageMemBarrier.subresourceRange.baseMipLevel = 0;              // First mip level to start alterations on
-  imageMemBarrier.subresourceRange.levelCount = 1;                // number of mip levels to alter starting from base mip level
+  imageMemBarrier.subresourceRange.baseMipLevel = baseMipLevel;   // First mip level to start alterations on
+  imageMemBarrier.subresourceRange.levelCount = levelCount;       // number of mip levels to alter starting from base mip level
   imageMemBarrier.subresourceRange.baseArrayLayer = 0;            // First layer to start alterations on
   imageMemBarrier.subresourceRange.layerCount = 1;                // number of layers to alter starting from base array layer
 
   imageMemBarrier.srcAccessMask = srcAccessFlag;
-  // Shader read-only ̾ƿ ȯ Ŀ ̴ ܰ迡 б⸸ ʿմϴ.
+  // Shader read-only 레이아웃으로 전환 후에는 셰이더 단계에서 읽기만 필요합니다.
   imageMemBarrier.dstAccessMask = dstAccessFlag;
 
   vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage,  // Pipeline Stages (match to src and dst AccessMasks)
@@ -474,6 +558,46 @@ static void CmdImageBarrier(VkCommandBuffer commandBuffer, VkImage image, VkImag
   );
 }
 
+// Full chain down to 1x1
+static uint32_t ComputeMipLevels(uint32_t width, uint32_t height) {
+  uint32_t mipLevels = 1;
+  while ((std::max)(width, height) >> mipLevels) ++mipLevels;
+  return mipLevels;
+}
+
+// Every level must be in TRANSFER_DST_OPTIMAL with mip 0 written, each level is a linear blit of the one above.
+// Needs a graphics queue (vkCmdBlitImage), every level ends in SHADER_READ_ONLY_OPTIMAL.
+static void CmdGenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels) {
+  int32_t mipWidth = static_cast<int32_t>(width);
+  int32_t mipHeight = static_cast<int32_t>(height);
+
+  for (uint32_t mip = 1; mip < mipLevels; ++mip) {
+    CmdImageBarrier(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mip - 1, 1);
+
+    VkImageBlit blit = {};
+    blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 0, 1};
+    blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+    mipWidth = (std::max)(mipWidth / 2, 1);
+    mipHeight = (std::max)(mipHeight / 2, 1);
+    blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 1};
+    blit.dstOffsets[1] = {mipWidth, mipHeight, 1};
+    vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
+                   VK_FILTER_LINEAR);
+  }
+
+  // Levels above the last one were read, the last one was written
+  if (mipLevels > 1) {
+    CmdImageBarrier(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, mipLevels - 1);
+  }
+  CmdImageBarrier(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_IMAGE_ASPECT_COLOR_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, mipLevels - 1, 1);
+}
+
 static void CreateSampler(VkDevice device, VkSamplerAddressMode addressMode, VkFilter filter, VkSampler* pOutSampler,
                           bool isAnisotropy = false) {
   VkSamplerCreateInfo samplerCreateInfo = {};
@@ -487,9 +611,10 @@ static void CreateSampler(VkDevice device, VkSamplerAddressMode addressMode, VkF
   samplerCreateInfo.maxAnisotropy = 1.0f;                                  // Maximum anisotropy
   samplerCreateInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;        // Border color
   samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;                    // Use normalized texture coordinates
-  samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  // Linear samplers are trilinear, single level render targets are not affected
+  samplerCreateInfo.mipmapMode = filter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
   samplerCreateInfo.minLod = 0.0f;
-  samplerCreateInfo.maxLod = 8.0f;
+  samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
 
   VK_CHECK(vkCreateSampler(device, &samplerCreateInfo, nullptr, pOutSampler));
 }
@@ -9,9 +9,10 @@ namespace VkUtils
 		std::ifstream file(filename, std::ios::binary | std::ios::ate);
 
 		// Check if file stream successfully opened
+		// A .spv that the pre-build step did not produce must not turn into an empty module in Release
 		if (!file.is_open())
 		{
-			assert(false && "Failed to open a file!");
+			throw std::runtime_error("Failed to open a file! (" + filename + ")");
 		}
 
 		// Get current read position and use to resize file buffer
@@ -0,0 +1,28 @@
+#include "StagingRing.h"
+
+#include "ResourceManager.h"
+
+namespace VkUtils {
+void StagingRing::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity) {
+  m_pDevice = device;
+  m_capacity = capacity;
+  m_head = m_tail = 0;
+  m_full = false;
+
+  CreateBuffer(device, physicalDevice, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_buffer, &m_memory);
+
+  // HOST_VISIBLE memory stays mapped for the lifetime of the allocation
+  m_pMappedData = g_MemoryAllocator.GetMappedData(m_buffer);
+}
+
+void StagingRing::Cleanup() {
+  if (m_buffer == VK_NULL_HANDLE) return;
+
+  g_MemoryAllocator.FreeBufferMemory(m_buffer);
+  vkDestroyBuffer(m_pDevice, m_buffer, nullptr);
+  m_buffer = VK_NULL_HANDLE;
+  m_memory = VK_NULL_HANDLE;
+  m_pMappedData = nullptr;
+}
+}  // namespace VkUtils
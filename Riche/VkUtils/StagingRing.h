@@ -0,0 +1,68 @@
+#pragma once
+#include "Rendering/Core.h"
+
+namespace VkUtils {
+
+/*
+ * StagingRing : one persistently mapped HOST_VISIBLE | HOST_COHERENT buffer used as a ring for uploads
+ *  - Allocate() hands out [offset, offset + size) at the head, Retire() moves the tail to the end of a finished submit.
+ *  - The ring never waits by itself, when Allocate() fails the owner submits what is pending and retires the oldest submit
+ *    (see ResourceManager::AllocateStaging).
+ */
+class StagingRing {
+ public:
+  static constexpr VkDeviceSize DEFAULT_CAPACITY = 64ull * 1024 * 1024;  // 64MB
+
+  void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity = DEFAULT_CAPACITY);
+  void Cleanup();
+
+  // false if there is no room until older submits retire
+  bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* pOutOffset) {
+    if (size > m_capacity) return false;
+
+    VkDeviceSize alignedHead = (m_head + alignment - 1) / alignment * alignment;
+    if (!m_full && m_head >= m_tail) {
+      // Free : [head, capacity) and [0, tail)
+      if (alignedHead + size <= m_capacity) {
+        *pOutOffset = alignedHead;
+      } else if (size <= m_tail) {
+        *pOutOffset = 0;  // Wrap, [head, capacity) is skipped until the tail passes it
+      } else {
+        return false;
+      }
+    } else {
+      // Free : [head, tail)
+      if (m_full || alignedHead + size > m_tail) return false;
+      *pOutOffset = alignedHead;
+    }
+
+    m_head = *pOutOffset + size;
+    m_full = m_head == m_tail && size > 0;
+    return true;
+  }
+
+  // Everything allocated before 'head' (a value returned by GetHead() at submit time) is no longer read by the GPU
+  void Retire(VkDeviceSize head) {
+    m_tail = head;
+    m_full = false;
+    if (m_tail == m_head) m_head = m_tail = 0;  // Empty, restart at the front to avoid wrapping
+  }
+
+  VkDeviceSize GetHead() const { return m_head; }
+  VkDeviceSize GetCapacity() const { return m_capacity; }
+  VkBuffer GetBuffer() const { return m_buffer; }
+  uint8_t* GetMappedData(VkDeviceSize offset) const { return m_pMappedData + offset; }
+
+ private:
+  VkDevice m_pDevice = VK_NULL_HANDLE;
+  VkBuffer m_buffer = VK_NULL_HANDLE;
+  VkDeviceMemory m_memory = VK_NULL_HANDLE;
+  uint8_t* m_pMappedData = nullptr;
+
+  VkDeviceSize m_capacity = 0;
+  VkDeviceSize m_head = 0;  // next free byte
+  VkDeviceSize m_tail = 0;  // oldest byte still in flight
+  bool m_full = false;      // head == tail is ambiguous, this tells full from empty
+};
+
+}  // namespace VkUtils
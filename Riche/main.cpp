@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <cstdlib>  // std::system
 #include <filesystem>
 #include <string_view>
 
 #include "Rendering/Camera.h"
 #include "Rendering/VulkanRenderer.h"
+#include "Utils/TextureCooker.h"
 
 GLFWwindow* window;
 VulkanRenderer vulkanRenderer;
@@ -12,8 +14,8 @@ Camera g_camera;
 static double deltaTime = 0.0;
 static float smoothedDeltaTime = 0.016f;
 
-double lastX = 0.0, lastY = 0.0;  //   콺 ǥ
-bool firstMouse = true;           // ʱ 콺 ġ Ȯ  ÷
+double lastX = 0.0, lastY = 0.0;  // 이전 프레임의 마우스 좌표
+bool firstMouse = true;           // 초기 마우스 위치 확인을 위한 플래그
 bool rightButtonPressed = false;
 bool leftButtonPressed = false;
 bool hasLeftButtonPressed = false;
@@ -21,11 +23,11 @@ bool hasLeftButtonPressed = false;
 void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) { /*g_camera.OnKeyInput(deltaTime, key);*/ }
 
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
-  if (button == GLFW_MOUSE_BUTTON_RIGHT) {  // 콺  ư 
-    if (action == GLFW_PRESS) {             //  
+  if (button == GLFW_MOUSE_BUTTON_RIGHT) {  // 마우스 오른쪽 버튼일 경우
+    if (action == GLFW_PRESS) {             // 누를 때
       rightButtonPressed = true;
-      firstMouse = true;                  // 콺   ʱȭ
-    } else if (action == GLFW_RELEASE) {  //  
+      firstMouse = true;                  // 마우스를 누를 때마다 초기화
+    } else if (action == GLFW_RELEASE) {  // 뗄 때
       rightButtonPressed = false;
     }
   }
@@ -45,7 +47,7 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 
   } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) {
     leftButtonPressed = false;
-    hasLeftButtonPressed = false;  //  巡׸  Ǯ
+    hasLeftButtonPressed = false;  // 다음 드래그를 위해 풀어줌
     g_camera.isMousePressed = false;
   }
 }
@@ -53,17 +55,17 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 void CursorPositionCallback(GLFWwindow* window, double xpos, double ypos) {
   if (rightButtonPressed) {
     if (firstMouse) {
-      // ó  ġ   ʱ ġ 
+      // 처음엔 이전 위치가 없기 때문에 초기 위치 설정
       lastX = xpos;
       lastY = ypos;
       firstMouse = false;
     }
 
-    // DeltaX, DeltaY 
+    // DeltaX, DeltaY 계산
     double deltaX = (xpos - lastX);
     double deltaY = (ypos - lastY);
 
-    //  ġ  ġ 
+    // 현재 위치를 이전 위치로 갱신
     lastX = xpos;
     lastY = ypos;
 
@@ -82,7 +84,18 @@ void InitWindow(std::string wName = "Test Window", const int w = 800, const int
   window = glfwCreateWindow(w, h, wName.c_str(), nullptr, nullptr);
 }
 
-int main() {
+int main(int argc, char** argv) {
+  // Riche.exe --cook [directory] [--force] : BCn .rtex next to every texture under directory, no window
+  if (argc > 1 && std::string_view(argv[1]) == "--cook") {
+    std::string directory = (argc > 2 && std::string_view(argv[2]) != "--force") ? argv[2] : "Resources/";
+    bool isForced = std::string_view(argv[argc - 1]) == "--force";
+
+    g_ThreadPool.Initialize((std::max)(1u, std::thread::hardware_concurrency()) - 1);
+    TextureCooker::CookStats stats = TextureCooker::CookDirectory(directory, isForced);
+    g_ThreadPool.Destroy();
+    return stats.failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   // Create Window
   InitWindow("Test Widnow", 1920, 1080);
 